@@ -0,0 +1,271 @@
+/*
+ * Hostitelská implementace furi_hal_crypto a furi_hal_random: AES-256
+ * (FIPS-197), CBC pro klíč z enklávy a GCM (NIST SP 800-38D). Na zařízení
+ * totéž počítá hardwarová AES jednotka.
+ *
+ * Implementace je přímočará (S-box bez T-tabulek, GHASH po bitech),
+ * hesla jsou krátká a rychlost tu nerozhoduje.
+ */
+
+#include <furi.h>
+#include <furi_hal.h>
+
+#include <sys/random.h>
+
+#define AES_BLOCK_SIZE 16
+#define AES_256_KEY_SIZE 32
+#define AES_256_ROUNDS 14
+
+// Pevný "klíč zařízení" hostitele, na zařízení je jedinečný a nečitelný
+static const uint8_t crypto_shim_unique_key[AES_256_KEY_SIZE] = {
+    0x50, 0x57, 0x4d, 0x2d, 0x68, 0x6f, 0x73, 0x74, 0x2d, 0x75, 0x6e, 0x69, 0x71, 0x75, 0x65, 0x2d,
+    0x6b, 0x65, 0x79, 0x2d, 0x6e, 0x6f, 0x74, 0x2d, 0x73, 0x65, 0x63, 0x72, 0x65, 0x74, 0x21, 0x00,
+};
+
+static const uint8_t aes_sbox[256] = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+typedef struct {
+    uint8_t round_keys[(AES_256_ROUNDS + 1) * AES_BLOCK_SIZE];
+} AesContext;
+
+static AesContext crypto_shim_enclave;
+static uint8_t crypto_shim_enclave_iv[AES_BLOCK_SIZE];
+static bool crypto_shim_enclave_loaded = false;
+
+// AES
+
+static uint8_t aes_xtime(uint8_t x) {
+    return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00));
+}
+
+static void aes_key_expand(AesContext* context, const uint8_t* key) {
+    uint8_t* w = context->round_keys;
+    memcpy(w, key, AES_256_KEY_SIZE);
+
+    uint8_t rcon = 0x01;
+    for(size_t i = AES_256_KEY_SIZE; i < sizeof(context->round_keys); i += 4) {
+        uint8_t t[4];
+        memcpy(t, w + i - 4, 4);
+        if(i % AES_256_KEY_SIZE == 0) {
+            uint8_t first = t[0];
+            t[0] = aes_sbox[t[1]] ^ rcon;
+            t[1] = aes_sbox[t[2]];
+            t[2] = aes_sbox[t[3]];
+            t[3] = aes_sbox[first];
+            rcon = aes_xtime(rcon);
+        } else if(i % AES_256_KEY_SIZE == 16) {
+            for(size_t k = 0; k < 4; k++) t[k] = aes_sbox[t[k]];
+        }
+        for(size_t k = 0; k < 4; k++) w[i + k] = w[i - AES_256_KEY_SIZE + k] ^ t[k];
+    }
+}
+
+static void aes_encrypt_block(const AesContext* context, const uint8_t* input, uint8_t* output) {
+    uint8_t state[AES_BLOCK_SIZE];
+    for(size_t i = 0; i < AES_BLOCK_SIZE; i++) state[i] = input[i] ^ context->round_keys[i];
+
+    for(size_t round = 1; round <= AES_256_ROUNDS; round++) {
+        // SubBytes a ShiftRows (stav je po sloupcích)
+        uint8_t shifted[AES_BLOCK_SIZE];
+        for(size_t column = 0; column < 4; column++) {
+            for(size_t row = 0; row < 4; row++) {
+                shifted[column * 4 + row] = aes_sbox[state[((column + row) % 4) * 4 + row]];
+            }
+        }
+
+        // MixColumns (kromě posledního kola)
+        if(round != AES_256_ROUNDS) {
+            for(size_t column = 0; column < 4; column++) {
+                uint8_t* c = shifted + column * 4;
+                uint8_t all = c[0] ^ c[1] ^ c[2] ^ c[3];
+                uint8_t first = c[0];
+                c[0] ^= all ^ aes_xtime(c[0] ^ c[1]);
+                c[1] ^= all ^ aes_xtime(c[1] ^ c[2]);
+                c[2] ^= all ^ aes_xtime(c[2] ^ c[3]);
+                c[3] ^= all ^ aes_xtime(c[3] ^ first);
+            }
+        }
+
+        const uint8_t* round_key = context->round_keys + round * AES_BLOCK_SIZE;
+        for(size_t i = 0; i < AES_BLOCK_SIZE; i++) state[i] = shifted[i] ^ round_key[i];
+    }
+    memcpy(output, state, AES_BLOCK_SIZE);
+}
+
+// Enkláva
+
+bool furi_hal_crypto_enclave_load_key(uint8_t slot, const uint8_t* iv) {
+    if(slot != FURI_HAL_CRYPTO_ENCLAVE_UNIQUE_KEY_SLOT) return false;
+    aes_key_expand(&crypto_shim_enclave, crypto_shim_unique_key);
+    memcpy(crypto_shim_enclave_iv, iv, AES_BLOCK_SIZE);
+    crypto_shim_enclave_loaded = true;
+    return true;
+}
+
+bool furi_hal_crypto_enclave_unload_key(uint8_t slot) {
+    UNUSED(slot);
+    memset(&crypto_shim_enclave, 0, sizeof(crypto_shim_enclave));
+    crypto_shim_enclave_loaded = false;
+    return true;
+}
+
+bool furi_hal_crypto_encrypt(const uint8_t* input, uint8_t* output, size_t size) {
+    if(!crypto_shim_enclave_loaded || size % AES_BLOCK_SIZE != 0) return false;
+
+    uint8_t chain[AES_BLOCK_SIZE];
+    memcpy(chain, crypto_shim_enclave_iv, AES_BLOCK_SIZE);
+    for(size_t offset = 0; offset < size; offset += AES_BLOCK_SIZE) {
+        for(size_t i = 0; i < AES_BLOCK_SIZE; i++) chain[i] ^= input[offset + i];
+        aes_encrypt_block(&crypto_shim_enclave, chain, chain);
+        memcpy(output + offset, chain, AES_BLOCK_SIZE);
+    }
+    return true;
+}
+
+// GCM
+
+// Násobení v GF(2^128) s polynomem GCM (bity v pořadí GCM)
+static void gcm_multiply(uint8_t* x, const uint8_t* h) {
+    uint8_t z[AES_BLOCK_SIZE] = {0};
+    uint8_t v[AES_BLOCK_SIZE];
+    memcpy(v, h, AES_BLOCK_SIZE);
+
+    for(size_t i = 0; i < AES_BLOCK_SIZE * 8; i++) {
+        if(x[i / 8] & (0x80 >> (i % 8))) {
+            for(size_t k = 0; k < AES_BLOCK_SIZE; k++) z[k] ^= v[k];
+        }
+        bool carry = v[AES_BLOCK_SIZE - 1] & 1;
+        for(size_t k = AES_BLOCK_SIZE - 1; k > 0; k--) v[k] = (v[k] >> 1) | (v[k - 1] << 7);
+        v[0] >>= 1;
+        if(carry) v[0] ^= 0xe1;
+    }
+    memcpy(x, z, AES_BLOCK_SIZE);
+}
+
+static void gcm_ghash_update(uint8_t* hash, const uint8_t* h, const uint8_t* data, size_t size) {
+    for(size_t offset = 0; offset < size; offset += AES_BLOCK_SIZE) {
+        size_t block = MIN(size - offset, (size_t)AES_BLOCK_SIZE);
+        for(size_t i = 0; i < block; i++) hash[i] ^= data[offset + i];
+        gcm_multiply(hash, h);
+    }
+}
+
+static void gcm_counter_increment(uint8_t* counter) {
+    for(size_t i = AES_BLOCK_SIZE; i-- > AES_BLOCK_SIZE - 4;) {
+        if(++counter[i] != 0) break;
+    }
+}
+
+/**
+ * Společná část šifrování i dešifrování: CTR od J0 + 1 a značka
+ * z GHASH nad AAD a šifrovým textem.
+ */
+static void gcm_process(
+    const uint8_t* key,
+    const uint8_t* iv,
+    const uint8_t* aad,
+    size_t aad_length,
+    const uint8_t* input,
+    uint8_t* output,
+    size_t length,
+    bool encrypt,
+    uint8_t* tag) {
+    AesContext context;
+    aes_key_expand(&context, key);
+
+    uint8_t h[AES_BLOCK_SIZE] = {0};
+    aes_encrypt_block(&context, h, h);
+
+    uint8_t j0[AES_BLOCK_SIZE] = {0};
+    memcpy(j0, iv, FURI_HAL_CRYPTO_GCM_IV_LENGTH);
+    j0[AES_BLOCK_SIZE - 1] = 1;
+
+    uint8_t hash[AES_BLOCK_SIZE] = {0};
+    gcm_ghash_update(hash, h, aad, aad_length);
+    // Při dešifrování vstupuje do GHASH šifrový text ještě před zpracováním
+    if(!encrypt) gcm_ghash_update(hash, h, input, length);
+
+    uint8_t counter[AES_BLOCK_SIZE];
+    uint8_t stream[AES_BLOCK_SIZE];
+    memcpy(counter, j0, AES_BLOCK_SIZE);
+    for(size_t offset = 0; offset < length; offset += AES_BLOCK_SIZE) {
+        gcm_counter_increment(counter);
+        aes_encrypt_block(&context, counter, stream);
+        size_t block = MIN(length - offset, (size_t)AES_BLOCK_SIZE);
+        for(size_t i = 0; i < block; i++) output[offset + i] = input[offset + i] ^ stream[i];
+    }
+    if(encrypt) gcm_ghash_update(hash, h, output, length);
+
+    uint8_t lengths[AES_BLOCK_SIZE];
+    uint64_t aad_bits = (uint64_t)aad_length * 8;
+    uint64_t text_bits = (uint64_t)length * 8;
+    for(size_t i = 0; i < 8; i++) {
+        lengths[i] = (uint8_t)(aad_bits >> (56 - i * 8));
+        lengths[8 + i] = (uint8_t)(text_bits >> (56 - i * 8));
+    }
+    gcm_ghash_update(hash, h, lengths, sizeof(lengths));
+
+    aes_encrypt_block(&context, j0, stream);
+    for(size_t i = 0; i < FURI_HAL_CRYPTO_GCM_TAG_LENGTH; i++) tag[i] = hash[i] ^ stream[i];
+
+    memset(&context, 0, sizeof(context));
+    memset(stream, 0, sizeof(stream));
+}
+
+FuriHalCryptoGCMState furi_hal_crypto_gcm_encrypt_and_tag(
+    const uint8_t* key,
+    const uint8_t* iv,
+    const uint8_t* aad,
+    size_t aad_length,
+    const uint8_t* input,
+    uint8_t* output,
+    size_t length,
+    uint8_t* tag) {
+    gcm_process(key, iv, aad, aad_length, input, output, length, true, tag);
+    return FuriHalCryptoGCMStateOk;
+}
+
+FuriHalCryptoGCMState furi_hal_crypto_gcm_decrypt_and_verify(
+    const uint8_t* key,
+    const uint8_t* iv,
+    const uint8_t* aad,
+    size_t aad_length,
+    const uint8_t* input,
+    uint8_t* output,
+    size_t length,
+    const uint8_t* tag) {
+    uint8_t computed[FURI_HAL_CRYPTO_GCM_TAG_LENGTH];
+    gcm_process(key, iv, aad, aad_length, input, output, length, false, computed);
+
+    // Porovnání v konstantním čase
+    uint8_t difference = 0;
+    for(size_t i = 0; i < sizeof(computed); i++) difference |= computed[i] ^ tag[i];
+    if(difference != 0) {
+        memset(output, 0, length);
+        return FuriHalCryptoGCMStateAuthFailure;
+    }
+    return FuriHalCryptoGCMStateOk;
+}
+
+// Náhodná čísla
+
+void furi_hal_random_fill_buf(uint8_t* buf, uint32_t len) {
+    if(getrandom(buf, len, 0) != (ssize_t)len) furi_crash("getrandom selhal");
+}
@@ -0,0 +1,493 @@
+/*
+ * Hostitelská implementace té části furi/furi_hal, kterou používá
+ * úložiště hesel: logování, záznamy, čas, čítač cyklů, vlákna, fronta
+ * zpráv, FuriString a měření haldy.
+ */
+
+#include <furi.h>
+#include <furi_hal.h>
+#include <toolbox/version.h>
+
+#include <malloc.h>
+#include <pthread.h>
+#include <time.h>
+
+#define FURI_SHIM_STRING_MIN_CAPACITY 16
+
+// Halda
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+static size_t heap_used = 0;
+static size_t heap_peak = 0;
+
+// Alokuje i vlákno workeru psaní a loaderu
+static void furi_shim_heap_account(size_t added, size_t removed) {
+    size_t used = __atomic_add_fetch(&heap_used, added - removed, __ATOMIC_RELAXED);
+    size_t peak = __atomic_load_n(&heap_peak, __ATOMIC_RELAXED);
+    while(used > peak && !__atomic_compare_exchange_n(
+                             &heap_peak, &peak, used, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void* __wrap_malloc(size_t size) {
+    void* ptr = __real_malloc(size);
+    if(ptr) furi_shim_heap_account(malloc_usable_size(ptr), 0);
+    return ptr;
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    void* ptr = __real_calloc(count, size);
+    if(ptr) furi_shim_heap_account(malloc_usable_size(ptr), 0);
+    return ptr;
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    size_t old_size = ptr ? malloc_usable_size(ptr) : 0;
+    void* new_ptr = __real_realloc(ptr, size);
+    if(new_ptr) {
+        furi_shim_heap_account(malloc_usable_size(new_ptr), old_size);
+    } else if(size == 0) {
+        furi_shim_heap_account(0, old_size);
+    }
+    return new_ptr;
+}
+
+void __wrap_free(void* ptr) {
+    if(ptr) furi_shim_heap_account(0, malloc_usable_size(ptr));
+    __real_free(ptr);
+}
+
+size_t furi_shim_heap_used(void) {
+    return heap_used;
+}
+
+size_t furi_shim_heap_peak(void) {
+    return heap_peak;
+}
+
+void furi_shim_heap_reset_peak(void) {
+    heap_peak = heap_used;
+}
+
+// Pád a logování
+
+void furi_crash(const char* message) {
+    fprintf(stderr, "furi_crash: %s\n", message);
+    abort();
+}
+
+static FuriLogLevel log_level = FuriLogLevelNone;
+static bool log_level_initialized = false;
+
+void furi_log_set_level(FuriLogLevel level) {
+    log_level = level;
+    log_level_initialized = true;
+}
+
+void furi_log_print_format(FuriLogLevel level, const char* tag, const char* format, ...) {
+    if(!log_level_initialized) {
+        const char* env = getenv("PASSWORD_HOST_LOG");
+        log_level = env ? (FuriLogLevel)atoi(env) : FuriLogLevelNone;
+        log_level_initialized = true;
+    }
+    if(level > log_level) return;
+
+    static const char* const prefixes[] = {"", "E", "W", "I", "D", "T"};
+    fprintf(stderr, "[%s][%s] ", prefixes[level], tag);
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+    fputc('\n', stderr);
+}
+
+// Záznamy
+
+void* furi_record_open(const char* name) {
+    // Služby na hostiteli nemají stav, stačí nenulový ukazatel
+    static char record;
+    UNUSED(name);
+    return &record;
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+// Čas
+//
+// furi_delay_ms na hostiteli nespí, jen posune virtuální hodiny. Benchmark
+// tak změří, kolik času by operace strávila na zařízení, a neběží zbytečně.
+
+static uint64_t virtual_delay_us = 0;
+
+static uint64_t furi_shim_monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+uint32_t furi_get_tick(void) {
+    uint64_t delay_us = __atomic_load_n(&virtual_delay_us, __ATOMIC_RELAXED);
+    return (uint32_t)((furi_shim_monotonic_us() + delay_us) / 1000ULL);
+}
+
+uint32_t furi_kernel_get_tick_frequency(void) {
+    return 1000;
+}
+
+uint32_t furi_ms_to_ticks(uint32_t milliseconds) {
+    return milliseconds;
+}
+
+void furi_delay_ms(uint32_t milliseconds) {
+    __atomic_add_fetch(&virtual_delay_us, (uint64_t)milliseconds * 1000ULL, __ATOMIC_RELAXED);
+}
+
+void furi_delay_us(uint32_t microseconds) {
+    __atomic_add_fetch(&virtual_delay_us, (uint64_t)microseconds, __ATOMIC_RELAXED);
+}
+
+#define FURI_SHIM_CYCLES_PER_US 64
+
+static __thread DWT_Type furi_shim_dwt_registers;
+
+DWT_Type* furi_shim_dwt(void) {
+    uint64_t delay_us = __atomic_load_n(&virtual_delay_us, __ATOMIC_RELAXED);
+    furi_shim_dwt_registers.CYCCNT =
+        (uint32_t)((furi_shim_monotonic_us() + delay_us) * FURI_SHIM_CYCLES_PER_US);
+    return &furi_shim_dwt_registers;
+}
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return FURI_SHIM_CYCLES_PER_US;
+}
+
+uint32_t furi_hal_rtc_get_timestamp(void) {
+    return time(NULL);
+}
+
+const char* version_get_version(const Version* version) {
+    UNUSED(version);
+    return "host";
+}
+
+// Vlákna
+//
+// Příznaky vlákna chrání mutex a podmínka, timeout čekání na příznaky
+// se na hostiteli nepoužívá a čeká se vždy bez omezení.
+
+struct FuriThread {
+    pthread_t handle;
+    pthread_mutex_t flags_mutex;
+    pthread_cond_t flags_cond;
+    uint32_t flags;
+    FuriThreadCallback callback;
+    void* context;
+};
+
+static __thread FuriThread* furi_shim_current_thread = NULL;
+
+static void* furi_shim_thread_body(void* arg) {
+    FuriThread* thread = arg;
+    furi_shim_current_thread = thread;
+    thread->callback(thread->context);
+    return NULL;
+}
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context) {
+    UNUSED(name);
+    UNUSED(stack_size);
+    FuriThread* thread = calloc(1, sizeof(FuriThread));
+    pthread_mutex_init(&thread->flags_mutex, NULL);
+    pthread_cond_init(&thread->flags_cond, NULL);
+    thread->callback = callback;
+    thread->context = context;
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    pthread_cond_destroy(&thread->flags_cond);
+    pthread_mutex_destroy(&thread->flags_mutex);
+    free(thread);
+}
+
+void furi_thread_start(FuriThread* thread) {
+    furi_check(pthread_create(&thread->handle, NULL, furi_shim_thread_body, thread) == 0);
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    return pthread_join(thread->handle, NULL) == 0;
+}
+
+FuriThreadId furi_thread_get_id(FuriThread* thread) {
+    return thread;
+}
+
+uint32_t furi_thread_flags_set(FuriThreadId thread_id, uint32_t flags) {
+    pthread_mutex_lock(&thread_id->flags_mutex);
+    thread_id->flags |= flags;
+    uint32_t result = thread_id->flags;
+    pthread_cond_broadcast(&thread_id->flags_cond);
+    pthread_mutex_unlock(&thread_id->flags_mutex);
+    return result;
+}
+
+uint32_t furi_thread_flags_wait(uint32_t flags, uint32_t options, uint32_t timeout) {
+    UNUSED(timeout);
+    FuriThread* thread = furi_shim_current_thread;
+    furi_check(thread);
+    pthread_mutex_lock(&thread->flags_mutex);
+    while((options & FuriFlagWaitAll) ? (thread->flags & flags) != flags :
+                                        (thread->flags & flags) == 0) {
+        pthread_cond_wait(&thread->flags_cond, &thread->flags_mutex);
+    }
+    uint32_t result = thread->flags;
+    if(!(options & FuriFlagNoClear)) thread->flags &= ~flags;
+    pthread_mutex_unlock(&thread->flags_mutex);
+    return result;
+}
+
+// Mutexy
+
+struct FuriMutex {
+    pthread_mutex_t handle;
+};
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    FuriMutex* mutex = calloc(1, sizeof(FuriMutex));
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    if(type == FuriMutexTypeRecursive) {
+        pthread_mutexattr_settype(&attributes, PTHREAD_MUTEX_RECURSIVE);
+    }
+    pthread_mutex_init(&mutex->handle, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* instance) {
+    pthread_mutex_destroy(&instance->handle);
+    free(instance);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* instance, uint32_t timeout) {
+    UNUSED(timeout);
+    return pthread_mutex_lock(&instance->handle) == 0 ? FuriStatusOk : FuriStatusError;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* instance) {
+    return pthread_mutex_unlock(&instance->handle) == 0 ? FuriStatusOk : FuriStatusError;
+}
+
+// Fronta zpráv
+//
+// Kruhový buffer pod mutexem. Na hostiteli se nečeká: timeout se nepoužívá,
+// plná nebo prázdná fronta vrátí FuriStatusErrorResource hned.
+
+struct FuriMessageQueue {
+    pthread_mutex_t mutex;
+    uint8_t* messages;
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t head;
+    uint32_t count;
+};
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size) {
+    FuriMessageQueue* queue = calloc(1, sizeof(FuriMessageQueue));
+    pthread_mutex_init(&queue->mutex, NULL);
+    queue->messages = malloc((size_t)msg_count * msg_size);
+    queue->capacity = msg_count;
+    queue->size = msg_size;
+    return queue;
+}
+
+void furi_message_queue_free(FuriMessageQueue* instance) {
+    pthread_mutex_destroy(&instance->mutex);
+    free(instance->messages);
+    free(instance);
+}
+
+FuriStatus furi_message_queue_put(FuriMessageQueue* instance, const void* msg_ptr, uint32_t timeout) {
+    UNUSED(timeout);
+    pthread_mutex_lock(&instance->mutex);
+    FuriStatus status = FuriStatusErrorResource;
+    if(instance->count < instance->capacity) {
+        uint32_t tail = (instance->head + instance->count) % instance->capacity;
+        memcpy(instance->messages + (size_t)tail * instance->size, msg_ptr, instance->size);
+        instance->count++;
+        status = FuriStatusOk;
+    }
+    pthread_mutex_unlock(&instance->mutex);
+    return status;
+}
+
+FuriStatus furi_message_queue_get(FuriMessageQueue* instance, void* msg_ptr, uint32_t timeout) {
+    UNUSED(timeout);
+    pthread_mutex_lock(&instance->mutex);
+    FuriStatus status = FuriStatusErrorResource;
+    if(instance->count > 0) {
+        memcpy(msg_ptr, instance->messages + (size_t)instance->head * instance->size, instance->size);
+        instance->head = (instance->head + 1) % instance->capacity;
+        instance->count--;
+        status = FuriStatusOk;
+    }
+    pthread_mutex_unlock(&instance->mutex);
+    return status;
+}
+
+uint32_t furi_message_queue_get_count(FuriMessageQueue* instance) {
+    pthread_mutex_lock(&instance->mutex);
+    uint32_t count = instance->count;
+    pthread_mutex_unlock(&instance->mutex);
+    return count;
+}
+
+// FuriString
+
+struct FuriString {
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+static void furi_string_reserve(FuriString* string, size_t size) {
+    if(size + 1 <= string->capacity) return;
+    size_t capacity = string->capacity ? string->capacity : FURI_SHIM_STRING_MIN_CAPACITY;
+    while(capacity < size + 1) capacity *= 2;
+    string->data = realloc(string->data, capacity);
+    string->capacity = capacity;
+}
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = calloc(1, sizeof(FuriString));
+    furi_string_reserve(string, 0);
+    string->data[0] = '\0';
+    return string;
+}
+
+FuriString* furi_string_alloc_set(const FuriString* source) {
+    return furi_string_alloc_set_str(source->data);
+}
+
+FuriString* furi_string_alloc_set_str(const char* cstr) {
+    FuriString* string = furi_string_alloc();
+    furi_string_set_str(string, cstr);
+    return string;
+}
+
+FuriString* furi_string_alloc_printf(const char* format, ...) {
+    FuriString* string = furi_string_alloc();
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if(length > 0) {
+        furi_string_reserve(string, (size_t)length);
+        va_start(args, format);
+        vsnprintf(string->data, (size_t)length + 1, format, args);
+        va_end(args);
+        string->size = (size_t)length;
+    }
+    return string;
+}
+
+void furi_string_free(FuriString* string) {
+    free(string->data);
+    free(string);
+}
+
+void furi_string_reset(FuriString* string) {
+    string->size = 0;
+    string->data[0] = '\0';
+}
+
+void furi_string_set_str(FuriString* string, const char* cstr) {
+    furi_string_reset(string);
+    furi_string_cat_str(string, cstr);
+}
+
+void furi_string_cat_str(FuriString* string, const char* cstr) {
+    size_t length = strlen(cstr);
+    furi_string_reserve(string, string->size + length);
+    memcpy(string->data + string->size, cstr, length + 1);
+    string->size += length;
+}
+
+void furi_string_push_back(FuriString* string, char c) {
+    furi_string_reserve(string, string->size + 1);
+    string->data[string->size++] = c;
+    string->data[string->size] = '\0';
+}
+
+static int furi_string_cat_vprintf(FuriString* string, const char* format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    if(length <= 0) return length;
+    furi_string_reserve(string, string->size + (size_t)length);
+    vsnprintf(string->data + string->size, (size_t)length + 1, format, args);
+    string->size += (size_t)length;
+    return length;
+}
+
+int furi_string_printf(FuriString* string, const char* format, ...) {
+    furi_string_reset(string);
+    va_list args;
+    va_start(args, format);
+    int result = furi_string_cat_vprintf(string, format, args);
+    va_end(args);
+    return result;
+}
+
+int furi_string_cat_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int result = furi_string_cat_vprintf(string, format, args);
+    va_end(args);
+    return result;
+}
+
+int furi_string_cmp_str(const FuriString* string, const char* cstr) {
+    return strcmp(string->data, cstr);
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return string->size;
+}
+
+char furi_string_get_char(const FuriString* string, size_t index) {
+    furi_check(index < string->size);
+    return string->data[index];
+}
+
+void furi_string_left(FuriString* string, size_t index) {
+    if(index < string->size) {
+        string->size = index;
+        string->data[index] = '\0';
+    }
+}
+
+size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t length = strlen(src);
+    if(size) {
+        size_t copy = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, copy);
+        dst[copy] = '\0';
+    }
+    return length;
+}
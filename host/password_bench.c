@@ -0,0 +1,654 @@
+/*
+ * Benchmark úložiště hesel pro hostitelský build.
+ *
+ * Pro každou velikost trezoru vygeneruje textový soubor, změří jeho převod
+ * na binární trezor a náhodný přístup k namapovanému trezoru (mmap) a v plném
+ * i stránkovaném režimu změří latenci otevření, procházení, hledání
+ * podle prefixu (na jeden napsaný znak), hledání přesného názvu, fuzzy hledání s prosetím masek
+ * proti naivnímu porovnání všech názvů, uložení,
+ * password_list_add a password_list_remove (včetně dávkového zápisu
+ * do žurnálu a průběžného slučování), otevření s přehráním žurnálu a špičkové
+ * využití haldy při otevření a procházení.
+ *
+ * S --kdf místo toho změří rychlost PBKDF2 (iterace za sekundu) a počet
+ * iterací, který by kalibrace zvolila pro PASSWORD_KDF_TARGET_MS.
+ *
+ * S --hid napíše testovací heslo každou rychlostí psaní přes zaznamenávající
+ * přenos, změří dobu psaní (součet prodlev na zařízení), čas posledního
+ * reportu (kdy má cíl celé heslo) a počet HID reportů a ze záznamu reportů
+ * ověří, že cíl dostane přesně zadaný text.
+ *
+ * S --totp změří propustnost kódů TOTP pro SHA-1 a SHA-256: s předpočítaným
+ * stavem HMAC (dvě komprese na kód) a s přípravou klíče pro každý kód
+ * znovu (čtyři komprese), jak by se počítal bez mezipaměti.
+ *
+ * S --gen změří propustnost generátoru hesel pro několik zásad: s náhodnými
+ * bajty po dávkách (jedno volání generátoru na PASSWORD_GENERATOR_RANDOM_SIZE B)
+ * a s jedním voláním na bajt, jak by se bajty bralo bez bufferu.
+ *
+ * Použití: password_bench [-n 50,1000,10000,100000] [-r opakování] [--csv] [--kdf] [--hid] [--totp] [--gen]
+ */
+
+#include "../password_storage.h"
+#include "../password_generator.h"
+#include "../password_kdf.h"
+#include "../password_keyboard.h"
+#include "../password_totp.h"
+#include "password_hid_mock.h"
+#include "password_vault_mmap.h"
+
+#include <furi_hal.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_DIRECTORY "/ext/passwords"
+#define BENCH_TEXT_PATH BENCH_DIRECTORY "/bench.txt"
+#define BENCH_VAULT_PATH BENCH_DIRECTORY "/bench.pwv"
+#define BENCH_SAVE_PATH BENCH_DIRECTORY "/bench_save.pwv"
+#define BENCH_MAX_SIZES 16
+#define BENCH_SEARCH_RESULTS 8
+#define BENCH_KDF_ITERATIONS 100000
+#define BENCH_TOTP_CODES 200000
+#define BENCH_GEN_PASSWORDS 100000
+#define BENCH_HID_PASSWORD "Tr0ub4dor&3-correct-HORSE-battery-staple!9_x{Zq}~`p@ss w0rd:\"<>?"
+
+// Pevný klíč, běhy tak nezávisí na klíči zařízení
+static const uint8_t bench_key[PASSWORD_CRYPTO_KEY_SIZE] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+    0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+};
+
+typedef struct {
+    uint32_t entries;
+    PasswordListMode mode;
+    uint32_t loaded;
+    double convert_ms;
+    double mmap_get_us;
+    double open_ms;
+    double reopen_ms;
+    double get_us;
+    double filter_us;
+    double find_us;
+    double naive_us;
+    double fuzzy_us;
+    double save_ms;
+    double add_us;
+    double remove_us;
+    double replay_ms;
+    size_t peak_bytes;
+} BenchStorageResult;
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Deterministický generátor, aby byly běhy srovnatelné
+static uint32_t bench_random_state = 0x12345678;
+
+static uint32_t bench_random(void) {
+    bench_random_state ^= bench_random_state << 13;
+    bench_random_state ^= bench_random_state >> 17;
+    bench_random_state ^= bench_random_state << 5;
+    return bench_random_state;
+}
+
+static void bench_random_string(char* out, size_t min_length, size_t max_length) {
+    static const char alphabet[] =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789!@#$%^&*()-_=+";
+    size_t length = min_length + bench_random() % (max_length - min_length + 1);
+    for(size_t i = 0; i < length; i++) {
+        out[i] = alphabet[bench_random() % (sizeof(alphabet) - 1)];
+    }
+    out[length] = '\0';
+}
+
+static void bench_entry(uint32_t index, char* name, char* password) {
+    char suffix[12];
+    bench_random_string(suffix, 4, 10);
+    snprintf(name, NAME_MAX_LENGTH, "entry-%06u-%s", index, suffix);
+    bench_random_string(password, 12, 40);
+}
+
+static bool bench_generate_text(const char* path, uint32_t entries) {
+    char host_path[512];
+    storage_shim_host_path(path, host_path, sizeof(host_path));
+    FILE* file = fopen(host_path, "wb");
+    if(!file) return false;
+
+    bench_random_state = 0x12345678;
+    char name[NAME_MAX_LENGTH];
+    char password[PASSWORD_MAX_LENGTH];
+    for(uint32_t i = 0; i < entries; i++) {
+        bench_entry(i, name, password);
+        fprintf(file, "%s:%s\n", name, password);
+    }
+    fclose(file);
+    return true;
+}
+
+static double bench_ms_since(uint64_t start) {
+    return (double)(bench_now_ns() - start) / 1e6;
+}
+
+static void bench_min(double* value, double sample) {
+    if(sample < *value) *value = sample;
+}
+
+static void bench_storage_run(
+    uint32_t entries,
+    PasswordListMode mode,
+    uint32_t repeat,
+    BenchStorageResult* result) {
+    memset(result, 0, sizeof(BenchStorageResult));
+    result->entries = entries;
+    result->mode = mode;
+    result->convert_ms = result->mmap_get_us = 1e300;
+    result->open_ms = result->reopen_ms = result->get_us = result->filter_us = 1e300;
+    result->find_us = 1e300;
+    result->naive_us = result->fuzzy_us = 1e300;
+    result->save_ms = result->add_us = result->remove_us = result->replay_ms = 1e300;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+
+    for(uint32_t r = 0; r < repeat; r++) {
+        // Každé opakování začíná s čerstvě převedeným trezorem bez žurnálu
+        bench_generate_text(BENCH_TEXT_PATH, entries);
+        storage_simply_remove(storage, BENCH_VAULT_PATH ".jnl");
+        uint64_t start = bench_now_ns();
+        password_vault_convert(BENCH_TEXT_PATH, BENCH_VAULT_PATH, bench_key);
+        bench_min(&result->convert_ms, bench_ms_since(start));
+
+        // Náhodná obrazovka přímo v namapovaném souboru, bez kopírování
+        const uint32_t screens = 256;
+        PasswordVaultMap map;
+        if(password_vault_map_open(&map, BENCH_VAULT_PATH)) {
+            PasswordVaultRecordView record;
+            volatile size_t touched = 0;
+            bench_random_state = 0x2468ace0;
+            start = bench_now_ns();
+            for(uint32_t i = 0; i < screens && entries; i++) {
+                uint32_t index = bench_random() % entries;
+                for(uint32_t row = index; row < index + 4 && row < entries; row++) {
+                    if(password_vault_view_record(map.data, map.size, row, &record)) {
+                        touched += record.name_length + record.password_length;
+                    }
+                }
+            }
+            bench_min(&result->mmap_get_us, bench_ms_since(start) * 1000.0 / screens);
+            password_vault_map_close(&map);
+        }
+
+        // Otevření (včetně alokace seznamu, aby se započetla jeho velikost)
+        furi_shim_heap_reset_peak();
+        size_t heap_before = furi_shim_heap_used();
+        start = bench_now_ns();
+        PasswordList* list = malloc(sizeof(PasswordList));
+        password_list_init(list);
+        password_list_set_key(list, bench_key);
+        password_list_open(list, BENCH_VAULT_PATH, mode);
+        bench_min(&result->open_ms, bench_ms_since(start));
+        result->loaded = list->count;
+
+        // Procházení: náhodná obrazovka o 4 řádcích a heslo vybrané položky
+        char secret[PASSWORD_MAX_LENGTH];
+        bench_random_state = 0x2468ace0;
+        start = bench_now_ns();
+        for(uint32_t i = 0; i < screens && list->count; i++) {
+            uint32_t index = bench_random() % list->count;
+            for(uint32_t row = index; row < index + 4 && row < list->count; row++) {
+                password_list_get_name(list, row);
+            }
+            password_list_read_password(list, index, secret, sizeof(secret));
+        }
+        bench_min(&result->get_us, bench_ms_since(start) * 1000.0 / screens);
+        result->peak_bytes = MAX(result->peak_bytes, furi_shim_heap_peak() - heap_before);
+
+        // Hledání: prefix názvu náhodné položky psaný znak po znaku
+        const uint32_t searches = 64;
+        uint32_t keystrokes = 0;
+        char prefix[NAME_MAX_LENGTH];
+        start = bench_now_ns();
+        for(uint32_t i = 0; i < searches && list->count; i++) {
+            strlcpy(prefix, password_list_get_name(list, bench_random() % list->count), sizeof(prefix));
+            PasswordListRange range = {0, list->count};
+            size_t length = strlen(prefix);
+            for(size_t typed = 1; typed <= length && typed <= 12; typed++) {
+                char saved = prefix[typed];
+                prefix[typed] = '\0';
+                password_list_filter(list, prefix, &range);
+                prefix[typed] = saved;
+                keystrokes++;
+            }
+        }
+        if(keystrokes) {
+            bench_min(&result->filter_us, bench_ms_since(start) * 1000.0 / keystrokes);
+        }
+
+        // Hledání přesného názvu (v plném režimu index názvů, sestaví se prvním hledáním)
+        const uint32_t finds = 256;
+        uint32_t found = 0;
+        char (*names)[NAME_MAX_LENGTH] = malloc(finds * NAME_MAX_LENGTH);
+        for(uint32_t i = 0; i < finds && list->count; i++) {
+            strlcpy(names[i], password_list_get_name(list, bench_random() % list->count), NAME_MAX_LENGTH);
+        }
+        if(list->count) password_list_find(list, names[0], &found);
+        start = bench_now_ns();
+        for(uint32_t i = 0; i < finds && list->count; i++) {
+            password_list_find(list, names[i], &found);
+        }
+        if(list->count) bench_min(&result->find_us, bench_ms_since(start) * 1000.0 / finds);
+        free(names);
+
+        // Fuzzy hledání: vzor ze dvou číslic a dvou znaků přípony náhodné položky,
+        // naivně porovnáním všech názvů a přes password_list_search
+        const uint32_t queries = 8;
+        char patterns[queries][5];
+        for(uint32_t i = 0; i < queries && list->count; i++) {
+            const char* source = password_list_get_name(list, bench_random() % list->count);
+            size_t length = strlen(source);
+            static const uint8_t picks[] = {8, 10, 13, 15};
+            for(size_t k = 0; k < sizeof(picks); k++) {
+                patterns[i][k] = source[MIN((size_t)picks[k], length - 1)];
+            }
+            patterns[i][sizeof(picks)] = '\0';
+        }
+        
+        volatile uint32_t matches = 0;
+        start = bench_now_ns();
+        for(uint32_t i = 0; i < queries && list->count; i++) {
+            for(uint32_t index = 0; index < list->count; index++) {
+                int16_t score;
+                if(password_search_match(password_list_get_name(list, index), patterns[i], &score)) {
+                    matches++;
+                }
+            }
+        }
+        if(list->count) bench_min(&result->naive_us, bench_ms_since(start) * 1000.0 / queries);
+        
+        PasswordSearchResult results[BENCH_SEARCH_RESULTS];
+        start = bench_now_ns();
+        for(uint32_t i = 0; i < queries && list->count; i++) {
+            matches += password_list_search(list, patterns[i], results, COUNT_OF(results));
+        }
+        if(list->count) bench_min(&result->fuzzy_us, bench_ms_since(start) * 1000.0 / queries);
+        
+        // Opakované otevření (soubor už je v cache)
+        start = bench_now_ns();
+        password_list_open(list, BENCH_VAULT_PATH, mode);
+        bench_min(&result->reopen_ms, bench_ms_since(start));
+
+        // Uložení do jiného souboru
+        start = bench_now_ns();
+        password_list_save(list, BENCH_SAVE_PATH);
+        bench_min(&result->save_ms, bench_ms_since(start));
+
+        // Odebírání z čela seznamu (nejhorší případ posunu)
+        uint32_t removed = MIN(list->count, 20u);
+        start = bench_now_ns();
+        for(uint32_t i = 0; i < removed; i++) {
+            password_list_remove(list, 0);
+        }
+        password_list_flush(list);
+        if(removed) {
+            bench_min(&result->remove_us, bench_ms_since(start) * 1000.0 / removed);
+        }
+
+        // Přidávání na konec seznamu
+        char name[NAME_MAX_LENGTH];
+        char password[PASSWORD_MAX_LENGTH];
+        uint32_t added = 0;
+        uint32_t to_add = MIN(entries, 1000u);
+        bench_random_state = 0x87654321;
+        start = bench_now_ns();
+        for(uint32_t i = 0; i < to_add; i++) {
+            bench_entry(entries + i, name, password);
+            if(!password_list_add(list, name, password)) break;
+            added++;
+        }
+        password_list_flush(list);
+        if(added) {
+            bench_min(&result->add_us, bench_ms_since(start) * 1000.0 / added);
+        }
+        
+        // Opětovné otevření s přehráním žurnálu posledních změn
+        start = bench_now_ns();
+        password_list_open(list, BENCH_VAULT_PATH, mode);
+        bench_min(&result->replay_ms, bench_ms_since(start));
+
+        password_list_free(list);
+        free(list);
+    }
+
+    // Operace, které se neprovedly (např. odebrání z prázdného seznamu)
+    double* samples[] = {
+        &result->convert_ms, &result->mmap_get_us, &result->open_ms, &result->reopen_ms, &result->get_us, &result->filter_us, &result->find_us,
+        &result->naive_us, &result->fuzzy_us, &result->save_ms, &result->add_us, &result->remove_us, &result->replay_ms};
+    for(size_t i = 0; i < COUNT_OF(samples); i++) {
+        if(*samples[i] == 1e300) *samples[i] = 0.0;
+    }
+
+    storage_simply_remove(storage, BENCH_VAULT_PATH ".jnl");
+    furi_record_close(RECORD_STORAGE);
+}
+
+static void bench_kdf_run(uint32_t repeat, bool csv) {
+    static const uint8_t salt[PASSWORD_KDF_SALT_SIZE] = {0};
+    uint8_t key[PASSWORD_KDF_HASH_SIZE];
+    double derive_ms = 1e300;
+    for(uint32_t r = 0; r < repeat; r++) {
+        uint64_t start = bench_now_ns();
+        password_kdf_derive("1234", 4, salt, sizeof(salt), BENCH_KDF_ITERATIONS, key);
+        bench_min(&derive_ms, bench_ms_since(start));
+    }
+    double per_second = BENCH_KDF_ITERATIONS / (derive_ms / 1000.0);
+    uint32_t calibrated = password_kdf_calibrate(PASSWORD_KDF_TARGET_MS);
+
+    if(csv) {
+        printf("iterations,derive_ms,iterations_per_s,target_ms,calibrated\n");
+        printf("%u,%.3f,%.0f,%u,%u\n", BENCH_KDF_ITERATIONS, derive_ms, per_second,
+               PASSWORD_KDF_TARGET_MS, calibrated);
+    } else {
+        printf("%10s %10s %12s %10s %11s\n", "iterations", "derive ms", "iter/s", "target ms", "calibrated");
+        printf("%10u %10.3f %12.0f %10u %11u\n", BENCH_KDF_ITERATIONS, derive_ms, per_second,
+               PASSWORD_KDF_TARGET_MS, calibrated);
+    }
+}
+
+static void bench_totp_run(uint32_t repeat, bool csv) {
+    static const uint8_t key[32] = "12345678901234567890123456789012";
+    static const struct {
+        const char* name;
+        PasswordTotpAlgorithm algorithm;
+        size_t key_size;
+    } algorithms[] = {
+        {"sha1", PasswordTotpAlgorithmSha1, 20},
+        {"sha256", PasswordTotpAlgorithmSha256, 32},
+    };
+
+    if(csv) {
+        printf("algorithm,codes,cached_ns,cached_per_s,uncached_ns,uncached_per_s\n");
+    } else {
+        printf("%9s %8s %10s %12s %12s %14s\n", "algorithm", "codes", "cached ns", "cached/s", "uncached ns", "uncached/s");
+    }
+    for(size_t a = 0; a < COUNT_OF(algorithms); a++) {
+        PasswordTotp totp;
+        char code[PASSWORD_TOTP_DIGITS_MAX + 1];
+        uint32_t checksum = 0;
+        double cached_ms = 1e300;
+        double uncached_ms = 1e300;
+        for(uint32_t r = 0; r < repeat; r++) {
+            // Stav HMAC připravený jednou, jako při otevření záznamu
+            uint64_t start = bench_now_ns();
+            password_totp_init(&totp, algorithms[a].algorithm, 6, key, algorithms[a].key_size);
+            for(uint32_t i = 0; i < BENCH_TOTP_CODES; i++) {
+                password_totp_hotp(&totp, i, code);
+                checksum += code[5];
+            }
+            bench_min(&cached_ms, bench_ms_since(start));
+
+            // Bez mezipaměti se klíč zpracuje pro každý kód znovu
+            start = bench_now_ns();
+            for(uint32_t i = 0; i < BENCH_TOTP_CODES; i++) {
+                password_totp_init(&totp, algorithms[a].algorithm, 6, key, algorithms[a].key_size);
+                password_totp_hotp(&totp, i, code);
+                checksum += code[5];
+            }
+            bench_min(&uncached_ms, bench_ms_since(start));
+        }
+        if(checksum == 0) fprintf(stderr, "nulový součet kódů\n");
+
+        double cached_ns = cached_ms * 1e6 / BENCH_TOTP_CODES;
+        double uncached_ns = uncached_ms * 1e6 / BENCH_TOTP_CODES;
+        if(csv) {
+            printf("%s,%u,%.1f,%.0f,%.1f,%.0f\n", algorithms[a].name, BENCH_TOTP_CODES, cached_ns,
+                   1e9 / cached_ns, uncached_ns, 1e9 / uncached_ns);
+        } else {
+            printf("%9s %8u %10.1f %12.0f %12.1f %14.0f\n", algorithms[a].name, BENCH_TOTP_CODES,
+                   cached_ns, 1e9 / cached_ns, uncached_ns, 1e9 / uncached_ns);
+        }
+    }
+}
+
+// Heslo se stejným zamítáním jako password_generator_generate, ale s voláním generátoru na bajt
+static void bench_gen_unbatched(const PasswordGeneratorPolicy* policy, char* password) {
+    char alphabet[PASSWORD_GENERATOR_ALPHABET_SIZE];
+    uint32_t size = password_generator_alphabet(policy->classes, alphabet);
+    uint32_t limit = 256 - 256 % size;
+    for(uint8_t i = 0; i < policy->length; i++) {
+        uint8_t byte;
+        do {
+            furi_hal_random_fill_buf(&byte, 1);
+        } while(byte >= limit);
+        password[i] = alphabet[byte % size];
+    }
+    password[policy->length] = '\0';
+}
+
+static void bench_gen_run(uint32_t repeat, bool csv) {
+    static const struct {
+        const char* name;
+        PasswordGeneratorPolicy policy;
+    } policies[] = {
+        {"aA1#-16",
+         {16,
+          PasswordGeneratorClassLower | PasswordGeneratorClassUpper | PasswordGeneratorClassDigits |
+              PasswordGeneratorClassSymbols,
+          true}},
+        {"aA1-32", {32, PasswordGeneratorClassLower | PasswordGeneratorClassUpper | PasswordGeneratorClassDigits, false}},
+        {"1-6", {6, PasswordGeneratorClassDigits, false}},
+    };
+
+    if(csv) {
+        printf("policy,passwords,entropy_bits,batched_ns,batched_per_s,refills_per_password,unbatched_ns,unbatched_per_s\n");
+    } else {
+        printf("%8s %9s %6s %10s %12s %9s %12s %14s\n", "policy", "passwords", "bits", "batched ns",
+               "batched/s", "refills", "unbatched ns", "unbatched/s");
+    }
+    for(size_t p = 0; p < COUNT_OF(policies); p++) {
+        const PasswordGeneratorPolicy* policy = &policies[p].policy;
+        char password[PASSWORD_MAX_LENGTH];
+        uint32_t checksum = 0;
+        double batched_ms = 1e300;
+        double unbatched_ms = 1e300;
+        double refills = 0;
+        for(uint32_t r = 0; r < repeat; r++) {
+            PasswordGenerator generator;
+            password_generator_init(&generator);
+            uint64_t start = bench_now_ns();
+            for(uint32_t i = 0; i < BENCH_GEN_PASSWORDS; i++) {
+                password_generator_generate(&generator, policy, password, sizeof(password));
+                checksum += password[0];
+            }
+            bench_min(&batched_ms, bench_ms_since(start));
+            refills = (double)generator.refills / BENCH_GEN_PASSWORDS;
+            password_generator_wipe(&generator);
+
+            start = bench_now_ns();
+            for(uint32_t i = 0; i < BENCH_GEN_PASSWORDS; i++) {
+                bench_gen_unbatched(policy, password);
+                checksum += password[0];
+            }
+            bench_min(&unbatched_ms, bench_ms_since(start));
+        }
+        if(checksum == 0) fprintf(stderr, "nulový součet hesel\n");
+
+        uint32_t bits = password_generator_entropy(policy);
+        double batched_ns = batched_ms * 1e6 / BENCH_GEN_PASSWORDS;
+        double unbatched_ns = unbatched_ms * 1e6 / BENCH_GEN_PASSWORDS;
+        if(csv) {
+            printf("%s,%u,%u,%.1f,%.0f,%.2f,%.1f,%.0f\n", policies[p].name, BENCH_GEN_PASSWORDS, bits,
+                   batched_ns, 1e9 / batched_ns, refills, unbatched_ns, 1e9 / unbatched_ns);
+        } else {
+            printf("%8s %9u %6u %10.1f %12.0f %9.2f %12.1f %14.0f\n", policies[p].name, BENCH_GEN_PASSWORDS,
+                   bits, batched_ns, 1e9 / batched_ns, refills, unbatched_ns, 1e9 / unbatched_ns);
+        }
+    }
+}
+
+// Přehraje záznam reportů jako cíl: každý stisk napíše znak dané klávesy a modifikátoru
+static bool bench_hid_decode(const PasswordKeyboardLayout* layout, char* out, size_t size) {
+    size_t count;
+    const PasswordHidMockReport* reports = password_hid_mock_reports(&count);
+    size_t length = 0;
+    for(size_t i = 0; i < count; i++) {
+        if(reports[i].keycode == 0) continue;
+        char c = '\0';
+        for(int candidate = 1; candidate < 128 && c == '\0'; candidate++) {
+            const PasswordKeyboardKey* key = password_keyboard_key(layout, (char)candidate);
+            if(key->keycode == reports[i].keycode && key->modifier == reports[i].modifier) c = (char)candidate;
+        }
+        if(c == '\0' || length + 1 >= size) return false;
+        out[length++] = c;
+    }
+    out[length] = '\0';
+    return true;
+}
+
+static void bench_hid_run(bool csv) {
+    if(csv) {
+        printf("speed,chars,type_ms,last_report_ms,reports,ms_per_char,ok\n");
+    } else {
+        printf("%10s %6s %9s %9s %8s %12s %4s\n", "speed", "chars", "type ms", "last ms", "reports", "ms per char", "ok");
+    }
+
+    PasswordKeyboardLayout layout;
+    password_keyboard_layout_default(&layout);
+    password_hid_mock.start();
+    size_t chars = strlen(BENCH_HID_PASSWORD);
+    for(int speed = 0; speed < PasswordKeyboardSpeedCount; speed++) {
+        password_hid_mock_reset();
+        uint32_t start = furi_get_tick();
+        password_keyboard_type(&password_hid_mock, BENCH_HID_PASSWORD, &layout, (PasswordKeyboardSpeed)speed, NULL, NULL);
+        uint32_t type_ms = furi_get_tick() - start;
+
+        size_t reports;
+        const PasswordHidMockReport* report = password_hid_mock_reports(&reports);
+        uint32_t last_ms = reports > 0 ? report[reports - 1].tick - start : 0;
+        char typed[128];
+        bool ok = bench_hid_decode(&layout, typed, sizeof(typed)) && strcmp(typed, BENCH_HID_PASSWORD) == 0;
+        const char* name = password_keyboard_speed_name((PasswordKeyboardSpeed)speed);
+        if(csv) {
+            printf("%s,%zu,%u,%u,%zu,%.2f,%d\n", name, chars, type_ms, last_ms, reports, (double)type_ms / chars, ok);
+        } else {
+            printf("%10s %6zu %9u %9u %8zu %12.2f %4s\n", name, chars, type_ms, last_ms, reports,
+                   (double)type_ms / chars, ok ? "ano" : "NE");
+        }
+    }
+    password_hid_mock.stop();
+}
+
+static uint32_t bench_parse_sizes(const char* text, uint32_t* sizes) {
+    uint32_t count = 0;
+    while(*text && count < BENCH_MAX_SIZES) {
+        char* end;
+        unsigned long value = strtoul(text, &end, 10);
+        if(end == text) break;
+        if(*end == 'k' || *end == 'K') {
+            value *= 1000;
+            end++;
+        }
+        sizes[count++] = (uint32_t)value;
+        text = (*end == ',') ? end + 1 : end;
+    }
+    return count;
+}
+
+int main(int argc, char** argv) {
+    uint32_t sizes[BENCH_MAX_SIZES] = {50, 1000, 10000, 100000};
+    uint32_t size_count = 4;
+    uint32_t repeat = 3;
+    bool csv = false;
+    bool kdf = false;
+    bool hid = false;
+    bool totp = false;
+    bool gen = false;
+
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            size_count = bench_parse_sizes(argv[++i], sizes);
+        } else if(strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            int value = atoi(argv[++i]);
+            repeat = value > 0 ? (uint32_t)value : 1;
+        } else if(strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        } else if(strcmp(argv[i], "--kdf") == 0) {
+            kdf = true;
+        } else if(strcmp(argv[i], "--hid") == 0) {
+            hid = true;
+        } else if(strcmp(argv[i], "--totp") == 0) {
+            totp = true;
+        } else if(strcmp(argv[i], "--gen") == 0) {
+            gen = true;
+        } else {
+            fprintf(stderr, "Použití: %s [-n 50,1k,10k,100k] [-r opakování] [--csv] [--kdf] [--hid] [--totp] [--gen]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if(kdf) {
+        bench_kdf_run(repeat, csv);
+        return 0;
+    }
+    if(hid) {
+        bench_hid_run(csv);
+        return 0;
+    }
+    if(totp) {
+        bench_totp_run(repeat, csv);
+        return 0;
+    }
+    if(gen) {
+        bench_gen_run(repeat, csv);
+        return 0;
+    }
+
+    char root[] = "/tmp/password_bench.XXXXXX";
+    if(!mkdtemp(root)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    storage_shim_set_root(root);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_simply_mkdir(storage, BENCH_DIRECTORY);
+
+    if(csv) {
+        printf("entries,mode,loaded,convert_ms,mmap_get_us,open_ms,reopen_ms,get_us,filter_us,find_us,naive_us,fuzzy_us,save_ms,add_us,remove_us,replay_ms,peak_bytes\n");
+    } else {
+        printf("%8s %6s %8s %10s %11s %9s %9s %9s %9s %9s %10s %10s %9s %9s %10s %9s %10s\n",
+               "entries", "mode", "loaded", "convert ms", "mmap get us", "open ms", "reopen ms",
+               "get us", "filter us", "find us", "naive us", "fuzzy us", "save ms", "add us", "remove us", "replay ms", "peak KiB");
+    }
+
+    static const PasswordListMode modes[] = {PasswordListModeFull, PasswordListModePaged};
+    static const char* const mode_names[] = {"auto", "full", "paged"};
+
+    for(uint32_t i = 0; i < size_count; i++) {
+        for(size_t m = 0; m < COUNT_OF(modes); m++) {
+            BenchStorageResult result;
+            bench_storage_run(sizes[i], modes[m], sizes[i] >= 100000 ? 1 : repeat, &result);
+            if(csv) {
+                printf("%u,%s,%u,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%zu\n",
+                       result.entries, mode_names[result.mode], result.loaded, result.convert_ms,
+                       result.mmap_get_us, result.open_ms, result.reopen_ms, result.get_us,
+                       result.filter_us, result.find_us, result.naive_us, result.fuzzy_us, result.save_ms, result.add_us, result.remove_us, result.replay_ms, result.peak_bytes);
+            } else {
+                printf("%8u %6s %8u %10.3f %11.3f %9.3f %9.3f %9.3f %9.3f %9.3f %10.1f %10.1f %9.3f %9.3f %10.3f %9.3f %10.1f\n",
+                       result.entries, mode_names[result.mode], result.loaded, result.convert_ms,
+                       result.mmap_get_us, result.open_ms, result.reopen_ms, result.get_us,
+                       result.filter_us, result.find_us, result.naive_us, result.fuzzy_us, result.save_ms, result.add_us, result.remove_us, result.replay_ms, (double)result.peak_bytes / 1024.0);
+            }
+        }
+    }
+
+    storage_simply_remove(storage, BENCH_TEXT_PATH);
+    storage_simply_remove(storage, BENCH_VAULT_PATH);
+    storage_simply_remove(storage, BENCH_SAVE_PATH);
+    storage_simply_remove(storage, BENCH_DIRECTORY);
+    furi_record_close(RECORD_STORAGE);
+    rmdir(root);
+
+    return 0;
+}
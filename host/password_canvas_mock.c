@@ -0,0 +1,88 @@
+/*
+ * Počítající plátno pro testy a benchmark.
+ */
+
+#include "password_canvas_mock.h"
+
+#include <string.h>
+
+#define MOCK_WIDTH 128
+#define MOCK_HEIGHT 64
+#define MOCK_STRINGS 16
+
+struct Canvas {
+    int unused;
+};
+
+static Canvas mock_canvas;
+static PasswordCanvasMockStats mock_stats;
+static char mock_strings[MOCK_STRINGS][64];
+
+Canvas* password_canvas_mock(void) {
+    return &mock_canvas;
+}
+
+PasswordCanvasMockStats password_canvas_mock_stats(void) {
+    return mock_stats;
+}
+
+void password_canvas_mock_reset(void) {
+    memset(&mock_stats, 0, sizeof(mock_stats));
+}
+
+const char* password_canvas_mock_string(size_t index) {
+    return index < MIN(mock_stats.strings, (size_t)MOCK_STRINGS) ? mock_strings[index] : NULL;
+}
+
+void canvas_clear(Canvas* canvas) {
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+}
+
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str) {
+    if(mock_stats.strings < MOCK_STRINGS) {
+        strlcpy(mock_strings[mock_stats.strings], str, sizeof(mock_strings[0]));
+    }
+    mock_stats.strings++;
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str) {
+    canvas_draw_str(canvas, x, y, str);
+}
+
+uint16_t canvas_string_width(Canvas* canvas, const char* str) {
+    mock_stats.measures++;
+    uint16_t width = 0;
+    for(; *str; str++) {
+        if((*str & 0xC0) != 0x80) width += PASSWORD_CANVAS_MOCK_CHAR_WIDTH;
+    }
+    return width;
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    mock_stats.boxes++;
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+}
+
+void canvas_draw_line(Canvas* canvas, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+}
+
+size_t canvas_width(Canvas* canvas) {
+    return MOCK_WIDTH;
+}
+
+size_t canvas_height(Canvas* canvas) {
+    return MOCK_HEIGHT;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+ * Plátno pro testy a benchmark (jen hostitelský build).
+ *
+ * Nic nevykresluje, jen počítá volání. Písmo má pevnou šířku
+ * PASSWORD_CANVAS_MOCK_CHAR_WIDTH pixelů na znak UTF-8, displej je
+ * 128 × 64 jako na zařízení.
+ */
+
+#include <gui/gui.h>
+
+#include <stddef.h>
+
+#define PASSWORD_CANVAS_MOCK_CHAR_WIDTH 6
+
+typedef struct {
+    size_t strings; // Volání canvas_draw_str
+    size_t measures; // Volání canvas_string_width
+    size_t boxes; // Volání canvas_draw_box
+} PasswordCanvasMockStats;
+
+/**
+ * @brief Vrátí plátno, které lze předat kreslícím funkcím
+ *
+ * @return Canvas* Plátno
+ */
+Canvas* password_canvas_mock(void);
+
+/**
+ * @brief Vrátí počty volání od posledního vynulování
+ *
+ * @return PasswordCanvasMockStats Počty volání
+ */
+PasswordCanvasMockStats password_canvas_mock_stats(void);
+
+/** @brief Vynuluje počty volání */
+void password_canvas_mock_reset(void);
+
+/**
+ * @brief Vrátí text n-tého canvas_draw_str od vynulování
+ *
+ * @param index Pořadí volání, jen prvních 16
+ * @return const char* Text, NULL pokud tolik volání nebylo
+ */
+const char* password_canvas_mock_string(size_t index);
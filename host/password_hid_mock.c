@@ -0,0 +1,76 @@
+/*
+ * Zaznamenávající přenos HID pro testy a benchmark.
+ */
+
+#include "password_hid_mock.h"
+
+#include <furi.h>
+
+static PasswordHidMockReport* mock_reports = NULL;
+static size_t mock_count = 0;
+static size_t mock_capacity = 0;
+static bool mock_started = false;
+static bool mock_connected = true;
+static uint32_t mock_starts = 0;
+
+static bool password_hid_mock_record(uint8_t modifier, uint8_t keycode) {
+    if(!mock_started || !mock_connected) return false;
+    if(mock_count == mock_capacity) {
+        mock_capacity = mock_capacity ? mock_capacity * 2 : 64;
+        mock_reports = realloc(mock_reports, mock_capacity * sizeof(PasswordHidMockReport));
+    }
+    mock_reports[mock_count++] = (PasswordHidMockReport){
+        .tick = furi_get_tick(),
+        .modifier = modifier,
+        .keycode = keycode,
+    };
+    return true;
+}
+
+static bool password_hid_mock_start(void) {
+    if(!mock_started) mock_starts++;
+    mock_started = true;
+    return true;
+}
+
+static void password_hid_mock_stop(void) {
+    mock_started = false;
+}
+
+static bool password_hid_mock_is_connected(void) {
+    return mock_started && mock_connected;
+}
+
+static bool password_hid_mock_press(uint8_t modifier, uint8_t keycode) {
+    return password_hid_mock_record(modifier, keycode);
+}
+
+static bool password_hid_mock_release_all(void) {
+    return password_hid_mock_record(0, 0);
+}
+
+const PasswordHidTransport password_hid_mock = {
+    .name = "Mock",
+    .start = password_hid_mock_start,
+    .stop = password_hid_mock_stop,
+    .is_connected = password_hid_mock_is_connected,
+    .press = password_hid_mock_press,
+    .release_all = password_hid_mock_release_all,
+};
+
+const PasswordHidMockReport* password_hid_mock_reports(size_t* count) {
+    *count = mock_count;
+    return mock_reports;
+}
+
+void password_hid_mock_reset(void) {
+    mock_count = 0;
+}
+
+void password_hid_mock_set_connected(bool connected) {
+    mock_connected = connected;
+}
+
+uint32_t password_hid_mock_starts(void) {
+    return mock_starts;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+ * Zaznamenávající přenos HID (jen hostitelský build).
+ *
+ * Každý report, který by šel do počítače, se uloží s časem virtuálních
+ * hodin (furi_delay_ms je posouvá bez čekání). Testy z něj modelem
+ * klávesnice cíle zjistí napsaný text, benchmark dobu psaní.
+ */
+
+#include "../password_hid.h"
+
+#include <stddef.h>
+
+typedef struct {
+    uint32_t tick; // Čas odeslání reportu v ms
+    uint8_t modifier; // Bity modifikátorů stisku
+    uint8_t keycode; // Stisknutá klávesa, 0 pro puštění všech kláves
+} PasswordHidMockReport;
+
+extern const PasswordHidTransport password_hid_mock;
+
+/**
+ * @brief Vrátí zaznamenané reporty
+ *
+ * @param count Výstup, počet reportů
+ * @return const PasswordHidMockReport* Reporty v pořadí odeslání
+ */
+const PasswordHidMockReport* password_hid_mock_reports(size_t* count);
+
+/** @brief Vymaže záznam reportů */
+void password_hid_mock_reset(void);
+
+/**
+ * @brief Nastaví, zda je počítač připojený (výchozí ano)
+ *
+ * @param connected Nepřipojený přenos odmítne psaní i reporty
+ */
+void password_hid_mock_set_connected(bool connected);
+
+/**
+ * @brief Vrátí počet zapnutí přenosu
+ *
+ * @return uint32_t Počet volání start, která přenos opravdu zapnula
+ */
+uint32_t password_hid_mock_starts(void);
@@ -0,0 +1,87 @@
+/*
+ * Převod textového popisu rozložení (layouts/<id>.txt) na soubor .pwl,
+ * který aplikace načte do tabulky znak -> stisky.
+ *
+ * Pro každý znak ASCII se vybere nejjednodušší způsob zápisu: nejdřív
+ * klávesy bez mrtvé klávesy, mezi nimi úroveň s nejméně modifikátory
+ * a nejnižší kód klávesy. Znak dostupný jen přes mrtvou klávesu se
+ * zapíše jako mrtvá klávesa a mezera.
+ *
+ * Použití: password_layout <popis.txt> <výstup.pwl>
+ */
+
+#include "password_layout_source.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Najde klávesu a úroveň, které znak napíšou
+static bool password_layout_find(
+    const PasswordLayoutSource* source,
+    uint8_t character,
+    bool dead,
+    PasswordKeyboardKey* key) {
+    for(size_t level = 0; level < PASSWORD_LAYOUT_LEVELS; level++) {
+        for(size_t keycode = 1; keycode < PASSWORD_LAYOUT_KEYS; keycode++) {
+            const PasswordLayoutSymbol* symbol = &source->keys[keycode][level];
+            if(symbol->character == character && symbol->dead == dead) {
+                key->keycode = (uint8_t)keycode;
+                key->modifier = password_layout_source_modifier(level);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    if(argc != 3) {
+        fprintf(stderr, "Použití: %s <popis.txt> <výstup.pwl>\n", argv[0]);
+        return 2;
+    }
+
+    static PasswordLayoutSource source;
+    if(!password_layout_source_parse(argv[1], &source)) return 1;
+
+    PasswordKeyboardKey space;
+    if(!password_layout_find(&source, ' ', false, &space)) {
+        fprintf(stderr, "%s: chybí mezera\n", argv[1]);
+        return 1;
+    }
+
+    PasswordKeyboardLayoutEntry entries[PASSWORD_KEYBOARD_CHARACTERS];
+    uint16_t count = 0;
+    for(uint8_t c = 1; c < PASSWORD_KEYBOARD_CHARACTERS; c++) {
+        PasswordKeyboardLayoutEntry* entry = &entries[count];
+        memset(entry, 0, sizeof(PasswordKeyboardLayoutEntry));
+        entry->character = c;
+        if(password_layout_find(&source, c, false, &entry->strokes[0])) {
+            count++;
+        } else if(password_layout_find(&source, c, true, &entry->strokes[0])) {
+            entry->strokes[1] = space;
+            count++;
+        }
+    }
+
+    PasswordKeyboardLayoutHeader header = {
+        .magic = PASSWORD_KEYBOARD_LAYOUT_MAGIC,
+        .version = PASSWORD_KEYBOARD_LAYOUT_VERSION,
+        .count = count,
+    };
+    snprintf(header.name, sizeof(header.name), "%s", source.name);
+
+    FILE* file = fopen(argv[2], "wb");
+    if(!file) {
+        perror(argv[2]);
+        return 1;
+    }
+    bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(entries, sizeof(PasswordKeyboardLayoutEntry), count, file) == count;
+    success = fclose(file) == 0 && success;
+    if(!success) {
+        perror(argv[2]);
+        remove(argv[2]);
+        return 1;
+    }
+    return 0;
+}
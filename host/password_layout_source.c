@@ -0,0 +1,87 @@
+/*
+ * Čtení textového popisu rozložení klávesnice.
+ */
+
+#include "password_layout_source.h"
+
+#include <furi_hal.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PASSWORD_LAYOUT_SHIFT (KEY_MOD_LEFT_SHIFT >> 8)
+#define PASSWORD_LAYOUT_ALTGR (KEY_MOD_RIGHT_ALT >> 8)
+
+static bool password_layout_source_symbol(const char* token, PasswordLayoutSymbol* symbol) {
+    symbol->dead = false;
+    if(strcmp(token, "none") == 0) {
+        symbol->character = 0;
+        return true;
+    }
+    if(strcmp(token, "space") == 0) {
+        symbol->character = ' ';
+        return true;
+    }
+    if(strncmp(token, "dead:", 5) == 0) {
+        token += 5;
+        symbol->dead = true;
+    }
+    if(strlen(token) != 1 || token[0] <= ' ' || token[0] > '~') return false;
+    symbol->character = (uint8_t)token[0];
+    return true;
+}
+
+bool password_layout_source_parse(const char* path, PasswordLayoutSource* source) {
+    memset(source, 0, sizeof(PasswordLayoutSource));
+    FILE* file = fopen(path, "r");
+    if(!file) {
+        perror(path);
+        return false;
+    }
+
+    char line[256];
+    unsigned number = 0;
+    bool success = true;
+    while(success && fgets(line, sizeof(line), file)) {
+        number++;
+        line[strcspn(line, "\r\n")] = '\0';
+        if(line[0] == '\0' || line[0] == '#') continue;
+
+        if(strncmp(line, "name ", 5) == 0) {
+            snprintf(source->name, sizeof(source->name), "%s", line + 5);
+            continue;
+        }
+
+        char* tokens[1 + PASSWORD_LAYOUT_LEVELS];
+        size_t count = 0;
+        for(char* token = strtok(line, " \t"); token && count < COUNT_OF(tokens);
+            token = strtok(NULL, " \t")) {
+            tokens[count++] = token;
+        }
+        char* end;
+        unsigned long keycode = count == COUNT_OF(tokens) ? strtoul(tokens[0], &end, 16) : 0;
+        success = keycode > 0 && keycode < PASSWORD_LAYOUT_KEYS && *end == '\0';
+        for(size_t level = 0; success && level < PASSWORD_LAYOUT_LEVELS; level++) {
+            success = password_layout_source_symbol(tokens[1 + level], &source->keys[keycode][level]);
+        }
+        if(!success) fprintf(stderr, "%s:%u: neplatný řádek\n", path, number);
+    }
+    fclose(file);
+
+    if(success && source->name[0] == '\0') {
+        fprintf(stderr, "%s: chybí název rozložení\n", path);
+        success = false;
+    }
+    return success;
+}
+
+uint8_t password_layout_source_modifier(size_t level) {
+    static const uint8_t modifiers[PASSWORD_LAYOUT_LEVELS] = {
+        0,
+        PASSWORD_LAYOUT_SHIFT,
+        PASSWORD_LAYOUT_ALTGR,
+        PASSWORD_LAYOUT_SHIFT | PASSWORD_LAYOUT_ALTGR,
+    };
+    return modifiers[level];
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+/*
+ * Textový popis rozložení klávesnice (layouts/<id>.txt, jen hostitelský build).
+ *
+ * Popis říká, co která klávesa napíše, tedy opačným směrem než tabulka
+ * v aplikaci. Z popisu vzniká soubor .pwl (password_layout.c) a test
+ * podle něj ověřuje, že napsaný text cíl přečte beze změny.
+ *
+ *   name <název>
+ *   <kód HID hex> <bez modifikátoru> <Shift> <AltGr> <Shift+AltGr>
+ *
+ * Znak je jeden znak ASCII, "space" mezera, "none" nic a "dead:X" mrtvá
+ * klávesa, která po stisku mezery napíše X. Řádky začínající # jsou
+ * komentáře.
+ */
+
+#include "../password_keyboard.h"
+
+#define PASSWORD_LAYOUT_LEVELS 4
+#define PASSWORD_LAYOUT_KEYS 256
+
+typedef struct {
+    uint8_t character; // 0 pro klávesu bez znaku
+    bool dead;
+} PasswordLayoutSymbol;
+
+typedef struct {
+    char name[PASSWORD_KEYBOARD_LAYOUT_NAME_SIZE];
+    PasswordLayoutSymbol keys[PASSWORD_LAYOUT_KEYS][PASSWORD_LAYOUT_LEVELS];
+} PasswordLayoutSource;
+
+/**
+ * @brief Načte textový popis rozložení
+ *
+ * @param path Cesta k souboru na hostiteli
+ * @param source Výstup, popis rozložení
+ * @return true Pokud je popis platný
+ * @return false Pokud soubor nejde přečíst nebo obsahuje chybu (vypíše ji)
+ */
+bool password_layout_source_parse(const char* path, PasswordLayoutSource* source);
+
+/**
+ * @brief Vrátí bity modifikátorů pro úroveň klávesy
+ *
+ * @param level Úroveň 0 až PASSWORD_LAYOUT_LEVELS - 1
+ * @return uint8_t Bity modifikátorů HID reportu
+ */
+uint8_t password_layout_source_modifier(size_t level);
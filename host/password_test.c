@@ -0,0 +1,2629 @@
+/*
+ * Testy hostitelského buildu.
+ *
+ * Rozložení klávesnice: pro každý popis v layouts/ se načte přeložený
+ * soubor .pwl (jako v aplikaci) a každý tisknutelný znak ASCII se převede
+ * na stisky a zpět podle popisu. Potom se stejně ověří celé psaní přes
+ * password_keyboard_type ve všech rychlostech: záznam HID reportů
+ * zaznamenávajícího přenosu se přehraje modelem klávesnice cíle a musí dát
+ * přesně napsaný text.
+ *
+ * Vestavěná tabulka US: nezávisle na popisu z layouts/ se každý tisknutelný
+ * znak ASCII porovná s ručně zapsanou tabulkou kódů podle HID Usage Tables
+ * (klávesa a Shift), dvojice kód a modifikátor patří právě jednomu znaku
+ * a zpětný převod dá zase ten znak. Řídicí znaky nejdou napsat.
+ *
+ * Přenos: bez připojeného počítače se nepíše nic a psaní ohlásí chybu.
+ *
+ * Aréna tajemství: sloty se vydávají vynulované, vrácené se přepíšou,
+ * plná aréna nic nevydá a opakované vydání nealokuje.
+ *
+ * Worker psaní: úlohy ve frontě se napíšou za sebou a zrušení zastaví
+ * právě psanou úlohu i čekající; napsané i zrušené vrátí sloty arény.
+ *
+ * Seznam na displeji: dlouhé názvy se zkrátí na šířku řádku, při posunu
+ * se čte a měří jen nový řádek, po změně seznamu všechny a velikost
+ * trezoru na práci se snímkem nic nemění.
+ *
+ * Posouvání: držená klávesa posouvá o 1, po 5 opakováních o 5 a po 15
+ * o stránku (1/32 seznamu, nejméně 5). Opakování stejné klávesy čekající
+ * ve frontě se sloučí, první jiná událost se odloží a zbytek fronty
+ * zůstane; s už odloženou událostí se fronta nečte.
+ *
+ * Měření: sondy počítají průchody, poslední, největší a součet hodnot,
+ * výsledky se připisují do CSV s hlavičkou jen v novém souboru. Přeloženo
+ * s PASSWORD_PERF (make PERF=1) se navíc ověří sonda psaní hesla.
+ *
+ * Index názvů: po náhodných přidáních, úpravách a odebráních najde
+ * password_list_find vždy totéž co průchod celým seznamem,
+ * password_list_put nevytváří duplicity.
+ *
+ * Šifrování: AES-256-GCM hostitelské náhrady furi_hal_crypto odpovídá
+ * testovacím vektorům NIST (GCM spec, případy 13, 14 a 16). Zapečetěné
+ * heslo se otevře stejné; změněný bajt šifrového textu, značky i nonce,
+ * jiný název (přidružená data) i jiný klíč otevření odmítnou a výstup
+ * zůstane prázdný.
+ *
+ * Pool řetězců: záznamy zaberou v poolu přesně svou délku (název,
+ * délka a zapečetěné heslo), počet hesel nemá pevný limit a místo
+ * po odebraných a upravených se uvolní, než tvoří polovinu poolu.
+ * Uložený a znovu otevřený seznam má stejný obsah a pool bez mezer.
+ *
+ * Stránkovaný režim: trezor nad 16 KiB se otevře stránkovaný, při
+ * průchodu i náhodném přístupu drží v paměti jen okno 16 názvů a hesla
+ * čte ze souboru. Změny v něm platí po otevření v obou režimech.
+ *
+ * Seřazený seznam: po náhodných přidáních, put, úpravách a odebráních
+ * zůstane seznam seřazený bez ohledu na velikost písmen a filtr zužovaný
+ * po znacích dá právě rozsah názvů s prefixem, i po otevření ze souboru
+ * v plném a stránkovaném režimu.
+ *
+ * Fuzzy hledání: skóre password_search_match upřednostní znaky za sebou,
+ * začátky slov (i "camelCase") a kratší mezery; vzor musí ležet v názvu
+ * ve stejném pořadí. password_list_search vrátí přesně nejlepší výsledky
+ * průchodu všemi názvy bez masek (skóre sestupně, při shodě podle
+ * indexu), stejné v plném i stránkovaném režimu i se změnami v žurnálu.
+ *
+ * Žurnál: změny zapsané do žurnálu se po znovuotevření přehrají,
+ * nedopsaný nebo poškozený poslední záznam se zahodí a zbytek platí;
+ * po 64 záznamech se žurnál sloučí do trezoru. Po každém otevření musí
+ * obsah seznamu přesně odpovídat modelu.
+ *
+ * Obnova po výpadku: nedopsaný "<cesta>.tmp" se zahodí a platí původní
+ * trezor; úplný "<cesta>.new" vyhraje nad původním i se starým žurnálem
+ * a platí i tam, kde původní soubor už zmizel.
+ *
+ * Formát trezoru: textový trezor se převede i automaticky zmigruje na
+ * binární se stejným obsahem, který vydrží další změnu a znovuotevření.
+ * Soubor se špatným magic, neznámou verzí nebo useknutou tabulkou se
+ * v plném ani stránkovaném režimu neotevře. Soubory vznikají v testu.
+ *
+ * Odvození klíče: SHA-256, HMAC-SHA256 a PBKDF2-HMAC-SHA256 odpovídají
+ * testovacím vektorům FIPS 180-2, RFC 4231 a RFC 7914 (a běžně
+ * citovaným vektorům "password"/"salt").
+ *
+ * Zámek: založený zámek odemkne jen správný PIN a dá stejný klíč trezoru,
+ * špatný PIN se pozná podle kontrolního bloku a klíč se přepíše, useknutý
+ * soubor zámku je chyba. Nedokončený "<cesta>.new" se po výpadku zahodí,
+ * pokud trezor ještě otevře klíč zařízení, a platí, pokud se trezor stihl
+ * přešifrovat.
+ *
+ * Import: exporty CSV, KeePass XML a Bitwarden JSON dají stejné záznamy
+ * po bajtech i najednou, neúplné záznamy a příliš dlouhá hesla se
+ * přeskočí, starší verze z historie KeePassu se ignorují. Soubor s 10 000
+ * řádky se naimportuje s pevnou malou haldou. Skupina záznamu je celá
+ * cesta ze sloupce CSV nebo ze skupin KeePassu, stejně pojmenované
+ * podsložky různých složek se nesloučí.
+ *
+ * Skupiny: manifest se zapíše jen po změně a načte stejný, i když výpadek
+ * nechal jen "<cesta>.tmp"; dlouhé názvy se zkrátí po celých znacích.
+ *
+ * Načítání na pozadí: náhled dá počet a první názvy ze základního souboru,
+ * loader načte trezor i se žurnálem a převzatý seznam dál zapisuje do
+ * svého trezoru; zrušený nebo poškozený trezor se nepřevezme. Zrušení
+ * nečeká na vlákno a zrušené otevření nesloučí žurnál.
+ *
+ * TOTP: kódy odpovídají testovacím vektorům RFC 4226 a RFC 6238 (SHA-1
+ * i SHA-256), v rámci kroku se nepočítají znovu. Tajemství z URI
+ * otpauth nebo z importu se připojí k heslu a při zobrazení se oddělí,
+ * neplatné nebo příliš dlouhé heslo nezmění. Při nahrazení hesla se
+ * tajemství přenese k novému, pokud se vejde.
+ *
+ * Generátor hesel: hesla mají zvolenou délku, jen znaky zvolených tříd
+ * a s require_each každou třídu; náhodné bajty se berou po dávkách.
+ * Rozdělení znaků celkově i na každé pozici projde testem chí-kvadrát,
+ * který prosté "bajt % velikost abecedy" spolehlivě odhalí. Entropie
+ * odpovídá délce krát log2 velikosti abecedy.
+ *
+ * Použití: password_test [kořen repozitáře]
+ */
+
+#include "../password_arena.h"
+#include "../password_crypto.h"
+#include "../password_generator.h"
+#include "../password_groups.h"
+#include "../password_import.h"
+#include "../password_keyboard.h"
+#include "../password_kdf.h"
+#include "../password_keyboard_worker.h"
+#include "../password_list_view.h"
+#include "../password_loader.h"
+#include "../password_lock.h"
+#include "../password_perf.h"
+#include "../password_scroll.h"
+#include "../password_search.h"
+#include "../password_storage.h"
+#include "../password_totp.h"
+#include "../password_vault_format.h"
+#include "password_canvas_mock.h"
+#include "password_hid_mock.h"
+#include "password_layout_source.h"
+
+#include <dirent.h>
+#include <furi_hal_crypto.h>
+#include <strings.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_PATH_MAX 512
+// Položek v modelu trezoru testů úložiště
+#define TEST_STORAGE_ENTRIES 300
+// PASSWORD_JOURNAL_MAX_RECORDS z password_storage.c
+#define TEST_JOURNAL_RECORDS 64
+// PASSWORD_POOL_COMPACT_MIN_GARBAGE z password_storage.c
+#define TEST_POOL_COMPACT_MIN_GARBAGE 512
+// PASSWORD_LIST_WINDOW_SIZE z password_storage.c
+#define TEST_LIST_WINDOW_SIZE 16
+// FUZZY_MAX_RESULTS z password_manager.c
+#define TEST_SEARCH_RESULTS 8
+
+static unsigned test_failures = 0;
+
+#define TEST_CHECK(condition, ...)                                \
+    do {                                                          \
+        if(!(condition)) {                                        \
+            fprintf(stderr, "CHYBA %s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__);                         \
+            fprintf(stderr, "\n");                                \
+            test_failures++;                                      \
+        }                                                         \
+    } while(0)
+
+// Úroveň klávesy podle modifikátorů, -1 pro kombinaci, kterou popis nezná
+static int test_layout_level(uint8_t modifier) {
+    for(size_t level = 0; level < PASSWORD_LAYOUT_LEVELS; level++) {
+        if(password_layout_source_modifier(level) == modifier) return (int)level;
+    }
+    return -1;
+}
+
+/*
+ * Model klávesnice cíle: stisk napíše znak své klávesy na úrovni podle
+ * modifikátorů, mrtvá klávesa čeká na mezeru. Stisk už držené klávesy
+ * nebo změna modifikátorů při držených klávesách by se na cíli ztratily.
+ */
+static bool test_layout_decode(
+    const PasswordLayoutSource* source,
+    const PasswordHidMockReport* reports,
+    size_t count,
+    char* out,
+    size_t size) {
+    uint8_t held[PASSWORD_KEYBOARD_REPORT_KEYS];
+    size_t held_count = 0;
+    uint8_t held_modifier = 0;
+    uint8_t dead = 0;
+    size_t length = 0;
+
+    for(size_t i = 0; i < count; i++) {
+        const PasswordHidMockReport* report = &reports[i];
+        if(report->keycode == 0) {
+            held_count = 0;
+            continue;
+        }
+
+        if(held_count == PASSWORD_KEYBOARD_REPORT_KEYS) return false;
+        for(size_t j = 0; j < held_count; j++) {
+            if(held[j] == report->keycode) return false;
+        }
+        if(held_count > 0 && report->modifier != held_modifier) return false;
+        held[held_count++] = report->keycode;
+        held_modifier = report->modifier;
+
+        int level = test_layout_level(report->modifier);
+        if(level < 0) return false;
+        const PasswordLayoutSymbol* symbol = &source->keys[report->keycode][level];
+        if(symbol->character == 0) return false;
+
+        char c;
+        if(symbol->dead) {
+            if(dead != 0) return false;
+            dead = symbol->character;
+            continue;
+        } else if(dead != 0) {
+            if(symbol->character != ' ') return false;
+            c = (char)dead;
+            dead = 0;
+        } else {
+            c = (char)symbol->character;
+        }
+        if(length + 1 >= size) return false;
+        out[length++] = c;
+    }
+    out[length] = '\0';
+    return dead == 0 && held_count == 0;
+}
+
+// Každý tisknutelný znak jde napsat a cíl z jeho stisků přečte zase ten znak
+static void test_layout_characters(
+    const char* id,
+    const PasswordKeyboardLayout* layout,
+    const PasswordLayoutSource* source) {
+    for(char c = ' '; c <= '~'; c++) {
+        const PasswordKeyboardKey* strokes = password_keyboard_key(layout, c);
+        PasswordHidMockReport reports[PASSWORD_KEYBOARD_MAX_STROKES * 2];
+        size_t count = 0;
+        for(size_t i = 0; i < PASSWORD_KEYBOARD_MAX_STROKES && strokes[i].keycode != 0; i++) {
+            reports[count++] = (PasswordHidMockReport){.modifier = strokes[i].modifier, .keycode = strokes[i].keycode};
+            reports[count++] = (PasswordHidMockReport){0};
+        }
+        char typed[4];
+        TEST_CHECK(count > 0, "%s: znak '%c' nejde napsat", id, c);
+        TEST_CHECK(
+            count == 0 || (test_layout_decode(source, reports, count, typed, sizeof(typed)) &&
+                           typed[0] == c && typed[1] == '\0'),
+            "%s: znak '%c' se napíše jinak",
+            id,
+            c);
+    }
+}
+
+// Celé psaní ve všech rychlostech včetně opakovaných kláves a mrtvých kláves za sebou
+static void test_layout_typing(
+    const char* id,
+    const PasswordKeyboardLayout* layout,
+    const PasswordLayoutSource* source) {
+    char text[256];
+    size_t length = 0;
+    for(char c = ' '; c <= '~'; c++) text[length++] = c;
+    static const char tricky[] = "aaAAa^^``~~ ^a~ 112233!!@@zzyyZZYY";
+    memcpy(text + length, tricky, sizeof(tricky));
+
+    for(int speed = 0; speed < PasswordKeyboardSpeedCount; speed++) {
+        password_hid_mock_reset();
+        TEST_CHECK(
+            password_keyboard_type(&password_hid_mock, text, layout, (PasswordKeyboardSpeed)speed, NULL, NULL) ==
+                PasswordKeyboardResultOk,
+            "%s: psaní selhalo",
+            id);
+        size_t count;
+        const PasswordHidMockReport* reports = password_hid_mock_reports(&count);
+        char typed[512];
+        bool decoded = test_layout_decode(source, reports, count, typed, sizeof(typed));
+        TEST_CHECK(decoded && strcmp(typed, text) == 0, "%s: rychlost %s napsala jiný text", id, password_keyboard_speed_name((PasswordKeyboardSpeed)speed));
+    }
+}
+
+static void test_layout(const char* root, const char* id) {
+    unsigned failures = test_failures;
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/layouts/%s.txt", root, id);
+    static PasswordLayoutSource source;
+    TEST_CHECK(password_layout_source_parse(path, &source), "%s: neplatný popis", id);
+
+    PasswordKeyboardLayout layout;
+    password_keyboard_layout_default(&layout);
+    snprintf(path, sizeof(path), "%s/%s%s", PASSWORD_KEYBOARD_LAYOUT_DIRECTORY, id, PASSWORD_KEYBOARD_LAYOUT_EXTENSION);
+    TEST_CHECK(password_keyboard_layout_load(&layout, path), "%s: nelze načíst %s", id, path);
+    TEST_CHECK(strcmp(layout.name, source.name) == 0, "%s: název %s místo %s", id, layout.name, source.name);
+
+    test_layout_characters(id, &layout, &source);
+    test_layout_typing(id, &layout, &source);
+
+    // Vestavěné rozložení musí odpovídat svému popisu stejně jako soubor
+    if(strcmp(id, PASSWORD_KEYBOARD_LAYOUT_DEFAULT) == 0) {
+        password_keyboard_layout_default(&layout);
+        test_layout_characters("vestavěné", &layout, &source);
+        test_layout_typing("vestavěné", &layout, &source);
+    }
+    printf("rozložení %-3s %-12s %s\n", id, source.name, test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Poškozený soubor se odmítne a rozložení zůstane beze změny
+static void test_layout_invalid(void) {
+    PasswordKeyboardLayout layout;
+    password_keyboard_layout_default(&layout);
+    TEST_CHECK(!password_keyboard_layout_load(&layout, APP_ASSETS_PATH("layouts/neexistuje.pwl")), "chybějící soubor se načetl");
+    TEST_CHECK(strcmp(layout.name, "US") == 0, "rozložení se po chybě změnilo");
+}
+
+// Řada kláves US: znak bez Shiftu a se Shiftem na kódu first + pořadí v řadě
+typedef struct {
+    const char* plain;
+    const char* shifted; // Kratší než plain, pokud klávesa se Shiftem nic nepíše
+    uint8_t first;
+} TestKeyboardRow;
+
+// Kódy podle HID Usage Tables (Keyboard/Keypad Page), ne podle furi_hal
+static const TestKeyboardRow test_keyboard_rows[] = {
+    {"abcdefghijklmnopqrstuvwxyz", "ABCDEFGHIJKLMNOPQRSTUVWXYZ", 0x04},
+    {"1234567890", "!@#$%^&*()", 0x1E},
+    {" ", "", 0x2C},
+    {"-=[]\\", "_+{}|", 0x2D},
+    {";'`,./", ":\"~<>?", 0x33},
+};
+
+#define TEST_KEYBOARD_SHIFT 0x02 // Levý Shift v bajtu modifikátorů
+
+// Vestavěné rozložení odpovídá tabulce a převod znak → stisk → znak je jednoznačný
+static void test_keyboard_table(void) {
+    unsigned failures = test_failures;
+    PasswordKeyboardLayout layout;
+    password_keyboard_layout_default(&layout);
+
+    char expected_char[256][2] = {{0}}; // [kód][Shift] → znak
+    bool covered[PASSWORD_KEYBOARD_CHARACTERS] = {false};
+    for(size_t row = 0; row < COUNT_OF(test_keyboard_rows); row++) {
+        const TestKeyboardRow* keys = &test_keyboard_rows[row];
+        for(size_t level = 0; level < 2; level++) {
+            const char* chars = level == 0 ? keys->plain : keys->shifted;
+            for(size_t i = 0; chars[i] != '\0'; i++) {
+                char c = chars[i];
+                uint8_t keycode = (uint8_t)(keys->first + i);
+                uint8_t modifier = level == 0 ? 0 : TEST_KEYBOARD_SHIFT;
+                TEST_CHECK(!covered[(uint8_t)c], "znak '%c' v tabulce dvakrát", c);
+                TEST_CHECK(expected_char[keycode][level] == 0, "kód 0x%02X v tabulce dvakrát", keycode);
+                covered[(uint8_t)c] = true;
+                expected_char[keycode][level] = c;
+
+                const PasswordKeyboardKey* strokes = password_keyboard_key(&layout, c);
+                TEST_CHECK(
+                    strokes[0].keycode == keycode && strokes[0].modifier == modifier,
+                    "znak '%c': kód 0x%02X/0x%02X místo 0x%02X/0x%02X",
+                    c,
+                    strokes[0].keycode,
+                    strokes[0].modifier,
+                    keycode,
+                    modifier);
+                TEST_CHECK(strokes[1].keycode == 0, "znak '%c' má dva stisky", c);
+            }
+        }
+    }
+
+    for(int c = 0; c < PASSWORD_KEYBOARD_CHARACTERS; c++) {
+        const PasswordKeyboardKey* strokes = password_keyboard_key(&layout, (char)c);
+        if(c < ' ' || c > '~') {
+            TEST_CHECK(strokes[0].keycode == 0, "řídicí znak 0x%02X jde napsat", c);
+            continue;
+        }
+        TEST_CHECK(covered[c], "znak '%c' chybí v tabulce testu", c);
+
+        // Zpětný převod přes tabulku: stisk musí dát zase ten znak
+        uint8_t modifier = strokes[0].modifier;
+        TEST_CHECK(modifier == 0 || modifier == TEST_KEYBOARD_SHIFT, "znak '%c': modifikátor 0x%02X", c, modifier);
+        char typed = expected_char[strokes[0].keycode][modifier == 0 ? 0 : 1];
+        TEST_CHECK(typed == c, "znak '%c' se přečte jako 0x%02X", c, (uint8_t)typed);
+    }
+    printf("tabulka US %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Přepínání prochází vestavěné rozložení a pak soubory podle abecedy
+static void test_layout_cycle(size_t count) {
+    char current[PASSWORD_KEYBOARD_LAYOUT_NAME_SIZE] = PASSWORD_KEYBOARD_LAYOUT_DEFAULT;
+    size_t visited = 0;
+    char next[PASSWORD_KEYBOARD_LAYOUT_NAME_SIZE];
+    PasswordKeyboardLayout layout;
+    while(password_keyboard_layout_next(PASSWORD_KEYBOARD_LAYOUT_DIRECTORY, current, next, sizeof(next))) {
+        TEST_CHECK(strcmp(next, current) > 0 || strcmp(current, PASSWORD_KEYBOARD_LAYOUT_DEFAULT) == 0, "rozložení %s po %s", next, current);
+        TEST_CHECK(strcmp(next, PASSWORD_KEYBOARD_LAYOUT_DEFAULT) != 0, "vestavěné rozložení podruhé");
+        TEST_CHECK(password_keyboard_layout_select(&layout, PASSWORD_KEYBOARD_LAYOUT_DIRECTORY, next), "nelze vybrat %s", next);
+        strlcpy(current, next, sizeof(current));
+        if(++visited > count) break;
+    }
+    // Popisy zahrnují i vestavěné rozložení
+    TEST_CHECK(visited + 1 == count, "přepínání prošlo %zu rozložení z %zu", visited + 1, count);
+}
+
+// Nepřipojený nebo vypnutý přenos psaní odmítne a neodešle žádný report
+static void test_hid_transport(void) {
+    unsigned failures = test_failures;
+    PasswordKeyboardLayout layout;
+    password_keyboard_layout_default(&layout);
+    size_t count;
+
+    password_hid_mock_reset();
+    password_hid_mock_set_connected(false);
+    TEST_CHECK(
+        password_keyboard_type(&password_hid_mock, "abc", &layout, PasswordKeyboardSpeedFast, NULL, NULL) ==
+            PasswordKeyboardResultDisconnected,
+        "nepřipojený přenos psal");
+    password_hid_mock_set_connected(true);
+
+    password_hid_mock.stop();
+    TEST_CHECK(
+        password_keyboard_type(&password_hid_mock, "abc", &layout, PasswordKeyboardSpeedFast, NULL, NULL) ==
+            PasswordKeyboardResultDisconnected,
+        "vypnutý přenos psal");
+    password_hid_mock_reports(&count);
+    TEST_CHECK(count == 0, "odesláno %zu reportů bez připojení", count);
+
+    // Opakované zapnutí zapnutého přenosu nic nemění
+    uint32_t starts = password_hid_mock_starts();
+    password_hid_mock.start();
+    password_hid_mock.start();
+    TEST_CHECK(password_hid_mock_starts() == starts + 1, "přenos zapnut %u×", password_hid_mock_starts() - starts);
+    printf("přenos HID %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Události workeru, callback běží ve vlákně workeru
+typedef struct {
+    PasswordKeyboardWorker* worker;
+    unsigned events[PasswordKeyboardWorkerEventCancelled + 1];
+    unsigned cancel_at; // Po kolika znacích callback psaní zruší, 0 nikdy
+} TestWorker;
+
+static void test_worker_callback(PasswordKeyboardWorkerEvent event, void* context) {
+    TestWorker* test = context;
+    unsigned progress = __atomic_add_fetch(&test->events[event], 1, __ATOMIC_SEQ_CST);
+    if(event == PasswordKeyboardWorkerEventProgress && progress == test->cancel_at) {
+        password_keyboard_worker_cancel(test->worker);
+    }
+}
+
+// Počká (nejvýš 5 s), až worker ohlásí daný počet dokončených úloh
+static bool test_worker_wait(TestWorker* test, unsigned finished) {
+    for(int i = 0; i < 5000; i++) {
+        unsigned count = __atomic_load_n(&test->events[PasswordKeyboardWorkerEventDone], __ATOMIC_SEQ_CST) +
+                         __atomic_load_n(&test->events[PasswordKeyboardWorkerEventCancelled], __ATOMIC_SEQ_CST);
+        if(count >= finished) return true;
+        nanosleep(&(struct timespec){.tv_nsec = 1000000}, NULL);
+    }
+    return false;
+}
+
+static void test_worker(const char* root) {
+    unsigned failures = test_failures;
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/layouts/%s.txt", root, PASSWORD_KEYBOARD_LAYOUT_DEFAULT);
+    static PasswordLayoutSource source;
+    TEST_CHECK(password_layout_source_parse(path, &source), "neplatný popis %s", path);
+    PasswordKeyboardLayout layout;
+    password_keyboard_layout_default(&layout);
+    static const char* const texts[] = {"prvni-heslo", "Druhe Heslo!", "treti~^"};
+    char typed[256];
+    size_t count;
+    PasswordArena* arena = password_arena_alloc();
+
+    // Úlohy ve frontě se napíšou celé a v pořadí zařazení
+    TestWorker test = {0};
+    password_hid_mock_reset();
+    test.worker = password_keyboard_worker_alloc(arena, test_worker_callback, &test);
+    for(size_t i = 0; i < COUNT_OF(texts); i++) {
+        TEST_CHECK(password_keyboard_worker_enqueue(test.worker, &password_hid_mock, texts[i], &layout, PasswordKeyboardSpeedFast), "úloha %zu se nezařadila", i);
+    }
+    TEST_CHECK(test_worker_wait(&test, COUNT_OF(texts)), "worker nedopsal frontu");
+    PasswordKeyboardWorkerStatus status;
+    password_keyboard_worker_status(test.worker, &status);
+    TEST_CHECK(status.pending == 0, "ve frontě zůstalo %u úloh", status.pending);
+    const PasswordHidMockReport* reports = password_hid_mock_reports(&count);
+    bool decoded = test_layout_decode(&source, reports, count, typed, sizeof(typed));
+    TEST_CHECK(decoded && strcmp(typed, "prvni-hesloDruhe Heslo!treti~^") == 0, "fronta napsala \"%s\"", typed);
+    TEST_CHECK(test.events[PasswordKeyboardWorkerEventDone] == COUNT_OF(texts), "dokončeno %u úloh", test.events[PasswordKeyboardWorkerEventDone]);
+    TEST_CHECK(password_arena_used(arena) == 0, "napsané úlohy drží %u slotů", password_arena_used(arena));
+
+    // Příliš dlouhý text se nezařadí
+    char long_text[PASSWORD_KEYBOARD_WORKER_TEXT_SIZE + 1];
+    memset(long_text, 'a', sizeof(long_text) - 1);
+    long_text[sizeof(long_text) - 1] = '\0';
+    TEST_CHECK(!password_keyboard_worker_enqueue(test.worker, &password_hid_mock, long_text, &layout, PasswordKeyboardSpeedFast), "zařazen příliš dlouhý text");
+    password_keyboard_worker_free(test.worker);
+
+    // Zrušení po pátém znaku: cíl dostane jen začátek první úlohy, čekající úlohy zmizí
+    test = (TestWorker){.cancel_at = 5};
+    password_hid_mock_reset();
+    test.worker = password_keyboard_worker_alloc(arena, test_worker_callback, &test);
+    for(size_t i = 0; i < COUNT_OF(texts); i++) {
+        password_keyboard_worker_enqueue(test.worker, &password_hid_mock, texts[i], &layout, PasswordKeyboardSpeedNormal);
+    }
+    TEST_CHECK(test_worker_wait(&test, 1), "worker nezrušil psaní");
+    password_keyboard_worker_status(test.worker, &status);
+    TEST_CHECK(status.pending == 0, "po zrušení zůstalo %u úloh", status.pending);
+    reports = password_hid_mock_reports(&count);
+    decoded = test_layout_decode(&source, reports, count, typed, sizeof(typed));
+    TEST_CHECK(decoded && strcmp(typed, "prvni") == 0, "zrušené psaní napsalo \"%s\"", typed);
+    TEST_CHECK(test.events[PasswordKeyboardWorkerEventDone] == 0, "zrušená úloha dokončena");
+    TEST_CHECK(password_arena_used(arena) == 0, "zrušené úlohy drží %u slotů", password_arena_used(arena));
+
+    // Po zrušení worker píše dál
+    TEST_CHECK(password_keyboard_worker_enqueue(test.worker, &password_hid_mock, texts[1], &layout, PasswordKeyboardSpeedSafe), "úloha po zrušení se nezařadila");
+    TEST_CHECK(test_worker_wait(&test, 2), "worker po zrušení nepíše");
+    reports = password_hid_mock_reports(&count);
+    decoded = test_layout_decode(&source, reports, count, typed, sizeof(typed));
+    TEST_CHECK(decoded && strcmp(typed, "prvniDruhe Heslo!") == 0, "po zrušení napsáno \"%s\"", typed);
+    password_keyboard_worker_free(test.worker);
+    password_arena_free(arena);
+
+    printf("worker psaní %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+static void test_arena(void) {
+    unsigned failures = test_failures;
+    PasswordArena* arena = password_arena_alloc();
+
+    // Sloty se vydají vynulované, po vrácení jsou přepsané
+    char* slots[PASSWORD_ARENA_SLOTS];
+    for(size_t i = 0; i < COUNT_OF(slots); i++) {
+        slots[i] = password_arena_take(arena, PASSWORD_ARENA_SLOT_SIZE);
+        TEST_CHECK(slots[i] != NULL, "slot %zu se nevydal", i);
+        if(!slots[i]) break;
+        bool zero = true;
+        for(size_t b = 0; b < PASSWORD_ARENA_SLOT_SIZE; b++) zero = zero && slots[i][b] == 0;
+        TEST_CHECK(zero, "slot %zu není vynulovaný", i);
+        memset(slots[i], 'x', PASSWORD_ARENA_SLOT_SIZE);
+    }
+    TEST_CHECK(password_arena_used(arena) == PASSWORD_ARENA_SLOTS, "vydáno %u slotů", password_arena_used(arena));
+    TEST_CHECK(password_arena_take(arena, 1) == NULL, "plná aréna vydala slot");
+
+    char* released = slots[3];
+    password_arena_release(arena, released);
+    bool wiped = true;
+    for(size_t b = 0; b < PASSWORD_ARENA_SLOT_SIZE; b++) wiped = wiped && released[b] == 0;
+    TEST_CHECK(wiped, "vrácený slot není přepsaný");
+    TEST_CHECK(password_arena_take(arena, 8) == released, "vrácený slot se znovu nevydal");
+
+    // Vrácení NULL nic nedělá, větší tajemství se do slotu nevejde
+    password_arena_release(arena, NULL);
+    for(size_t i = 0; i < COUNT_OF(slots); i++) password_arena_release(arena, slots[i]);
+    TEST_CHECK(password_arena_used(arena) == 0, "po vrácení vydáno %u slotů", password_arena_used(arena));
+    TEST_CHECK(password_arena_take(arena, PASSWORD_ARENA_SLOT_SIZE + 1) == NULL, "vydán příliš malý slot");
+
+    // Opakované vydání a vrácení nealokuje
+    size_t heap = furi_shim_heap_used();
+    for(unsigned i = 0; i < 1000; i++) password_arena_release(arena, password_arena_take(arena, 32));
+    TEST_CHECK(furi_shim_heap_used() == heap, "aréna alokovala %zu B", furi_shim_heap_used() - heap);
+    password_arena_free(arena);
+
+    printf("aréna tajemství %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Připraví a vykreslí seznam, vrátí, kolik řádků se připravilo znovu
+static uint32_t test_list_view_draw(
+    PasswordListView* view,
+    PasswordList* list,
+    PasswordListRange range,
+    uint32_t selected) {
+    uint32_t misses = view->misses;
+    password_list_view_update(view, list, range, selected);
+    password_canvas_mock_reset();
+    password_list_view_draw(view, password_canvas_mock(), 22);
+    return view->misses - misses;
+}
+
+static void test_list_view(void) {
+    unsigned failures = test_failures;
+    static const char* const names[] = {
+        "aaa-velmi-dlouhy-nazev-hesla-x",
+        "žžžžžžžžžžžžžžžžžžžžžž",
+        "beta",
+        "delta",
+        "epsilon",
+        "gama",
+        "kappa",
+        "lambda",
+    };
+    PasswordList list;
+    password_list_init(&list);
+    for(size_t i = 0; i < COUNT_OF(names); i++) password_list_add(&list, names[i], "heslo");
+    PasswordListView view;
+    password_list_view_reset(&view);
+    PasswordListRange all = {0, list.count};
+
+    // Dlouhý název se zkrátí i s "..." na šířku řádku vedle posuvníku
+    uint32_t misses = test_list_view_draw(&view, &list, all, 0);
+    PasswordCanvasMockStats stats = password_canvas_mock_stats();
+    TEST_CHECK(misses == PASSWORD_LIST_VIEW_ROWS, "připraveno %u řádků", misses);
+    TEST_CHECK(stats.boxes == 1, "posuvník nakreslen %zu×", stats.boxes);
+    const PasswordListViewRow* row = &view.rows[0];
+    size_t length = strlen(row->text);
+    TEST_CHECK(
+        length > 3 && strcmp(row->text + length - 3, "...") == 0 && row->width <= 128 - 15,
+        "zkrácený název \"%s\" (%u px)", row->text, row->width);
+    TEST_CHECK(
+        row->width == canvas_string_width(password_canvas_mock(), row->text),
+        "uložená šířka %u neodpovídá", row->width);
+    TEST_CHECK(
+        strcmp(password_canvas_mock_string(1), row->text) == 0, "kreslí se \"%s\"", password_canvas_mock_string(1));
+
+    // Poslední název (ž) se zkracuje po celých znacích UTF-8
+    misses = test_list_view_draw(&view, &list, all, list.count - 1);
+    row = &view.rows[PASSWORD_LIST_VIEW_ROWS - 1];
+    length = strlen(row->text);
+    TEST_CHECK(
+        length > 3 && (unsigned char)row->text[length - 4] != 0xC5 && row->width <= 128 - 15,
+        "název zkrácen uprostřed znaku: \"%s\"", row->text);
+
+    // Překreslení beze změny nic nečte ani neměří, posun o řádek připraví jen nový řádek
+    test_list_view_draw(&view, &list, all, 3);
+    misses = test_list_view_draw(&view, &list, all, 3);
+    stats = password_canvas_mock_stats();
+    TEST_CHECK(misses == 0 && stats.measures == 0, "překreslení připravilo %u řádků", misses);
+    misses = test_list_view_draw(&view, &list, all, 4);
+    TEST_CHECK(misses == 1, "posun o řádek připravil %u řádků", misses);
+
+    // Krátký rozsah je bez posuvníku, názvy mají víc místa a zkrátí se znovu
+    misses = test_list_view_draw(&view, &list, (PasswordListRange){2, 5}, 2);
+    stats = password_canvas_mock_stats();
+    TEST_CHECK(stats.boxes == 0 && misses == 3, "krátký rozsah: %zu posuvníků, %u řádků", stats.boxes, misses);
+
+    // Po změně seznamu se připraví všechny řádky
+    test_list_view_draw(&view, &list, all, 4);
+    password_list_add(&list, "eta", "heslo");
+    misses = test_list_view_draw(&view, &list, (PasswordListRange){0, list.count}, 4);
+    TEST_CHECK(misses == PASSWORD_LIST_VIEW_ROWS, "po změně připraveno %u řádků", misses);
+
+    // Práce se snímkem nezávisí na velikosti seznamu
+    char name[NAME_MAX_LENGTH];
+    for(uint32_t i = 0; i < 2000; i++) {
+        snprintf(name, sizeof(name), "heslo-%05u", (unsigned)i);
+        password_list_add(&list, name, "heslo");
+    }
+    test_list_view_draw(&view, &list, (PasswordListRange){0, list.count}, 1500);
+    stats = password_canvas_mock_stats();
+    TEST_CHECK(
+        stats.strings == PASSWORD_LIST_VIEW_ROWS + 1 && stats.measures <= PASSWORD_LIST_VIEW_ROWS,
+        "snímek: %zu textů, %zu měření", stats.strings, stats.measures);
+
+    // Kreslení čte jen připravené řádky, seznam už může být uvolněný
+    password_list_view_update(&view, &list, (PasswordListRange){0, list.count}, 1501);
+    strlcpy(name, password_list_get_name(&list, 1501), sizeof(name));
+    password_list_free(&list);
+    password_canvas_mock_reset();
+    password_list_view_draw(&view, password_canvas_mock(), 22);
+    TEST_CHECK(
+        strcmp(password_canvas_mock_string(3), name) == 0,
+        "po uvolnění seznamu kreslí \"%s\"", password_canvas_mock_string(3));
+
+    printf("seznam na displeji %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Opakování držené klávesy, kontext je klávesa
+static bool test_scroll_is_repeat(const void* event, void* context) {
+    const InputEvent* input = event;
+    return input->type == InputTypeRepeat && input->key == *(const InputKey*)context;
+}
+
+static void test_scroll(void) {
+    unsigned failures = test_failures;
+
+    // Kroky po opakováních: 1, pak 5, pak stránka (1/32 seznamu, u krátkého seznamu 5)
+    static const struct {
+        uint32_t repeat;
+        uint32_t length;
+        uint32_t step;
+    } steps[] = {
+        {0, 10000, 1},
+        {4, 10000, 1},
+        {5, 10000, 5},
+        {14, 10000, 5},
+        {15, 10000, 312},
+        {100, 10000, 312},
+        {15, 100, 5},
+        {15, 0, 5},
+    };
+    for(size_t i = 0; i < COUNT_OF(steps); i++) {
+        uint32_t step = password_scroll_step(steps[i].repeat, steps[i].length);
+        TEST_CHECK(
+            step == steps[i].step,
+            "krok %u. opakování v %u: %u místo %u",
+            (unsigned)steps[i].repeat,
+            (unsigned)steps[i].length,
+            (unsigned)step,
+            (unsigned)steps[i].step);
+    }
+
+    // Součet sloučených opakování je stejný jako po jednom a pokračuje od dosaženého opakování
+    uint32_t repeats = 0;
+    uint32_t delta = password_scroll_delta(&repeats, 20, 10000);
+    TEST_CHECK(delta == 5 * 1 + 10 * 5 + 5 * 312 && repeats == 20, "20 opakování: posun %u", (unsigned)delta);
+    uint32_t single = 0, one_by_one = 0;
+    for(unsigned i = 0; i < 20; i++) one_by_one += password_scroll_delta(&single, 1, 10000);
+    TEST_CHECK(one_by_one == delta && single == repeats, "po jednom posun %u", (unsigned)one_by_one);
+
+    // Slučování: opakování Dolů se vytáhnou, Nahoru se odloží, zbytek fronty zůstane
+    FuriMessageQueue* queue = furi_message_queue_alloc(8, sizeof(InputEvent));
+    static const InputEvent queued[] = {
+        {.key = InputKeyDown, .type = InputTypeRepeat},
+        {.key = InputKeyDown, .type = InputTypeRepeat},
+        {.key = InputKeyDown, .type = InputTypeRepeat},
+        {.key = InputKeyUp, .type = InputTypeRepeat},
+        {.key = InputKeyDown, .type = InputTypeRepeat},
+    };
+    for(size_t i = 0; i < COUNT_OF(queued); i++) furi_message_queue_put(queue, &queued[i], 0);
+    InputKey key = InputKeyDown;
+    InputEvent pending;
+    bool has_pending = false;
+    uint32_t coalesced = password_scroll_coalesce(queue, test_scroll_is_repeat, &key, &pending, &has_pending);
+    TEST_CHECK(
+        coalesced == 3 && has_pending && pending.key == InputKeyUp && furi_message_queue_get_count(queue) == 1,
+        "sloučeno %u, ve frontě %u",
+        (unsigned)coalesced,
+        (unsigned)furi_message_queue_get_count(queue));
+
+    // S odloženou událostí se fronta nečte, uvolnění klávesy slučování zastaví
+    coalesced = password_scroll_coalesce(queue, test_scroll_is_repeat, &key, &pending, &has_pending);
+    TEST_CHECK(coalesced == 0 && furi_message_queue_get_count(queue) == 1, "fronta čtena přes odloženou událost");
+    has_pending = false;
+    static const InputEvent release = {.key = InputKeyDown, .type = InputTypeRelease};
+    furi_message_queue_put(queue, &release, 0);
+    coalesced = password_scroll_coalesce(queue, test_scroll_is_repeat, &key, &pending, &has_pending);
+    TEST_CHECK(
+        coalesced == 1 && has_pending && pending.type == InputTypeRelease &&
+            furi_message_queue_get_count(queue) == 0,
+        "před uvolněním sloučeno %u", (unsigned)coalesced);
+
+    // Prázdná fronta nic neodloží
+    has_pending = false;
+    coalesced = password_scroll_coalesce(queue, test_scroll_is_repeat, &key, &pending, &has_pending);
+    TEST_CHECK(coalesced == 0 && !has_pending, "prázdná fronta");
+    furi_message_queue_free(queue);
+
+    printf("posouvání %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+static void test_perf(void) {
+    unsigned failures = test_failures;
+    PasswordPerfStat stat;
+
+#ifdef PASSWORD_PERF
+    // Každý napsaný znak je jeden průchod sondy psaní
+    PasswordKeyboardLayout layout;
+    password_keyboard_layout_default(&layout);
+    password_perf_reset();
+    password_keyboard_type(&password_hid_mock, "heslo", &layout, PasswordKeyboardSpeedNormal, NULL, NULL);
+    password_perf_get(PasswordPerfProbeKey, &stat);
+    TEST_CHECK(stat.count == 5 && stat.max > 0, "psaní: %u průchodů, nejvýš %u us", stat.count, stat.max);
+#endif
+
+    // Sonda počítá průchody, poslední a největší hodnotu a jejich součet
+    password_perf_reset();
+    password_perf_record(PasswordPerfProbeQueue, 3);
+    password_perf_record(PasswordPerfProbeQueue, 1);
+    password_perf_get(PasswordPerfProbeQueue, &stat);
+    TEST_CHECK(
+        stat.count == 2 && stat.last == 1 && stat.max == 3 && stat.total == 4,
+        "sonda: %u průchodů, poslední %u, nejvýš %u", stat.count, stat.last, stat.max);
+
+    // Dvě připsání do nového souboru: jedna hlavička a dvakrát řádek každé sondy
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    TEST_CHECK(password_perf_append_csv("/ext/perf.log"), "první zápis CSV selhal");
+    TEST_CHECK(password_perf_append_csv("/ext/perf.log"), "druhý zápis CSV selhal");
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/perf.log", root);
+    FILE* file = fopen(path, "r");
+    char line[128];
+    unsigned headers = 0, rows = 0;
+    while(file && fgets(line, sizeof(line), file)) {
+        if(strncmp(line, "firmware,", 9) == 0) headers++;
+        if(strncmp(line, "host,", 5) == 0 && strstr(line, ",queue,2,1,2,3")) rows++;
+    }
+    if(file) fclose(file);
+    TEST_CHECK(headers == 1 && rows == 2, "CSV: %u hlaviček, %u řádků fronty", headers, rows);
+    unlink(path);
+    rmdir(root);
+
+    printf("měření %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Hledání linárním průchodem, u stejných názvů poslední
+static bool test_name_index_scan(PasswordList* list, const char* name, uint32_t* index) {
+    bool found = false;
+    for(uint32_t i = 0; i < list->count; i++) {
+        if(strcmp(password_list_get_name(list, i), name) == 0) {
+            *index = i;
+            found = true;
+        }
+    }
+    return found;
+}
+
+static void test_name_index(void) {
+    unsigned failures = test_failures;
+    PasswordList list;
+    password_list_init(&list);
+
+    // Náhodné přidávání, úpravy a odebírání; index musí po každé změně najít totéž co průchod
+    srand(1);
+    char name[NAME_MAX_LENGTH];
+    unsigned mismatches = 0;
+    for(unsigned step = 0; step < 3000; step++) {
+        snprintf(name, sizeof(name), "heslo-%u", rand() % 400);
+        unsigned op = rand() % 4;
+        uint32_t index = list.count ? (uint32_t)rand() % list.count : 0;
+        if(op < 2 || list.count == 0) {
+            password_list_add(&list, name, "x");
+        } else if(op == 2) {
+            password_list_update(&list, index, name, "y");
+        } else {
+            password_list_remove(&list, index);
+        }
+
+        for(unsigned probe = 0; probe < 8; probe++) {
+            snprintf(name, sizeof(name), "heslo-%u", rand() % 420);
+            uint32_t expected = 0, actual = 0;
+            bool expected_found = test_name_index_scan(&list, name, &expected);
+            bool actual_found = password_list_find(&list, name, &actual);
+            if(expected_found != actual_found || (expected_found && expected != actual)) mismatches++;
+        }
+    }
+    TEST_CHECK(mismatches == 0, "index názvů se %u× lišil od průchodu", mismatches);
+
+    // Přidání nebo nahrazení: stejný název nevytvoří duplicitu
+    password_list_clear(&list);
+    char password[PASSWORD_MAX_LENGTH];
+    uint32_t index;
+    TEST_CHECK(password_list_put(&list, "web", "prvni", false) == PasswordListPutAdded, "put nepřidal");
+    TEST_CHECK(password_list_put(&list, "web", "druhe", false) == PasswordListPutExists, "put bez nahrazení přepsal");
+    TEST_CHECK(password_list_put(&list, "web", "treti", true) == PasswordListPutReplaced, "put nenahradil");
+    TEST_CHECK(
+        list.count == 1 && password_list_find(&list, "web", &index) &&
+            password_list_read_password(&list, index, password, sizeof(password)) &&
+            strcmp(password, "treti") == 0,
+        "po put %u hesel", list.count);
+    TEST_CHECK(!password_list_find(&list, "Web", &index), "hledání nerozlišuje velikost písmen");
+    password_list_free(&list);
+
+    printf("index názvů %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Převede hexadecimální zápis na bajty, vrátí jejich počet
+static size_t test_hex(const char* hex, uint8_t* bytes) {
+    size_t size = strlen(hex) / 2;
+    for(size_t i = 0; i < size; i++) {
+        unsigned value;
+        sscanf(hex + 2 * i, "%2x", &value);
+        bytes[i] = (uint8_t)value;
+    }
+    return size;
+}
+
+// Otevře zapečetěné heslo a ověří, že se odmítlo a výstup zůstal prázdný
+static bool test_crypto_rejected(
+    const uint8_t* key,
+    const char* name,
+    const uint8_t* sealed,
+    size_t length) {
+    char password[PASSWORD_MAX_LENGTH];
+    memset(password, 'x', sizeof(password));
+    bool opened = password_crypto_open(key, name, strlen(name), sealed, length, password);
+    bool wiped = password[0] == '\0';
+    for(size_t i = 1; i < length; i++) wiped = wiped && password[i] == '\0';
+    return !opened && wiped;
+}
+
+static void test_crypto(void) {
+    unsigned failures = test_failures;
+
+    // Testovací vektory NIST GCM spec: 13 (prázdný text), 14 (nulový blok), 16 (s AAD)
+    static const struct {
+        const char* key;
+        const char* iv;
+        const char* aad;
+        const char* plaintext;
+        const char* ciphertext;
+        const char* tag;
+    } vectors[] = {
+        {"0000000000000000000000000000000000000000000000000000000000000000",
+         "000000000000000000000000",
+         "",
+         "",
+         "",
+         "530f8afbc74536b9a963b4f1c4cb738b"},
+        {"0000000000000000000000000000000000000000000000000000000000000000",
+         "000000000000000000000000",
+         "",
+         "00000000000000000000000000000000",
+         "cea7403d4d606b6e074ec5d3baf39d18",
+         "d0d1c8a799996bf0265b98b5d48ab919"},
+        {"feffe9928665731c6d6a8f9467308308feffe9928665731c6d6a8f9467308308",
+         "cafebabefacedbaddecaf888",
+         "feedfacedeadbeeffeedfacedeadbeefabaddad2",
+         "d9313225f88406e5a55909c5aff5269a86a7a9531534f7da2e4c303d8a318a72"
+         "1c3c0c95956809532fcf0e2449a6b525b16aedf5aa0de657ba637b39",
+         "522dc1f099567d07f47f37a32a84427d643a8cdcbfe5c0c97598a2bd2555d1aa"
+         "8cb08e48590dbb3da7b08b1056828838c5f61e6393ba7a0abcc9f662",
+         "76fc6ece0f4e1768cddf8853bb2d551b"},
+    };
+    for(size_t i = 0; i < COUNT_OF(vectors); i++) {
+        uint8_t key[PASSWORD_CRYPTO_KEY_SIZE], iv[FURI_HAL_CRYPTO_GCM_IV_LENGTH], aad[32];
+        uint8_t plaintext[64], ciphertext[64], expected[64], output[64];
+        uint8_t tag[FURI_HAL_CRYPTO_GCM_TAG_LENGTH], expected_tag[FURI_HAL_CRYPTO_GCM_TAG_LENGTH];
+        test_hex(vectors[i].key, key);
+        test_hex(vectors[i].iv, iv);
+        size_t aad_length = test_hex(vectors[i].aad, aad);
+        size_t length = test_hex(vectors[i].plaintext, plaintext);
+        test_hex(vectors[i].ciphertext, expected);
+        test_hex(vectors[i].tag, expected_tag);
+        TEST_CHECK(
+            furi_hal_crypto_gcm_encrypt_and_tag(key, iv, aad, aad_length, plaintext, ciphertext, length, tag) ==
+                    FuriHalCryptoGCMStateOk &&
+                memcmp(ciphertext, expected, length) == 0 && memcmp(tag, expected_tag, sizeof(tag)) == 0,
+            "GCM vektor %zu: šifrový text nebo značka nesouhlasí", i);
+        TEST_CHECK(
+            furi_hal_crypto_gcm_decrypt_and_verify(key, iv, aad, aad_length, expected, output, length, expected_tag) ==
+                    FuriHalCryptoGCMStateOk &&
+                memcmp(output, plaintext, length) == 0,
+            "GCM vektor %zu: dešifrování nesouhlasí", i);
+        expected_tag[0] ^= 0x01;
+        TEST_CHECK(
+            furi_hal_crypto_gcm_decrypt_and_verify(key, iv, aad, aad_length, expected, output, length, expected_tag) ==
+                FuriHalCryptoGCMStateAuthFailure,
+            "GCM vektor %zu: změněná značka prošla", i);
+    }
+
+    // Zapečetěné heslo se otevře stejné, dvě pečetě téhož hesla se liší nonce
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    memset(key, 0x5A, sizeof(key));
+    static const char name[] = "banka";
+    static const char secret[] = "tajne-heslo-123";
+    size_t length = strlen(secret);
+    uint8_t sealed[PASSWORD_CRYPTO_SEALED_SIZE(PASSWORD_MAX_LENGTH)];
+    uint8_t other[PASSWORD_CRYPTO_SEALED_SIZE(PASSWORD_MAX_LENGTH)];
+    char password[PASSWORD_MAX_LENGTH];
+    TEST_CHECK(password_crypto_seal(key, name, strlen(name), secret, length, sealed), "heslo nejde zapečetit");
+    TEST_CHECK(
+        password_crypto_open(key, name, strlen(name), sealed, length, password) && strcmp(password, secret) == 0,
+        "otevřené heslo \"%s\"", password);
+    password_crypto_seal(key, name, strlen(name), secret, length, other);
+    TEST_CHECK(
+        memcmp(sealed, other, PASSWORD_CRYPTO_NONCE_SIZE) != 0 &&
+            memcmp(sealed, other, PASSWORD_CRYPTO_SEALED_SIZE(length)) != 0,
+        "dvě pečetě téhož hesla jsou stejné");
+    TEST_CHECK(
+        password_crypto_seal(key, name, strlen(name), "", 0, other) &&
+            password_crypto_open(key, name, strlen(name), other, 0, password) && password[0] == '\0',
+        "prázdné heslo");
+
+    // Změněný bajt v nonce, šifrovém textu nebo značce pečeť neotevře
+    const size_t flips[] = {
+        0,
+        PASSWORD_CRYPTO_NONCE_SIZE,
+        PASSWORD_CRYPTO_NONCE_SIZE + length - 1,
+        PASSWORD_CRYPTO_SEALED_SIZE(length) - PASSWORD_CRYPTO_TAG_SIZE,
+        PASSWORD_CRYPTO_SEALED_SIZE(length) - 1,
+    };
+    for(size_t i = 0; i < COUNT_OF(flips); i++) {
+        memcpy(other, sealed, PASSWORD_CRYPTO_SEALED_SIZE(length));
+        other[flips[i]] ^= 0x80;
+        TEST_CHECK(test_crypto_rejected(key, name, other, length), "prošla pečeť změněná na bajtu %zu", flips[i]);
+    }
+
+    // Pečeť patří k názvu a klíči: jiný název, useknutý název ani jiný klíč ji neotevřou
+    TEST_CHECK(test_crypto_rejected(key, "Banka", sealed, length), "pečeť se otevřela pod jiným názvem");
+    TEST_CHECK(test_crypto_rejected(key, "bank", sealed, length), "pečeť se otevřela pod useknutým názvem");
+    uint8_t wrong[PASSWORD_CRYPTO_KEY_SIZE];
+    memcpy(wrong, key, sizeof(wrong));
+    wrong[PASSWORD_CRYPTO_KEY_SIZE - 1] ^= 0x01;
+    TEST_CHECK(test_crypto_rejected(wrong, name, sealed, length), "pečeť se otevřela jiným klíčem");
+
+    printf("šifrování %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Model trezoru: heslo položky "polozka NNN" podle čísla, prázdné pro chybějící
+typedef struct {
+    char passwords[TEST_STORAGE_ENTRIES][PASSWORD_MAX_LENGTH];
+} TestStorageModel;
+
+static void test_storage_model_set(TestStorageModel* model, PasswordList* list, unsigned i, const char* password) {
+    char name[NAME_MAX_LENGTH];
+    snprintf(name, sizeof(name), "polozka %03u", i);
+    uint32_t index;
+    if(password[0] == '\0') {
+        if(password_list_find(list, name, &index)) password_list_remove(list, index);
+    } else if(password_list_find(list, name, &index)) {
+        password_list_update(list, index, name, password);
+    } else {
+        password_list_add(list, name, password);
+    }
+    strlcpy(model->passwords[i], password, sizeof(model->passwords[i]));
+}
+
+// Seznam obsahuje přesně položky modelu v pořadí názvů, i se správnými hesly
+static bool test_storage_equals(PasswordList* list, const TestStorageModel* model) {
+    uint32_t index = 0;
+    char name[NAME_MAX_LENGTH];
+    char password[PASSWORD_MAX_LENGTH];
+    for(unsigned i = 0; i < TEST_STORAGE_ENTRIES; i++) {
+        if(model->passwords[i][0] == '\0') continue;
+        snprintf(name, sizeof(name), "polozka %03u", i);
+        if(index >= list->count || strcmp(password_list_get_name(list, index), name) != 0 ||
+           !password_list_read_password(list, index, password, sizeof(password)) ||
+           strcmp(password, model->passwords[i]) != 0) {
+            return false;
+        }
+        index++;
+    }
+    return index == list->count;
+}
+
+// Zavře seznam (čekající změny se zapíšou) a otevře ho znovu ze souboru
+static bool test_storage_reopen(PasswordList* list, const uint8_t* key, const char* path, PasswordListMode mode) {
+    password_list_free(list);
+    password_list_init(list);
+    password_list_set_key(list, key);
+    return password_list_open(list, path, mode);
+}
+
+// Velikost souboru pod kořenem shimu, -1 pokud chybí
+static long test_file_size(const char* root, const char* name) {
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    struct stat info;
+    return stat(path, &info) == 0 ? (long)info.st_size : -1;
+}
+
+// Velikost živých záznamů modelu v poolu: "název\0" [délka hesla] [zapečetěné heslo]
+static size_t test_storage_model_bytes(const TestStorageModel* model) {
+    size_t size = 0;
+    for(unsigned i = 0; i < TEST_STORAGE_ENTRIES; i++) {
+        size_t length = strlen(model->passwords[i]);
+        if(length > 0) size += strlen("polozka 000") + 2 + PASSWORD_CRYPTO_SEALED_SIZE(length);
+    }
+    return size;
+}
+
+static void test_string_pool(void) {
+    unsigned failures = test_failures;
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    memset(key, 0x2D, sizeof(key));
+    static TestStorageModel model;
+    memset(&model, 0, sizeof(model));
+
+    // Tři krátká hesla zaberou jen svou délku
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    test_storage_model_set(&model, &list, 0, "a");
+    test_storage_model_set(&model, &list, 1, "bb");
+    test_storage_model_set(&model, &list, 2, "ccc");
+    TEST_CHECK(
+        list.pool_size == test_storage_model_bytes(&model) && list.pool_garbage == 0,
+        "3 hesla zabrala %zu B poolu", list.pool_size);
+
+    // Náhodné přidávání, úpravy a odebírání hesel různé délky až po nejdelší možné
+    srand(2);
+    char password[PASSWORD_MAX_LENGTH];
+    unsigned leaks = 0, uncollected = 0;
+    uint32_t most = 0;
+    for(unsigned step = 0; step < 3000; step++) {
+        size_t length = (size_t)rand() % PASSWORD_MAX_LENGTH;
+        memset(password, 'a' + step % 26, length);
+        password[length] = '\0';
+        test_storage_model_set(&model, &list, (unsigned)rand() % TEST_STORAGE_ENTRIES, password);
+        if(list.pool_size - list.pool_garbage != test_storage_model_bytes(&model)) leaks++;
+        if(list.pool_garbage >= TEST_POOL_COMPACT_MIN_GARBAGE && list.pool_garbage * 2 >= list.pool_size) {
+            uncollected++;
+        }
+        most = MAX(most, list.count);
+    }
+    TEST_CHECK(leaks == 0, "živé záznamy %u× nezabíraly přesně svou délku", leaks);
+    TEST_CHECK(uncollected == 0, "místo po odebraných se %u× neuvolnilo", uncollected);
+    TEST_CHECK(most > 50 && test_storage_equals(&list, &model), "po změnách %u hesel, nejvýš %u", list.count, most);
+
+    // Uložený a znovu otevřený seznam: stejný obsah, pool bez mezer
+    TEST_CHECK(password_list_save(&list, "/ext/pool.pwv"), "seznam nejde uložit");
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/pool.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    TEST_CHECK(
+        test_storage_equals(&list, &model) && list.pool_garbage == 0 &&
+            list.pool_size == test_storage_model_bytes(&model),
+        "po otevření %u hesel, %zu B poolu", list.count, list.pool_size);
+    password_list_free(&list);
+
+    static const char* const files[] = {"pool.pwv", "pool.pwv.jnl", "passwords"};
+    for(size_t i = 0; i < COUNT_OF(files); i++) {
+        char path[TEST_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+        remove(path);
+    }
+    rmdir(root);
+
+    printf("pool řetězců %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+static void test_paged_window(void) {
+    unsigned failures = test_failures;
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    memset(key, 0x3E, sizeof(key));
+    static TestStorageModel model;
+    memset(&model, 0, sizeof(model));
+
+    // Trezor nad 16 KiB otevře automatický režim stránkovaný, malý celý
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    test_storage_model_set(&model, &list, 0, "maly");
+    TEST_CHECK(password_list_save(&list, "/ext/maly.pwv"), "malý trezor nejde uložit");
+    char password[PASSWORD_MAX_LENGTH];
+    for(unsigned i = 0; i < TEST_STORAGE_ENTRIES; i++) {
+        snprintf(password, sizeof(password), "heslo-%03u-0123456789abcdefghijklmnopqrstuvwxyz", i);
+        test_storage_model_set(&model, &list, i, password);
+    }
+    TEST_CHECK(password_list_save(&list, "/ext/velky.pwv"), "velký trezor nejde uložit");
+    TEST_CHECK(test_file_size(root, "velky.pwv") > 16 * 1024, "velký trezor má jen %ld B", test_file_size(root, "velky.pwv"));
+    TEST_CHECK(
+        test_storage_reopen(&list, key, "/ext/maly.pwv", PasswordListModeAuto) && !password_list_is_paged(&list),
+        "malý trezor se otevřel stránkovaný");
+    TEST_CHECK(
+        test_storage_reopen(&list, key, "/ext/velky.pwv", PasswordListModeAuto) && password_list_is_paged(&list),
+        "velký trezor se neotevřel stránkovaný");
+
+    // Průchod i náhodný přístup: okno drží nejvýš 16 názvů, hesla se čtou ze souboru
+    TEST_CHECK(test_storage_equals(&list, &model), "stránkovaný průchod nesouhlasí");
+    srand(3);
+    unsigned mismatches = 0, oversized = 0;
+    char name[NAME_MAX_LENGTH];
+    for(unsigned step = 0; step < 500; step++) {
+        uint32_t index = (uint32_t)rand() % list.count;
+        snprintf(name, sizeof(name), "polozka %03u", index);
+        if(strcmp(password_list_get_name(&list, index), name) != 0 ||
+           !password_list_read_password(&list, index, password, sizeof(password)) ||
+           strcmp(password, model.passwords[index]) != 0) {
+            mismatches++;
+        }
+        if(list.window_count > TEST_LIST_WINDOW_SIZE || list.capacity > TEST_LIST_WINDOW_SIZE) oversized++;
+    }
+    TEST_CHECK(mismatches == 0, "náhodný přístup se %u× lišil", mismatches);
+    TEST_CHECK(oversized == 0, "okno %u× přerostlo %u názvů", oversized, TEST_LIST_WINDOW_SIZE);
+    TEST_CHECK(
+        list.pool_capacity < (size_t)TEST_LIST_WINDOW_SIZE * (NAME_MAX_LENGTH + PASSWORD_MAX_LENGTH),
+        "okno zabírá %zu B", list.pool_capacity);
+
+    // Seznam na displeji si názvy zkopíruje, kreslení po posunu okna jinam nic nenačítá
+    PasswordListView view;
+    password_list_view_reset(&view);
+    password_list_view_update(&view, &list, (PasswordListRange){0, list.count}, list.count - 1);
+    password_list_get_name(&list, 0);
+    password_canvas_mock_reset();
+    password_list_view_draw(&view, password_canvas_mock(), 22);
+    snprintf(name, sizeof(name), "polozka %03u", list.count - 1);
+    TEST_CHECK(
+        strcmp(password_canvas_mock_string(4), name) == 0,
+        "stránkovaný seznam kreslí \"%s\"", password_canvas_mock_string(4));
+
+    // Změny ve stránkovaném režimu platí po otevření v obou režimech
+    for(unsigned step = 0; step < 40; step++) {
+        unsigned i = (unsigned)rand() % TEST_STORAGE_ENTRIES;
+        test_storage_model_set(&model, &list, i, step % 4 == 0 ? "" : step % 2 ? "upraveno" : "znovu");
+    }
+    TEST_CHECK(test_storage_equals(&list, &model), "po změnách %u hesel", list.count);
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/velky.pwv", PasswordListModePaged), "trezor nejde otevřít");
+    TEST_CHECK(test_storage_equals(&list, &model), "stránkovaně po otevření %u hesel", list.count);
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/velky.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    TEST_CHECK(
+        !password_list_is_paged(&list) && test_storage_equals(&list, &model), "celý po otevření %u hesel", list.count);
+    password_list_free(&list);
+
+    static const char* const files[] = {"maly.pwv", "velky.pwv", "velky.pwv.jnl", "passwords"};
+    for(size_t i = 0; i < COUNT_OF(files); i++) {
+        char path[TEST_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+        remove(path);
+    }
+    rmdir(root);
+
+    printf("stránkovaný režim %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Pořadí názvů v seznamu: bez ohledu na velikost písmen ASCII, při shodě přesně
+static int test_name_order(const char* a, const char* b) {
+    for(size_t i = 0;; i++) {
+        int ca = a[i] >= 'A' && a[i] <= 'Z' ? a[i] + ('a' - 'A') : (unsigned char)a[i];
+        int cb = b[i] >= 'A' && b[i] <= 'Z' ? b[i] + ('a' - 'A') : (unsigned char)b[i];
+        if(ca != cb) return ca - cb;
+        if(ca == 0) break;
+    }
+    return strcmp(a, b);
+}
+
+// Náhodný krátký název z malé abecedy: hodně společných prefixů a shod až na velikost písmen
+static void test_sorted_name(char* name) {
+    static const char alphabet[] = "abAB1_";
+    size_t length = 1 + (size_t)rand() % 5;
+    for(size_t i = 0; i < length; i++) name[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+    name[length] = '\0';
+}
+
+// Počet chyb řazení a filtru: prefixy náhodných názvů se zužují po znacích a porovnají s průchodem
+static unsigned test_sorted_errors(PasswordList* list) {
+    unsigned errors = 0;
+    char previous[NAME_MAX_LENGTH] = "";
+    for(uint32_t i = 0; i < list->count; i++) {
+        const char* name = password_list_get_name(list, i);
+        if(i > 0 && test_name_order(previous, name) > 0) errors++;
+        strlcpy(previous, name, sizeof(previous));
+    }
+
+    char name[NAME_MAX_LENGTH];
+    char prefix[NAME_MAX_LENGTH];
+    for(unsigned probe = 0; probe < 8; probe++) {
+        test_sorted_name(name);
+        PasswordListRange range = {0, list->count};
+        for(size_t length = 1; length <= strlen(name); length++) {
+            strlcpy(prefix, name, length + 1);
+            password_list_filter(list, prefix, &range);
+            uint32_t matches = 0, first = list->count;
+            for(uint32_t i = 0; i < list->count; i++) {
+                char start[NAME_MAX_LENGTH];
+                strlcpy(start, password_list_get_name(list, i), length + 1);
+                if(strcasecmp(start, prefix) == 0) {
+                    if(matches++ == 0) first = i;
+                }
+            }
+            if(matches == 0 ? range.start != range.end :
+                              range.start != first || range.end - range.start != matches) {
+                errors++;
+            }
+        }
+    }
+    return errors;
+}
+
+static void test_sorted_filter(void) {
+    unsigned failures = test_failures;
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    memset(key, 0x1F, sizeof(key));
+
+    // Náhodné přidávání, put, úpravy a odebírání; po každé změně seřazený seznam a přesný filtr
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    srand(4);
+    char name[NAME_MAX_LENGTH];
+    unsigned errors = 0;
+    for(unsigned step = 0; step < 1500; step++) {
+        test_sorted_name(name);
+        unsigned op = (unsigned)rand() % 5;
+        uint32_t index = list.count ? (uint32_t)rand() % list.count : 0;
+        if(op == 0 || list.count == 0) {
+            password_list_add(&list, name, "x");
+        } else if(op == 1) {
+            password_list_put(&list, name, "p", rand() % 2);
+        } else if(op == 2) {
+            password_list_update(&list, index, name, "u");
+        } else if(op == 3 && list.count > 60) {
+            password_list_remove(&list, index);
+        }
+        if(step % 10 == 0) errors += test_sorted_errors(&list);
+    }
+    TEST_CHECK(errors == 0 && list.count > 60, "řazení nebo filtr %u× chybně, %u hesel", errors, list.count);
+    TEST_CHECK(
+        test_sorted_errors(&list) == 0 && password_list_save(&list, "/ext/serazeny.pwv"), "seznam nejde uložit");
+    uint32_t count = list.count;
+
+    // Po otevření ze souboru v obou režimech totéž, filtr ve stránkovaném čte názvy ze souboru
+    static const PasswordListMode modes[] = {PasswordListModeFull, PasswordListModePaged};
+    for(size_t i = 0; i < COUNT_OF(modes); i++) {
+        TEST_CHECK(test_storage_reopen(&list, key, "/ext/serazeny.pwv", modes[i]), "trezor nejde otevřít");
+        TEST_CHECK(
+            list.count == count && test_sorted_errors(&list) == 0, "režim %zu: %u hesel", i, list.count);
+        for(unsigned step = 0; step < 20; step++) {
+            test_sorted_name(name);
+            password_list_put(&list, name, "z", false);
+        }
+        TEST_CHECK(test_sorted_errors(&list) == 0, "režim %zu: po změnách chybně", i);
+        count = list.count;
+    }
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/serazeny.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    TEST_CHECK(list.count == count && test_sorted_errors(&list) == 0, "po změnách ze souboru chybně");
+    PasswordListRange range = {0, list.count};
+    password_list_filter(&list, "zz", &range);
+    TEST_CHECK(range.start == range.end, "neexistující prefix našel %u hesel", range.end - range.start);
+    password_list_free(&list);
+
+    static const char* const files[] = {"serazeny.pwv", "serazeny.pwv.jnl", "passwords"};
+    for(size_t i = 0; i < COUNT_OF(files); i++) {
+        char path[TEST_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+        remove(path);
+    }
+    rmdir(root);
+
+    printf("seřazený seznam %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Název z kousků, na kterých záleží skóre: oddělovače, velká písmena, číslice
+static void test_search_name(char* name) {
+    static const char* const words[] = {
+        "github", "GitLab", "mail", "bank", "work", "home", "digit", "WiFi", "gothub", "x", "b2b", "AmaZon"};
+    static const char* const separators[] = {"", "-", "_", " ", "."};
+    size_t parts = 1 + (size_t)rand() % 3;
+    name[0] = '\0';
+    for(size_t i = 0; i < parts; i++) {
+        size_t length = strlen(name);
+        const char* separator = i > 0 ? separators[rand() % COUNT_OF(separators)] : "";
+        snprintf(name + length, NAME_MAX_LENGTH - length, "%s%s", separator, words[rand() % COUNT_OF(words)]);
+    }
+}
+
+// Nejlepší výsledky průchodem všemi názvy bez masek, seřazené jako v password_list_search
+static uint32_t test_search_scan(
+    PasswordList* list,
+    const char* pattern,
+    PasswordSearchResult* results,
+    uint32_t max_results) {
+    uint32_t found = 0;
+    for(uint32_t index = 0; index < list->count; index++) {
+        int16_t score;
+        if(!password_search_match(password_list_get_name(list, index), pattern, &score)) continue;
+        uint32_t i = found < max_results ? found++ : max_results;
+        while(i > 0 && results[i - 1].score < score) {
+            if(i < max_results) results[i] = results[i - 1];
+            i--;
+        }
+        if(i < max_results) results[i] = (PasswordSearchResult){index, score};
+    }
+    return found;
+}
+
+// Shodné výsledky (porovnávají se položky, struktura má výplň)
+static bool test_search_equal(const PasswordSearchResult* a, const PasswordSearchResult* b, uint32_t count) {
+    for(uint32_t i = 0; i < count; i++) {
+        if(a[i].index != b[i].index || a[i].score != b[i].score) return false;
+    }
+    return true;
+}
+
+// Počet vzorů, pro které se password_list_search liší od průchodu
+static unsigned test_search_errors(PasswordList* list) {
+    static const char* const patterns[] = {"g", "gh", "gthb", "GL", "wk", "mail", "b2", "wifi", "hm", "zz", "x-x", ""};
+    unsigned errors = 0;
+    for(size_t i = 0; i < COUNT_OF(patterns); i++) {
+        PasswordSearchResult expected[TEST_SEARCH_RESULTS], actual[TEST_SEARCH_RESULTS];
+        uint32_t count = test_search_scan(list, patterns[i], expected, TEST_SEARCH_RESULTS);
+        if(password_list_search(list, patterns[i], actual, TEST_SEARCH_RESULTS) != count ||
+           !test_search_equal(expected, actual, count)) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+static void test_search(void) {
+    unsigned failures = test_failures;
+    int16_t score, other;
+
+    // Shoda: znaky vzoru ve stejném pořadí bez ohledu na velikost písmen
+    TEST_CHECK(password_search_match("github-work", "gthb", &score), "\"gthb\" nenašlo github-work");
+    TEST_CHECK(password_search_match("github-work", "GW", &score), "velikost písmen vadí");
+    TEST_CHECK(!password_search_match("github-work", "bhtg", &score), "obrácené pořadí našlo");
+    TEST_CHECK(!password_search_match("mail", "mails", &score), "delší vzor našel");
+    TEST_CHECK(password_search_match("mail", "", &score) && score == 0, "prázdný vzor");
+
+    // Pořadí skóre: za sebou, začátek slova, camelCase, kratší mezera, číslice za písmenem
+    static const struct {
+        const char* pattern;
+        const char* better;
+        const char* worse;
+    } orders[] = {
+        {"abc", "abcxx", "axbxc"},
+        {"git", "git-lab", "digit"},
+        {"gh", "GitHub", "gothub"},
+        {"wk", "my-work", "my-awkward"},
+        {"gl", "git-lab", "gitxlab"},
+        {"ml", "mail", "maxxxil"},
+    };
+    for(size_t i = 0; i < COUNT_OF(orders); i++) {
+        TEST_CHECK(
+            password_search_match(orders[i].better, orders[i].pattern, &score) &&
+                password_search_match(orders[i].worse, orders[i].pattern, &other) && score > other,
+            "\"%s\": %s (%d) není lepší než %s (%d)",
+            orders[i].pattern,
+            orders[i].better,
+            score,
+            orders[i].worse,
+            other);
+    }
+
+    // Ze všech umístění vzoru se vybere nejlepší, ne první
+    password_search_match("wx-work", "wk", &score);
+    password_search_match("work", "wk", &other);
+    TEST_CHECK(score == other, "nejlepší umístění: %d místo %d", score, other);
+
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    memset(key, 0x2C, sizeof(key));
+
+    // Hledání v seznamu: přesně nejlepší výsledky průchodu, masky nic správného nezahodí
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    srand(5);
+    char name[NAME_MAX_LENGTH];
+    for(unsigned i = 0; i < 600; i++) {
+        test_search_name(name);
+        password_list_put(&list, name, "x", false);
+    }
+    TEST_CHECK(test_search_errors(&list) == 0, "plný režim: hledání se liší od průchodu");
+    PasswordSearchResult results[TEST_SEARCH_RESULTS];
+    uint32_t count = password_list_search(&list, "gthb", results, TEST_SEARCH_RESULTS);
+    TEST_CHECK(
+        count == TEST_SEARCH_RESULTS && results[0].score >= results[count - 1].score &&
+            password_search_match(password_list_get_name(&list, results[0].index), "gthb", &score),
+        "\"gthb\": %u výsledků", count);
+    TEST_CHECK(password_list_save(&list, "/ext/hledani.pwv"), "seznam nejde uložit");
+
+    // Po otevření v obou režimech totéž, stránkovaný čte masky ze souboru a změny ze žurnálu
+    static const PasswordListMode modes[] = {PasswordListModeFull, PasswordListModePaged};
+    for(size_t i = 0; i < COUNT_OF(modes); i++) {
+        TEST_CHECK(test_storage_reopen(&list, key, "/ext/hledani.pwv", modes[i]), "trezor nejde otevřít");
+        TEST_CHECK(test_search_errors(&list) == 0, "režim %zu: hledání se liší od průchodu", i);
+        for(unsigned step = 0; step < 20; step++) {
+            test_search_name(name);
+            password_list_put(&list, name, "z", false);
+        }
+        TEST_CHECK(test_search_errors(&list) == 0, "režim %zu: po změnách se hledání liší", i);
+    }
+    PasswordSearchResult paged[TEST_SEARCH_RESULTS];
+    uint32_t paged_count = password_list_search(&list, "wk", paged, TEST_SEARCH_RESULTS);
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/hledani.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    TEST_CHECK(
+        password_list_search(&list, "wk", results, TEST_SEARCH_RESULTS) == paged_count &&
+            test_search_equal(results, paged, paged_count),
+        "plný a stránkovaný režim našly jiné výsledky");
+    password_list_free(&list);
+
+    static const char* const files[] = {"hledani.pwv", "hledani.pwv.jnl", "passwords"};
+    for(size_t i = 0; i < COUNT_OF(files); i++) {
+        char path[TEST_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+        remove(path);
+    }
+    rmdir(root);
+
+    printf("fuzzy hledání %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+static void test_journal(void) {
+    unsigned failures = test_failures;
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    memset(key, 0x4A, sizeof(key));
+    static TestStorageModel model;
+    memset(&model, 0, sizeof(model));
+
+    // Změny nového trezoru jsou jen v žurnálu a po otevření se přehrají
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    TEST_CHECK(password_list_open(&list, "/ext/jnl.pwv", PasswordListModeFull), "nový trezor nejde otevřít");
+    test_storage_model_set(&model, &list, 2, "c");
+    test_storage_model_set(&model, &list, 0, "a");
+    test_storage_model_set(&model, &list, 1, "b");
+    test_storage_model_set(&model, &list, 2, "c2");
+    test_storage_model_set(&model, &list, 1, "");
+    TEST_CHECK(password_list_flush(&list) && !password_list_is_dirty(&list), "žurnál se nezapsal");
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/jnl.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    TEST_CHECK(
+        list.count == 2 && test_storage_equals(&list, &model), "po přehrání %u hesel místo 2", list.count);
+    password_list_free(&list);
+    long journal = test_file_size(root, "jnl.pwv.jnl");
+    TEST_CHECK(journal > 0 && test_file_size(root, "jnl.pwv") < 0, "změny nejsou jen v žurnálu");
+
+    // Nedopsaný poslední záznam se zahodí, předchozí platí
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    password_list_open(&list, "/ext/jnl.pwv", PasswordListModeFull);
+    test_storage_model_set(&model, &list, 3, "d");
+    password_list_free(&list);
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/jnl.pwv.jnl", root);
+    TEST_CHECK(
+        test_file_size(root, "jnl.pwv.jnl") > journal + 5 && truncate(path, journal + 5) == 0,
+        "žurnál nejde zkrátit");
+    model.passwords[3][0] = '\0';
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    TEST_CHECK(password_list_open(&list, "/ext/jnl.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    TEST_CHECK(
+        list.count == 2 && test_storage_equals(&list, &model), "po nedopsaném záznamu %u hesel", list.count);
+
+    // Poškozený poslední záznam (CRC nesedí) se zahodí také, ostatní zůstanou
+    test_storage_model_set(&model, &list, 4, "e");
+    test_storage_model_set(&model, &list, 5, "f");
+    password_list_free(&list);
+    FILE* file = fopen(path, "r+b");
+    TEST_CHECK(file != NULL && fseek(file, -1, SEEK_END) == 0, "žurnál chybí");
+    int last = fgetc(file);
+    fseek(file, -1, SEEK_END);
+    fputc(last ^ 0x55, file);
+    fclose(file);
+    model.passwords[5][0] = '\0';
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    TEST_CHECK(password_list_open(&list, "/ext/jnl.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    TEST_CHECK(
+        list.count == 3 && test_storage_equals(&list, &model), "po poškozeném záznamu %u hesel", list.count);
+
+    // Poškozený konec se sloučil, další otevření dá totéž
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/jnl.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    TEST_CHECK(list.count == 3 && test_storage_equals(&list, &model), "po sloučení %u hesel", list.count);
+
+    // Velký trezor: 63 změn zůstane v žurnálu, 64. ho sloučí
+    for(unsigned i = 0; i < TEST_STORAGE_ENTRIES; i++) test_storage_model_set(&model, &list, i, "zaklad");
+    TEST_CHECK(password_list_save(&list, "/ext/velky.pwv"), "velký trezor nejde uložit");
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/velky.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    for(unsigned i = 0; i < TEST_JOURNAL_RECORDS - 1; i++) {
+        test_storage_model_set(&model, &list, (i * 7) % TEST_STORAGE_ENTRIES, i % 3 == 0 ? "" : "zmena");
+        password_list_flush(&list);
+    }
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/velky.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    TEST_CHECK(
+        test_file_size(root, "velky.pwv.jnl") > 0 && test_storage_equals(&list, &model),
+        "před sloučením: %u hesel", list.count);
+    long base = test_file_size(root, "velky.pwv");
+    test_storage_model_set(&model, &list, 1, "posledni");
+    TEST_CHECK(
+        test_file_size(root, "velky.pwv.jnl") < 0 && test_file_size(root, "velky.pwv") != base,
+        "64. záznam žurnál nesloučil");
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/velky.pwv", PasswordListModeFull), "trezor nejde otevřít");
+    TEST_CHECK(test_storage_equals(&list, &model), "po sloučení: %u hesel", list.count);
+    password_list_free(&list);
+
+    static const char* const files[] = {"jnl.pwv", "jnl.pwv.jnl", "velky.pwv", "velky.pwv.jnl", "passwords"};
+    for(size_t i = 0; i < COUNT_OF(files); i++) {
+        snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+        remove(path);
+    }
+    rmdir(root);
+
+    printf("žurnál %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Zapíše trezor s položkami 0 až count - 1 a daným heslem, mimo model
+static bool test_storage_write(const uint8_t* key, const char* path, unsigned count, const char* password) {
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    TestStorageModel* model = malloc(sizeof(TestStorageModel));
+    for(unsigned i = 0; i < count; i++) test_storage_model_set(model, &list, i, password);
+    free(model);
+    bool success = password_list_save(&list, path);
+    password_list_free(&list);
+    return success;
+}
+
+// Otevře trezor a porovná ho s modelem položek 0 až count - 1 s daným heslem
+static bool test_storage_check(const uint8_t* key, const char* path, unsigned count, const char* password) {
+    TestStorageModel* model = malloc(sizeof(TestStorageModel));
+    memset(model, 0, sizeof(TestStorageModel));
+    for(unsigned i = 0; i < count; i++) strlcpy(model->passwords[i], password, sizeof(model->passwords[i]));
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    bool equal = password_list_open(&list, path, PasswordListModeFull) && test_storage_equals(&list, model);
+    password_list_free(&list);
+    free(model);
+    return equal;
+}
+
+static void test_recovery(void) {
+    unsigned failures = test_failures;
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    memset(key, 0x6B, sizeof(key));
+    char path[TEST_PATH_MAX];
+    char other[TEST_PATH_MAX];
+
+    // Nedopsaný .tmp se zahodí, platí původní generace
+    TEST_CHECK(test_storage_write(key, "/ext/obnova.pwv", 5, "prvni"), "trezor nejde uložit");
+    snprintf(path, sizeof(path), "%s/obnova.pwv.tmp", root);
+    FILE* file = fopen(path, "w");
+    fprintf(file, "PWVT nedopsaná druhá generace");
+    fclose(file);
+    TEST_CHECK(test_storage_check(key, "/ext/obnova.pwv", 5, "prvni"), ".tmp přepsal původní trezor");
+    TEST_CHECK(access(path, F_OK) != 0, ".tmp zůstal");
+
+    // Úplný .new vedle původního vyhraje, žurnál původní generace se zahodí
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    password_list_open(&list, "/ext/obnova.pwv", PasswordListModeFull);
+    password_list_add(&list, "polozka 999", "zurnal");
+    password_list_free(&list);
+    TEST_CHECK(test_storage_write(key, "/ext/druha.pwv", 8, "druhe"), "trezor nejde uložit");
+    snprintf(path, sizeof(path), "%s/druha.pwv", root);
+    snprintf(other, sizeof(other), "%s/obnova.pwv.new", root);
+    TEST_CHECK(rename(path, other) == 0, "nelze připravit .new");
+    TEST_CHECK(test_storage_check(key, "/ext/obnova.pwv", 8, "druhe"), ".new vedle původního nevyhrál");
+    snprintf(path, sizeof(path), "%s/obnova.pwv.jnl", root);
+    TEST_CHECK(access(other, F_OK) != 0 && access(path, F_OK) != 0, ".new nebo starý žurnál zůstal");
+
+    // Úplný .new bez původního (výpadek mezi smazáním a přejmenováním) platí také
+    TEST_CHECK(test_storage_write(key, "/ext/druha.pwv", 3, "treti"), "trezor nejde uložit");
+    snprintf(path, sizeof(path), "%s/druha.pwv", root);
+    TEST_CHECK(rename(path, other) == 0, "nelze připravit .new");
+    snprintf(path, sizeof(path), "%s/obnova.pwv", root);
+    TEST_CHECK(remove(path) == 0, "nelze smazat původní trezor");
+    TEST_CHECK(test_storage_check(key, "/ext/obnova.pwv", 3, "treti"), ".new bez původního nevyhrál");
+    TEST_CHECK(access(other, F_OK) != 0 && access(path, F_OK) == 0, ".new se nepřejmenoval");
+
+    static const char* const files[] = {"obnova.pwv", "obnova.pwv.jnl", "passwords"};
+    for(size_t i = 0; i < COUNT_OF(files); i++) {
+        snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+        remove(path);
+    }
+    rmdir(root);
+
+    printf("obnova po výpadku %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Zapíše soubor pod kořen shimu
+static void test_file_write(const char* root, const char* name, const void* data, size_t size) {
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", root, name);
+    FILE* file = fopen(path, "wb");
+    fwrite(data, 1, size, file);
+    fclose(file);
+}
+
+// Poškozený trezor se neotevře v žádném režimu a seznam zůstane prázdný
+static bool test_vault_rejected(const uint8_t* key, const char* path) {
+    static const PasswordListMode modes[] = {PasswordListModeFull, PasswordListModePaged};
+    PasswordVaultPreview preview;
+    bool rejected = !password_vault_preview(path, &preview);
+    for(size_t i = 0; i < COUNT_OF(modes); i++) {
+        PasswordList list;
+        password_list_init(&list);
+        password_list_set_key(&list, key);
+        rejected = rejected && !password_list_open(&list, path, modes[i]) && list.count == 0;
+        password_list_free(&list);
+    }
+    return rejected;
+}
+
+static void test_vault_format(void) {
+    unsigned failures = test_failures;
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    memset(key, 0x7C, sizeof(key));
+
+    // Převod textového trezoru: neplatný řádek se přeskočí, dvojtečka v hesle zůstane
+    static const char text[] = "polozka 002:c:3\nneplatny radek\npolozka 000:a\npolozka 001:b\n";
+    test_file_write(root, "prevod.txt", text, strlen(text));
+    static TestStorageModel model;
+    memset(&model, 0, sizeof(model));
+    strcpy(model.passwords[0], "a");
+    strcpy(model.passwords[1], "b");
+    strcpy(model.passwords[2], "c:3");
+    TEST_CHECK(password_vault_convert("/ext/prevod.txt", "/ext/prevod.pwv", key), "převod selhal");
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    TEST_CHECK(
+        password_list_open(&list, "/ext/prevod.pwv", PasswordListModeFull) && test_storage_equals(&list, &model),
+        "převedeno %u hesel", list.count);
+    test_storage_model_set(&model, &list, 3, "d");
+    TEST_CHECK(test_storage_reopen(&list, key, "/ext/prevod.pwv", PasswordListModePaged), "trezor nejde otevřít");
+    TEST_CHECK(test_storage_equals(&list, &model), "po změně převedeného %u hesel", list.count);
+    password_list_free(&list);
+
+    // Migrace při načtení: textový trezor zůstane jako záloha, další načtení čte binární
+    test_file_write(root, "migrace.txt", text, strlen(text));
+    model.passwords[3][0] = '\0';
+    for(unsigned attempt = 0; attempt < 2; attempt++) {
+        password_list_init(&list);
+        password_list_set_key(&list, key);
+        TEST_CHECK(
+            password_list_load(&list, "/ext/migrace.pwv") && test_storage_equals(&list, &model),
+            "migrace %u: %u hesel", attempt, list.count);
+        password_list_free(&list);
+    }
+    TEST_CHECK(
+        test_file_size(root, "migrace.txt") < 0 && test_file_size(root, "migrace.txt.bak") == (long)strlen(text),
+        "textový trezor nezůstal jako záloha");
+
+    // Špatný magic, verze a useknutá tabulka platného trezoru se odmítnou
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/prevod.pwv", root);
+    FILE* file = fopen(path, "rb");
+    static uint8_t vault[4096];
+    size_t size = fread(vault, 1, sizeof(vault), file);
+    fclose(file);
+    TEST_CHECK(size > sizeof(PasswordVaultHeader) + 8 && size < sizeof(vault), "trezor má %zu B", size);
+    PasswordVaultHeader header;
+    memcpy(&header, vault, sizeof(header));
+    TEST_CHECK(header.magic == PASSWORD_VAULT_MAGIC && header.version == PASSWORD_VAULT_VERSION, "neznámá hlavička");
+    test_file_write(root, "kopie.pwv", vault, size);
+    TEST_CHECK(!test_vault_rejected(key, "/ext/kopie.pwv"), "kopie platného trezoru se odmítla");
+
+    static const struct {
+        const char* name;
+        size_t offset;
+        uint32_t value;
+        size_t size;
+    } corruptions[] = {
+        {"magic", offsetof(PasswordVaultHeader, magic), 0x54565751, 0},
+        {"verze 0", offsetof(PasswordVaultHeader, version), 0, 0},
+        {"vyšší verze", offsetof(PasswordVaultHeader, version), PASSWORD_VAULT_VERSION + 1, 0},
+        {"počet", offsetof(PasswordVaultHeader, count), 1000, 0},
+        {"useknutá tabulka", 0, 0, sizeof(PasswordVaultHeader) + 6},
+        {"jen hlavička", 0, 0, sizeof(PasswordVaultHeader) - 1},
+    };
+    for(size_t i = 0; i < COUNT_OF(corruptions); i++) {
+        static uint8_t broken[sizeof(vault)];
+        memcpy(broken, vault, size);
+        if(corruptions[i].size == 0) {
+            memcpy(broken + corruptions[i].offset, &corruptions[i].value, sizeof(uint32_t));
+        }
+        test_file_write(root, "poskozeny.pwv", broken, corruptions[i].size ? corruptions[i].size : size);
+        TEST_CHECK(test_vault_rejected(key, "/ext/poskozeny.pwv"), "%s: trezor se otevřel", corruptions[i].name);
+        TEST_CHECK(
+            test_file_size(root, "poskozeny.pwv") == (long)(corruptions[i].size ? corruptions[i].size : size),
+            "%s: odmítnutý trezor se změnil", corruptions[i].name);
+    }
+
+    static const char* const files[] = {
+        "prevod.txt", "prevod.pwv", "prevod.pwv.jnl", "migrace.txt.bak", "migrace.pwv", "kopie.pwv",
+        "poskozeny.pwv", "passwords"};
+    for(size_t i = 0; i < COUNT_OF(files); i++) {
+        snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+        remove(path);
+    }
+    rmdir(root);
+
+    printf("formát trezoru %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+static void test_kdf(void) {
+    unsigned failures = test_failures;
+    uint8_t digest[PASSWORD_KDF_HASH_SIZE];
+    uint8_t expected[PASSWORD_KDF_HASH_SIZE];
+
+    // FIPS 180-2: jeden blok, prázdný vstup a zpráva přes dva bloky
+    static const struct {
+        const char* message;
+        const char* digest;
+    } hashes[] = {
+        {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+        {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+         "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+    };
+    for(size_t i = 0; i < COUNT_OF(hashes); i++) {
+        PasswordSha256 sha;
+        password_sha256_init(&sha);
+        password_sha256_update(&sha, hashes[i].message, strlen(hashes[i].message));
+        password_sha256_finish(&sha, digest);
+        test_hex(hashes[i].digest, expected);
+        TEST_CHECK(memcmp(digest, expected, sizeof(digest)) == 0, "SHA-256 \"%s\" nesouhlasí", hashes[i].message);
+    }
+
+    // RFC 4231, případ 2
+    static const char hmac_data[] = "what do ya want for nothing?";
+    password_hmac_sha256((const uint8_t*)"Jefe", 4, hmac_data, strlen(hmac_data), digest);
+    test_hex("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843", expected);
+    TEST_CHECK(memcmp(digest, expected, sizeof(digest)) == 0, "HMAC-SHA256 nesouhlasí");
+
+    // PBKDF2-HMAC-SHA256, první blok výstupu (RFC 7914, kap. 11, a vektory "password"/"salt")
+    static const struct {
+        const char* pin;
+        const char* salt;
+        uint32_t iterations;
+        const char* key;
+    } vectors[] = {
+        {"passwd", "salt", 1, "55ac046e56e3089fec1691c22544b605f94185216dde0465e68b9d57c20dacbc"},
+        {"password", "salt", 1, "120fb6cffcf8b32c43e7225256c4f837a86548c92ccc35480805987cb70be17b"},
+        {"password", "salt", 2, "ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43"},
+        {"password", "salt", 4096, "c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a"},
+    };
+    for(size_t i = 0; i < COUNT_OF(vectors); i++) {
+        password_kdf_derive(
+            vectors[i].pin,
+            strlen(vectors[i].pin),
+            (const uint8_t*)vectors[i].salt,
+            strlen(vectors[i].salt),
+            vectors[i].iterations,
+            digest);
+        test_hex(vectors[i].key, expected);
+        TEST_CHECK(
+            memcmp(digest, expected, sizeof(digest)) == 0,
+            "PBKDF2 \"%s\" po %u iteracích nesouhlasí",
+            vectors[i].pin,
+            (unsigned)vectors[i].iterations);
+    }
+
+    printf("odvození klíče %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+// Otevře trezor klíčem a zjistí, zda jde přečíst první heslo (jako obnova zámku v aplikaci)
+static bool test_lock_opens(PasswordList* list, const uint8_t* key, const char* path) {
+    char password[PASSWORD_MAX_LENGTH];
+    bool opens = test_storage_reopen(list, key, path, PasswordListModeFull) && list->count > 0 &&
+                 password_list_read_password(list, 0, password, sizeof(password));
+    password_crypto_wipe(password, sizeof(password));
+    return opens;
+}
+
+static void test_lock(void) {
+    unsigned failures = test_failures;
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    static const char lock[] = "/ext/passwords.pwk";
+    static const char vault[] = "/ext/passwords.pwv";
+
+    // Trezor před založením PINu je zašifrovaný klíčem zařízení
+    uint8_t device_key[PASSWORD_CRYPTO_KEY_SIZE];
+    TEST_CHECK(password_crypto_device_key(device_key), "klíč zařízení nejde odvodit");
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, device_key);
+    password_list_add(&list, "banka", "tajne");
+    TEST_CHECK(password_list_save(&list, vault), "trezor nejde uložit");
+    TEST_CHECK(!password_lock_exists(lock) && !password_lock_pending(lock), "zámek existuje před založením");
+
+    // Výpadek po zapsání "<cesta>.new", než se trezor přešifroval: nedokončený zámek se zahodí
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    TEST_CHECK(
+        password_lock_create(lock, "1234", key) && password_lock_pending(lock) && !password_lock_exists(lock),
+        "zámek se nezaložil jako nedokončený");
+    password_lock_recover(lock, !test_lock_opens(&list, device_key, vault));
+    TEST_CHECK(
+        !password_lock_pending(lock) && !password_lock_exists(lock), "nedokončený zámek nepřešifrovaného trezoru zůstal");
+
+    // Výpadek po přešifrování, před přejmenováním: nedokončený zámek platí
+    TEST_CHECK(password_lock_create(lock, "1234", key), "zámek nejde založit");
+    TEST_CHECK(
+        test_lock_opens(&list, device_key, vault) && password_list_rekey(&list, key), "trezor nejde přešifrovat");
+    password_lock_recover(lock, !test_lock_opens(&list, device_key, vault));
+    TEST_CHECK(password_lock_exists(lock) && !password_lock_pending(lock), "nedokončený zámek se nedokončil");
+    password_lock_recover(lock, false);
+    TEST_CHECK(password_lock_exists(lock), "obnova smazala platný zámek");
+
+    // Správný PIN dá klíč trezoru, špatný se pozná podle kontrolního bloku a klíč se přepíše
+    uint8_t unlocked[PASSWORD_CRYPTO_KEY_SIZE];
+    TEST_CHECK(
+        password_lock_unlock(lock, "1234", unlocked) == PasswordLockResultOk &&
+            memcmp(unlocked, key, sizeof(key)) == 0 && test_lock_opens(&list, unlocked, vault),
+        "správný PIN trezor neodemkl");
+    static const uint8_t zero[PASSWORD_CRYPTO_KEY_SIZE];
+    TEST_CHECK(
+        password_lock_unlock(lock, "4321", unlocked) == PasswordLockResultWrongPin &&
+            memcmp(unlocked, zero, sizeof(zero)) == 0,
+        "špatný PIN prošel nebo nechal klíč");
+
+    // Useknutý soubor zámku je chyba, ne špatný PIN
+    test_file_write(root, "passwords.pwk", "PWLK", 4);
+    TEST_CHECK(password_lock_unlock(lock, "1234", unlocked) == PasswordLockResultError, "useknutý zámek se přijal");
+    password_list_free(&list);
+
+    static const char* const files[] = {
+        "passwords.pwk", "passwords.pwk.new", "passwords.pwv", "passwords.pwv.jnl", "passwords"};
+    char path[TEST_PATH_MAX];
+    for(size_t i = 0; i < COUNT_OF(files); i++) {
+        snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+        remove(path);
+    }
+    rmdir(root);
+
+    printf("zámek %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+typedef struct {
+    PasswordList* list; // NULL: záznamy se jen počítají
+    uint32_t count;
+    uint32_t progress_calls;
+    char first_name[NAME_MAX_LENGTH];
+    char first_password[PASSWORD_MAX_LENGTH];
+} TestImport;
+
+// Záznam se skupinou se uloží jako "<skupina>/<název>"
+static PasswordImportEntryResult
+    test_import_entry(const char* group, const char* name, const char* password, void* context) {
+    TestImport* test = context;
+    if(test->count++ == 0) {
+        strncpy(test->first_name, name, sizeof(test->first_name) - 1);
+        strncpy(test->first_password, password, sizeof(test->first_password) - 1);
+    }
+    if(!test->list) return PasswordImportEntryAdded;
+    char full[NAME_MAX_LENGTH + PASSWORD_GROUP_NAME_SIZE];
+    snprintf(full, sizeof(full), "%s%s%s", group, group[0] ? "/" : "", name);
+    PasswordListPutResult result = password_list_put(test->list, full, password, false);
+    return result == PasswordListPutAdded  ? PasswordImportEntryAdded :
+           result == PasswordListPutExists ? PasswordImportEntrySkipped :
+                                             PasswordImportEntryFailed;
+}
+
+static bool test_import_progress(const PasswordImportProgress* progress, void* context) {
+    TestImport* test = context;
+    test->progress_calls++;
+    return true;
+}
+
+// Vstup po kouscích dané velikosti, vrací výsledek a počty
+static PasswordImportResult test_import_text(
+    const char* text,
+    size_t chunk,
+    PasswordList* list,
+    PasswordImportProgress* progress) {
+    PasswordImport* import = password_import_alloc(PasswordImportFormatAuto, test_import_entry, &(TestImport){.list = list});
+    size_t length = strlen(text);
+    for(size_t i = 0; i < length; i += chunk) {
+        if(!password_import_feed(import, (const uint8_t*)text + i, MIN(chunk, length - i))) break;
+    }
+    PasswordImportResult result = password_import_finish(import, progress);
+    password_import_free(import);
+    return result;
+}
+
+// Hesla z exportu v seznamu
+static bool test_import_check(PasswordList* list, const char* name, const char* password) {
+    uint32_t index;
+    char buffer[PASSWORD_MAX_LENGTH];
+    return password_list_find(list, name, &index) &&
+           password_list_read_password(list, index, buffer, sizeof(buffer)) &&
+           strcmp(buffer, password) == 0;
+}
+
+static void test_import(void) {
+    unsigned failures = test_failures;
+    static const char csv[] =
+        "\xEF\xBB\xBF\"Group\",\"Title\",\"Username\",\"Password\",\"Notes\"\r\n"
+        "\"Root\",\"web:mail\",\"jan\",\"tajne,\"\"heslo\"\"\",\"více\r\nřádků\"\r\n"
+        "\r\n"
+        "Root,bez hesla,jan,,\n"
+        "Root,dlouhe,jan,0123456789012345678901234567890123456789012345678901234567890123,\n"
+        "Root/Infra/Web,server,jan,s3rver,\n"
+        "Root,posledni,jan,konec,bez konce řádku";
+    static const char keepass[] =
+        "<?xml version=\"1.0\" encoding=\"utf-8\" standalone=\"yes\"?>\n"
+        "<KeePassFile><Root><Group><Name>Root</Name>\n"
+        "<Entry><UUID>AAAA</UUID>\n"
+        "<String><Key>Title</Key><Value>a &amp; b: &#x10D;</Value></String>\n"
+        "<String><Key>Password</Key><Value ProtectInMemory=\"True\">&lt;nove&gt;</Value></String>\n"
+        "<History><Entry><String><Key>Title</Key><Value>stare</Value></String>"
+        "<String><Key>Password</Key><Value>stare-heslo</Value></String></Entry></History>\n"
+        "</Entry>\n"
+        "<Group><Name>Pr&#xE1;ce</Name><Entry><String><Key>Title</Key><Value>vpn</Value></String>"
+        "<String><Key>Password</Key><Value>tunel</Value></String></Entry>\n"
+        "<Group><Name>Infra</Name><Entry><String><Key>Title</Key><Value>vpn</Value></String>"
+        "<String><Key>Password</Key><Value>pod</Value></String></Entry></Group></Group>\n"
+        "<Entry><String><Key>Title</Key><Value>po skupine</Value></String>"
+        "<String><Key>Password</Key><Value>koren</Value></String></Entry>\n"
+        "<Entry><String><Key>Title</Key><Value>prazdne</Value></String>"
+        "<String><Key>Password</Key><Value/></String></Entry>\n"
+        "</Group></Root></KeePassFile>\n";
+    static const char bitwarden[] =
+        "{\"encrypted\": false, \"folders\": [],\n"
+        " \"items\": [\n"
+        "  {\"id\": \"1\", \"type\": 1, \"name\": \"bank \\\"A\\\"\", \"favorite\": false,\n"
+        "   \"fields\": [{\"name\": \"pin\", \"value\": \"1234\"}],\n"
+        "   \"login\": {\"username\": \"jan\", \"password\": \"\\u010Dervena\\ud83d\\ude00\", \"uris\": null}},\n"
+        "  {\"id\": \"2\", \"type\": 2, \"name\": \"poznamka\", \"login\": null, \"notes\": \"password\"}\n"
+        " ]}";
+    static const struct {
+        const char* name;
+        const char* text;
+        uint32_t imported;
+        uint32_t skipped;
+    } exports[] = {
+        {"CSV", csv, 3, 2},
+        {"KeePass", keepass, 4, 1},
+        {"Bitwarden", bitwarden, 1, 1},
+    };
+
+    // Stejný výsledek po bajtech i najednou; dvojtečka v názvu nevadí
+    for(size_t i = 0; i < COUNT_OF(exports); i++) {
+        static const size_t chunks[] = {1, 7, sizeof(csv)};
+        for(size_t c = 0; c < COUNT_OF(chunks); c++) {
+            PasswordList list;
+            password_list_init(&list);
+            PasswordImportProgress progress;
+            PasswordImportResult result = test_import_text(exports[i].text, chunks[c], &list, &progress);
+            TEST_CHECK(
+                result == PasswordImportResultOk && progress.imported == exports[i].imported &&
+                    progress.skipped == exports[i].skipped,
+                "%s po %zu B: výsledek %d, %u přidáno, %u přeskočeno",
+                exports[i].name, chunks[c], result, progress.imported, progress.skipped);
+            if(i == 0) {
+                TEST_CHECK(test_import_check(&list, "web:mail", "tajne,\"heslo\""), "CSV: uvozovky v hesle");
+                TEST_CHECK(test_import_check(&list, "posledni", "konec"), "CSV: poslední řádek");
+                TEST_CHECK(test_import_check(&list, "Infra/Web/server", "s3rver"), "CSV: cesta skupiny");
+            } else if(i == 1) {
+                TEST_CHECK(test_import_check(&list, "a & b: č", "<nove>"), "KeePass: entity nebo historie");
+                TEST_CHECK(test_import_check(&list, "Práce/vpn", "tunel"), "KeePass: vnořená skupina");
+                TEST_CHECK(test_import_check(&list, "Práce/Infra/vpn", "pod"), "KeePass: cesta skupiny");
+                TEST_CHECK(test_import_check(&list, "po skupine", "koren"), "KeePass: návrat ze skupiny");
+            } else {
+                TEST_CHECK(test_import_check(&list, "bank \"A\"", "červena😀"), "Bitwarden: escape sekvence");
+            }
+            password_list_free(&list);
+        }
+    }
+
+    // Název už v trezoru se přeskočí
+    PasswordList list;
+    password_list_init(&list);
+    password_list_add(&list, "posledni", "puvodni");
+    PasswordImportProgress progress;
+    test_import_text(csv, sizeof(csv), &list, &progress);
+    TEST_CHECK(progress.imported == 2 && progress.skipped == 3, "duplicita: %u přidáno", progress.imported);
+    TEST_CHECK(test_import_check(&list, "posledni", "puvodni"), "duplicita přepsala heslo");
+    password_list_free(&list);
+
+    // Stejně pojmenované podsložky různých složek zůstanou oddělené
+    password_list_init(&list);
+    test_import_text(
+        "folder,name,password\na/x,web,1\nb\\x/,web,2\nx,web,3\n/,web,4\n", 3, &list, &progress);
+    TEST_CHECK(
+        progress.imported == 4 && test_import_check(&list, "a/x/web", "1") &&
+            test_import_check(&list, "b/x/web", "2") && test_import_check(&list, "x/web", "3") &&
+            test_import_check(&list, "web", "4"),
+        "cesty složek: %u přidáno", progress.imported);
+    password_list_free(&list);
+
+    // Šifrovaný export a CSV bez sloupce hesla se odmítnou
+    TEST_CHECK(
+        test_import_text("{\"encrypted\": true, \"items\": []}", 5, NULL, &progress) == PasswordImportResultEncrypted,
+        "šifrovaný export se neodmítl");
+    TEST_CHECK(
+        test_import_text("name,url\nweb,x\n", 5, NULL, &progress) == PasswordImportResultUnknownFormat,
+        "CSV bez hesla se neodmítlo");
+
+    // 10 000 řádků ze souboru: paměť nezávisí na velikosti exportu
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/import.csv", root);
+    FILE* file = fopen(path, "w");
+    fprintf(file, "name,password,notes\n");
+    for(unsigned i = 0; i < 10000; i++) fprintf(file, "\"polozka %u\",\"heslo-%u\",\"poznamka\"\n", i, i);
+    fclose(file);
+
+    TestImport test = {0};
+    furi_shim_heap_reset_peak();
+    size_t heap = furi_shim_heap_used();
+    PasswordImportResult result = password_import_file(
+        "/ext/import.csv", PasswordImportFormatAuto, test_import_entry, test_import_progress, &test, &progress);
+    size_t peak = furi_shim_heap_peak() - heap;
+    TEST_CHECK(
+        result == PasswordImportResultOk && progress.imported == 10000 && test.count == 10000,
+        "soubor: výsledek %d, %u přidáno", result, progress.imported);
+    TEST_CHECK(
+        progress.bytes_read == progress.bytes_total && test.progress_calls > 1,
+        "průběh: %u z %u B, %u volání", progress.bytes_read, progress.bytes_total, test.progress_calls);
+    TEST_CHECK(
+        strcmp(test.first_name, "polozka 0") == 0 && strcmp(test.first_password, "heslo-0") == 0,
+        "první záznam %s", test.first_name);
+    TEST_CHECK(peak < 2048, "import zabral %zu B haldy", peak);
+    TEST_CHECK(furi_shim_heap_used() == heap, "import neuvolnil %zu B", furi_shim_heap_used() - heap);
+    unlink(path);
+    rmdir(root);
+
+    printf("import %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+static void test_groups(void) {
+    unsigned failures = test_failures;
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+
+    // Bez manifestu jen výchozí skupina, nezměněný manifest se nezapisuje
+    PasswordGroups groups;
+    TEST_CHECK(password_groups_load(&groups, "/ext/groups.txt") && groups.count == 1, "bez manifestu");
+    TEST_CHECK(password_groups_save(&groups, "/ext/groups.txt"), "nezměněný manifest");
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/groups.txt", root);
+    TEST_CHECK(access(path, F_OK) != 0, "nezměněný manifest se zapsal");
+
+    // Založení, nalezení a zkrácení dlouhého názvu po celých znacích
+    uint8_t work, home, again;
+    TEST_CHECK(password_groups_add(&groups, "", &again) && again == 0, "prázdný název není výchozí");
+    TEST_CHECK(password_groups_add(&groups, "práce", &work) && work == 1, "založení skupiny");
+    TEST_CHECK(
+        password_groups_add(&groups, "osobní účty a předplatné služeb, členské příspěvky", &home) && home == 2,
+        "založení dlouhé skupiny");
+    TEST_CHECK(
+        strlen(groups.groups[home].name) < PASSWORD_GROUP_NAME_SIZE &&
+            strncmp(
+                groups.groups[home].name, "osobní účty a předplatné služeb, člensk",
+                strlen(groups.groups[home].name)) == 0,
+        "zkrácený název %s", groups.groups[home].name);
+    TEST_CHECK(
+        password_groups_add(&groups, "osobní účty a předplatné služeb, členské", &again) && again == home,
+        "zkrácený název se nenašel");
+    password_groups_set_count(&groups, work, 12);
+    password_groups_set_count(&groups, 0, 3);
+
+    char vault[TEST_PATH_MAX];
+    password_groups_vault_path(&groups, work, "/ext/main.pwv", "/ext/groups", vault, sizeof(vault));
+    TEST_CHECK(strcmp(vault, "/ext/groups/1.pwv") == 0, "cesta trezoru %s", vault);
+    password_groups_vault_path(&groups, 0, "/ext/main.pwv", "/ext/groups", vault, sizeof(vault));
+    TEST_CHECK(strcmp(vault, "/ext/main.pwv") == 0, "cesta výchozího trezoru %s", vault);
+
+    // Manifest se načte stejný, i když výpadek nechal jen ".tmp"
+    TEST_CHECK(password_groups_save(&groups, "/ext/groups.txt") && !groups.dirty, "zápis manifestu");
+    char temp[TEST_PATH_MAX];
+    snprintf(temp, sizeof(temp), "%s.tmp", path);
+    for(int pass = 0; pass < 2; pass++) {
+        if(pass == 1) TEST_CHECK(rename(path, temp) == 0, "nelze přejmenovat manifest");
+        PasswordGroups loaded;
+        TEST_CHECK(password_groups_load(&loaded, "/ext/groups.txt"), "načtení manifestu");
+        TEST_CHECK(
+            loaded.count == 3 && loaded.groups[0].count == 3 && loaded.groups[work].count == 12 &&
+                strcmp(loaded.groups[home].name, groups.groups[home].name) == 0,
+            "manifest %s: %u skupin", pass ? ".tmp" : "", loaded.count);
+        TEST_CHECK(loaded.dirty == (pass == 1), "manifest z .tmp se znovu nezapíše");
+
+        // Nová skupina dostane nové id, ne pořadí
+        uint8_t index;
+        TEST_CHECK(
+            password_groups_add(&loaded, "nová", &index) && loaded.groups[index].id == 3,
+            "id nové skupiny %u", loaded.groups[index].id);
+        if(pass == 1) {
+            TEST_CHECK(password_groups_save(&loaded, "/ext/groups.txt"), "zápis manifestu z .tmp");
+            TEST_CHECK(access(temp, F_OK) != 0, ".tmp zůstal");
+        }
+    }
+
+    // Plný seznam další skupinu nezaloží
+    char name[8];
+    for(uint8_t i = groups.count; i < PASSWORD_GROUPS_MAX; i++) {
+        snprintf(name, sizeof(name), "g%u", i);
+        password_groups_add(&groups, name, &again);
+    }
+    TEST_CHECK(!password_groups_add(&groups, "navic", &again), "skupin je víc než PASSWORD_GROUPS_MAX");
+
+    unlink(path);
+    rmdir(root);
+    printf("skupiny %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+static void test_loader_callback(void* context) {
+    __atomic_add_fetch((uint32_t*)context, 1, __ATOMIC_RELAXED);
+}
+
+static void test_loader(void) {
+    unsigned failures = test_failures;
+    char root[] = "/tmp/password_test.XXXXXX";
+    TEST_CHECK(mkdtemp(root) != NULL, "nelze vytvořit dočasný adresář");
+    storage_shim_set_root(root);
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    memset(key, 0x5A, sizeof(key));
+
+    // Trezor s 1000 hesly a jedním dalším v žurnálu
+    PasswordList list;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    char name[NAME_MAX_LENGTH];
+    for(unsigned i = 0; i < 1000; i++) {
+        snprintf(name, sizeof(name), "polozka %04u", i);
+        password_list_add(&list, name, "heslo");
+    }
+    TEST_CHECK(password_list_save(&list, "/ext/loader.pwv"), "nelze uložit trezor");
+    password_list_free(&list);
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    password_list_load(&list, "/ext/loader.pwv");
+    password_list_add(&list, "aaa", "prvni");
+    password_list_free(&list);
+
+    // Náhled čte jen základní soubor
+    PasswordVaultPreview preview;
+    TEST_CHECK(password_vault_preview("/ext/loader.pwv", &preview), "náhled nejde přečíst");
+    TEST_CHECK(
+        preview.count == 1000 && preview.names_count == PASSWORD_VAULT_PREVIEW_NAMES &&
+            strcmp(preview.names[0], "polozka 0000") == 0 && strcmp(preview.names[2], "polozka 0002") == 0,
+        "náhled: %u hesel, první %s", preview.count, preview.names[0]);
+    TEST_CHECK(
+        !password_vault_preview("/ext/chybi.pwv", &preview) && preview.count == 0, "náhled chybějícího trezoru");
+
+    // Načtení na pozadí i se žurnálem, druhé načítání se nespustí
+    uint32_t callbacks = 0;
+    PasswordLoader* loader = password_loader_alloc(test_loader_callback, &callbacks);
+    TEST_CHECK(password_loader_start(loader, "/ext/loader.pwv", key), "načítání se nespustilo");
+    TEST_CHECK(!password_loader_start(loader, "/ext/loader.pwv", key), "druhé načítání se spustilo");
+    password_list_init(&list);
+    TEST_CHECK(password_loader_finish(loader, &list), "trezor se nenačetl");
+    TEST_CHECK(callbacks == 1 && !password_loader_is_done(loader), "callback %u×", callbacks);
+
+    // Přesunutý seznam dál zapisuje do svého trezoru
+    uint32_t index;
+    char password[PASSWORD_MAX_LENGTH];
+    TEST_CHECK(
+        list.count == 1001 && password_list_find(&list, "aaa", &index) &&
+            password_list_read_password(&list, index, password, sizeof(password)) &&
+            strcmp(password, "prvni") == 0,
+        "načteno %u hesel", list.count);
+    password_list_add(&list, "zzz", "posledni");
+    password_list_free(&list);
+
+    // Zrušené načítání výsledek zahodí, změna z přesunutého seznamu v trezoru je
+    TEST_CHECK(password_loader_start(loader, "/ext/loader.pwv", key), "načítání se nespustilo");
+    password_loader_cancel(loader);
+    password_list_init(&list);
+    TEST_CHECK(!password_loader_finish(loader, &list) && list.count == 0, "zrušené načítání se převzalo");
+    TEST_CHECK(password_loader_start(loader, "/ext/loader.pwv", key), "načítání se nespustilo");
+    TEST_CHECK(
+        password_loader_finish(loader, &list) && list.count == 1002 &&
+            password_list_find(&list, "zzz", &index),
+        "změna přesunutého seznamu chybí");
+    password_list_free(&list);
+
+    // Zrušení na vlákno nečeká, další načítání se spustí, až zrušené skončí
+    TEST_CHECK(password_loader_start(loader, "/ext/loader.pwv", key), "načítání se nespustilo");
+    password_loader_cancel(loader);
+    TEST_CHECK(!password_loader_is_done(loader), "zrušené načítání čeká na převzetí");
+    unsigned attempts = 0;
+    while(!password_loader_start(loader, "/ext/loader.pwv", key) && attempts < 1000) {
+        usleep(1000);
+        attempts++;
+    }
+    password_list_init(&list);
+    TEST_CHECK(
+        attempts < 1000 && password_loader_finish(loader, &list) && list.count == 1002,
+        "po zrušení načteno %u hesel", list.count);
+    password_list_free(&list);
+
+    // Zrušené otevření nic nenačte ani nesloučí žurnál
+    volatile bool cancel = true;
+    password_list_init(&list);
+    password_list_set_key(&list, key);
+    list.cancel = &cancel;
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/loader.pwv.jnl", root);
+    TEST_CHECK(
+        !password_list_open(&list, "/ext/loader.pwv", PasswordListModeFull) && list.count == 0 &&
+            access(path, F_OK) == 0,
+        "zrušené otevření: %u hesel", list.count);
+    password_list_free(&list);
+
+    // Poškozený trezor se nenačte a seznam zůstane prázdný
+    snprintf(path, sizeof(path), "%s/poskozeny.pwv", root);
+    FILE* file = fopen(path, "w");
+    fprintf(file, "PWVT poškozená hlavička a trochu dat navíc");
+    fclose(file);
+    TEST_CHECK(password_loader_start(loader, "/ext/poskozeny.pwv", key), "načítání se nespustilo");
+    password_list_init(&list);
+    TEST_CHECK(!password_loader_finish(loader, &list) && list.count == 0, "poškozený trezor se načetl");
+    password_list_free(&list);
+    password_loader_free(loader);
+
+    static const char* const files[] = {"poskozeny.pwv", "loader.pwv", "loader.pwv.jnl", "passwords"};
+    for(size_t i = 0; i < COUNT_OF(files); i++) {
+        snprintf(path, sizeof(path), "%s/%s", root, files[i]);
+        remove(path);
+    }
+    rmdir(root);
+    printf("načítání na pozadí %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+static int test_compare(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+// Klíče testovacích vektorů RFC 6238 (pro SHA-1 i RFC 4226) v ASCII a v Base32
+#define TEST_TOTP_SHA1_KEY "12345678901234567890"
+#define TEST_TOTP_SHA256_KEY "12345678901234567890123456789012"
+#define TEST_TOTP_SHA1_BASE32 "GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQ"
+#define TEST_TOTP_SHA256_BASE32 "GEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQGEZDGNBVGY3TQOJQGEZA"
+
+static void test_totp(void) {
+    unsigned failures = test_failures;
+    char code[PASSWORD_TOTP_DIGITS_MAX + 1];
+    PasswordTotp sha1;
+    PasswordTotp sha256;
+
+    // RFC 4226, dodatek D: HOTP-SHA1, 6 číslic
+    static const char* const hotp[] = {
+        "755224", "287082", "359152", "969429", "338314",
+        "254676", "287922", "162583", "399871", "520489",
+    };
+    TEST_CHECK(
+        password_totp_init(&sha1, PasswordTotpAlgorithmSha1, 6, (const uint8_t*)TEST_TOTP_SHA1_KEY, 20),
+        "klíč SHA-1 se nepřijal");
+    for(size_t i = 0; i < COUNT_OF(hotp); i++) {
+        password_totp_hotp(&sha1, i, code);
+        TEST_CHECK(strcmp(code, hotp[i]) == 0, "HOTP %zu: %s místo %s", i, code, hotp[i]);
+    }
+
+    // RFC 6238, dodatek B: TOTP, 8 číslic, krok 30 s
+    static const struct {
+        uint64_t time;
+        const char* sha1;
+        const char* sha256;
+    } vectors[] = {
+        {59, "94287082", "46119246"},
+        {1111111109, "07081804", "68084774"},
+        {1111111111, "14050471", "67062674"},
+        {1234567890, "89005924", "91819424"},
+        {2000000000, "69279037", "90698825"},
+        {20000000000ULL, "65353130", "77737706"},
+    };
+    password_totp_init(&sha1, PasswordTotpAlgorithmSha1, 8, (const uint8_t*)TEST_TOTP_SHA1_KEY, 20);
+    TEST_CHECK(
+        password_totp_init(&sha256, PasswordTotpAlgorithmSha256, 8, (const uint8_t*)TEST_TOTP_SHA256_KEY, 32),
+        "klíč SHA-256 se nepřijal");
+    for(size_t i = 0; i < COUNT_OF(vectors); i++) {
+        const char* result = password_totp_code(&sha1, vectors[i].time);
+        TEST_CHECK(strcmp(result, vectors[i].sha1) == 0, "SHA-1 v %llu: %s", (unsigned long long)vectors[i].time, result);
+        result = password_totp_code(&sha256, vectors[i].time);
+        TEST_CHECK(strcmp(result, vectors[i].sha256) == 0, "SHA-256 v %llu: %s", (unsigned long long)vectors[i].time, result);
+    }
+    TEST_CHECK(!password_totp_init(&sha1, PasswordTotpAlgorithmSha1, 7, (const uint8_t*)TEST_TOTP_SHA1_KEY, 20), "přijato 7 číslic");
+
+    // Kód se počítá jen v novém kroku
+    password_totp_init(&sha1, PasswordTotpAlgorithmSha1, 6, (const uint8_t*)TEST_TOTP_SHA1_KEY, 20);
+    password_totp_code(&sha1, 59);
+    sha1.code[0] = 'x';
+    TEST_CHECK(password_totp_code(&sha1, 30)[0] == 'x', "kód se v kroku počítal znovu");
+    TEST_CHECK(strcmp(password_totp_code(&sha1, 60), hotp[2]) == 0, "kód se v novém kroku nepřepočítal");
+    TEST_CHECK(
+        password_totp_remaining(59) == 1 && password_totp_remaining(60) == PASSWORD_TOTP_PERIOD,
+        "zbývá %u s", password_totp_remaining(59));
+
+    // Base32: velikost písmen, mezery a zarovnání nevadí, jiné znaky ano
+    uint8_t key[PASSWORD_TOTP_KEY_MAX_SIZE];
+    TEST_CHECK(
+        password_totp_base32_decode("gezd gnbv gy3t qojq GEZD-GNBV-GY3T-QOJQ", key, sizeof(key)) == 20 &&
+            memcmp(key, TEST_TOTP_SHA1_KEY, 20) == 0,
+        "Base32 s mezerami");
+    TEST_CHECK(password_totp_base32_decode("MZXW6===", key, sizeof(key)) == 3 && memcmp(key, "foo", 3) == 0, "Base32 se zarovnáním");
+    TEST_CHECK(password_totp_base32_decode("MZXW1", key, sizeof(key)) == 0, "Base32 s neplatným znakem");
+    TEST_CHECK(password_totp_base32_decode("MZ=XW", key, sizeof(key)) == 0, "Base32 se znakem za zarovnáním");
+    TEST_CHECK(password_totp_base32_decode(TEST_TOTP_SHA1_BASE32, key, 10) == 0, "Base32 přetekl výstup");
+
+    // Uložený tvar: URI se připojí k heslu a při zobrazení se oddělí
+    char password[PASSWORD_MAX_LENGTH] = "heslo";
+    TEST_CHECK(
+        password_totp_append(
+            password,
+            sizeof(password),
+            "otpauth://totp/ACME:jan?issuer=ACME&secret=" TEST_TOTP_SHA256_BASE32 "&algorithm=SHA256&digits=8&period=30"),
+        "URI se nepřipojilo");
+    PasswordTotp totp;
+    TEST_CHECK(
+        password_totp_split(password, &totp) && strcmp(password, "heslo") == 0 &&
+            strcmp(password_totp_code(&totp, 59), "46119246") == 0,
+        "oddělené heslo %s", password);
+    TEST_CHECK(!password_totp_split(password, &totp) && strcmp(password, "heslo") == 0, "heslo bez TOTP");
+
+    // Neplatné tajemství ani takové, které se k heslu nevejde, heslo nezmění
+    static const char* const invalid[] = {
+        "otpauth://totp/ACME?secret=" TEST_TOTP_SHA1_BASE32 "&period=60",
+        "otpauth://totp/ACME?secret=" TEST_TOTP_SHA1_BASE32 "&algorithm=SHA512",
+        "otpauth://hotp/ACME?secret=" TEST_TOTP_SHA1_BASE32 "&counter=1",
+        "otpauth://totp/ACME?issuer=ACME",
+        "neni base32!",
+        TEST_TOTP_SHA256_BASE32,
+    };
+    strlcpy(password, "dlouhe-heslo-s-dvaceti", sizeof(password));
+    for(size_t i = 0; i < COUNT_OF(invalid); i++) {
+        TEST_CHECK(
+            !password_totp_append(password, sizeof(password), invalid[i]) &&
+                strcmp(password, "dlouhe-heslo-s-dvaceti") == 0,
+            "přijato tajemství %zu", i);
+    }
+
+    // Nahrazení hesla tajemství přenese, jen pokud se k novému heslu vejde
+    char previous[PASSWORD_MAX_LENGTH] = "stare";
+    password_totp_append(previous, sizeof(previous), TEST_TOTP_SHA1_BASE32);
+    strlcpy(password, "nove", sizeof(password));
+    TEST_CHECK(
+        password_totp_carry(password, sizeof(password), previous) && password_totp_split(password, &totp) &&
+            strcmp(password, "nove") == 0 && strcmp(password_totp_code(&totp, 59), "287082") == 0,
+        "tajemství se s novým heslem nepřeneslo");
+    memset(password, 'x', 40);
+    password[40] = '\0';
+    TEST_CHECK(
+        !password_totp_carry(password, sizeof(password), previous) && strlen(password) == 40,
+        "tajemství se nevešlo, heslo se přesto změnilo");
+    TEST_CHECK(password_totp_carry(password, sizeof(password), "bez-totp") && strlen(password) == 40, "heslo bez TOTP");
+
+    // Import: tajemství ze sloupce CSV, řetězce KeePassXC a loginu Bitwardenu
+    static const char* const exports[] = {
+        "name,password,TOTP\nweb,heslo,\"" TEST_TOTP_SHA1_BASE32 "\"\n",
+        "<KeePassFile><Root><Group><Name>Root</Name><Entry>"
+        "<String><Key>Title</Key><Value>web</Value></String>"
+        "<String><Key>Password</Key><Value>heslo</Value></String>"
+        "<String><Key>otp</Key><Value>otpauth://totp/web?secret=" TEST_TOTP_SHA1_BASE32 "&amp;digits=6</Value></String>"
+        "</Entry></Group></Root></KeePassFile>",
+        "{\"items\": [{\"name\": \"web\", \"login\": {\"password\": \"heslo\", \"totp\": \"" TEST_TOTP_SHA1_BASE32 "\"}}]}",
+    };
+    for(size_t i = 0; i < COUNT_OF(exports); i++) {
+        PasswordList list;
+        password_list_init(&list);
+        PasswordImportProgress progress;
+        test_import_text(exports[i], 3, &list, &progress);
+        uint32_t index;
+        bool found = password_list_find(&list, "web", &index) &&
+                     password_list_read_password(&list, index, password, sizeof(password)) &&
+                     password_totp_split(password, &totp);
+        TEST_CHECK(
+            found && strcmp(password, "heslo") == 0 && strcmp(password_totp_code(&totp, 59), hotp[1]) == 0,
+            "import %zu: TOTP chybí", i);
+        password_list_free(&list);
+    }
+
+    printf("TOTP %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+#define TEST_GENERATOR_PASSWORDS 20000
+#define TEST_GENERATOR_LENGTH 16
+// Kvantil chí-kvadrát pro 89 stupňů volnosti a p = 1e-6, náhodně selže zhruba jednou za milion běhů
+#define TEST_GENERATOR_CHI_SQUARE_MAX 170.0
+
+// Statistika chí-kvadrát četností proti rovnoměrnému rozdělení
+static double test_chi_square(const uint32_t* counts, size_t size, uint32_t total) {
+    double expected = (double)total / size;
+    double chi_square = 0;
+    for(size_t i = 0; i < size; i++) {
+        double difference = counts[i] - expected;
+        chi_square += difference * difference / expected;
+    }
+    return chi_square;
+}
+
+static void test_generator(void) {
+    unsigned failures = test_failures;
+    PasswordGenerator generator;
+    password_generator_init(&generator);
+    char alphabet[PASSWORD_GENERATOR_ALPHABET_SIZE];
+    char password[PASSWORD_MAX_LENGTH];
+    const uint8_t all = PasswordGeneratorClassLower | PasswordGeneratorClassUpper |
+                        PasswordGeneratorClassDigits | PasswordGeneratorClassSymbols;
+
+    // Abecedy tříd, symboly bez uvozovek a zpětného lomítka
+    size_t alphabet_size = password_generator_alphabet(all, alphabet);
+    TEST_CHECK(alphabet_size == 90 && !strpbrk(alphabet, "\"'`\\ "), "abeceda %s", alphabet);
+    TEST_CHECK(password_generator_alphabet(PasswordGeneratorClassDigits, alphabet) == 10, "abeceda číslic");
+    password_generator_describe(PasswordGeneratorClassLower | PasswordGeneratorClassDigits, alphabet);
+    TEST_CHECK(strcmp(alphabet, "a1") == 0, "popis tříd %s", alphabet);
+
+    // Entropie: délka krát log2 abecedy, dolů zaokrouhlená
+    static const struct {
+        PasswordGeneratorPolicy policy;
+        uint32_t bits;
+    } entropy[] = {
+        {{16, all, true}, 103}, // 16 * 6,49
+        {{20, PasswordGeneratorClassDigits, false}, 66}, // 20 * 3,32
+        {{8, PasswordGeneratorClassLower, false}, 37}, // 8 * 4,70
+        {{63, PasswordGeneratorClassLower | PasswordGeneratorClassUpper, false}, 359}, // 63 * 5,70
+    };
+    for(size_t i = 0; i < COUNT_OF(entropy); i++) {
+        uint32_t bits = password_generator_entropy(&entropy[i].policy);
+        TEST_CHECK(bits == entropy[i].bits, "entropie %zu: %u místo %u bitů", i, bits, entropy[i].bits);
+    }
+
+    // Neplatné zásady nic nevygenerují
+    static const PasswordGeneratorPolicy invalid[] = {
+        {PASSWORD_GENERATOR_MIN_LENGTH - 1, PasswordGeneratorClassLower, false},
+        {PASSWORD_GENERATOR_MAX_LENGTH + 1, PasswordGeneratorClassLower, false},
+        {16, 0, false},
+    };
+    for(size_t i = 0; i < COUNT_OF(invalid); i++) {
+        TEST_CHECK(
+            !password_generator_generate(&generator, &invalid[i], password, sizeof(password)),
+            "přijaty zásady %zu", i);
+    }
+    PasswordGeneratorPolicy policy = {16, all, false};
+    TEST_CHECK(!password_generator_generate(&generator, &policy, password, 16), "heslo přeteklo výstup");
+
+    // Nejkratší hesla se všemi třídami: délka, znaky i třídy podle zásad
+    policy = (PasswordGeneratorPolicy){PASSWORD_GENERATOR_MIN_LENGTH, all, true};
+    bool valid = true;
+    for(uint32_t i = 0; i < 1000 && valid; i++) {
+        valid = password_generator_generate(&generator, &policy, password, sizeof(password)) &&
+                strlen(password) == PASSWORD_GENERATOR_MIN_LENGTH && strpbrk(password, "abcdefghijklmnopqrstuvwxyz") &&
+                strpbrk(password, "ABCDEFGHIJKLMNOPQRSTUVWXYZ") && strpbrk(password, "0123456789") &&
+                strspn(password, "abcdefghijklmnopqrstuvwxyz0123456789") < strlen(password);
+    }
+    TEST_CHECK(valid, "heslo %s nesplňuje zásady", password);
+    policy = (PasswordGeneratorPolicy){PASSWORD_GENERATOR_MAX_LENGTH, PasswordGeneratorClassDigits, false};
+    TEST_CHECK(
+        password_generator_generate(&generator, &policy, password, sizeof(password)) &&
+            strlen(password) == PASSWORD_GENERATOR_MAX_LENGTH &&
+            strspn(password, "0123456789") == PASSWORD_GENERATOR_MAX_LENGTH,
+        "heslo z číslic %s", password);
+
+    // Dávky: číslice zamítnou 6 bajtů z 256, na 6400 znaků tak stačí kolem 103 doplnění
+    password_generator_init(&generator);
+    policy = (PasswordGeneratorPolicy){32, PasswordGeneratorClassDigits, false};
+    for(uint32_t i = 0; i < 200; i++) password_generator_generate(&generator, &policy, password, sizeof(password));
+    TEST_CHECK(
+        generator.refills >= 100 && generator.refills <= 110,
+        "%u doplnění na 6400 znaků", generator.refills);
+    password_generator_wipe(&generator);
+    uint8_t zero[PASSWORD_GENERATOR_RANDOM_SIZE] = {0};
+    TEST_CHECK(memcmp(generator.random, zero, sizeof(zero)) == 0, "dávka se nepřepsala");
+
+    // Chí-kvadrát četností znaků celkem a na každé pozici, 89 stupňů volnosti
+    static uint32_t counts[TEST_GENERATOR_LENGTH + 1][90];
+    memset(counts, 0, sizeof(counts));
+    alphabet_size = password_generator_alphabet(all, alphabet);
+    policy = (PasswordGeneratorPolicy){TEST_GENERATOR_LENGTH, all, false};
+    for(uint32_t i = 0; i < TEST_GENERATOR_PASSWORDS; i++) {
+        password_generator_generate(&generator, &policy, password, sizeof(password));
+        for(size_t position = 0; position < TEST_GENERATOR_LENGTH; position++) {
+            size_t index = strchr(alphabet, password[position]) - alphabet;
+            counts[position][index]++;
+            counts[TEST_GENERATOR_LENGTH][index]++;
+        }
+    }
+    for(size_t position = 0; position <= TEST_GENERATOR_LENGTH; position++) {
+        uint32_t total = TEST_GENERATOR_PASSWORDS * (position == TEST_GENERATOR_LENGTH ? TEST_GENERATOR_LENGTH : 1);
+        double chi_square = test_chi_square(counts[position], alphabet_size, total);
+        TEST_CHECK(chi_square < TEST_GENERATOR_CHI_SQUARE_MAX, "pozice %zu: chí-kvadrát %.1f", position, chi_square);
+    }
+
+    // Stejný test odhalí zkreslení prostého zbytku po dělení
+    memset(counts, 0, sizeof(counts));
+    for(uint32_t i = 0; i < TEST_GENERATOR_PASSWORDS * TEST_GENERATOR_LENGTH; i++) {
+        counts[0][password_generator_uniform(&generator, 256) % alphabet_size]++;
+    }
+    double biased = test_chi_square(counts[0], alphabet_size, TEST_GENERATOR_PASSWORDS * TEST_GENERATOR_LENGTH);
+    TEST_CHECK(biased > TEST_GENERATOR_CHI_SQUARE_MAX, "zkreslení neodhaleno, chí-kvadrát %.1f", biased);
+    password_generator_wipe(&generator);
+
+    printf("generátor %s\n", test_failures == failures ? "ok" : "CHYBA");
+}
+
+int main(int argc, char** argv) {
+    const char* root = argc > 1 ? argv[1] : "..";
+    char path[TEST_PATH_MAX];
+    snprintf(path, sizeof(path), "%s/files", root);
+    storage_shim_set_assets(path);
+    password_hid_mock.start();
+
+    snprintf(path, sizeof(path), "%s/layouts", root);
+    DIR* dir = opendir(path);
+    if(!dir) {
+        perror(path);
+        return 1;
+    }
+    char* ids[64];
+    size_t count = 0;
+    struct dirent* entry;
+    while((entry = readdir(dir)) && count < COUNT_OF(ids)) {
+        char* extension = strrchr(entry->d_name, '.');
+        if(!extension || strcmp(extension, ".txt") != 0) continue;
+        ids[count++] = strndup(entry->d_name, (size_t)(extension - entry->d_name));
+    }
+    closedir(dir);
+    qsort(ids, count, sizeof(ids[0]), test_compare);
+
+    for(size_t i = 0; i < count; i++) test_layout(root, ids[i]);
+    test_layout_invalid();
+    test_layout_cycle(count);
+    test_keyboard_table();
+    test_hid_transport();
+    test_arena();
+    test_worker(root);
+    test_list_view();
+    test_scroll();
+    test_perf();
+    test_name_index();
+    test_crypto();
+    test_string_pool();
+    test_paged_window();
+    test_sorted_filter();
+    test_search();
+    test_journal();
+    test_recovery();
+    test_vault_format();
+    test_kdf();
+    test_lock();
+    test_import();
+    test_groups();
+    test_loader();
+    test_totp();
+    test_generator();
+    for(size_t i = 0; i < count; i++) free(ids[i]);
+
+    if(test_failures > 0) {
+        fprintf(stderr, "%u chyb\n", test_failures);
+        return 1;
+    }
+    printf("vše ok\n");
+    return 0;
+}
@@ -0,0 +1,50 @@
+/*
+ * Mapování binárního trezoru do paměti pro hostitelský build.
+ */
+
+#include "password_vault_mmap.h"
+
+#include <storage/storage.h>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool password_vault_map_open(PasswordVaultMap* map, const char* path) {
+    memset(map, 0, sizeof(PasswordVaultMap));
+    map->fd = -1;
+
+    char host_path[512];
+    storage_shim_host_path(path, host_path, sizeof(host_path));
+    map->fd = open(host_path, O_RDONLY);
+    if(map->fd < 0) return false;
+
+    struct stat info;
+    if(fstat(map->fd, &info) != 0 || info.st_size <= 0) {
+        password_vault_map_close(map);
+        return false;
+    }
+
+    void* data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, map->fd, 0);
+    if(data == MAP_FAILED) {
+        password_vault_map_close(map);
+        return false;
+    }
+    map->data = data;
+    map->size = (size_t)info.st_size;
+
+    if(!password_vault_view_check(map->data, map->size, true)) {
+        password_vault_map_close(map);
+        return false;
+    }
+    return true;
+}
+
+void password_vault_map_close(PasswordVaultMap* map) {
+    if(map->data) munmap((void*)map->data, map->size);
+    if(map->fd >= 0) close(map->fd);
+    map->fd = -1;
+    map->data = NULL;
+    map->size = 0;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+/*
+ * Čtení binárního trezoru přes mmap (jen hostitelský build).
+ *
+ * Zařízení mmap nemá, na hostiteli ale formát umožňuje přistupovat
+ * k záznamům přímo v namapovaném souboru bez kopírování a bez čtení.
+ */
+
+#include "../password_vault_format.h"
+
+typedef struct {
+    int fd;
+    const uint8_t* data;
+    size_t size;
+} PasswordVaultMap;
+
+/**
+ * @brief Namapuje trezor a ověří jeho hlavičku i kontrolní součet
+ * 
+ * @param map Namapovaný trezor
+ * @param path Cesta k trezoru (stejná jako pro Storage)
+ * @return true Pokud je trezor namapovaný a platný
+ * @return false Pokud se mapování nepodařilo nebo trezor není platný
+ */
+bool password_vault_map_open(PasswordVaultMap* map, const char* path);
+
+/**
+ * @brief Zruší mapování trezoru
+ * 
+ * @param map Namapovaný trezor
+ */
+void password_vault_map_close(PasswordVaultMap* map);
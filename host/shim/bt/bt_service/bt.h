@@ -0,0 +1,39 @@
+#pragma once
+
+/*
+ * Náhrada bt/bt_service/bt.h pro hostitelský build (jen deklarace pro
+ * kontrolu překladu přenosu Bluetooth).
+ */
+
+#include <furi_hal_bt.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECORD_BT "bt"
+
+typedef struct Bt Bt;
+
+typedef enum {
+    BtStatusUnavailable,
+    BtStatusOff,
+    BtStatusAdvertising,
+    BtStatusConnected,
+} BtStatus;
+
+typedef void (*BtStatusChangedCallback)(BtStatus status, void* context);
+
+FuriHalBleProfileBase* bt_profile_start(
+    Bt* bt,
+    const FuriHalBleProfileTemplate* profile_template,
+    FuriHalBleProfileParams params);
+bool bt_profile_restore_default(Bt* bt);
+void bt_disconnect(Bt* bt);
+void bt_set_status_changed_callback(Bt* bt, BtStatusChangedCallback callback, void* context);
+void bt_keys_storage_set_storage_path(Bt* bt, const char* keys_storage_path);
+void bt_keys_storage_set_default_path(Bt* bt);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+
+/*
+ * Náhrada extra_profiles/hid_profile.h (knihovna ble_profile) pro
+ * hostitelský build, jen deklarace pro kontrolu překladu přenosu Bluetooth.
+ */
+
+#include <furi_hal_bt.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const FuriHalBleProfileTemplate* ble_profile_hid;
+
+bool ble_profile_hid_kb_press(FuriHalBleProfileBase* profile, uint16_t button);
+bool ble_profile_hid_kb_release_all(FuriHalBleProfileBase* profile);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+
+/*
+ * Náhrada furi_hal.h pro hostitelský build.
+ */
+
+#include <furi.h>
+#include <furi_hal_crypto.h>
+#include <furi_hal_random.h>
+#include <furi_hal_rtc.h>
+#include <furi_hal_bt.h>
+#include <furi_hal_cortex.h>
+#include <furi_hal_usb.h>
+#include <furi_hal_usb_hid.h>
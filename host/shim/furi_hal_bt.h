@@ -0,0 +1,22 @@
+#pragma once
+
+/*
+ * Náhrada furi_hal_bt.h pro hostitelský build (jen deklarace pro kontrolu
+ * překladu přenosu Bluetooth).
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FuriHalBleProfileBase FuriHalBleProfileBase;
+typedef struct FuriHalBleProfileTemplate FuriHalBleProfileTemplate;
+typedef void* FuriHalBleProfileParams;
+
+void furi_hal_bt_start_advertising(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,25 @@
+#pragma once
+
+/*
+ * Náhrada furi_hal_cortex.h a čítače cyklů DWT pro hostitelský build.
+ * Čítač jde podle hodin furi_get_tick (i virtuálních) s 64 cykly na us.
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+DWT_Type* furi_shim_dwt(void);
+#define DWT (furi_shim_dwt())
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+/*
+ * Náhrada furi_hal_crypto.h pro hostitelský build.
+ * Místo hardwarového AES jednotky STM32WB počítá AES-256 softwarově,
+ * výsledky jsou shodné se zařízením (soubory jsou přenositelné).
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FURI_HAL_CRYPTO_ENCLAVE_UNIQUE_KEY_SLOT 11
+
+#define FURI_HAL_CRYPTO_GCM_IV_LENGTH 12
+#define FURI_HAL_CRYPTO_GCM_TAG_LENGTH 16
+
+typedef enum {
+    FuriHalCryptoGCMStateOk,
+    FuriHalCryptoGCMStateError,
+    FuriHalCryptoGCMStateAuthFailure,
+} FuriHalCryptoGCMState;
+
+/** Načte klíč z enklávy (na hostiteli pevný klíč zařízení) */
+bool furi_hal_crypto_enclave_load_key(uint8_t slot, const uint8_t* iv);
+
+bool furi_hal_crypto_enclave_unload_key(uint8_t slot);
+
+/** AES-256-CBC načteným klíčem, size musí být násobek 16 */
+bool furi_hal_crypto_encrypt(const uint8_t* input, uint8_t* output, size_t size);
+
+FuriHalCryptoGCMState furi_hal_crypto_gcm_encrypt_and_tag(
+    const uint8_t* key,
+    const uint8_t* iv,
+    const uint8_t* aad,
+    size_t aad_length,
+    const uint8_t* input,
+    uint8_t* output,
+    size_t length,
+    uint8_t* tag);
+
+FuriHalCryptoGCMState furi_hal_crypto_gcm_decrypt_and_verify(
+    const uint8_t* key,
+    const uint8_t* iv,
+    const uint8_t* aad,
+    size_t aad_length,
+    const uint8_t* input,
+    uint8_t* output,
+    size_t length,
+    const uint8_t* tag);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+/*
+ * Náhrada furi_hal_random.h pro hostitelský build (getrandom).
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void furi_hal_random_fill_buf(uint8_t* buf, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+/*
+ * Náhrada furi_hal_rtc.h pro hostitelský build (systémové hodiny).
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t furi_hal_rtc_get_timestamp(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,24 @@
+#pragma once
+
+/*
+ * Náhrada furi_hal_usb.h pro hostitelský build (jen deklarace pro kontrolu
+ * překladu přenosu USB).
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FuriHalUsbInterface FuriHalUsbInterface;
+
+extern FuriHalUsbInterface usb_hid;
+
+FuriHalUsbInterface* furi_hal_usb_get_config(void);
+bool furi_hal_usb_set_config(FuriHalUsbInterface* new_if, void* ctx);
+void furi_hal_usb_unlock(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+
+/*
+ * Náhrada furi_hal_usb_hid.h pro hostitelský build.
+ * Funkce HID jsou jen deklarované kvůli kontrole překladu přenosu USB,
+ * testy a benchmark píšou přes zaznamenávající přenos (password_hid_mock.h).
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Modifikátory (stejné hodnoty jako ve firmwaru, posunuté o 8 bitů)
+#define KEY_MOD_LEFT_CTRL (1 << 8)
+#define KEY_MOD_LEFT_SHIFT (1 << 9)
+#define KEY_MOD_LEFT_ALT (1 << 10)
+#define KEY_MOD_LEFT_GUI (1 << 11)
+#define KEY_MOD_RIGHT_CTRL (1 << 12)
+#define KEY_MOD_RIGHT_SHIFT (1 << 13)
+#define KEY_MOD_RIGHT_ALT (1 << 14)
+#define KEY_MOD_RIGHT_GUI (1 << 15)
+
+// Kódy kláves dle HID Usage Tables
+enum HidKeyboardKeys {
+    HID_KEYBOARD_NONE = 0x00,
+    HID_KEYBOARD_A = 0x04,
+    HID_KEYBOARD_B = 0x05,
+    HID_KEYBOARD_C = 0x06,
+    HID_KEYBOARD_D = 0x07,
+    HID_KEYBOARD_E = 0x08,
+    HID_KEYBOARD_F = 0x09,
+    HID_KEYBOARD_G = 0x0A,
+    HID_KEYBOARD_H = 0x0B,
+    HID_KEYBOARD_I = 0x0C,
+    HID_KEYBOARD_J = 0x0D,
+    HID_KEYBOARD_K = 0x0E,
+    HID_KEYBOARD_L = 0x0F,
+    HID_KEYBOARD_M = 0x10,
+    HID_KEYBOARD_N = 0x11,
+    HID_KEYBOARD_O = 0x12,
+    HID_KEYBOARD_P = 0x13,
+    HID_KEYBOARD_Q = 0x14,
+    HID_KEYBOARD_R = 0x15,
+    HID_KEYBOARD_S = 0x16,
+    HID_KEYBOARD_T = 0x17,
+    HID_KEYBOARD_U = 0x18,
+    HID_KEYBOARD_V = 0x19,
+    HID_KEYBOARD_W = 0x1A,
+    HID_KEYBOARD_X = 0x1B,
+    HID_KEYBOARD_Y = 0x1C,
+    HID_KEYBOARD_Z = 0x1D,
+    HID_KEYBOARD_1 = 0x1E,
+    HID_KEYBOARD_2 = 0x1F,
+    HID_KEYBOARD_3 = 0x20,
+    HID_KEYBOARD_4 = 0x21,
+    HID_KEYBOARD_5 = 0x22,
+    HID_KEYBOARD_6 = 0x23,
+    HID_KEYBOARD_7 = 0x24,
+    HID_KEYBOARD_8 = 0x25,
+    HID_KEYBOARD_9 = 0x26,
+    HID_KEYBOARD_0 = 0x27,
+    HID_KEYBOARD_RETURN = 0x28,
+    HID_KEYBOARD_ESCAPE = 0x29,
+    HID_KEYBOARD_DELETE = 0x2A,
+    HID_KEYBOARD_TAB = 0x2B,
+    HID_KEYBOARD_SPACEBAR = 0x2C,
+    HID_KEYBOARD_MINUS = 0x2D,
+    HID_KEYBOARD_EQUAL = 0x2E,
+    HID_KEYBOARD_OPEN_BRACKET = 0x2F,
+    HID_KEYBOARD_CLOSE_BRACKET = 0x30,
+    HID_KEYBOARD_BACKSLASH = 0x31,
+    HID_KEYBOARD_NON_US_HASH = 0x32,
+    HID_KEYBOARD_SEMICOLON = 0x33,
+    HID_KEYBOARD_APOSTROPHE = 0x34,
+    HID_KEYBOARD_GRAVE_ACCENT = 0x35,
+    HID_KEYBOARD_COMMA = 0x36,
+    HID_KEYBOARD_DOT = 0x37,
+    HID_KEYBOARD_SLASH = 0x38,
+    HID_KEYBOARD_CAPS_LOCK = 0x39,
+    HID_KEYBOARD_NON_US_BACKSLASH = 0x64,
+};
+
+bool furi_hal_hid_is_connected(void);
+bool furi_hal_hid_kb_press(uint16_t button);
+bool furi_hal_hid_kb_release_all(void);
+
+#ifdef __cplusplus
+}
+#endif
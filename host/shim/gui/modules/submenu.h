@@ -0,0 +1,7 @@
+#pragma once
+
+/* Náhrada gui/modules/submenu.h pro hostitelský build (jen deklarace typu). */
+
+#include <gui/view.h>
+
+typedef struct Submenu Submenu;
@@ -0,0 +1,7 @@
+#pragma once
+
+/* Náhrada gui/modules/text_input.h pro hostitelský build (jen deklarace typu). */
+
+#include <gui/view.h>
+
+typedef struct TextInput TextInput;
@@ -0,0 +1,7 @@
+#pragma once
+
+/* Náhrada gui/modules/widget.h pro hostitelský build (jen deklarace typu). */
+
+#include <gui/view.h>
+
+typedef struct Widget Widget;
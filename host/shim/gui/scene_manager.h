@@ -0,0 +1,7 @@
+#pragma once
+
+/* Náhrada gui/scene_manager.h pro hostitelský build (jen deklarace typu). */
+
+#include <gui/gui.h>
+
+typedef struct SceneManager SceneManager;
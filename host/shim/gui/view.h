@@ -0,0 +1,7 @@
+#pragma once
+
+/* Náhrada gui/view.h pro hostitelský build (jen deklarace typu). */
+
+#include <gui/gui.h>
+
+typedef struct View View;
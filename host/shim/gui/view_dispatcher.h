@@ -0,0 +1,7 @@
+#pragma once
+
+/* Náhrada gui/view_dispatcher.h pro hostitelský build (jen deklarace typu). */
+
+#include <gui/gui.h>
+
+typedef struct ViewDispatcher ViewDispatcher;
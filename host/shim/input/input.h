@@ -0,0 +1,48 @@
+#pragma once
+
+/*
+ * Náhrada input/input.h pro hostitelský build.
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECORD_INPUT_EVENTS "input_events"
+
+typedef enum {
+    InputKeyUp,
+    InputKeyDown,
+    InputKeyRight,
+    InputKeyLeft,
+    InputKeyOk,
+    InputKeyBack,
+    InputKeyMAX,
+} InputKey;
+
+typedef enum {
+    InputTypePress,
+    InputTypeRelease,
+    InputTypeShort,
+    InputTypeLong,
+    InputTypeRepeat,
+    InputTypeMAX,
+} InputType;
+
+typedef struct {
+    union {
+        uint32_t sequence;
+        struct {
+            uint8_t sequence_source : 2;
+            uint32_t sequence_counter : 30;
+        };
+    };
+    InputKey key;
+    InputType type;
+} InputEvent;
+
+#ifdef __cplusplus
+}
+#endif
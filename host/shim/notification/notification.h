@@ -0,0 +1,23 @@
+#pragma once
+
+/*
+ * Náhrada notification/notification.h pro hostitelský build.
+ */
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECORD_NOTIFICATION "notification"
+
+typedef struct NotificationApp NotificationApp;
+typedef struct NotificationMessage NotificationMessage;
+typedef const NotificationMessage* NotificationSequence[];
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+/*
+ * Náhrada notification/notification_messages.h pro hostitelský build.
+ */
+
+#include "notification.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern const NotificationSequence sequence_blink_green_100;
+extern const NotificationSequence sequence_blink_red_100;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+/*
+ * Náhrada toolbox/version.h pro hostitelský build, verze firmwaru je "host".
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Version Version;
+
+const char* version_get_version(const Version* version);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,364 @@
+/*
+ * Hostitelská implementace Storage, File a souborového Streamu nad stdio.
+ */
+
+#include <storage/storage.h>
+#include <toolbox/stream/file_stream.h>
+
+#include <dirent.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define STORAGE_SHIM_PATH_MAX 512
+
+static char storage_root[STORAGE_SHIM_PATH_MAX] = "";
+static char storage_assets[STORAGE_SHIM_PATH_MAX] = "";
+
+void storage_shim_set_root(const char* root) {
+    strlcpy(storage_root, root, sizeof(storage_root));
+}
+
+void storage_shim_set_assets(const char* assets) {
+    strlcpy(storage_assets, assets, sizeof(storage_assets));
+}
+
+void storage_shim_host_path(const char* path, char* out, size_t out_size) {
+    if(storage_root[0] == '\0') {
+        const char* env = getenv("PASSWORD_HOST_ROOT");
+        storage_shim_set_root(env ? env : ".");
+    }
+
+    size_t assets_length = strlen(STORAGE_APP_ASSETS_PATH_PREFIX);
+    if(storage_assets[0] != '\0' && strncmp(path, STORAGE_APP_ASSETS_PATH_PREFIX, assets_length) == 0) {
+        snprintf(out, out_size, "%s%s", storage_assets, path + assets_length);
+        return;
+    }
+
+    // /ext, /int i /any míří do stejného kořenového adresáře
+    const char* relative = path;
+    if(strncmp(path, "/ext", 4) == 0 || strncmp(path, "/int", 4) == 0 ||
+       strncmp(path, "/any", 4) == 0) {
+        relative = path + 4;
+    }
+    snprintf(out, out_size, "%s%s%s", storage_root, relative[0] == '/' ? "" : "/", relative);
+}
+
+// Storage
+
+bool storage_dir_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char host_path[STORAGE_SHIM_PATH_MAX];
+    storage_shim_host_path(path, host_path, sizeof(host_path));
+    struct stat st;
+    return stat(host_path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool storage_file_exists(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char host_path[STORAGE_SHIM_PATH_MAX];
+    storage_shim_host_path(path, host_path, sizeof(host_path));
+    struct stat st;
+    return stat(host_path, &st) == 0 && S_ISREG(st.st_mode);
+}
+
+bool storage_simply_mkdir(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char host_path[STORAGE_SHIM_PATH_MAX];
+    storage_shim_host_path(path, host_path, sizeof(host_path));
+    return mkdir(host_path, 0755) == 0 || errno == EEXIST;
+}
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo) {
+    UNUSED(storage);
+    char host_path[STORAGE_SHIM_PATH_MAX];
+    storage_shim_host_path(path, host_path, sizeof(host_path));
+    struct stat st;
+    if(stat(host_path, &st) != 0) return FSE_NOT_EXIST;
+    if(fileinfo) {
+        fileinfo->flags = S_ISDIR(st.st_mode) ? FSF_DIRECTORY : 0;
+        fileinfo->size = (uint64_t)st.st_size;
+    }
+    return FSE_OK;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    char host_path[STORAGE_SHIM_PATH_MAX];
+    storage_shim_host_path(path, host_path, sizeof(host_path));
+    if(remove(host_path) == 0) return FSE_OK;
+    return errno == ENOENT ? FSE_NOT_EXIST : FSE_INTERNAL;
+}
+
+bool storage_simply_remove(Storage* storage, const char* path) {
+    FS_Error error = storage_common_remove(storage, path);
+    return error == FSE_OK || error == FSE_NOT_EXIST;
+}
+
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    UNUSED(storage);
+    char host_old[STORAGE_SHIM_PATH_MAX];
+    char host_new[STORAGE_SHIM_PATH_MAX];
+    storage_shim_host_path(old_path, host_old, sizeof(host_old));
+    storage_shim_host_path(new_path, host_new, sizeof(host_new));
+    if(rename(host_old, host_new) == 0) return FSE_OK;
+    return errno == ENOENT ? FSE_NOT_EXIST : FSE_INTERNAL;
+}
+
+// File
+
+struct File {
+    FILE* handle;
+    DIR* dir;
+    bool writing;
+    FS_Error error;
+};
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    File* file = calloc(1, sizeof(File));
+    return file;
+}
+
+void storage_file_free(File* file) {
+    if(file->handle) storage_file_close(file);
+    if(file->dir) storage_dir_close(file);
+    free(file);
+}
+
+bool storage_file_open(File* file, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    UNUSED(access_mode);
+    char host_path[STORAGE_SHIM_PATH_MAX];
+    storage_shim_host_path(path, host_path, sizeof(host_path));
+
+    FILE* handle = NULL;
+    switch(open_mode) {
+    case FSOM_OPEN_EXISTING:
+        handle = fopen(host_path, (access_mode & FSAM_WRITE) ? "r+b" : "rb");
+        break;
+    case FSOM_OPEN_ALWAYS:
+    case FSOM_OPEN_APPEND:
+        handle = fopen(host_path, "r+b");
+        if(!handle) handle = fopen(host_path, "w+b");
+        if(handle && open_mode == FSOM_OPEN_APPEND) fseek(handle, 0, SEEK_END);
+        break;
+    case FSOM_CREATE_NEW:
+        handle = fopen(host_path, "w+bx");
+        break;
+    case FSOM_CREATE_ALWAYS:
+        handle = fopen(host_path, "w+b");
+        break;
+    }
+
+    file->handle = handle;
+    file->writing = false;
+    file->error = handle ? FSE_OK : (errno == ENOENT ? FSE_NOT_EXIST : FSE_DENIED);
+    return handle != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(!file->handle) return false;
+    fclose(file->handle);
+    file->handle = NULL;
+    return true;
+}
+
+bool storage_file_is_open(File* file) {
+    return file->handle != NULL;
+}
+
+static void storage_file_switch(File* file, bool writing) {
+    // stdio vyžaduje seek mezi čtením a zápisem
+    if(file->writing != writing) {
+        fseek(file->handle, 0, SEEK_CUR);
+        file->writing = writing;
+    }
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read) {
+    if(!file->handle) return 0;
+    storage_file_switch(file, false);
+    return fread(buff, 1, bytes_to_read, file->handle);
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write) {
+    if(!file->handle) return 0;
+    storage_file_switch(file, true);
+    return fwrite(buff, 1, bytes_to_write, file->handle);
+}
+
+bool storage_file_seek(File* file, uint32_t offset, bool from_start) {
+    if(!file->handle) return false;
+    file->writing = false;
+    return fseek(file->handle, (long)offset, from_start ? SEEK_SET : SEEK_CUR) == 0;
+}
+
+uint64_t storage_file_tell(File* file) {
+    if(!file->handle) return 0;
+    return (uint64_t)ftell(file->handle);
+}
+
+uint64_t storage_file_size(File* file) {
+    if(!file->handle) return 0;
+    fflush(file->handle);
+    struct stat st;
+    if(fstat(fileno(file->handle), &st) != 0) return 0;
+    return (uint64_t)st.st_size;
+}
+
+bool storage_file_sync(File* file) {
+    if(!file->handle) return false;
+    return fflush(file->handle) == 0 && fsync(fileno(file->handle)) == 0;
+}
+
+bool storage_file_eof(File* file) {
+    if(!file->handle) return true;
+    return storage_file_tell(file) >= storage_file_size(file);
+}
+
+// Stream
+
+struct Stream {
+    File* file;
+};
+
+Stream* file_stream_alloc(Storage* storage) {
+    Stream* stream = malloc(sizeof(Stream));
+    stream->file = storage_file_alloc(storage);
+    return stream;
+}
+
+bool file_stream_open(Stream* stream, const char* path, FS_AccessMode access_mode, FS_OpenMode open_mode) {
+    return storage_file_open(stream->file, path, access_mode, open_mode);
+}
+
+bool file_stream_close(Stream* stream) {
+    return storage_file_close(stream->file);
+}
+
+FS_Error file_stream_get_error(Stream* stream) {
+    return stream->file->error;
+}
+
+void stream_free(Stream* stream) {
+    storage_file_free(stream->file);
+    free(stream);
+}
+
+bool stream_eof(Stream* stream) {
+    return storage_file_eof(stream->file);
+}
+
+bool stream_seek(Stream* stream, int32_t offset, StreamOffset offset_type) {
+    File* file = stream->file;
+    if(!file->handle) return false;
+    file->writing = false;
+    int whence = offset_type == StreamOffsetFromStart ? SEEK_SET :
+                 offset_type == StreamOffsetFromEnd   ? SEEK_END :
+                                                        SEEK_CUR;
+    return fseek(file->handle, offset, whence) == 0;
+}
+
+size_t stream_tell(Stream* stream) {
+    return (size_t)storage_file_tell(stream->file);
+}
+
+size_t stream_size(Stream* stream) {
+    return (size_t)storage_file_size(stream->file);
+}
+
+size_t stream_write(Stream* stream, const uint8_t* data, size_t size) {
+    return storage_file_write(stream->file, data, size);
+}
+
+size_t stream_read(Stream* stream, uint8_t* data, size_t count) {
+    return storage_file_read(stream->file, data, count);
+}
+
+bool stream_read_line(Stream* stream, FuriString* str_result) {
+    // Stejné chování jako ve firmwaru: '\r' se zahazuje, '\n' zůstává
+    furi_string_reset(str_result);
+    File* file = stream->file;
+    if(!file->handle) return false;
+    storage_file_switch(file, false);
+
+    int c;
+    while((c = fgetc(file->handle)) != EOF) {
+        if(c == '\r') continue;
+        furi_string_push_back(str_result, (char)c);
+        if(c == '\n') break;
+    }
+    return furi_string_size(str_result) != 0;
+}
+
+bool stream_rewind(Stream* stream) {
+    return stream_seek(stream, 0, StreamOffsetFromStart);
+}
+
+size_t stream_write_char(Stream* stream, char c) {
+    return stream_write(stream, (const uint8_t*)&c, 1);
+}
+
+size_t stream_write_string(Stream* stream, FuriString* string) {
+    return stream_write(stream, (const uint8_t*)furi_string_get_cstr(string), furi_string_size(string));
+}
+
+size_t stream_write_cstring(Stream* stream, const char* string) {
+    return stream_write(stream, (const uint8_t*)string, strlen(string));
+}
+
+size_t stream_write_vaformat(Stream* stream, const char* format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int length = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    size_t written = 0;
+    if(length > 0) {
+        char* buffer = malloc((size_t)length + 1);
+        vsnprintf(buffer, (size_t)length + 1, format, args);
+        written = stream_write(stream, (const uint8_t*)buffer, (size_t)length);
+        free(buffer);
+    }
+    return written;
+}
+
+size_t stream_write_format(Stream* stream, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    size_t written = stream_write_vaformat(stream, format, args);
+    va_end(args);
+    return written;
+}
+
+// Adresáře
+
+bool storage_dir_open(File* file, const char* path) {
+    char host_path[STORAGE_SHIM_PATH_MAX];
+    storage_shim_host_path(path, host_path, sizeof(host_path));
+    file->dir = opendir(host_path);
+    file->error = file->dir ? FSE_OK : FSE_NOT_EXIST;
+    return file->dir != NULL;
+}
+
+bool storage_dir_close(File* file) {
+    if(!file->dir) return false;
+    closedir(file->dir);
+    file->dir = NULL;
+    return true;
+}
+
+bool storage_dir_read(File* file, FileInfo* fileinfo, char* name, uint16_t name_length) {
+    if(!file->dir) return false;
+    struct dirent* entry;
+    do {
+        entry = readdir(file->dir);
+    } while(entry && (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0));
+    if(!entry) return false;
+
+    if(fileinfo) {
+        fileinfo->flags = entry->d_type == DT_DIR ? FSF_DIRECTORY : 0;
+        fileinfo->size = 0;
+    }
+    if(name) strlcpy(name, entry->d_name, name_length);
+    return true;
+}
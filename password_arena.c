@@ -0,0 +1,69 @@
+#include "password_arena.h"
+#include "password_crypto.h"
+#include <furi.h>
+#include <string.h>
+
+#define TAG "PasswordArena"
+
+_Static_assert(PASSWORD_ARENA_SLOTS <= 32, "obsazenost slotů je bitová maska uint32_t");
+_Static_assert(PASSWORD_ARENA_SLOT_SIZE >= PASSWORD_CRYPTO_KEY_SIZE, "klíč se do slotu nevejde");
+
+struct PasswordArena {
+    FuriMutex* mutex;
+    uint32_t used; // Bit i = slot i je vydaný
+    uint8_t slots[PASSWORD_ARENA_SLOTS][PASSWORD_ARENA_SLOT_SIZE];
+};
+
+PasswordArena* password_arena_alloc(void) {
+    PasswordArena* arena = malloc(sizeof(PasswordArena));
+    memset(arena, 0, sizeof(PasswordArena));
+    arena->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    return arena;
+}
+
+void password_arena_free(PasswordArena* arena) {
+    if(arena->used) FURI_LOG_W(TAG, "Nevrácené sloty: %lx", arena->used);
+    furi_mutex_free(arena->mutex);
+    password_crypto_wipe(arena, sizeof(PasswordArena));
+    free(arena);
+}
+
+void* password_arena_take(PasswordArena* arena, size_t size) {
+    if(size > PASSWORD_ARENA_SLOT_SIZE) return NULL;
+    
+    furi_mutex_acquire(arena->mutex, FuriWaitForever);
+    uint8_t* secret = NULL;
+    for(uint8_t i = 0; i < PASSWORD_ARENA_SLOTS && !secret; i++) {
+        if(arena->used & (1UL << i)) continue;
+        arena->used |= 1UL << i;
+        secret = arena->slots[i];
+    }
+    furi_mutex_release(arena->mutex);
+    
+    if(!secret) {
+        FURI_LOG_E(TAG, "Aréna je plná");
+        return NULL;
+    }
+    // Vrácené sloty jsou přepsané, nula při vydání jen pro jistotu po chybě volajícího
+    password_crypto_wipe(secret, PASSWORD_ARENA_SLOT_SIZE);
+    return secret;
+}
+
+void password_arena_release(PasswordArena* arena, void* secret) {
+    if(!secret) return;
+    
+    size_t slot = ((uint8_t*)secret - &arena->slots[0][0]) / PASSWORD_ARENA_SLOT_SIZE;
+    furi_check(slot < PASSWORD_ARENA_SLOTS && secret == arena->slots[slot]);
+    password_crypto_wipe(secret, PASSWORD_ARENA_SLOT_SIZE);
+    
+    furi_mutex_acquire(arena->mutex, FuriWaitForever);
+    arena->used &= ~(1UL << slot);
+    furi_mutex_release(arena->mutex);
+}
+
+uint8_t password_arena_used(PasswordArena* arena) {
+    furi_mutex_acquire(arena->mutex, FuriWaitForever);
+    uint8_t used = __builtin_popcount(arena->used);
+    furi_mutex_release(arena->mutex);
+    return used;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Aréna tajemství
+ * 
+ * Jediné místo, kde žijí otevřená tajemství aplikace: dešifrované heslo
+ * při zobrazení, heslo v editoru, zadávaný PIN, klíč trezorů a kopie
+ * hesel čekající na napsání. Aréna je pevný blok slotů stejné velikosti
+ * alokovaný jednou při startu (slab s jedinou třídou velikosti), takže
+ * se nefragmentuje a opakované zobrazení a psaní hesel nealokuje
+ * na haldě.
+ * 
+ * Slot se při vydání i vrácení přepíše nulami (password_crypto_wipe),
+ * při uvolnění arény se přepíšou všechny sloty včetně nevrácených.
+ * Aréna je chráněná mutexem, sloty si bere i vlákno workeru psaní.
+ * 
+ * Krátkodobé kopie uvnitř úložiště a importu (na zásobníku nebo ve
+ * struktuře parseru) do arény nepatří: přepisují se hned po použití.
+ */
+
+// Velikost slotu: heslo i s ukončovací nulou, PIN i klíč (PASSWORD_CRYPTO_KEY_SIZE)
+#define PASSWORD_ARENA_SLOT_SIZE 64
+// Počet slotů: buffery aplikace a fronta workeru psaní
+#define PASSWORD_ARENA_SLOTS 12
+
+typedef struct PasswordArena PasswordArena;
+
+/**
+ * @brief Alokuje arénu se všemi sloty volnými
+ * 
+ * @return PasswordArena* Aréna
+ */
+PasswordArena* password_arena_alloc(void);
+
+/**
+ * @brief Přepíše všechny sloty, i nevrácené, a uvolní arénu
+ * 
+ * @param arena Aréna
+ */
+void password_arena_free(PasswordArena* arena);
+
+/**
+ * @brief Vydá vynulovaný slot
+ * 
+ * @param arena Aréna
+ * @param size Potřebná velikost, nejvýš PASSWORD_ARENA_SLOT_SIZE
+ * @return void* Slot, NULL pokud je aréna plná nebo je velikost příliš velká
+ */
+void* password_arena_take(PasswordArena* arena, size_t size);
+
+/**
+ * @brief Přepíše slot a vrátí ho do arény
+ * 
+ * @param arena Aréna
+ * @param secret Slot z password_arena_take, může být NULL
+ */
+void password_arena_release(PasswordArena* arena, void* secret);
+
+/**
+ * @brief Vrátí počet vydaných slotů
+ * 
+ * @param arena Aréna
+ * @return uint8_t Počet vydaných slotů
+ */
+uint8_t password_arena_used(PasswordArena* arena);
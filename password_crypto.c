@@ -0,0 +1,90 @@
+#include "password_crypto.h"
+#include <furi.h>
+#include <furi_hal.h>
+
+#define TAG "PasswordCrypto"
+
+// Vstup a IV pro odvození klíče zařízení, mění se jen se změnou formátu
+static const uint8_t password_crypto_device_iv[16] = {
+    'p', 'w', 'm', '-', 'd', 'e', 'v', 'i', 'c', 'e', '-', 'k', 'e', 'y', '-', '1',
+};
+static const uint8_t password_crypto_device_input[PASSWORD_CRYPTO_KEY_SIZE] = {
+    'f', 'l', 'i', 'p', 'p', 'e', 'r', '-', 'p', 'a', 's', 's', 'w', 'o', 'r', 'd',
+    '-', 'm', 'a', 'n', 'a', 'g', 'e', 'r', '-', 'v', 'a', 'u', 'l', 't', '-', 'k',
+};
+
+bool password_crypto_seal(
+    const uint8_t* key,
+    const char* name,
+    size_t name_length,
+    const char* password,
+    size_t password_length,
+    uint8_t* sealed) {
+    uint8_t* nonce = sealed;
+    uint8_t* ciphertext = sealed + PASSWORD_CRYPTO_NONCE_SIZE;
+    uint8_t* tag = ciphertext + password_length;
+    
+    furi_hal_random_fill_buf(nonce, PASSWORD_CRYPTO_NONCE_SIZE);
+    if(furi_hal_crypto_gcm_encrypt_and_tag(
+           key,
+           nonce,
+           (const uint8_t*)name,
+           name_length,
+           (const uint8_t*)password,
+           ciphertext,
+           password_length,
+           tag) != FuriHalCryptoGCMStateOk) {
+        FURI_LOG_E(TAG, "Šifrování selhalo");
+        password_crypto_wipe(sealed, PASSWORD_CRYPTO_SEALED_SIZE(password_length));
+        return false;
+    }
+    return true;
+}
+
+bool password_crypto_open(
+    const uint8_t* key,
+    const char* name,
+    size_t name_length,
+    const uint8_t* sealed,
+    size_t password_length,
+    char* password) {
+    const uint8_t* nonce = sealed;
+    const uint8_t* ciphertext = sealed + PASSWORD_CRYPTO_NONCE_SIZE;
+    const uint8_t* tag = ciphertext + password_length;
+    
+    if(furi_hal_crypto_gcm_decrypt_and_verify(
+           key,
+           nonce,
+           (const uint8_t*)name,
+           name_length,
+           ciphertext,
+           (uint8_t*)password,
+           password_length,
+           tag) != FuriHalCryptoGCMStateOk) {
+        FURI_LOG_E(TAG, "Heslo nelze ověřit");
+        password_crypto_wipe(password, password_length);
+        password[0] = '\0';
+        return false;
+    }
+    password[password_length] = '\0';
+    return true;
+}
+
+void password_crypto_wipe(void* data, size_t size) {
+    volatile uint8_t* bytes = data;
+    while(size--) *bytes++ = 0;
+}
+
+bool password_crypto_device_key(uint8_t* key) {
+    // Klíč enklávy nejde přečíst, klíč trezoru je zašifrovaný pevný blok
+    if(!furi_hal_crypto_enclave_load_key(
+           FURI_HAL_CRYPTO_ENCLAVE_UNIQUE_KEY_SLOT, password_crypto_device_iv)) {
+        FURI_LOG_E(TAG, "Nelze načíst klíč zařízení");
+        return false;
+    }
+    bool success = furi_hal_crypto_encrypt(
+        password_crypto_device_input, key, PASSWORD_CRYPTO_KEY_SIZE);
+    furi_hal_crypto_enclave_unload_key(FURI_HAL_CRYPTO_ENCLAVE_UNIQUE_KEY_SLOT);
+    if(!success) FURI_LOG_E(TAG, "Odvození klíče zařízení selhalo");
+    return success;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Šifrování hesel po záznamech (AES-256-GCM)
+ * 
+ * Každé heslo je zapečetěné zvlášť s vlastním náhodným nonce:
+ * 
+ *   [nonce 12 B][šifrový text, délka hesla][autentizační značka 16 B]
+ * 
+ * Název záznamu vstupuje jako přidružená data (AAD), zapečetěné heslo
+ * tak nejde bez odhalení přesunout k jinému názvu. Dešifruje se jen
+ * heslo, které je opravdu potřeba, do krátkodobého bufferu.
+ * 
+ * Na zařízení počítá AES hardwarová jednotka (furi_hal_crypto),
+ * hostitelský build ji nahrazuje softwarovou implementací.
+ */
+
+#define PASSWORD_CRYPTO_KEY_SIZE 32
+#define PASSWORD_CRYPTO_NONCE_SIZE 12
+#define PASSWORD_CRYPTO_TAG_SIZE 16
+#define PASSWORD_CRYPTO_OVERHEAD (PASSWORD_CRYPTO_NONCE_SIZE + PASSWORD_CRYPTO_TAG_SIZE)
+
+// Velikost zapečetěného hesla dané délky
+#define PASSWORD_CRYPTO_SEALED_SIZE(length) ((length) + PASSWORD_CRYPTO_OVERHEAD)
+
+/**
+ * @brief Zašifruje heslo a připojí nonce a autentizační značku
+ * 
+ * @param key Klíč (PASSWORD_CRYPTO_KEY_SIZE B)
+ * @param name Název záznamu (přidružená data)
+ * @param name_length Délka názvu
+ * @param password Heslo
+ * @param password_length Délka hesla
+ * @param sealed Výstup, PASSWORD_CRYPTO_SEALED_SIZE(password_length) B
+ * @return true Pokud se šifrování podařilo
+ * @return false Pokud se šifrování nepodařilo
+ */
+bool password_crypto_seal(
+    const uint8_t* key,
+    const char* name,
+    size_t name_length,
+    const char* password,
+    size_t password_length,
+    uint8_t* sealed);
+
+/**
+ * @brief Ověří a dešifruje zapečetěné heslo
+ * 
+ * @param key Klíč (PASSWORD_CRYPTO_KEY_SIZE B)
+ * @param name Název záznamu (přidružená data)
+ * @param name_length Délka názvu
+ * @param sealed Zapečetěné heslo
+ * @param password_length Délka hesla
+ * @param password Výstup, nejméně password_length + 1 B, ukončený nulou
+ * @return true Pokud je heslo pravé a dešifrované
+ * @return false Pokud je heslo poškozené, patří k jinému názvu nebo klíči
+ */
+bool password_crypto_open(
+    const uint8_t* key,
+    const char* name,
+    size_t name_length,
+    const uint8_t* sealed,
+    size_t password_length,
+    char* password);
+
+/**
+ * @brief Přepíše paměť nulami tak, aby zápis překladač nevynechal
+ * 
+ * @param data Paměť
+ * @param size Velikost
+ */
+void password_crypto_wipe(void* data, size_t size);
+
+/**
+ * @brief Odvodí klíč vázaný na zařízení z jedinečného klíče enklávy
+ * 
+ * @param key Výstup (PASSWORD_CRYPTO_KEY_SIZE B)
+ * @return true Pokud se odvození podařilo
+ * @return false Pokud enkláva není dostupná
+ */
+bool password_crypto_device_key(uint8_t* key);
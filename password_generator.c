@@ -0,0 +1,149 @@
+#include "password_generator.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <string.h>
+
+// Pokusů o heslo se všemi třídami; i pro 4 znaky ze 4 tříd uspěje zhruba každý patnáctý
+#define PASSWORD_GENERATOR_ATTEMPTS 256
+
+static const char* const password_generator_lower = "abcdefghijklmnopqrstuvwxyz";
+static const char* const password_generator_upper = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+static const char* const password_generator_digits = "0123456789";
+// Bez uvozovek a zpětného lomítka, které formuláře a CSV rády mění
+static const char* const password_generator_symbols = "!#$%&()*+,-./:;<=>?@[]^_{|}~";
+
+static const struct {
+    PasswordGeneratorClass mask;
+    const char* const* chars;
+    char symbol;
+} password_generator_classes[] = {
+    {PasswordGeneratorClassLower, &password_generator_lower, 'a'},
+    {PasswordGeneratorClassUpper, &password_generator_upper, 'A'},
+    {PasswordGeneratorClassDigits, &password_generator_digits, '1'},
+    {PasswordGeneratorClassSymbols, &password_generator_symbols, '#'},
+};
+
+#define PASSWORD_GENERATOR_CLASS_COUNT \
+    (sizeof(password_generator_classes) / sizeof(password_generator_classes[0]))
+
+void password_generator_init(PasswordGenerator* generator) {
+    memset(generator, 0, sizeof(PasswordGenerator));
+    generator->random_used = PASSWORD_GENERATOR_RANDOM_SIZE;
+}
+
+void password_generator_wipe(PasswordGenerator* generator) {
+    memset(generator->random, 0, sizeof(generator->random));
+    generator->random_used = PASSWORD_GENERATOR_RANDOM_SIZE;
+}
+
+static uint8_t password_generator_byte(PasswordGenerator* generator) {
+    if(generator->random_used >= PASSWORD_GENERATOR_RANDOM_SIZE) {
+        furi_hal_random_fill_buf(generator->random, PASSWORD_GENERATOR_RANDOM_SIZE);
+        generator->random_used = 0;
+        generator->refills++;
+    }
+    uint8_t byte = generator->random[generator->random_used];
+    generator->random[generator->random_used++] = 0;
+    return byte;
+}
+
+uint8_t password_generator_uniform(PasswordGenerator* generator, uint32_t bound) {
+    if(bound <= 1 || bound > 256) return 0;
+    
+    // Největší násobek bound do 256, bajty nad ním by zvýhodnily malá čísla
+    uint32_t limit = 256 - 256 % bound;
+    while(true) {
+        uint32_t byte = password_generator_byte(generator);
+        if(byte < limit) return byte % bound;
+    }
+}
+
+size_t password_generator_alphabet(uint8_t classes, char* alphabet) {
+    size_t size = 0;
+    for(size_t i = 0; i < PASSWORD_GENERATOR_CLASS_COUNT; i++) {
+        if(!(classes & password_generator_classes[i].mask)) continue;
+        const char* chars = *password_generator_classes[i].chars;
+        size_t length = strlen(chars);
+        memcpy(alphabet + size, chars, length);
+        size += length;
+    }
+    alphabet[size] = '\0';
+    return size;
+}
+
+// Maska tříd, do kterých znaky hesla patří
+static uint8_t password_generator_classes_of(const char* password) {
+    uint8_t classes = 0;
+    for(size_t i = 0; i < PASSWORD_GENERATOR_CLASS_COUNT; i++) {
+        if(strpbrk(password, *password_generator_classes[i].chars)) {
+            classes |= password_generator_classes[i].mask;
+        }
+    }
+    return classes;
+}
+
+bool password_generator_generate(
+    PasswordGenerator* generator,
+    const PasswordGeneratorPolicy* policy,
+    char* password,
+    size_t size) {
+    if(policy->length < PASSWORD_GENERATOR_MIN_LENGTH ||
+       policy->length > PASSWORD_GENERATOR_MAX_LENGTH || (size_t)policy->length + 1 > size) {
+        return false;
+    }
+    
+    char alphabet[PASSWORD_GENERATOR_ALPHABET_SIZE];
+    size_t alphabet_size = password_generator_alphabet(policy->classes, alphabet);
+    if(alphabet_size == 0) return false;
+    
+    uint8_t classes = policy->classes & password_generator_classes_of(alphabet);
+    for(uint32_t attempt = 0; attempt < PASSWORD_GENERATOR_ATTEMPTS; attempt++) {
+        for(uint8_t i = 0; i < policy->length; i++) {
+            password[i] = alphabet[password_generator_uniform(generator, alphabet_size)];
+        }
+        password[policy->length] = '\0';
+        
+        if(!policy->require_each || password_generator_classes_of(password) == classes) {
+            return true;
+        }
+    }
+    
+    memset(password, 0, size);
+    return false;
+}
+
+// log2(n) v pevné řádové čárce Q16, bez libm
+static uint32_t password_generator_log2_q16(uint32_t n) {
+    if(n <= 1) return 0;
+    
+    uint32_t result = 0;
+    while((n >> (result + 1)) != 0) result++;
+    
+    // Zbytek po celé části: n / 2^celá v [1, 2), bity dostaneme opakovaným umocněním
+    uint64_t x = ((uint64_t)n << 16) >> result;
+    result <<= 16;
+    for(uint32_t bit = 1 << 15; bit != 0; bit >>= 1) {
+        x = (x * x) >> 16;
+        if(x >= (2 << 16)) {
+            x >>= 1;
+            result |= bit;
+        }
+    }
+    return result;
+}
+
+uint32_t password_generator_entropy(const PasswordGeneratorPolicy* policy) {
+    char alphabet[PASSWORD_GENERATOR_ALPHABET_SIZE];
+    size_t alphabet_size = password_generator_alphabet(policy->classes, alphabet);
+    return (policy->length * password_generator_log2_q16(alphabet_size)) >> 16;
+}
+
+void password_generator_describe(uint8_t classes, char* text) {
+    size_t length = 0;
+    for(size_t i = 0; i < PASSWORD_GENERATOR_CLASS_COUNT; i++) {
+        if(classes & password_generator_classes[i].mask) {
+            text[length++] = password_generator_classes[i].symbol;
+        }
+    }
+    text[length] = '\0';
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "password_storage.h"
+
+/*
+ * Generátor hesel
+ * 
+ * Heslo zvolené délky ze zvolených tříd znaků (malá a velká písmena,
+ * číslice, symboly). Náhodné bajty se berou z hardwarového generátoru
+ * po dávkách PASSWORD_GENERATOR_RANDOM_SIZE B do bufferu, ne jedním
+ * voláním na znak. Znak se vybírá zamítáním: bajt z neúplného posledního
+ * násobku velikosti abecedy se zahodí, takže všechny znaky jsou stejně
+ * pravděpodobné (prosté "bajt % velikost" by první znaky zvýhodnilo).
+ * 
+ * S require_each se heslo, kterému některá zvolená třída chybí, vygeneruje
+ * celé znovu; výsledek je tak rovnoměrný mezi hesly, která podmínku splňují.
+ */
+
+#define PASSWORD_GENERATOR_RANDOM_SIZE 64
+#define PASSWORD_GENERATOR_MIN_LENGTH 4
+#define PASSWORD_GENERATOR_MAX_LENGTH (PASSWORD_MAX_LENGTH - 1)
+// Nejvíc znaků všech tříd dohromady a ukončovací nula
+#define PASSWORD_GENERATOR_ALPHABET_SIZE 96
+
+typedef enum {
+    PasswordGeneratorClassLower = 1 << 0,
+    PasswordGeneratorClassUpper = 1 << 1,
+    PasswordGeneratorClassDigits = 1 << 2,
+    PasswordGeneratorClassSymbols = 1 << 3,
+} PasswordGeneratorClass;
+
+typedef struct {
+    uint8_t length;
+    uint8_t classes; // Maska PasswordGeneratorClass
+    bool require_each; // Každá zvolená třída aspoň jednou
+} PasswordGeneratorPolicy;
+
+typedef struct {
+    uint8_t random[PASSWORD_GENERATOR_RANDOM_SIZE];
+    uint8_t random_used; // Spotřebované bajty bufferu
+    uint32_t refills; // Volání hardwarového generátoru
+} PasswordGenerator;
+
+/**
+ * @brief Připraví generátor s prázdným bufferem
+ * 
+ * @param generator Generátor
+ */
+void password_generator_init(PasswordGenerator* generator);
+
+/**
+ * @brief Přepíše nespotřebované náhodné bajty
+ * 
+ * @param generator Generátor
+ */
+void password_generator_wipe(PasswordGenerator* generator);
+
+/**
+ * @brief Vybere rovnoměrně náhodné číslo zamítáním
+ * 
+ * @param generator Generátor
+ * @param bound Horní mez (1 až 256)
+ * @return uint8_t Číslo z 0 až bound - 1
+ */
+uint8_t password_generator_uniform(PasswordGenerator* generator, uint32_t bound);
+
+/**
+ * @brief Sestaví abecedu ze tříd znaků
+ * 
+ * @param classes Maska PasswordGeneratorClass
+ * @param alphabet Výstup (PASSWORD_GENERATOR_ALPHABET_SIZE B)
+ * @return size_t Počet znaků abecedy
+ */
+size_t password_generator_alphabet(uint8_t classes, char* alphabet);
+
+/**
+ * @brief Vygeneruje heslo podle zásad
+ * 
+ * @param generator Generátor
+ * @param policy Zásady
+ * @param password Výstup
+ * @param size Velikost výstupu, aspoň policy->length + 1
+ * @return true Pokud se heslo vygenerovalo
+ * @return false Pokud jsou zásady neplatné (délka, žádná třída)
+ */
+bool password_generator_generate(
+    PasswordGenerator* generator,
+    const PasswordGeneratorPolicy* policy,
+    char* password,
+    size_t size);
+
+/**
+ * @brief Odhadne entropii hesla podle zásad
+ * 
+ * Délka krát log2 velikosti abecedy; require_each ji nepatrně snižuje,
+ * odhad to zanedbává.
+ * 
+ * @param policy Zásady
+ * @return uint32_t Entropie v bitech (dolů zaokrouhlená)
+ */
+uint32_t password_generator_entropy(const PasswordGeneratorPolicy* policy);
+
+/**
+ * @brief Krátký popis tříd znaků pro displej, např. "aA1#"
+ * 
+ * @param classes Maska PasswordGeneratorClass
+ * @param text Výstup (aspoň 5 B)
+ */
+void password_generator_describe(uint8_t classes, char* text);
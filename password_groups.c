@@ -0,0 +1,193 @@
+#include "password_groups.h"
+#include <furi.h>
+#include <storage/storage.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TAG "PasswordGroups"
+
+#define PASSWORD_GROUPS_TEMP_SUFFIX ".tmp"
+// Řádek manifestu: id, počet, název a oddělovače
+#define PASSWORD_GROUPS_LINE_SIZE (PASSWORD_GROUP_NAME_SIZE + 16)
+#define PASSWORD_GROUPS_FILE_SIZE (PASSWORD_GROUPS_MAX * PASSWORD_GROUPS_LINE_SIZE)
+
+void password_groups_init(PasswordGroups* groups) {
+    memset(groups, 0, sizeof(PasswordGroups));
+    groups->groups[0].id = PASSWORD_GROUP_DEFAULT_ID;
+    groups->count = 1;
+}
+
+// Zkopíruje název, delší se zkrátí po celých znacích UTF-8
+static void password_groups_copy_name(char* out, const char* name, size_t length) {
+    if(length >= PASSWORD_GROUP_NAME_SIZE) {
+        length = PASSWORD_GROUP_NAME_SIZE - 1;
+        while(length > 0 && ((uint8_t)name[length] & 0xC0) == 0x80) length--;
+    }
+    memcpy(out, name, length);
+    out[length] = '\0';
+}
+
+// Načte řádek "<id>\t<počet>\t<název>", výchozí skupina přepíše jen počet
+static void password_groups_parse_line(PasswordGroups* groups, char* line) {
+    char* end;
+    unsigned long id = strtoul(line, &end, 10);
+    if(end == line || *end != '\t' || id > UINT8_MAX) return;
+    unsigned long count = strtoul(end + 1, &end, 10);
+    if(*end != '\t') return;
+    const char* name = end + 1;
+    
+    if(id == PASSWORD_GROUP_DEFAULT_ID) {
+        groups->groups[0].count = count;
+        return;
+    }
+    
+    // Duplicitní id nebo název by ukazovaly na stejný trezor
+    uint8_t index;
+    if(name[0] == '\0' || groups->count == PASSWORD_GROUPS_MAX ||
+       password_groups_find(groups, name, &index)) {
+        return;
+    }
+    for(uint8_t i = 0; i < groups->count; i++) {
+        if(groups->groups[i].id == id) return;
+    }
+    
+    PasswordGroup* group = &groups->groups[groups->count++];
+    group->id = id;
+    group->count = count;
+    password_groups_copy_name(group->name, name, strlen(name));
+}
+
+static bool password_groups_read(PasswordGroups* groups, Storage* storage, const char* path) {
+    File* file = storage_file_alloc(storage);
+    bool success = storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING);
+    if(success) {
+        char* data = malloc(PASSWORD_GROUPS_FILE_SIZE + 1);
+        size_t size = storage_file_read(file, data, PASSWORD_GROUPS_FILE_SIZE);
+        data[size] = '\0';
+        
+        for(char* line = data; *line;) {
+            char* next = line + strcspn(line, "\n");
+            bool last = *next == '\0';
+            *next = '\0';
+            if(next > line && next[-1] == '\r') next[-1] = '\0';
+            password_groups_parse_line(groups, line);
+            line = last ? next : next + 1;
+        }
+        free(data);
+    }
+    storage_file_free(file);
+    return success;
+}
+
+bool password_groups_load(PasswordGroups* groups, const char* path) {
+    password_groups_init(groups);
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FuriString* temp_path = furi_string_alloc_printf("%s%s", path, PASSWORD_GROUPS_TEMP_SUFFIX);
+    
+    // Výpadek mezi smazáním starého a přejmenováním nového manifestu nechá jen ".tmp"
+    bool success = true;
+    if(storage_file_exists(storage, path)) {
+        success = password_groups_read(groups, storage, path);
+    } else if(storage_file_exists(storage, furi_string_get_cstr(temp_path))) {
+        success = password_groups_read(groups, storage, furi_string_get_cstr(temp_path));
+        groups->dirty = success;
+    }
+    
+    furi_string_free(temp_path);
+    furi_record_close(RECORD_STORAGE);
+    
+    if(!success) FURI_LOG_E(TAG, "Nelze načíst %s", path);
+    FURI_LOG_I(TAG, "Načteno %u skupin", groups->count);
+    return success;
+}
+
+bool password_groups_save(PasswordGroups* groups, const char* path) {
+    if(!groups->dirty) return true;
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FuriString* temp_path = furi_string_alloc_printf("%s%s", path, PASSWORD_GROUPS_TEMP_SUFFIX);
+    FuriString* line = furi_string_alloc();
+    File* file = storage_file_alloc(storage);
+    
+    bool success = storage_file_open(file, furi_string_get_cstr(temp_path), FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    for(uint8_t i = 0; success && i < groups->count; i++) {
+        const PasswordGroup* group = &groups->groups[i];
+        furi_string_printf(line, "%u\t%lu\t%s\n", group->id, group->count, group->name);
+        size_t size = furi_string_size(line);
+        success = storage_file_write(file, furi_string_get_cstr(line), size) == size;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    
+    // Nový manifest nahradí starý, až je celý zapsaný
+    if(success) {
+        storage_common_remove(storage, path);
+        success = storage_common_rename(storage, furi_string_get_cstr(temp_path), path) == FSE_OK;
+    }
+    if(success) {
+        groups->dirty = false;
+    } else {
+        FURI_LOG_E(TAG, "Nelze zapsat %s", path);
+    }
+    
+    furi_string_free(line);
+    furi_string_free(temp_path);
+    furi_record_close(RECORD_STORAGE);
+    return success;
+}
+
+bool password_groups_find(const PasswordGroups* groups, const char* name, uint8_t* index) {
+    for(uint8_t i = 0; i < groups->count; i++) {
+        if(strcmp(groups->groups[i].name, name) == 0) {
+            *index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool password_groups_add(PasswordGroups* groups, const char* name, uint8_t* index) {
+    // Název se porovnává zkrácený, stejně jak se uloží
+    char key[PASSWORD_GROUP_NAME_SIZE];
+    password_groups_copy_name(key, name, strlen(name));
+    if(password_groups_find(groups, key, index)) return true;
+    if(groups->count == PASSWORD_GROUPS_MAX) {
+        FURI_LOG_E(TAG, "Příliš mnoho skupin");
+        return false;
+    }
+    
+    // Nové id je o jedna větší než největší, trezor smazané skupiny se tak nepoužije znovu
+    uint8_t id = PASSWORD_GROUP_DEFAULT_ID;
+    for(uint8_t i = 0; i < groups->count; i++) id = MAX(id, groups->groups[i].id);
+    if(id == UINT8_MAX) return false;
+    
+    *index = groups->count++;
+    PasswordGroup* group = &groups->groups[*index];
+    group->id = id + 1;
+    group->count = 0;
+    strlcpy(group->name, key, sizeof(group->name));
+    groups->dirty = true;
+    FURI_LOG_I(TAG, "Nová skupina %s", group->name);
+    return true;
+}
+
+void password_groups_set_count(PasswordGroups* groups, uint8_t index, uint32_t count) {
+    if(index >= groups->count || groups->groups[index].count == count) return;
+    groups->groups[index].count = count;
+    groups->dirty = true;
+}
+
+void password_groups_vault_path(
+    const PasswordGroups* groups,
+    uint8_t index,
+    const char* default_path,
+    const char* directory,
+    char* buffer,
+    size_t size) {
+    if(index == 0 || index >= groups->count) {
+        strlcpy(buffer, default_path, size);
+    } else {
+        snprintf(buffer, size, "%s/%u.pwv", directory, groups->groups[index].id);
+    }
+}
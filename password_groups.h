@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Skupiny hesel (např. práce, osobní, infrastruktura)
+ * 
+ * Každá skupina je samostatný trezor (shard) ve formátu password_vault_format.h
+ * s vlastním žurnálem, výchozí skupina je hlavní trezor aplikace. Seznam
+ * skupin s počty hesel drží malý textový manifest, jeden řádek na skupinu:
+ * 
+ *   <id>\t<počet hesel>\t<název>
+ * 
+ * Při startu se čte jen manifest. Trezor skupiny se načte až při vstupu
+ * do ní a při odchodu se zase uvolní, paměť tak závisí na zobrazené skupině,
+ * ne na celém obsahu karty. Id skupiny určuje název souboru
+ * (<adresář>/<id>.pwv), název skupiny tak může obsahovat cokoli kromě
+ * konce řádku. Vnořené složky exportu mají jako název celou cestu
+ * ("Práce/Infra"), stejně pojmenované podsložky tak zůstanou oddělené.
+ * Manifest se zapisuje přes "<cesta>.tmp".
+ */
+
+#define PASSWORD_GROUPS_MAX 16
+// Velikost názvu skupiny včetně ukončovací nuly, delší se zkrátí po celých znacích UTF-8
+#define PASSWORD_GROUP_NAME_SIZE 48
+// Id výchozí skupiny (hlavní trezor)
+#define PASSWORD_GROUP_DEFAULT_ID 0
+
+typedef struct {
+    uint8_t id;
+    uint32_t count; // Počet hesel při posledním uvolnění trezoru skupiny
+    char name[PASSWORD_GROUP_NAME_SIZE];
+} PasswordGroup;
+
+typedef struct {
+    PasswordGroup groups[PASSWORD_GROUPS_MAX]; // Výchozí skupina je vždy první
+    uint8_t count;
+    bool dirty; // Manifest se změnil od načtení nebo uložení
+} PasswordGroups;
+
+/**
+ * @brief Inicializuje seznam jen s výchozí skupinou
+ * 
+ * @param groups Skupiny
+ */
+void password_groups_init(PasswordGroups* groups);
+
+/**
+ * @brief Načte manifest
+ * 
+ * Chybějící manifest znamená jen výchozí skupinu. Neplatné řádky se přeskočí.
+ * 
+ * @param groups Skupiny
+ * @param path Cesta k manifestu
+ * @return true Pokud se manifest načetl nebo neexistuje
+ * @return false Pokud manifest nejde přečíst
+ */
+bool password_groups_load(PasswordGroups* groups, const char* path);
+
+/**
+ * @brief Zapíše manifest, pokud se změnil
+ * 
+ * @param groups Skupiny
+ * @param path Cesta k manifestu
+ * @return true Pokud je manifest na kartě aktuální
+ * @return false Pokud se zápis nepodařil
+ */
+bool password_groups_save(PasswordGroups* groups, const char* path);
+
+/**
+ * @brief Najde skupinu podle přesného názvu
+ * 
+ * @param groups Skupiny
+ * @param name Název, prázdný je výchozí skupina
+ * @param index Výstup, pořadí skupiny
+ * @return true Pokud skupina existuje
+ * @return false Pokud skupina neexistuje
+ */
+bool password_groups_find(const PasswordGroups* groups, const char* name, uint8_t* index);
+
+/**
+ * @brief Najde skupinu, chybějící založí (zatím bez trezoru)
+ * 
+ * @param groups Skupiny
+ * @param name Název, prázdný je výchozí skupina
+ * @param index Výstup, pořadí skupiny
+ * @return true Pokud skupina existuje nebo se založila
+ * @return false Pokud už je skupin PASSWORD_GROUPS_MAX
+ */
+bool password_groups_add(PasswordGroups* groups, const char* name, uint8_t* index);
+
+/**
+ * @brief Zaznamená počet hesel skupiny
+ * 
+ * @param groups Skupiny
+ * @param index Pořadí skupiny
+ * @param count Počet hesel
+ */
+void password_groups_set_count(PasswordGroups* groups, uint8_t index, uint32_t count);
+
+/**
+ * @brief Sestaví cestu k trezoru skupiny
+ * 
+ * @param groups Skupiny
+ * @param index Pořadí skupiny
+ * @param default_path Cesta k trezoru výchozí skupiny
+ * @param directory Adresář trezorů ostatních skupin
+ * @param buffer Výstup, cesta
+ * @param size Velikost bufferu
+ */
+void password_groups_vault_path(
+    const PasswordGroups* groups,
+    uint8_t index,
+    const char* default_path,
+    const char* directory,
+    char* buffer,
+    size_t size);
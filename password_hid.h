@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Přenos stisků kláves do počítače
+ * 
+ * Psaní hesla (password_keyboard.c) neví, kudy stisky jdou, volá jen
+ * funkce přenosu. Přenos se zapne jednou na celou relaci aplikace a při
+ * ukončení vrátí rozhraní do původního stavu: přepnutí USB do režimu HID
+ * znamená nové vyjmenování zařízení na počítači (kolem sekundy), které se
+ * tak neplatí při každém odeslání.
+ * 
+ * Přenosy jsou jedináčci, stav drží každý ve svém souboru. Hostitelský
+ * build má navíc přenos, který reporty jen zaznamenává (host/password_hid_mock.h).
+ */
+
+typedef struct {
+    const char* name; // Název pro zobrazení
+
+    /**
+     * @brief Zapne přenos, rozhraní zůstane v režimu HID do stop
+     *
+     * @return true Pokud se přenos zapnul
+     */
+    bool (*start)(void);
+
+    /** @brief Vypne přenos a vrátí rozhraní do stavu před start */
+    void (*stop)(void);
+
+    /** @brief Zda počítač přenos přijal a stisky dojdou */
+    bool (*is_connected)(void);
+
+    /**
+     * @brief Stiskne klávesu, dříve stisknuté zůstanou držené
+     *
+     * @param modifier Bity modifikátorů HID reportu
+     * @param keycode Kód klávesy dle HID Usage Tables
+     * @return true Pokud se report odeslal
+     */
+    bool (*press)(uint8_t modifier, uint8_t keycode);
+
+    /**
+     * @brief Pustí všechny klávesy i modifikátory jedním reportem
+     *
+     * @return true Pokud se report odeslal
+     */
+    bool (*release_all)(void);
+} PasswordHidTransport;
+
+// USB HID klávesnice, při stop se obnoví předchozí konfigurace USB
+extern const PasswordHidTransport password_hid_usb;
+
+// Bluetooth LE HID klávesnice s vlastním úložištěm párovacích klíčů,
+// při stop se obnoví výchozí profil Bluetooth
+extern const PasswordHidTransport password_hid_ble;
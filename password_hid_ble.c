@@ -0,0 +1,84 @@
+#include "password_hid.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <bt/bt_service/bt.h>
+#include <extra_profiles/hid_profile.h>
+#include <storage/storage.h>
+
+#define TAG "PasswordHidBle"
+
+// Párování s počítačem se ukládá zvlášť, systémové párování zůstane beze změny
+#define PASSWORD_HID_BLE_KEYS_PATH APP_DATA_PATH(".bt_hid.keys")
+// Čas na odpojení před změnou profilu
+#define PASSWORD_HID_BLE_DISCONNECT_MS 200
+
+static Bt* password_hid_ble_bt = NULL;
+static FuriHalBleProfileBase* password_hid_ble_profile = NULL;
+static volatile bool password_hid_ble_connected = false;
+
+static void password_hid_ble_status_changed(BtStatus status, void* context) {
+    UNUSED(context);
+    password_hid_ble_connected = status == BtStatusConnected;
+}
+
+static bool password_hid_ble_start(void) {
+    if(password_hid_ble_profile) return true;
+    
+    password_hid_ble_bt = furi_record_open(RECORD_BT);
+    bt_disconnect(password_hid_ble_bt);
+    furi_delay_ms(PASSWORD_HID_BLE_DISCONNECT_MS);
+    bt_keys_storage_set_storage_path(password_hid_ble_bt, PASSWORD_HID_BLE_KEYS_PATH);
+    
+    password_hid_ble_profile = bt_profile_start(password_hid_ble_bt, ble_profile_hid, NULL);
+    if(!password_hid_ble_profile) {
+        FURI_LOG_E(TAG, "Nelze spustit profil HID");
+        bt_keys_storage_set_default_path(password_hid_ble_bt);
+        furi_record_close(RECORD_BT);
+        password_hid_ble_bt = NULL;
+        return false;
+    }
+    
+    password_hid_ble_connected = false;
+    bt_set_status_changed_callback(password_hid_ble_bt, password_hid_ble_status_changed, NULL);
+    furi_hal_bt_start_advertising();
+    FURI_LOG_I(TAG, "Bluetooth v režimu HID");
+    return true;
+}
+
+static void password_hid_ble_stop(void) {
+    if(!password_hid_ble_profile) return;
+    
+    ble_profile_hid_kb_release_all(password_hid_ble_profile);
+    bt_set_status_changed_callback(password_hid_ble_bt, NULL, NULL);
+    bt_disconnect(password_hid_ble_bt);
+    furi_delay_ms(PASSWORD_HID_BLE_DISCONNECT_MS);
+    bt_keys_storage_set_default_path(password_hid_ble_bt);
+    if(!bt_profile_restore_default(password_hid_ble_bt)) {
+        FURI_LOG_E(TAG, "Nelze obnovit výchozí profil Bluetooth");
+    }
+    furi_record_close(RECORD_BT);
+    password_hid_ble_bt = NULL;
+    password_hid_ble_profile = NULL;
+    password_hid_ble_connected = false;
+}
+
+static bool password_hid_ble_is_connected(void) {
+    return password_hid_ble_profile && password_hid_ble_connected;
+}
+
+static bool password_hid_ble_press(uint8_t modifier, uint8_t keycode) {
+    return ble_profile_hid_kb_press(password_hid_ble_profile, keycode | (modifier << 8));
+}
+
+static bool password_hid_ble_release_all(void) {
+    return ble_profile_hid_kb_release_all(password_hid_ble_profile);
+}
+
+const PasswordHidTransport password_hid_ble = {
+    .name = "BLE",
+    .start = password_hid_ble_start,
+    .stop = password_hid_ble_stop,
+    .is_connected = password_hid_ble_is_connected,
+    .press = password_hid_ble_press,
+    .release_all = password_hid_ble_release_all,
+};
@@ -0,0 +1,56 @@
+#include "password_hid.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <furi_hal_usb.h>
+#include <furi_hal_usb_hid.h>
+
+#define TAG "PasswordHidUsb"
+
+// Konfigurace USB před zapnutím přenosu (typicky CDC pro qFlipper)
+static FuriHalUsbInterface* password_hid_usb_previous = NULL;
+
+static bool password_hid_usb_start(void) {
+    if(password_hid_usb_previous) return true;
+    
+    password_hid_usb_previous = furi_hal_usb_get_config();
+    furi_hal_usb_unlock();
+    if(!furi_hal_usb_set_config(&usb_hid, NULL)) {
+        FURI_LOG_E(TAG, "Nelze přepnout USB do režimu HID");
+        password_hid_usb_previous = NULL;
+        return false;
+    }
+    FURI_LOG_I(TAG, "USB v režimu HID");
+    return true;
+}
+
+static void password_hid_usb_stop(void) {
+    if(!password_hid_usb_previous) return;
+    
+    furi_hal_hid_kb_release_all();
+    if(!furi_hal_usb_set_config(password_hid_usb_previous, NULL)) {
+        FURI_LOG_E(TAG, "Nelze obnovit konfiguraci USB");
+    }
+    password_hid_usb_previous = NULL;
+}
+
+static bool password_hid_usb_is_connected(void) {
+    return password_hid_usb_previous && furi_hal_hid_is_connected();
+}
+
+static bool password_hid_usb_press(uint8_t modifier, uint8_t keycode) {
+    // Firmware má modifikátory v horním bajtu kódu (KEY_MOD_*)
+    return furi_hal_hid_kb_press(keycode | (modifier << 8));
+}
+
+static bool password_hid_usb_release_all(void) {
+    return furi_hal_hid_kb_release_all();
+}
+
+const PasswordHidTransport password_hid_usb = {
+    .name = "USB",
+    .start = password_hid_usb_start,
+    .stop = password_hid_usb_stop,
+    .is_connected = password_hid_usb_is_connected,
+    .press = password_hid_usb_press,
+    .release_all = password_hid_usb_release_all,
+};
@@ -0,0 +1,850 @@
+#include "password_import.h"
+#include "password_crypto.h"
+#include "password_groups.h"
+#include "password_totp.h"
+#include <furi.h>
+#include <storage/storage.h>
+#include <string.h>
+
+#define TAG "PasswordImport"
+
+// Klíče (hlavičky CSV, klíče JSON, řetězce KeePass) delší než tato mez se s ničím neshodují
+#define PASSWORD_IMPORT_KEY_SIZE 24
+// Tajemství TOTP: Base32 nebo URI otpauth s parametry
+#define PASSWORD_IMPORT_TOTP_SIZE 160
+#define PASSWORD_IMPORT_TAG_SIZE 16
+// Escape sekvence: entita XML ("#x10FFFF") nebo \uXXXX
+#define PASSWORD_IMPORT_ESCAPE_SIZE 10
+#define PASSWORD_IMPORT_NO_COLUMN 0xFF
+// Vnoření skupin KeePassu, hlubší skupiny patří pod nejhlubší zapamatovanou
+#define PASSWORD_IMPORT_GROUP_DEPTH 4
+
+typedef enum {
+    PasswordImportTargetNone,
+    PasswordImportTargetName,
+    PasswordImportTargetPassword,
+    PasswordImportTargetGroup,
+    PasswordImportTargetTotp,
+    PasswordImportTargetKey,
+} PasswordImportTarget;
+
+typedef enum {
+    // CSV
+    PasswordImportStateFieldStart,
+    PasswordImportStateUnquoted,
+    PasswordImportStateQuoted,
+    PasswordImportStateQuotedQuote, // Uvozovka v poli s uvozovkami: konec pole nebo ""
+    // XML
+    PasswordImportStateText,
+    PasswordImportStateEntity,
+    PasswordImportStateTagStart,
+    PasswordImportStateTagName,
+    PasswordImportStateTagAttributes,
+    PasswordImportStateTagSkip, // <?...?>, <!...>
+    // JSON
+    PasswordImportStateValue,
+    PasswordImportStateString,
+    PasswordImportStateStringEscape,
+    PasswordImportStateStringUnicode,
+    PasswordImportStateLiteral,
+} PasswordImportState;
+
+struct PasswordImport {
+    PasswordImportFormat format;
+    PasswordImportState state;
+    PasswordImportResult result;
+    PasswordImportEntryCallback callback;
+    void* context;
+    uint32_t imported;
+    uint32_t skipped;
+    uint8_t bom; // Přeskočené bajty UTF-8 BOM na začátku
+    bool started; // Formát je určený, automat běží
+    
+    // Právě čtený záznam
+    char name[NAME_MAX_LENGTH];
+    uint8_t name_length;
+    char password[PASSWORD_MAX_LENGTH];
+    uint8_t password_length;
+    bool password_overflow;
+    char totp[PASSWORD_IMPORT_TOTP_SIZE];
+    uint8_t totp_length;
+    bool totp_overflow;
+    char group[PASSWORD_GROUP_NAME_SIZE];
+    uint8_t group_length;
+    uint8_t group_separators; // Oddělovače cesty skupiny v CSV
+    bool group_full;
+    bool in_record;
+    
+    // Kam jdou znaky právě čteného textu
+    PasswordImportTarget target;
+    char key[PASSWORD_IMPORT_KEY_SIZE];
+    uint8_t key_length;
+    bool key_overflow;
+    char escape[PASSWORD_IMPORT_ESCAPE_SIZE];
+    uint8_t escape_length;
+    uint16_t high_surrogate;
+    
+    // CSV
+    uint8_t column;
+    uint8_t name_column;
+    uint8_t password_column;
+    uint8_t group_column;
+    uint8_t totp_column;
+    bool group_root; // Cesta skupiny začíná kořenem databáze (KeePass)
+    bool header;
+    bool row_data;
+    
+    // KeePass XML
+    char tag[PASSWORD_IMPORT_TAG_SIZE];
+    uint8_t tag_length;
+    bool tag_closing;
+    bool tag_empty;
+    char attribute_quote;
+    uint8_t history_depth;
+    uint8_t group_depth;
+    char groups[PASSWORD_IMPORT_GROUP_DEPTH][PASSWORD_GROUP_NAME_SIZE];
+    
+    // Bitwarden JSON: hloubka vnoření, bit i v objects = úroveň i + 1 je objekt
+    uint8_t depth;
+    uint32_t objects;
+    bool expect_key;
+    uint8_t items_depth; // Pole items
+    uint8_t item_depth; // Objekt položky
+    uint8_t login_depth; // Objekt login položky
+};
+
+// Záznam a zápis
+
+static void password_import_record_begin(PasswordImport* import) {
+    password_crypto_wipe(import->password, sizeof(import->password));
+    password_crypto_wipe(import->totp, sizeof(import->totp));
+    import->name_length = 0;
+    import->password_length = 0;
+    import->password_overflow = false;
+    import->totp_length = 0;
+    import->totp_overflow = false;
+    import->group_length = 0;
+    import->group_separators = 0;
+    import->group_full = false;
+    import->in_record = true;
+}
+
+// Předá úplný záznam callbacku, neúplný přeskočí
+static void password_import_record_end(PasswordImport* import) {
+    if(!import->in_record) return;
+    import->in_record = false;
+    import->name[import->name_length] = '\0';
+    import->password[import->password_length] = '\0';
+    
+    // Skupina z CSV KeePassu bez dalšího oddělovače je kořen databáze
+    if(import->group_root && import->group_separators == 0) import->group_length = 0;
+    while(import->group_length > 0 && import->group[import->group_length - 1] == '/') import->group_length--;
+    import->group[import->group_length] = '\0';
+    
+    PasswordImportEntryResult result = PasswordImportEntrySkipped;
+    if(import->name_length > 0 && import->password_length > 0 && !import->password_overflow) {
+        // Tajemství TOTP, které je neplatné nebo se k heslu nevejde, se vynechá
+        import->totp[import->totp_length] = '\0';
+        if(import->totp_length > 0 && !import->totp_overflow) {
+            password_totp_append(import->password, sizeof(import->password), import->totp);
+        }
+        result = import->callback(import->group, import->name, import->password, import->context);
+    }
+    password_crypto_wipe(import->password, sizeof(import->password));
+    password_crypto_wipe(import->totp, sizeof(import->totp));
+    
+    if(result == PasswordImportEntryAdded) {
+        import->imported++;
+    } else if(result == PasswordImportEntrySkipped) {
+        import->skipped++;
+    } else {
+        import->result = PasswordImportResultWriteFailed;
+    }
+}
+
+// Připíše bajt do textu délky size, zkrácený text nesmí končit půlkou znaku UTF-8
+static bool password_import_put_text(char* text, uint8_t* length, size_t size, uint8_t c) {
+    if(*length < size - 1) {
+        text[(*length)++] = c;
+        return true;
+    }
+    while(*length > 0 && (text[*length - 1] & 0xC0) == 0x80) (*length)--;
+    if(*length > 0 && (text[*length - 1] & 0x80)) (*length)--;
+    return false;
+}
+
+// Připíše bajt textu do cíle: název se zkrátí, heslo příliš dlouhé označí záznam k přeskočení
+static void password_import_put(PasswordImport* import, uint8_t c) {
+    switch(import->target) {
+        case PasswordImportTargetName:
+            if(!password_import_put_text(import->name, &import->name_length, NAME_MAX_LENGTH, c)) {
+                import->target = PasswordImportTargetNone;
+            }
+            break;
+        case PasswordImportTargetPassword:
+            if(import->password_length < PASSWORD_MAX_LENGTH - 1) {
+                import->password[import->password_length++] = c;
+            } else {
+                import->password_overflow = true;
+            }
+            break;
+        case PasswordImportTargetTotp:
+            if(import->totp_length < PASSWORD_IMPORT_TOTP_SIZE - 1) {
+                import->totp[import->totp_length++] = c;
+            } else {
+                import->totp_overflow = true;
+            }
+            break;
+        case PasswordImportTargetGroup:
+            // Cesta skupiny v CSV ("Root/Práce/Infra") zůstane celá s oddělovačem '/', bez kořene KeePassu
+            if(import->format == PasswordImportFormatCsv && (c == '/' || c == '\\')) {
+                if(import->group_root && import->group_separators == 0) {
+                    import->group_length = 0;
+                    import->group_full = false;
+                } else if(
+                    !import->group_full && import->group_length > 0 &&
+                    import->group[import->group_length - 1] != '/') {
+                    import->group_full = !password_import_put_text(
+                        import->group, &import->group_length, sizeof(import->group), '/');
+                }
+                if(import->group_separators < UINT8_MAX) import->group_separators++;
+            } else if(!import->group_full) {
+                import->group_full = !password_import_put_text(
+                    import->group, &import->group_length, sizeof(import->group), c);
+            }
+            break;
+        case PasswordImportTargetKey:
+            if(import->key_length < PASSWORD_IMPORT_KEY_SIZE - 1) {
+                import->key[import->key_length++] = c;
+            } else {
+                import->key_overflow = true;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Připíše znak Unicode jako UTF-8
+static void password_import_put_codepoint(PasswordImport* import, uint32_t codepoint) {
+    if(codepoint < 0x80) {
+        password_import_put(import, codepoint);
+    } else if(codepoint < 0x800) {
+        password_import_put(import, 0xC0 | (codepoint >> 6));
+        password_import_put(import, 0x80 | (codepoint & 0x3F));
+    } else if(codepoint < 0x10000) {
+        password_import_put(import, 0xE0 | (codepoint >> 12));
+        password_import_put(import, 0x80 | ((codepoint >> 6) & 0x3F));
+        password_import_put(import, 0x80 | (codepoint & 0x3F));
+    } else if(codepoint < 0x110000) {
+        password_import_put(import, 0xF0 | (codepoint >> 18));
+        password_import_put(import, 0x80 | ((codepoint >> 12) & 0x3F));
+        password_import_put(import, 0x80 | ((codepoint >> 6) & 0x3F));
+        password_import_put(import, 0x80 | (codepoint & 0x3F));
+    }
+}
+
+static void password_import_key_begin(PasswordImport* import) {
+    import->target = PasswordImportTargetKey;
+    import->key_length = 0;
+    import->key_overflow = false;
+}
+
+// Porovná přečtený klíč (bez ohledu na velikost písmen u CSV)
+static bool password_import_key_is(PasswordImport* import, const char* key) {
+    if(import->key_overflow || strlen(key) != import->key_length) return false;
+    if(import->format == PasswordImportFormatCsv) {
+        return strncasecmp(import->key, key, import->key_length) == 0;
+    }
+    return strncmp(import->key, key, import->key_length) == 0;
+}
+
+// CSV
+
+static void password_import_csv_field_end(PasswordImport* import) {
+    if(import->header) {
+        if(password_import_key_is(import, "name") || password_import_key_is(import, "title") ||
+           password_import_key_is(import, "account")) {
+            if(import->name_column == PASSWORD_IMPORT_NO_COLUMN) import->name_column = import->column;
+        } else if(
+            password_import_key_is(import, "group") || password_import_key_is(import, "folder") ||
+            password_import_key_is(import, "grouping")) {
+            if(import->group_column == PASSWORD_IMPORT_NO_COLUMN) {
+                import->group_column = import->column;
+                import->group_root = password_import_key_is(import, "group");
+            }
+        } else if(
+            password_import_key_is(import, "password") ||
+            password_import_key_is(import, "login_password")) {
+            if(import->password_column == PASSWORD_IMPORT_NO_COLUMN) {
+                import->password_column = import->column;
+            }
+        } else if(
+            password_import_key_is(import, "totp") || password_import_key_is(import, "otp") ||
+            password_import_key_is(import, "login_totp")) {
+            if(import->totp_column == PASSWORD_IMPORT_NO_COLUMN) import->totp_column = import->column;
+        }
+    }
+    if(import->column < PASSWORD_IMPORT_NO_COLUMN - 1) import->column++;
+    import->target = PasswordImportTargetNone;
+    import->state = PasswordImportStateFieldStart;
+}
+
+static void password_import_csv_row_end(PasswordImport* import) {
+    password_import_csv_field_end(import);
+    if(import->header) {
+        import->header = false;
+        if(import->name_column == PASSWORD_IMPORT_NO_COLUMN ||
+           import->password_column == PASSWORD_IMPORT_NO_COLUMN) {
+            FURI_LOG_E(TAG, "CSV bez sloupce názvu nebo hesla");
+            import->result = PasswordImportResultUnknownFormat;
+        }
+    } else if(import->row_data) {
+        password_import_record_end(import);
+    }
+    import->in_record = false;
+    import->column = 0;
+    import->row_data = false;
+}
+
+// Začátek pole: podle sloupce se určí, kam jdou jeho znaky
+static void password_import_csv_field_begin(PasswordImport* import) {
+    if(import->header) {
+        password_import_key_begin(import);
+        return;
+    }
+    if(!import->in_record) password_import_record_begin(import);
+    if(import->column == import->name_column) {
+        import->target = PasswordImportTargetName;
+    } else if(import->column == import->password_column) {
+        import->target = PasswordImportTargetPassword;
+    } else if(import->column == import->group_column) {
+        import->target = PasswordImportTargetGroup;
+    } else if(import->column == import->totp_column) {
+        import->target = PasswordImportTargetTotp;
+    } else {
+        import->target = PasswordImportTargetNone;
+    }
+}
+
+static void password_import_csv(PasswordImport* import, uint8_t c) {
+    switch(import->state) {
+        case PasswordImportStateFieldStart:
+            if(c == '\r') break;
+            if(c == '\n') {
+                // Prázdný řádek nic neobsahuje
+                if(import->column > 0 || import->row_data) password_import_csv_row_end(import);
+                break;
+            }
+            import->row_data = true;
+            password_import_csv_field_begin(import);
+            if(c == '"') {
+                import->state = PasswordImportStateQuoted;
+            } else if(c == ',') {
+                password_import_csv_field_end(import);
+            } else {
+                password_import_put(import, c);
+                import->state = PasswordImportStateUnquoted;
+            }
+            break;
+        case PasswordImportStateUnquoted:
+            if(c == ',') {
+                password_import_csv_field_end(import);
+            } else if(c == '\n') {
+                password_import_csv_row_end(import);
+            } else if(c != '\r') {
+                password_import_put(import, c);
+            }
+            break;
+        case PasswordImportStateQuoted:
+            if(c == '"') {
+                import->state = PasswordImportStateQuotedQuote;
+            } else {
+                password_import_put(import, c);
+            }
+            break;
+        case PasswordImportStateQuotedQuote:
+            if(c == '"') {
+                password_import_put(import, c);
+                import->state = PasswordImportStateQuoted;
+            } else if(c == ',') {
+                password_import_csv_field_end(import);
+            } else if(c == '\n') {
+                password_import_csv_row_end(import);
+            } else if(c != '\r') {
+                // Text za uzavírací uvozovkou (nepřesné CSV) patří k poli
+                password_import_put(import, c);
+                import->state = PasswordImportStateUnquoted;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// KeePass XML
+
+static bool password_import_tag_is(PasswordImport* import, const char* tag) {
+    return strlen(tag) == import->tag_length && strncmp(import->tag, tag, import->tag_length) == 0;
+}
+
+// Přečtený tag: otevírá nebo uzavírá položku, historii, klíč nebo hodnotu řetězce
+static void password_import_xml_tag(PasswordImport* import) {
+    bool opening = !import->tag_closing;
+    bool closing = import->tag_closing || import->tag_empty;
+    bool entry = import->in_record && import->history_depth == 0;
+    
+    if(password_import_tag_is(import, "Entry")) {
+        if(opening && !import->in_record) {
+            // Položky přímo v kořeni databáze patří do výchozí skupiny
+            password_import_record_begin(import);
+            if(import->group_depth > 1) {
+                uint8_t depth = MIN(import->group_depth, PASSWORD_IMPORT_GROUP_DEPTH);
+                import->group_length = strlen(import->groups[depth - 1]);
+                memcpy(import->group, import->groups[depth - 1], import->group_length);
+            }
+        }
+        if(closing && entry) password_import_record_end(import);
+    } else if(password_import_tag_is(import, "Group") && !import->in_record) {
+        if(opening && import->group_depth < UINT8_MAX) {
+            import->group_depth++;
+            uint8_t depth = import->group_depth;
+            if(depth <= PASSWORD_IMPORT_GROUP_DEPTH) {
+                // Do načtení vlastního názvu platí název nadřazené skupiny
+                if(depth > 1) {
+                    strlcpy(import->groups[depth - 1], import->groups[depth - 2], PASSWORD_GROUP_NAME_SIZE);
+                } else {
+                    import->groups[0][0] = '\0';
+                }
+            }
+        }
+        if(closing && import->group_depth > 0) import->group_depth--;
+    } else if(
+        password_import_tag_is(import, "Name") && !import->in_record && import->group_depth > 0) {
+        // Název skupiny, platí pro její položky a podskupiny; pod kořenem se připojí k cestě nadřazené
+        if(opening && !closing) {
+            import->target = PasswordImportTargetGroup;
+            import->group_length = 0;
+            import->group_full = false;
+            uint8_t depth = import->group_depth;
+            if(depth > 2 && depth <= PASSWORD_IMPORT_GROUP_DEPTH && import->groups[depth - 2][0]) {
+                import->group_length = strlen(import->groups[depth - 2]);
+                memcpy(import->group, import->groups[depth - 2], import->group_length);
+                import->group_full = !password_import_put_text(
+                    import->group, &import->group_length, sizeof(import->group), '/');
+            }
+        } else if(import->target == PasswordImportTargetGroup) {
+            import->target = PasswordImportTargetNone;
+            while(import->group_length > 0 && import->group[import->group_length - 1] == '/') {
+                import->group_length--;
+            }
+            if(import->group_depth <= PASSWORD_IMPORT_GROUP_DEPTH) {
+                memcpy(import->groups[import->group_depth - 1], import->group, import->group_length);
+                import->groups[import->group_depth - 1][import->group_length] = '\0';
+            }
+        }
+    } else if(password_import_tag_is(import, "History") && import->in_record) {
+        if(opening) import->history_depth++;
+        if(closing && import->history_depth > 0) import->history_depth--;
+    } else if(password_import_tag_is(import, "Key") && entry) {
+        if(opening) password_import_key_begin(import);
+        if(closing) import->target = PasswordImportTargetNone;
+    } else if(password_import_tag_is(import, "Value") && entry) {
+        import->target = PasswordImportTargetNone;
+        if(opening && !closing) {
+            if(password_import_key_is(import, "Title")) {
+                import->target = PasswordImportTargetName;
+            } else if(password_import_key_is(import, "Password")) {
+                import->target = PasswordImportTargetPassword;
+            } else if(
+                password_import_key_is(import, "otp") ||
+                password_import_key_is(import, "TimeOtp-Secret-Base32")) {
+                import->target = PasswordImportTargetTotp;
+            }
+        }
+    }
+    import->state = PasswordImportStateText;
+}
+
+// Entita XML: pojmenovaná nebo číselná
+static void password_import_xml_entity(PasswordImport* import) {
+    import->escape[import->escape_length] = '\0';
+    const char* entity = import->escape;
+    if(strcmp(entity, "amp") == 0) {
+        password_import_put(import, '&');
+    } else if(strcmp(entity, "lt") == 0) {
+        password_import_put(import, '<');
+    } else if(strcmp(entity, "gt") == 0) {
+        password_import_put(import, '>');
+    } else if(strcmp(entity, "quot") == 0) {
+        password_import_put(import, '"');
+    } else if(strcmp(entity, "apos") == 0) {
+        password_import_put(import, '\'');
+    } else if(entity[0] == '#') {
+        bool hex = entity[1] == 'x' || entity[1] == 'X';
+        password_import_put_codepoint(import, strtoul(entity + (hex ? 2 : 1), NULL, hex ? 16 : 10));
+    }
+    import->state = PasswordImportStateText;
+}
+
+static void password_import_xml(PasswordImport* import, uint8_t c) {
+    switch(import->state) {
+        case PasswordImportStateText:
+            if(c == '<') {
+                import->state = PasswordImportStateTagStart;
+            } else if(c == '&') {
+                import->escape_length = 0;
+                import->state = PasswordImportStateEntity;
+            } else {
+                password_import_put(import, c);
+            }
+            break;
+        case PasswordImportStateEntity:
+            if(c == ';') {
+                password_import_xml_entity(import);
+            } else if(import->escape_length < PASSWORD_IMPORT_ESCAPE_SIZE - 1) {
+                import->escape[import->escape_length++] = c;
+            }
+            break;
+        case PasswordImportStateTagStart:
+            import->tag_length = 0;
+            import->tag_closing = c == '/';
+            import->tag_empty = false;
+            if(c == '?' || c == '!') {
+                import->state = PasswordImportStateTagSkip;
+            } else {
+                import->state = PasswordImportStateTagName;
+                if(!import->tag_closing) import->tag[import->tag_length++] = c;
+            }
+            break;
+        case PasswordImportStateTagName:
+            if(c == '>') {
+                password_import_xml_tag(import);
+            } else if(c == '/') {
+                import->tag_empty = true;
+            } else if(c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+                import->attribute_quote = '\0';
+                import->state = PasswordImportStateTagAttributes;
+            } else if(import->tag_length < PASSWORD_IMPORT_TAG_SIZE) {
+                import->tag[import->tag_length++] = c;
+            }
+            break;
+        case PasswordImportStateTagAttributes:
+            // Hodnoty atributů mohou obsahovat '>' i '/'
+            if(import->attribute_quote) {
+                if(c == import->attribute_quote) import->attribute_quote = '\0';
+            } else if(c == '"' || c == '\'') {
+                import->attribute_quote = c;
+            } else if(c == '/') {
+                import->tag_empty = true;
+            } else if(c == '>') {
+                password_import_xml_tag(import);
+            } else {
+                import->tag_empty = false;
+            }
+            break;
+        case PasswordImportStateTagSkip:
+            if(c == '>') import->state = PasswordImportStateText;
+            break;
+        default:
+            break;
+    }
+}
+
+// Bitwarden JSON
+
+static void password_import_json_open(PasswordImport* import, bool object) {
+    bool in_root = import->depth == 1;
+    bool in_items = import->items_depth && import->depth == import->items_depth;
+    bool in_item = import->item_depth && import->depth == import->item_depth;
+    
+    import->depth++;
+    if(import->depth <= 32) {
+        if(object) {
+            import->objects |= 1UL << (import->depth - 1);
+        } else {
+            import->objects &= ~(1UL << (import->depth - 1));
+        }
+    }
+    
+    if(!object && in_root && password_import_key_is(import, "items")) {
+        import->items_depth = import->depth;
+    } else if(object && in_items) {
+        import->item_depth = import->depth;
+        password_import_record_begin(import);
+    } else if(object && in_item && password_import_key_is(import, "login")) {
+        import->login_depth = import->depth;
+    }
+    import->expect_key = object;
+    import->state = PasswordImportStateValue;
+}
+
+static void password_import_json_close(PasswordImport* import) {
+    if(import->depth == 0) return;
+    if(import->depth == import->login_depth) {
+        import->login_depth = 0;
+    } else if(import->depth == import->item_depth) {
+        password_import_record_end(import);
+        import->item_depth = 0;
+    } else if(import->depth == import->items_depth) {
+        import->items_depth = 0;
+    }
+    import->depth--;
+    import->expect_key = false;
+    import->state = PasswordImportStateValue;
+}
+
+static bool password_import_json_in_object(PasswordImport* import) {
+    return import->depth > 0 && import->depth <= 32 && (import->objects >> (import->depth - 1)) & 1;
+}
+
+// Začátek řetězce: klíč, název, heslo nebo TOTP položky, jinak se zahodí
+static void password_import_json_string_begin(PasswordImport* import) {
+    if(import->expect_key) {
+        password_import_key_begin(import);
+    } else if(import->item_depth && import->depth == import->item_depth &&
+              password_import_key_is(import, "name")) {
+        import->target = PasswordImportTargetName;
+    } else if(import->login_depth && import->depth == import->login_depth &&
+              password_import_key_is(import, "password")) {
+        import->target = PasswordImportTargetPassword;
+    } else if(import->login_depth && import->depth == import->login_depth &&
+              password_import_key_is(import, "totp")) {
+        import->target = PasswordImportTargetTotp;
+    } else {
+        import->target = PasswordImportTargetNone;
+    }
+    import->high_surrogate = 0;
+    import->state = PasswordImportStateString;
+}
+
+static void password_import_json_unicode(PasswordImport* import) {
+    import->escape[import->escape_length] = '\0';
+    uint32_t codepoint = strtoul(import->escape, NULL, 16);
+    if(codepoint >= 0xD800 && codepoint < 0xDC00) {
+        import->high_surrogate = codepoint;
+    } else {
+        if(codepoint >= 0xDC00 && codepoint < 0xE000 && import->high_surrogate) {
+            codepoint = 0x10000 + ((import->high_surrogate - 0xD800) << 10) + (codepoint - 0xDC00);
+        }
+        import->high_surrogate = 0;
+        password_import_put_codepoint(import, codepoint);
+    }
+    import->state = PasswordImportStateString;
+}
+
+static void password_import_json(PasswordImport* import, uint8_t c) {
+    switch(import->state) {
+        case PasswordImportStateLiteral:
+            // Číslo, true, false nebo null končí oddělovačem, který se zpracuje jako hodnota
+            if(c != ',' && c != '}' && c != ']' && c != ' ' && c != '\t' && c != '\r' &&
+               c != '\n') {
+                break;
+            }
+            import->state = PasswordImportStateValue;
+            // fall through
+        case PasswordImportStateValue:
+            if(c == '{' || c == '[') {
+                password_import_json_open(import, c == '{');
+            } else if(c == '}' || c == ']') {
+                password_import_json_close(import);
+            } else if(c == '"') {
+                password_import_json_string_begin(import);
+            } else if(c == ':') {
+                import->expect_key = false;
+            } else if(c == ',') {
+                import->expect_key = password_import_json_in_object(import);
+            } else if(c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+                // Šifrovaný export má v kořeni "encrypted": true
+                if(import->depth == 1 && c == 't' && password_import_key_is(import, "encrypted")) {
+                    FURI_LOG_E(TAG, "Šifrovaný export Bitwardenu");
+                    import->result = PasswordImportResultEncrypted;
+                }
+                import->state = PasswordImportStateLiteral;
+            }
+            break;
+        case PasswordImportStateString:
+            if(c == '"') {
+                import->target = PasswordImportTargetNone;
+                import->state = PasswordImportStateValue;
+            } else if(c == '\\') {
+                import->state = PasswordImportStateStringEscape;
+            } else {
+                password_import_put(import, c);
+            }
+            break;
+        case PasswordImportStateStringEscape: {
+            static const char escapes[] = "b\bf\fn\nr\rt\t";
+            const char* escape = c ? strchr(escapes, c) : NULL;
+            import->state = PasswordImportStateString;
+            if(c == 'u') {
+                import->escape_length = 0;
+                import->state = PasswordImportStateStringUnicode;
+            } else if(escape && (escape - escapes) % 2 == 0) {
+                password_import_put(import, escape[1]);
+            } else {
+                password_import_put(import, c); // \" \\ \/
+            }
+            break;
+        }
+        case PasswordImportStateStringUnicode:
+            import->escape[import->escape_length++] = c;
+            if(import->escape_length == 4) password_import_json_unicode(import);
+            break;
+        default:
+            break;
+    }
+}
+
+// Veřejné API
+
+PasswordImport* password_import_alloc(
+    PasswordImportFormat format,
+    PasswordImportEntryCallback callback,
+    void* context) {
+    PasswordImport* import = malloc(sizeof(PasswordImport));
+    memset(import, 0, sizeof(PasswordImport));
+    import->format = format;
+    import->callback = callback;
+    import->context = context;
+    import->result = PasswordImportResultOk;
+    import->name_column = PASSWORD_IMPORT_NO_COLUMN;
+    import->password_column = PASSWORD_IMPORT_NO_COLUMN;
+    import->group_column = PASSWORD_IMPORT_NO_COLUMN;
+    import->totp_column = PASSWORD_IMPORT_NO_COLUMN;
+    return import;
+}
+
+void password_import_free(PasswordImport* import) {
+    password_crypto_wipe(import, sizeof(PasswordImport));
+    free(import);
+}
+
+// Formát podle prvního znaku, počáteční stav automatu
+static void password_import_begin(PasswordImport* import, uint8_t c) {
+    if(import->format == PasswordImportFormatAuto) {
+        import->format = c == '<' ? PasswordImportFormatKeepassXml :
+                         c == '{' ? PasswordImportFormatBitwardenJson :
+                                    PasswordImportFormatCsv;
+    }
+    if(import->format == PasswordImportFormatCsv) {
+        import->state = PasswordImportStateFieldStart;
+        import->header = true;
+    } else if(import->format == PasswordImportFormatKeepassXml) {
+        import->state = PasswordImportStateText;
+    } else {
+        import->state = PasswordImportStateValue;
+    }
+}
+
+bool password_import_feed(PasswordImport* import, const uint8_t* data, size_t size) {
+    static const uint8_t bom[] = {0xEF, 0xBB, 0xBF};
+    
+    for(size_t i = 0; i < size && import->result == PasswordImportResultOk; i++) {
+        uint8_t c = data[i];
+        
+        // Před prvním znakem se přeskočí BOM a mezery, formát ještě není určený
+        if(!import->started) {
+            if(import->bom < sizeof(bom) && c == bom[import->bom]) {
+                import->bom++;
+                continue;
+            }
+            if(c == ' ' || c == '\t' || c == '\r' || c == '\n') continue;
+            password_import_begin(import, c);
+            import->started = true;
+        }
+        
+        switch(import->format) {
+            case PasswordImportFormatCsv:
+                password_import_csv(import, c);
+                break;
+            case PasswordImportFormatKeepassXml:
+                password_import_xml(import, c);
+                break;
+            default:
+                password_import_json(import, c);
+                break;
+        }
+    }
+    return import->result == PasswordImportResultOk;
+}
+
+PasswordImportResult password_import_finish(PasswordImport* import, PasswordImportProgress* progress) {
+    // Poslední řádek CSV nemusí končit koncem řádku
+    if(import->result == PasswordImportResultOk && import->format == PasswordImportFormatCsv &&
+       import->started && (import->column > 0 || import->row_data)) {
+        password_import_csv_row_end(import);
+    }
+    if(progress) {
+        progress->imported = import->imported;
+        progress->skipped = import->skipped;
+    }
+    return import->result;
+}
+
+PasswordImportResult password_import_file(
+    const char* path,
+    PasswordImportFormat format,
+    PasswordImportEntryCallback callback,
+    PasswordImportProgressCallback progress_callback,
+    void* context,
+    PasswordImportProgress* progress) {
+    FURI_LOG_I(TAG, "Import z %s", path);
+    
+    PasswordImportProgress current = {0};
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    
+    PasswordImportResult result = PasswordImportResultOpenFailed;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        current.bytes_total = storage_file_size(file);
+        PasswordImport* import = password_import_alloc(format, callback, context);
+        // Kousek na haldě, zásobník zůstane callbacku (zápis do žurnálu)
+        uint8_t* chunk = malloc(PASSWORD_IMPORT_CHUNK_SIZE);
+        bool cancelled = false;
+        bool read_failed = false;
+        
+        // Po kouscích, paměť nezávisí na velikosti souboru
+        while(true) {
+            size_t read = storage_file_read(file, chunk, PASSWORD_IMPORT_CHUNK_SIZE);
+            if(read == 0) {
+                read_failed = !storage_file_eof(file);
+                break;
+            }
+            current.bytes_read += read;
+            bool ok = password_import_feed(import, chunk, read);
+            
+            current.imported = import->imported;
+            current.skipped = import->skipped;
+            if(progress_callback && !progress_callback(&current, context)) {
+                cancelled = true;
+                break;
+            }
+            if(!ok) break;
+        }
+        password_crypto_wipe(chunk, PASSWORD_IMPORT_CHUNK_SIZE);
+        free(chunk);
+        
+        result = password_import_finish(import, &current);
+        if(cancelled) {
+            result = PasswordImportResultCancelled;
+        } else if(read_failed && result == PasswordImportResultOk) {
+            result = PasswordImportResultOpenFailed;
+        }
+        password_import_free(import);
+    } else {
+        FURI_LOG_E(TAG, "Nelze otevřít %s", path);
+    }
+    
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    
+    FURI_LOG_I(
+        TAG,
+        "Importováno %lu, přeskočeno %lu",
+        current.imported,
+        current.skipped);
+    if(progress) *progress = current;
+    return result;
+}
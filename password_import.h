@@ -0,0 +1,160 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "password_storage.h"
+
+/*
+ * Import hesel z exportů jiných správců
+ * 
+ * Podporované formáty:
+ * - CSV (RFC 4180: uvozovky, "" uvnitř uvozovek, konce řádků v poli)
+ *   s hlavičkou; název je ve sloupci name, title nebo account, heslo
+ *   ve sloupci password nebo login_password (KeePass, KeePassXC,
+ *   Bitwarden, prohlížeče)
+ * - KeePass XML (KeePass 2): položky Entry, řetězce Title a Password,
+ *   starší verze položek v History se přeskočí
+ * - Bitwarden JSON (nešifrovaný export): items[].name a items[].login.password
+ * 
+ * Parser je stavový automat, který dostává vstup po kouscích libovolné
+ * velikosti a drží jen právě čtený záznam. Paměť ani zásobník tak
+ * nezávisí na velikosti exportu; soubor se čte po
+ * PASSWORD_IMPORT_CHUNK_SIZE B. Každý úplný záznam jde hned
+ * do callbacku (typicky password_list_add, změna se zapíše do žurnálu).
+ * 
+ * Skupinu záznamu dává sloupec group (cesta KeePassu bez kořene),
+ * folder nebo grouping v CSV, resp. cesta pojmenovaných skupin pod kořenem
+ * v KeePass XML; části cesty spojí '/'. Export Bitwardenu
+ * odkazuje na složky jen přes id, jeho záznamy jdou do výchozí skupiny.
+ * 
+ * Tajemství TOTP (Base32 nebo URI otpauth) je ve sloupci totp, otp nebo
+ * login_totp v CSV, v řetězci otp (KeePassXC) nebo TimeOtp-Secret-Base32
+ * (KeePass) a v items[].login.totp Bitwardenu. Připojí se k heslu
+ * (password_totp.h); neplatné nebo k heslu se nevejdoucí se vynechá.
+ * 
+ * Záznam bez názvu nebo hesla a záznam s heslem delším než
+ * PASSWORD_MAX_LENGTH - 1 se přeskočí (zkrácené heslo by nefungovalo),
+ * delší název se zkrátí. Kopie hesel se po předání callbacku přepíšou.
+ */
+
+// Velikost kousku souboru čteného najednou
+#define PASSWORD_IMPORT_CHUNK_SIZE 256
+
+typedef struct PasswordImport PasswordImport;
+
+typedef enum {
+    PasswordImportFormatAuto, // Podle prvního znaku: '<' XML, '{' JSON, jinak CSV
+    PasswordImportFormatCsv,
+    PasswordImportFormatKeepassXml,
+    PasswordImportFormatBitwardenJson,
+} PasswordImportFormat;
+
+typedef enum {
+    PasswordImportResultOk,
+    PasswordImportResultOpenFailed, // Soubor nejde otevřít nebo číst
+    PasswordImportResultUnknownFormat, // CSV bez sloupce názvu nebo hesla
+    PasswordImportResultEncrypted, // Šifrovaný export Bitwardenu
+    PasswordImportResultWriteFailed, // Callback záznam nezapsal
+    PasswordImportResultCancelled, // Callback průběhu import zrušil
+} PasswordImportResult;
+
+typedef enum {
+    PasswordImportEntryAdded,
+    PasswordImportEntrySkipped, // Např. název už v trezoru je
+    PasswordImportEntryFailed, // Import skončí chybou zápisu
+} PasswordImportEntryResult;
+
+typedef struct {
+    uint32_t imported; // Přidané záznamy
+    uint32_t skipped; // Přeskočené záznamy (neúplné, dlouhé heslo, odmítnuté callbackem)
+    uint32_t bytes_read; // Přečtené bajty souboru
+    uint32_t bytes_total; // Velikost souboru
+} PasswordImportProgress;
+
+/**
+ * @brief Callback úplného záznamu
+ * 
+ * @param group Skupina (password_groups.h), prázdná pro výchozí
+ * @param name Název
+ * @param password Heslo, případně s tajemstvím TOTP; buffer se po návratu přepíše
+ * @param context Kontext
+ * @return PasswordImportEntryResult Výsledek zápisu
+ */
+typedef PasswordImportEntryResult (*PasswordImportEntryCallback)(
+    const char* group,
+    const char* name,
+    const char* password,
+    void* context);
+
+/**
+ * @brief Callback průběhu, volá se po každém kousku souboru
+ * 
+ * @param progress Průběh
+ * @param context Kontext
+ * @return true Pokud import pokračuje
+ * @return false Pokud se má import zrušit
+ */
+typedef bool (*PasswordImportProgressCallback)(const PasswordImportProgress* progress, void* context);
+
+/**
+ * @brief Vytvoří parser
+ * 
+ * @param format Formát vstupu
+ * @param callback Callback úplného záznamu
+ * @param context Kontext callbacku
+ * @return PasswordImport* Parser
+ */
+PasswordImport* password_import_alloc(
+    PasswordImportFormat format,
+    PasswordImportEntryCallback callback,
+    void* context);
+
+/**
+ * @brief Přepíše rozepsaný záznam a uvolní parser
+ * 
+ * @param import Parser
+ */
+void password_import_free(PasswordImport* import);
+
+/**
+ * @brief Zpracuje další kousek vstupu
+ * 
+ * Kousky mohou končit kdekoli, i uprostřed znaku UTF-8 nebo escape sekvence.
+ * 
+ * @param import Parser
+ * @param data Data
+ * @param size Velikost dat
+ * @return true Pokud lze pokračovat
+ * @return false Pokud import skončil chybou (password_import_finish ji vrátí)
+ */
+bool password_import_feed(PasswordImport* import, const uint8_t* data, size_t size);
+
+/**
+ * @brief Dokončí vstup (poslední řádek CSV bez konce řádku)
+ * 
+ * @param import Parser
+ * @param progress Výstup, počty záznamů; může být NULL
+ * @return PasswordImportResult Výsledek importu
+ */
+PasswordImportResult password_import_finish(PasswordImport* import, PasswordImportProgress* progress);
+
+/**
+ * @brief Naimportuje soubor
+ * 
+ * @param path Cesta k exportu
+ * @param format Formát, PasswordImportFormatAuto podle obsahu
+ * @param callback Callback úplného záznamu
+ * @param progress_callback Callback průběhu, může být NULL
+ * @param context Kontext callbacků
+ * @param progress Výstup, konečný průběh; může být NULL
+ * @return PasswordImportResult Výsledek importu
+ */
+PasswordImportResult password_import_file(
+    const char* path,
+    PasswordImportFormat format,
+    PasswordImportEntryCallback callback,
+    PasswordImportProgressCallback progress_callback,
+    void* context,
+    PasswordImportProgress* progress);
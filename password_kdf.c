@@ -0,0 +1,263 @@
+#include "password_kdf.h"
+#include "password_crypto.h"
+#include <furi.h>
+#include <string.h>
+
+#define TAG "PasswordKdf"
+
+// Délka vzorku kalibrace jako díl cílového času
+#define PASSWORD_KDF_CALIBRATION_FRACTION 10
+#define PASSWORD_KDF_CALIBRATION_START 1000
+
+static const uint32_t password_sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static const uint32_t password_sha256_initial[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+};
+
+#define PASSWORD_SHA256_ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static uint32_t password_sha256_load(const uint8_t* data) {
+    return (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16 | (uint32_t)data[2] << 8 | data[3];
+}
+
+static void password_sha256_store(uint8_t* data, uint32_t value) {
+    data[0] = value >> 24;
+    data[1] = value >> 16;
+    data[2] = value >> 8;
+    data[3] = value;
+}
+
+void password_sha256_compress(uint32_t* state, const uint8_t* block) {
+    uint32_t w[64];
+    for(size_t i = 0; i < 16; i++) w[i] = password_sha256_load(block + i * 4);
+    for(size_t i = 16; i < 64; i++) {
+        uint32_t s0 = PASSWORD_SHA256_ROR(w[i - 15], 7) ^ PASSWORD_SHA256_ROR(w[i - 15], 18) ^
+                      (w[i - 15] >> 3);
+        uint32_t s1 = PASSWORD_SHA256_ROR(w[i - 2], 17) ^ PASSWORD_SHA256_ROR(w[i - 2], 19) ^
+                      (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for(size_t i = 0; i < 64; i++) {
+        uint32_t s1 = PASSWORD_SHA256_ROR(e, 6) ^ PASSWORD_SHA256_ROR(e, 11) ^
+                      PASSWORD_SHA256_ROR(e, 25);
+        uint32_t choice = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + choice + password_sha256_k[i] + w[i];
+        uint32_t s0 = PASSWORD_SHA256_ROR(a, 2) ^ PASSWORD_SHA256_ROR(a, 13) ^
+                      PASSWORD_SHA256_ROR(a, 22);
+        uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + majority;
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+void password_sha256_init(PasswordSha256* sha) {
+    memcpy(sha->state, password_sha256_initial, sizeof(sha->state));
+    sha->length = 0;
+    sha->block_size = 0;
+}
+
+void password_sha256_update(PasswordSha256* sha, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+    sha->length += size;
+    while(size > 0) {
+        size_t chunk = PASSWORD_KDF_BLOCK_SIZE - sha->block_size;
+        if(chunk > size) chunk = size;
+        memcpy(sha->block + sha->block_size, bytes, chunk);
+        sha->block_size += chunk;
+        bytes += chunk;
+        size -= chunk;
+        if(sha->block_size == PASSWORD_KDF_BLOCK_SIZE) {
+            password_sha256_compress(sha->state, sha->block);
+            sha->block_size = 0;
+        }
+    }
+}
+
+void password_sha256_finish(PasswordSha256* sha, uint8_t* digest) {
+    uint64_t bits = sha->length * 8;
+    uint8_t padding = 0x80;
+    password_sha256_update(sha, &padding, 1);
+    padding = 0;
+    while(sha->block_size != PASSWORD_KDF_BLOCK_SIZE - sizeof(bits)) {
+        password_sha256_update(sha, &padding, 1);
+    }
+    for(size_t i = 0; i < sizeof(bits); i++) {
+        sha->block[sha->block_size + i] = bits >> (56 - i * 8);
+    }
+    password_sha256_compress(sha->state, sha->block);
+    
+    for(size_t i = 0; i < 8; i++) password_sha256_store(digest + i * 4, sha->state[i]);
+    password_crypto_wipe(sha, sizeof(PasswordSha256));
+}
+
+/**
+ * Stav HMAC po zpracování bloků klíče s ipad a opad. Připravený jednou
+ * ušetří PBKDF2 dvě ze čtyř kompresí v každé iteraci.
+ */
+typedef struct {
+    PasswordSha256 inner;
+    PasswordSha256 outer;
+} PasswordHmac;
+
+static void password_hmac_init(PasswordHmac* hmac, const uint8_t* key, size_t key_size) {
+    uint8_t block[PASSWORD_KDF_BLOCK_SIZE] = {0};
+    if(key_size > PASSWORD_KDF_BLOCK_SIZE) {
+        PasswordSha256 sha;
+        password_sha256_init(&sha);
+        password_sha256_update(&sha, key, key_size);
+        password_sha256_finish(&sha, block);
+    } else {
+        memcpy(block, key, key_size);
+    }
+    
+    for(size_t i = 0; i < sizeof(block); i++) block[i] ^= 0x36;
+    password_sha256_init(&hmac->inner);
+    password_sha256_update(&hmac->inner, block, sizeof(block));
+    for(size_t i = 0; i < sizeof(block); i++) block[i] ^= 0x36 ^ 0x5c;
+    password_sha256_init(&hmac->outer);
+    password_sha256_update(&hmac->outer, block, sizeof(block));
+    password_crypto_wipe(block, sizeof(block));
+}
+
+static void password_hmac_finish(
+    const PasswordHmac* hmac,
+    const void* data,
+    size_t size,
+    uint8_t* mac) {
+    PasswordSha256 sha = hmac->inner;
+    password_sha256_update(&sha, data, size);
+    password_sha256_finish(&sha, mac);
+    sha = hmac->outer;
+    password_sha256_update(&sha, mac, PASSWORD_KDF_HASH_SIZE);
+    password_sha256_finish(&sha, mac);
+}
+
+void password_hmac_sha256(
+    const uint8_t* key,
+    size_t key_size,
+    const void* data,
+    size_t size,
+    uint8_t* mac) {
+    PasswordHmac hmac;
+    password_hmac_init(&hmac, key, key_size);
+    password_hmac_finish(&hmac, data, size, mac);
+    password_crypto_wipe(&hmac, sizeof(hmac));
+}
+
+/**
+ * Jedna iterace HMAC nad 32bajtovým vstupem. Zarovnání bloku je vždy
+ * stejné, blok se proto sestaví rovnou a zkomprimuje bez bufferování.
+ */
+static void password_hmac_iterate(const PasswordHmac* hmac, uint8_t* block) {
+    uint32_t state[8];
+    
+    // Délka zprávy včetně bloku klíče: (64 + 32) * 8 bitů
+    memcpy(state, hmac->inner.state, sizeof(state));
+    password_sha256_compress(state, block);
+    for(size_t i = 0; i < 8; i++) password_sha256_store(block + i * 4, state[i]);
+    
+    memcpy(state, hmac->outer.state, sizeof(state));
+    password_sha256_compress(state, block);
+    for(size_t i = 0; i < 8; i++) password_sha256_store(block + i * 4, state[i]);
+    password_crypto_wipe(state, sizeof(state));
+}
+
+// Provede iterace PBKDF2 nad prvním blokem U1 (v block), výsledný XOR zapíše do key
+static void password_kdf_iterate(
+    const PasswordHmac* hmac,
+    uint8_t* block,
+    uint32_t iterations,
+    uint8_t* key) {
+    // Zarovnání SHA-256 pro 32 B dat za 64 B klíče je pro všechny iterace stejné
+    memset(block + PASSWORD_KDF_HASH_SIZE, 0, PASSWORD_KDF_BLOCK_SIZE - PASSWORD_KDF_HASH_SIZE);
+    block[PASSWORD_KDF_HASH_SIZE] = 0x80;
+    block[PASSWORD_KDF_BLOCK_SIZE - 2] = ((PASSWORD_KDF_BLOCK_SIZE + PASSWORD_KDF_HASH_SIZE) * 8) >> 8;
+    block[PASSWORD_KDF_BLOCK_SIZE - 1] = ((PASSWORD_KDF_BLOCK_SIZE + PASSWORD_KDF_HASH_SIZE) * 8) & 0xff;
+    
+    memcpy(key, block, PASSWORD_KDF_HASH_SIZE);
+    for(uint32_t i = 1; i < iterations; i++) {
+        password_hmac_iterate(hmac, block);
+        for(size_t j = 0; j < PASSWORD_KDF_HASH_SIZE; j++) key[j] ^= block[j];
+    }
+}
+
+void password_kdf_derive(
+    const char* pin,
+    size_t pin_length,
+    const uint8_t* salt,
+    size_t salt_size,
+    uint32_t iterations,
+    uint8_t* key) {
+    PasswordHmac hmac;
+    password_hmac_init(&hmac, (const uint8_t*)pin, pin_length);
+    
+    // Klíč má velikost jednoho bloku PBKDF2, U1 = HMAC(PIN, sůl || 1)
+    uint8_t block[PASSWORD_KDF_BLOCK_SIZE];
+    static const uint8_t index[4] = {0, 0, 0, 1};
+    PasswordSha256 sha = hmac.inner;
+    password_sha256_update(&sha, salt, salt_size);
+    password_sha256_update(&sha, index, sizeof(index));
+    password_sha256_finish(&sha, block);
+    sha = hmac.outer;
+    password_sha256_update(&sha, block, PASSWORD_KDF_HASH_SIZE);
+    password_sha256_finish(&sha, block);
+    
+    password_kdf_iterate(&hmac, block, iterations, key);
+    password_crypto_wipe(block, sizeof(block));
+    password_crypto_wipe(&hmac, sizeof(hmac));
+}
+
+uint32_t password_kdf_calibrate(uint32_t target_ms) {
+    PasswordHmac hmac;
+    password_hmac_init(&hmac, (const uint8_t*)"calibration", 11);
+    uint8_t block[PASSWORD_KDF_BLOCK_SIZE] = {0};
+    uint8_t key[PASSWORD_KDF_HASH_SIZE];
+    
+    // Vzorek se zdvojnásobuje, dokud netrvá dost dlouho na přesné měření
+    uint32_t frequency = furi_kernel_get_tick_frequency();
+    uint32_t sample_ms = target_ms / PASSWORD_KDF_CALIBRATION_FRACTION;
+    uint32_t iterations = PASSWORD_KDF_CALIBRATION_START;
+    uint32_t elapsed_ms = 0;
+    while(iterations < PASSWORD_KDF_MAX_ITERATIONS) {
+        uint32_t start = furi_get_tick();
+        password_kdf_iterate(&hmac, block, iterations, key);
+        elapsed_ms = (uint64_t)(furi_get_tick() - start) * 1000 / frequency;
+        if(elapsed_ms >= sample_ms && elapsed_ms > 0) break;
+        iterations *= 2;
+    }
+    
+    uint64_t calibrated = elapsed_ms ? (uint64_t)iterations * target_ms / elapsed_ms :
+                                       PASSWORD_KDF_MAX_ITERATIONS;
+    if(calibrated < PASSWORD_KDF_MIN_ITERATIONS) calibrated = PASSWORD_KDF_MIN_ITERATIONS;
+    if(calibrated > PASSWORD_KDF_MAX_ITERATIONS) calibrated = PASSWORD_KDF_MAX_ITERATIONS;
+    FURI_LOG_I(TAG, "Kalibrace: %lu iterací za %lu ms", iterations, elapsed_ms);
+    return calibrated;
+}
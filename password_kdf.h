@@ -0,0 +1,109 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Odvození klíče z PINu (PBKDF2-HMAC-SHA256)
+ * 
+ * Počet iterací se kalibruje při založení trezoru podle rychlosti
+ * zařízení tak, aby odemčení trvalo přibližně PASSWORD_KDF_TARGET_MS.
+ * Útočník s kopií SD karty pak za každý zkoušený PIN zaplatí stejnou
+ * práci jako Flipper.
+ */
+
+#define PASSWORD_KDF_HASH_SIZE 32
+#define PASSWORD_KDF_BLOCK_SIZE 64
+#define PASSWORD_KDF_SALT_SIZE 16
+#define PASSWORD_KDF_TARGET_MS 500
+// Spodní mez, i na rychlém stroji zůstane odvození drahé
+#define PASSWORD_KDF_MIN_ITERATIONS 10000
+// Horní mez, chrání před nesmyslem z poškozeného souboru
+#define PASSWORD_KDF_MAX_ITERATIONS 10000000
+
+typedef struct {
+    uint32_t state[8];
+    uint64_t length;
+    uint8_t block[PASSWORD_KDF_BLOCK_SIZE];
+    size_t block_size;
+} PasswordSha256;
+
+/**
+ * @brief Začne nový výpočet SHA-256
+ * 
+ * @param sha Stav výpočtu
+ */
+void password_sha256_init(PasswordSha256* sha);
+
+/**
+ * @brief Zpracuje jeden 64bajtový blok SHA-256 bez zarovnání a délky
+ * 
+ * Pro výpočty, které si zarovnání posledního bloku připraví samy
+ * (HMAC s předpočítaným stavem klíče).
+ * 
+ * @param state Stav hashe (8 slov)
+ * @param block Blok (PASSWORD_KDF_BLOCK_SIZE B)
+ */
+void password_sha256_compress(uint32_t* state, const uint8_t* block);
+
+/**
+ * @brief Přidá data do výpočtu SHA-256
+ * 
+ * @param sha Stav výpočtu
+ * @param data Data
+ * @param size Velikost dat
+ */
+void password_sha256_update(PasswordSha256* sha, const void* data, size_t size);
+
+/**
+ * @brief Dokončí výpočet SHA-256 a přepíše stav
+ * 
+ * @param sha Stav výpočtu
+ * @param digest Výstup (PASSWORD_KDF_HASH_SIZE B)
+ */
+void password_sha256_finish(PasswordSha256* sha, uint8_t* digest);
+
+/**
+ * @brief Spočítá HMAC-SHA256
+ * 
+ * @param key Klíč
+ * @param key_size Velikost klíče
+ * @param data Data
+ * @param size Velikost dat
+ * @param mac Výstup (PASSWORD_KDF_HASH_SIZE B)
+ */
+void password_hmac_sha256(
+    const uint8_t* key,
+    size_t key_size,
+    const void* data,
+    size_t size,
+    uint8_t* mac);
+
+/**
+ * @brief Odvodí klíč z PINu funkcí PBKDF2-HMAC-SHA256
+ * 
+ * @param pin PIN
+ * @param pin_length Délka PINu
+ * @param salt Sůl
+ * @param salt_size Velikost soli
+ * @param iterations Počet iterací
+ * @param key Výstup (PASSWORD_KDF_HASH_SIZE B)
+ */
+void password_kdf_derive(
+    const char* pin,
+    size_t pin_length,
+    const uint8_t* salt,
+    size_t salt_size,
+    uint32_t iterations,
+    uint8_t* key);
+
+/**
+ * @brief Změří rychlost odvození a spočítá počet iterací pro cílový čas
+ * 
+ * Měření trvá zhruba desetinu cílového času.
+ * 
+ * @param target_ms Cílová doba odvození
+ * @return uint32_t Počet iterací, nejméně PASSWORD_KDF_MIN_ITERATIONS
+ */
+uint32_t password_kdf_calibrate(uint32_t target_ms);
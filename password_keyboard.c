@@ -0,0 +1,281 @@
+#include "password_keyboard.h"
+#include "password_perf.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <string.h>
+
+#define TAG "PasswordKeyboard"
+
+// Levý Shift v bitech modifikátorů reportu (KEY_MOD_* jsou posunuté o 8 bitů)
+#define PASSWORD_KEYBOARD_SHIFT (KEY_MOD_LEFT_SHIFT >> 8)
+
+#define PASSWORD_KEYBOARD_PLAIN(code) {(code), 0}
+#define PASSWORD_KEYBOARD_SHIFTED(code) {(code), PASSWORD_KEYBOARD_SHIFT}
+#define PASSWORD_KEYBOARD_LETTER(c)                                    \
+    [c] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_A + ((c) - 'a')),       \
+    [(c) - 'a' + 'A'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_A + ((c) - 'a'))
+#define PASSWORD_KEYBOARD_DIGIT(c, shifted)                             \
+    [c] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_1 + ((c) - '1')),        \
+    [shifted] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_1 + ((c) - '1'))
+
+// Vestavěné rozložení US, index je kód znaku ASCII
+static const PasswordKeyboardKey password_keyboard_ascii[PASSWORD_KEYBOARD_CHARACTERS] = {
+    PASSWORD_KEYBOARD_LETTER('a'), PASSWORD_KEYBOARD_LETTER('b'), PASSWORD_KEYBOARD_LETTER('c'),
+    PASSWORD_KEYBOARD_LETTER('d'), PASSWORD_KEYBOARD_LETTER('e'), PASSWORD_KEYBOARD_LETTER('f'),
+    PASSWORD_KEYBOARD_LETTER('g'), PASSWORD_KEYBOARD_LETTER('h'), PASSWORD_KEYBOARD_LETTER('i'),
+    PASSWORD_KEYBOARD_LETTER('j'), PASSWORD_KEYBOARD_LETTER('k'), PASSWORD_KEYBOARD_LETTER('l'),
+    PASSWORD_KEYBOARD_LETTER('m'), PASSWORD_KEYBOARD_LETTER('n'), PASSWORD_KEYBOARD_LETTER('o'),
+    PASSWORD_KEYBOARD_LETTER('p'), PASSWORD_KEYBOARD_LETTER('q'), PASSWORD_KEYBOARD_LETTER('r'),
+    PASSWORD_KEYBOARD_LETTER('s'), PASSWORD_KEYBOARD_LETTER('t'), PASSWORD_KEYBOARD_LETTER('u'),
+    PASSWORD_KEYBOARD_LETTER('v'), PASSWORD_KEYBOARD_LETTER('w'), PASSWORD_KEYBOARD_LETTER('x'),
+    PASSWORD_KEYBOARD_LETTER('y'), PASSWORD_KEYBOARD_LETTER('z'),
+    
+    PASSWORD_KEYBOARD_DIGIT('1', '!'), PASSWORD_KEYBOARD_DIGIT('2', '@'),
+    PASSWORD_KEYBOARD_DIGIT('3', '#'), PASSWORD_KEYBOARD_DIGIT('4', '$'),
+    PASSWORD_KEYBOARD_DIGIT('5', '%'), PASSWORD_KEYBOARD_DIGIT('6', '^'),
+    PASSWORD_KEYBOARD_DIGIT('7', '&'), PASSWORD_KEYBOARD_DIGIT('8', '*'),
+    PASSWORD_KEYBOARD_DIGIT('9', '('),
+    ['0'] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_0),
+    [')'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_0),
+    
+    [' '] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_SPACEBAR),
+    ['-'] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_MINUS),
+    ['_'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_MINUS),
+    ['='] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_EQUAL),
+    ['+'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_EQUAL),
+    ['['] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_OPEN_BRACKET),
+    ['{'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_OPEN_BRACKET),
+    [']'] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_CLOSE_BRACKET),
+    ['}'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_CLOSE_BRACKET),
+    ['\\'] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_BACKSLASH),
+    ['|'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_BACKSLASH),
+    [';'] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_SEMICOLON),
+    [':'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_SEMICOLON),
+    ['\''] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_APOSTROPHE),
+    ['"'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_APOSTROPHE),
+    ['`'] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_GRAVE_ACCENT),
+    ['~'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_GRAVE_ACCENT),
+    [','] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_COMMA),
+    ['<'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_COMMA),
+    ['.'] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_DOT),
+    ['>'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_DOT),
+    ['/'] = PASSWORD_KEYBOARD_PLAIN(HID_KEYBOARD_SLASH),
+    ['?'] = PASSWORD_KEYBOARD_SHIFTED(HID_KEYBOARD_SLASH),
+};
+
+static const PasswordKeyboardTiming password_keyboard_timings[PasswordKeyboardSpeedCount] = {
+    [PasswordKeyboardSpeedSafe] = {.press_ms = 10, .release_ms = 10, .batch = 1},
+    [PasswordKeyboardSpeedNormal] = {.press_ms = 4, .release_ms = 6, .batch = 3},
+    [PasswordKeyboardSpeedFast] = {.press_ms = 2, .release_ms = 2, .batch = PASSWORD_KEYBOARD_REPORT_KEYS},
+};
+
+static const char* const password_keyboard_speed_names[PasswordKeyboardSpeedCount] = {
+    [PasswordKeyboardSpeedSafe] = "Bezpečná",
+    [PasswordKeyboardSpeedNormal] = "Normální",
+    [PasswordKeyboardSpeedFast] = "Rychlá",
+};
+
+void password_keyboard_layout_default(PasswordKeyboardLayout* layout) {
+    memset(layout, 0, sizeof(PasswordKeyboardLayout));
+    strlcpy(layout->name, "US", sizeof(layout->name));
+    for(size_t i = 0; i < PASSWORD_KEYBOARD_CHARACTERS; i++) {
+        layout->keys[i][0] = password_keyboard_ascii[i];
+    }
+}
+
+bool password_keyboard_layout_load(PasswordKeyboardLayout* layout, const char* path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    PasswordKeyboardLayout* loaded = malloc(sizeof(PasswordKeyboardLayout));
+    memset(loaded, 0, sizeof(PasswordKeyboardLayout));
+    
+    PasswordKeyboardLayoutHeader header;
+    bool success = storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+                   storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+                   header.magic == PASSWORD_KEYBOARD_LAYOUT_MAGIC &&
+                   header.version == PASSWORD_KEYBOARD_LAYOUT_VERSION &&
+                   header.count <= PASSWORD_KEYBOARD_CHARACTERS &&
+                   storage_file_size(file) ==
+                       sizeof(header) + header.count * sizeof(PasswordKeyboardLayoutEntry);
+                       
+    // Záznamy se čtou po jednom, soubor má nejvýš 128 záznamů po 5 B
+    for(uint16_t i = 0; success && i < header.count; i++) {
+        PasswordKeyboardLayoutEntry entry;
+        success = storage_file_read(file, &entry, sizeof(entry)) == sizeof(entry) &&
+                  entry.character < PASSWORD_KEYBOARD_CHARACTERS && entry.strokes[0].keycode != 0;
+        if(success) memcpy(loaded->keys[entry.character], entry.strokes, sizeof(entry.strokes));
+    }
+    
+    if(success) {
+        memcpy(loaded->name, header.name, sizeof(loaded->name));
+        loaded->name[sizeof(loaded->name) - 1] = '\0';
+        memcpy(layout, loaded, sizeof(PasswordKeyboardLayout));
+    } else {
+        FURI_LOG_E(TAG, "Neplatné rozložení %s", path);
+    }
+    
+    free(loaded);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return success;
+}
+
+bool password_keyboard_layout_select(
+    PasswordKeyboardLayout* layout,
+    const char* directory,
+    const char* id) {
+    if(strcmp(id, PASSWORD_KEYBOARD_LAYOUT_DEFAULT) == 0) {
+        password_keyboard_layout_default(layout);
+        return true;
+    }
+    FuriString* path =
+        furi_string_alloc_printf("%s/%s%s", directory, id, PASSWORD_KEYBOARD_LAYOUT_EXTENSION);
+    bool success = password_keyboard_layout_load(layout, furi_string_get_cstr(path));
+    furi_string_free(path);
+    return success;
+}
+
+bool password_keyboard_layout_next(
+    const char* directory,
+    const char* current,
+    char* next,
+    size_t size) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* dir = storage_file_alloc(storage);
+    char name[64];
+    FileInfo info;
+    bool found = false;
+    
+    // Nejmenší identifikátor větší než aktuální, seznam se v paměti nedrží.
+    // Vestavěné rozložení je první, za ním následuje celý adresář.
+    if(strcmp(current, PASSWORD_KEYBOARD_LAYOUT_DEFAULT) == 0) current = "";
+    if(storage_dir_open(dir, directory)) {
+        while(storage_dir_read(dir, &info, name, sizeof(name))) {
+            char* extension = strrchr(name, '.');
+            if((info.flags & FSF_DIRECTORY) || !extension ||
+               strcmp(extension, PASSWORD_KEYBOARD_LAYOUT_EXTENSION) != 0) {
+                continue;
+            }
+            *extension = '\0';
+            if(strcmp(name, PASSWORD_KEYBOARD_LAYOUT_DEFAULT) == 0 || strcmp(name, current) <= 0) {
+                continue;
+            }
+            if(!found || strcmp(name, next) < 0) {
+                strlcpy(next, name, size);
+                found = true;
+            }
+        }
+    }
+    storage_dir_close(dir);
+    storage_file_free(dir);
+    furi_record_close(RECORD_STORAGE);
+    return found;
+}
+
+const PasswordKeyboardKey* password_keyboard_key(const PasswordKeyboardLayout* layout, char c) {
+    static const PasswordKeyboardKey none[PASSWORD_KEYBOARD_MAX_STROKES] = {0};
+    uint8_t index = (uint8_t)c;
+    if(index >= PASSWORD_KEYBOARD_CHARACTERS) return none;
+    return layout->keys[index];
+}
+
+const PasswordKeyboardTiming* password_keyboard_timing(PasswordKeyboardSpeed speed) {
+    if(speed >= PasswordKeyboardSpeedCount) speed = PasswordKeyboardSpeedSafe;
+    return &password_keyboard_timings[speed];
+}
+
+const char* password_keyboard_speed_name(PasswordKeyboardSpeed speed) {
+    if(speed >= PasswordKeyboardSpeedCount) speed = PasswordKeyboardSpeedSafe;
+    return password_keyboard_speed_names[speed];
+}
+
+// Pustí všechny držené klávesy jedním reportem a počká, až je cíl zpracuje
+static bool password_keyboard_release(
+    const PasswordHidTransport* transport,
+    uint8_t* held_count,
+    const PasswordKeyboardTiming* timing) {
+    bool sent = transport->release_all();
+    *held_count = 0;
+    furi_delay_ms(timing->release_ms);
+    return sent;
+}
+
+// Napíše sekvenci s mrtvou klávesou, každý stisk samostatně
+static bool password_keyboard_sequence(
+    const PasswordHidTransport* transport,
+    const PasswordKeyboardKey* strokes,
+    const PasswordKeyboardTiming* timing) {
+    for(size_t i = 0; i < PASSWORD_KEYBOARD_MAX_STROKES && strokes[i].keycode != 0; i++) {
+        uint8_t held_count = 1;
+        bool sent = transport->press(strokes[i].modifier, strokes[i].keycode);
+        furi_delay_ms(timing->press_ms);
+        if(!password_keyboard_release(transport, &held_count, timing) || !sent) return false;
+    }
+    return true;
+}
+
+PasswordKeyboardResult password_keyboard_type(
+    const PasswordHidTransport* transport,
+    const char* text,
+    const PasswordKeyboardLayout* layout,
+    PasswordKeyboardSpeed speed,
+    PasswordKeyboardProgressCallback progress,
+    void* context) {
+    FURI_LOG_I(TAG, "Odesílání hesla přes %s", transport->name);
+    
+    // Kontrola, zda počítač přenos přijal
+    if(!transport->is_connected()) {
+        FURI_LOG_E(TAG, "%s není připojeno", transport->name);
+        return PasswordKeyboardResultDisconnected;
+    }
+    
+    const PasswordKeyboardTiming* timing = password_keyboard_timing(speed);
+    uint8_t held[PASSWORD_KEYBOARD_REPORT_KEYS];
+    uint8_t held_count = 0;
+    uint8_t held_modifier = 0;
+    PasswordKeyboardResult result = PasswordKeyboardResultOk;
+    
+    for(const char* c = text; *c != '\0'; c++) {
+        PASSWORD_PERF_BEGIN(start);
+        const PasswordKeyboardKey* strokes = password_keyboard_key(layout, *c);
+        PasswordKeyboardKey key = strokes[0];
+        bool sent = true;
+        
+        if(key.keycode == 0) {
+            // Znak se přeskočí
+        } else if(strokes[1].keycode != 0) {
+            // Mrtvá klávesa se nesmí potkat s drženými klávesami
+            if(held_count > 0) sent = password_keyboard_release(transport, &held_count, timing);
+            sent = password_keyboard_sequence(transport, strokes, timing) && sent;
+        } else {
+            // Klávesa se přidá k drženým, jen pokud sedí modifikátor, report má
+            // místo a stejná klávesa už držená není (jinak by se znak ztratil)
+            bool joins = held_count > 0 && held_count < timing->batch &&
+                         key.modifier == held_modifier;
+            for(uint8_t i = 0; joins && i < held_count; i++) {
+                if(held[i] == key.keycode) joins = false;
+            }
+            if(held_count > 0 && !joins) sent = password_keyboard_release(transport, &held_count, timing);
+            
+            sent = transport->press(key.modifier, key.keycode) && sent;
+            held[held_count++] = key.keycode;
+            held_modifier = key.modifier;
+            furi_delay_ms(timing->press_ms);
+        }
+        
+        if(!sent) {
+            FURI_LOG_E(TAG, "%s: report se neodeslal", transport->name);
+            result = PasswordKeyboardResultDisconnected;
+            break;
+        }
+        PASSWORD_PERF_END(PasswordPerfProbeKey, start);
+        if(progress && !progress(c - text + 1, context)) {
+            FURI_LOG_I(TAG, "Psaní zrušeno");
+            result = PasswordKeyboardResultCancelled;
+            break;
+        }
+    }
+    if(held_count > 0) password_keyboard_release(transport, &held_count, timing);
+    
+    return result;
+}
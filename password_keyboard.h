@@ -0,0 +1,198 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <storage/storage.h>
+
+#include "password_hid.h"
+
+/*
+ * Psaní hesla jako HID klávesnice
+ * 
+ * Znak se na kód klávesy a modifikátor převádí tabulkou rozložení pro
+ * 128 znaků ASCII. Rozložení US je přeložené v aplikaci, další se načítají
+ * ze souborů *.pwl v adresáři PASSWORD_KEYBOARD_LAYOUT_DIRECTORY:
+ * 
+ *   PasswordKeyboardLayoutHeader
+ *   PasswordKeyboardLayoutEntry entries[count]   znak a jeho stisky
+ * 
+ * Soubor se načte jednou do tabulky v RAM, při psaní se už jen indexuje.
+ * Znak, který se píše mrtvou klávesou (např. ^ na české klávesnici), má
+ * dva stisky: mrtvou klávesu a mezeru. Soubory vznikají z textových
+ * popisů v layouts/ nástrojem host/password_layout.c.
+ * 
+ * Po sobě jdoucí různé klávesy se stejným
+ * modifikátorem se drží současně (až 6 kláves v jednom reportu) a pustí
+ * se naráz jedním reportem, jeden znak tak nestojí dva celé intervaly
+ * čekání. Reporty odesílá přenos (password_hid.h), USB nebo Bluetooth.
+ * 
+ * Prodlevy po stisku a po puštění určuje rychlost psaní. Pomalé cíle
+ * (BIOS, vzdálená plocha) potřebují bezpečnou rychlost, běžný počítač
+ * zvládne i rychlou.
+ */
+
+// Nejvíc současně držených kláves v reportu (HID boot klávesnice)
+#define PASSWORD_KEYBOARD_REPORT_KEYS 6
+// Nejvíc stisků na jeden znak (mrtvá klávesa a mezera)
+#define PASSWORD_KEYBOARD_MAX_STROKES 2
+#define PASSWORD_KEYBOARD_CHARACTERS 128
+
+#define PASSWORD_KEYBOARD_LAYOUT_MAGIC 0x4C4B5750 // "PWKL"
+#define PASSWORD_KEYBOARD_LAYOUT_VERSION 1
+#define PASSWORD_KEYBOARD_LAYOUT_NAME_SIZE 16
+#define PASSWORD_KEYBOARD_LAYOUT_DIRECTORY APP_ASSETS_PATH("layouts")
+#define PASSWORD_KEYBOARD_LAYOUT_EXTENSION ".pwl"
+// Identifikátor vestavěného rozložení, nemá soubor
+#define PASSWORD_KEYBOARD_LAYOUT_DEFAULT "us"
+
+typedef enum {
+    PasswordKeyboardSpeedSafe,
+    PasswordKeyboardSpeedNormal,
+    PasswordKeyboardSpeedFast,
+    PasswordKeyboardSpeedCount,
+} PasswordKeyboardSpeed;
+
+typedef enum {
+    PasswordKeyboardResultOk,
+    PasswordKeyboardResultDisconnected, // Přenos není připojený nebo report neodeslal
+    PasswordKeyboardResultCancelled, // Psaní zrušil callback průběhu
+} PasswordKeyboardResult;
+
+/**
+ * @brief Callback průběhu psaní, volá se po každém znaku textu
+ * 
+ * @param typed Počet zpracovaných znaků textu
+ * @param context Kontext
+ * @return true Pokud se má psát dál
+ * @return false Pokud se má psaní zrušit
+ */
+typedef bool (*PasswordKeyboardProgressCallback)(size_t typed, void* context);
+
+typedef struct {
+    uint8_t press_ms; // Prodleva po každém stisku
+    uint8_t release_ms; // Prodleva po puštění držených kláves
+    uint8_t batch; // Nejvíc současně držených kláves, 1 až PASSWORD_KEYBOARD_REPORT_KEYS
+} PasswordKeyboardTiming;
+
+typedef struct {
+    uint8_t keycode; // Kód klávesy dle HID Usage Tables, 0 pro nepodporovaný znak
+    uint8_t modifier; // Bity modifikátorů HID reportu
+} PasswordKeyboardKey;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t count;
+    char name[PASSWORD_KEYBOARD_LAYOUT_NAME_SIZE]; // Název pro zobrazení, ukončený nulou
+} PasswordKeyboardLayoutHeader;
+
+typedef struct {
+    uint8_t character;
+    PasswordKeyboardKey strokes[PASSWORD_KEYBOARD_MAX_STROKES]; // Nepoužité stisky mají keycode 0
+} PasswordKeyboardLayoutEntry;
+
+typedef struct {
+    char name[PASSWORD_KEYBOARD_LAYOUT_NAME_SIZE];
+    PasswordKeyboardKey keys[PASSWORD_KEYBOARD_CHARACTERS][PASSWORD_KEYBOARD_MAX_STROKES];
+} PasswordKeyboardLayout;
+
+/**
+ * @brief Naplní rozložení vestavěnou tabulkou US
+ * 
+ * @param layout Rozložení
+ */
+void password_keyboard_layout_default(PasswordKeyboardLayout* layout);
+
+/**
+ * @brief Načte rozložení ze souboru
+ * 
+ * Při chybě zůstane rozložení beze změny.
+ * 
+ * @param layout Rozložení
+ * @param path Cesta k souboru .pwl
+ * @return true Pokud se načtení podařilo
+ * @return false Pokud soubor chybí nebo je poškozený
+ */
+bool password_keyboard_layout_load(PasswordKeyboardLayout* layout, const char* path);
+
+/**
+ * @brief Načte rozložení podle identifikátoru
+ * 
+ * @param layout Rozložení
+ * @param directory Adresář rozložení
+ * @param id Identifikátor (název souboru bez přípony), PASSWORD_KEYBOARD_LAYOUT_DEFAULT
+ *           pro vestavěné
+ * @return true Pokud se rozložení načetlo
+ * @return false Pokud soubor chybí nebo je poškozený, rozložení zůstane beze změny
+ */
+bool password_keyboard_layout_select(
+    PasswordKeyboardLayout* layout,
+    const char* directory,
+    const char* id);
+
+/**
+ * @brief Najde další rozložení v abecedním pořadí
+ * 
+ * Prochází soubory .pwl v adresáři, vestavěné rozložení je první.
+ * 
+ * @param directory Adresář rozložení
+ * @param current Identifikátor aktuálního rozložení (název souboru bez přípony)
+ * @param next Výstup, identifikátor dalšího rozložení
+ * @param size Velikost výstupu
+ * @return true Pokud další rozložení existuje
+ * @return false Pokud je aktuální poslední, další je vestavěné
+ */
+bool password_keyboard_layout_next(
+    const char* directory,
+    const char* current,
+    char* next,
+    size_t size);
+
+/**
+ * @brief Vrátí stisky pro znak
+ * 
+ * @param layout Rozložení
+ * @param c Znak
+ * @return const PasswordKeyboardKey* PASSWORD_KEYBOARD_MAX_STROKES stisků,
+ *         první má keycode 0, pokud znak nejde napsat
+ */
+const PasswordKeyboardKey* password_keyboard_key(const PasswordKeyboardLayout* layout, char c);
+
+/**
+ * @brief Vrátí prodlevy pro rychlost psaní
+ * 
+ * @param speed Rychlost psaní
+ * @return const PasswordKeyboardTiming* Prodlevy
+ */
+const PasswordKeyboardTiming* password_keyboard_timing(PasswordKeyboardSpeed speed);
+
+/**
+ * @brief Vrátí název rychlosti psaní pro zobrazení
+ * 
+ * @param speed Rychlost psaní
+ * @return const char* Název
+ */
+const char* password_keyboard_speed_name(PasswordKeyboardSpeed speed);
+
+/**
+ * @brief Napíše text jako HID klávesnice
+ * 
+ * Znaky, které v rozložení nejde napsat (mimo ASCII, řídicí), se přeskočí.
+ * Při zrušení se držené klávesy pustí, cíl tak dostane začátek textu.
+ * 
+ * @param transport Přenos, musí být zapnutý
+ * @param text Text k napsání
+ * @param layout Rozložení klávesnice cíle
+ * @param speed Rychlost psaní
+ * @param progress Callback průběhu, může být NULL
+ * @param context Kontext callbacku
+ * @return PasswordKeyboardResult Výsledek psaní
+ */
+PasswordKeyboardResult password_keyboard_type(
+    const PasswordHidTransport* transport,
+    const char* text,
+    const PasswordKeyboardLayout* layout,
+    PasswordKeyboardSpeed speed,
+    PasswordKeyboardProgressCallback progress,
+    void* context);
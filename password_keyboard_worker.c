@@ -0,0 +1,199 @@
+#include "password_keyboard_worker.h"
+#include "password_arena.h"
+#include <furi.h>
+#include <string.h>
+
+#define TAG "PasswordKeyboardWorker"
+
+#define PASSWORD_KEYBOARD_WORKER_STACK_SIZE 1024
+
+#define PASSWORD_KEYBOARD_WORKER_FLAG_JOB (1UL << 0)
+#define PASSWORD_KEYBOARD_WORKER_FLAG_STOP (1UL << 1)
+
+typedef struct {
+    char* text; // Slot arény tajemství, vrátí se po napsání nebo zrušení
+    const PasswordHidTransport* transport;
+    const PasswordKeyboardLayout* layout;
+    PasswordKeyboardSpeed speed;
+    uint32_t generation; // Generace workeru při zařazení, starší generace je zrušená
+} PasswordKeyboardWorkerJob;
+
+struct PasswordKeyboardWorker {
+    FuriThread* thread;
+    FuriMutex* mutex;
+    PasswordArena* arena;
+    
+    // Kruhová fronta, úloha jobs[head] se právě píše nebo je další na řadě
+    PasswordKeyboardWorkerJob jobs[PASSWORD_KEYBOARD_WORKER_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+    uint32_t generation;
+    
+    // Průběh právě psané úlohy
+    uint8_t typed;
+    uint8_t length;
+    
+    PasswordKeyboardWorkerCallback callback;
+    void* context;
+};
+
+static void password_keyboard_worker_notify(
+    PasswordKeyboardWorker* worker,
+    PasswordKeyboardWorkerEvent event) {
+    if(worker->callback) worker->callback(event, worker->context);
+}
+
+// Zapíše průběh a ověří, že úlohu mezitím nikdo nezrušil (ani z callbacku)
+static bool password_keyboard_worker_progress(size_t typed, void* context) {
+    PasswordKeyboardWorker* worker = context;
+    furi_mutex_acquire(worker->mutex, FuriWaitForever);
+    worker->typed = typed;
+    furi_mutex_release(worker->mutex);
+    password_keyboard_worker_notify(worker, PasswordKeyboardWorkerEventProgress);
+    
+    furi_mutex_acquire(worker->mutex, FuriWaitForever);
+    bool current = worker->jobs[worker->head].generation == worker->generation;
+    furi_mutex_release(worker->mutex);
+    return current;
+}
+
+// Napíše úlohu na začátku fronty a odebere ji, false pokud je fronta prázdná
+static bool password_keyboard_worker_run_job(PasswordKeyboardWorker* worker) {
+    furi_mutex_acquire(worker->mutex, FuriWaitForever);
+    if(worker->count == 0) {
+        furi_mutex_release(worker->mutex);
+        return false;
+    }
+    // Úlohu na začátku fronty nikdo jiný nemění, píše se bez držení mutexu
+    PasswordKeyboardWorkerJob* job = &worker->jobs[worker->head];
+    bool current = job->generation == worker->generation;
+    worker->typed = 0;
+    worker->length = strlen(job->text);
+    furi_mutex_release(worker->mutex);
+    
+    PasswordKeyboardResult result = current ? password_keyboard_type(
+                                                  job->transport,
+                                                  job->text,
+                                                  job->layout,
+                                                  job->speed,
+                                                  password_keyboard_worker_progress,
+                                                  worker) :
+                                              PasswordKeyboardResultCancelled;
+                                              
+    furi_mutex_acquire(worker->mutex, FuriWaitForever);
+    password_arena_release(worker->arena, job->text);
+    memset(job, 0, sizeof(PasswordKeyboardWorkerJob));
+    worker->head = (worker->head + 1) % PASSWORD_KEYBOARD_WORKER_QUEUE_SIZE;
+    worker->count--;
+    worker->typed = 0;
+    worker->length = 0;
+    furi_mutex_release(worker->mutex);
+    
+    static const PasswordKeyboardWorkerEvent events[] = {
+        [PasswordKeyboardResultOk] = PasswordKeyboardWorkerEventDone,
+        [PasswordKeyboardResultDisconnected] = PasswordKeyboardWorkerEventFailed,
+        [PasswordKeyboardResultCancelled] = PasswordKeyboardWorkerEventCancelled,
+    };
+    password_keyboard_worker_notify(worker, events[result]);
+    return true;
+}
+
+static int32_t password_keyboard_worker_thread(void* context) {
+    PasswordKeyboardWorker* worker = context;
+    while(true) {
+        uint32_t flags = furi_thread_flags_wait(
+            PASSWORD_KEYBOARD_WORKER_FLAG_JOB | PASSWORD_KEYBOARD_WORKER_FLAG_STOP,
+            FuriFlagWaitAny,
+            FuriWaitForever);
+        if(flags & PASSWORD_KEYBOARD_WORKER_FLAG_STOP) break;
+        while(password_keyboard_worker_run_job(worker)) {
+        }
+    }
+    return 0;
+}
+
+PasswordKeyboardWorker* password_keyboard_worker_alloc(
+    PasswordArena* arena,
+    PasswordKeyboardWorkerCallback callback,
+    void* context) {
+    PasswordKeyboardWorker* worker = malloc(sizeof(PasswordKeyboardWorker));
+    memset(worker, 0, sizeof(PasswordKeyboardWorker));
+    worker->arena = arena;
+    worker->callback = callback;
+    worker->context = context;
+    worker->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    worker->thread = furi_thread_alloc_ex(
+        TAG, PASSWORD_KEYBOARD_WORKER_STACK_SIZE, password_keyboard_worker_thread, worker);
+    furi_thread_start(worker->thread);
+    return worker;
+}
+
+void password_keyboard_worker_free(PasswordKeyboardWorker* worker) {
+    password_keyboard_worker_cancel(worker);
+    furi_thread_flags_set(furi_thread_get_id(worker->thread), PASSWORD_KEYBOARD_WORKER_FLAG_STOP);
+    furi_thread_join(worker->thread);
+    furi_thread_free(worker->thread);
+    furi_mutex_free(worker->mutex);
+    free(worker);
+}
+
+bool password_keyboard_worker_enqueue(
+    PasswordKeyboardWorker* worker,
+    const PasswordHidTransport* transport,
+    const char* text,
+    const PasswordKeyboardLayout* layout,
+    PasswordKeyboardSpeed speed) {
+    if(strlen(text) >= PASSWORD_KEYBOARD_WORKER_TEXT_SIZE) return false;
+    
+    // Kopie textu je tajemství, patří do arény
+    char* copy = password_arena_take(worker->arena, PASSWORD_KEYBOARD_WORKER_TEXT_SIZE);
+    if(!copy) return false;
+    strlcpy(copy, text, PASSWORD_KEYBOARD_WORKER_TEXT_SIZE);
+    
+    furi_mutex_acquire(worker->mutex, FuriWaitForever);
+    bool queued = worker->count < PASSWORD_KEYBOARD_WORKER_QUEUE_SIZE;
+    if(queued) {
+        PasswordKeyboardWorkerJob* job =
+            &worker->jobs[(worker->head + worker->count) % PASSWORD_KEYBOARD_WORKER_QUEUE_SIZE];
+        job->text = copy;
+        job->transport = transport;
+        job->layout = layout;
+        job->speed = speed;
+        job->generation = worker->generation;
+        worker->count++;
+    }
+    furi_mutex_release(worker->mutex);
+    
+    if(queued) {
+        furi_thread_flags_set(furi_thread_get_id(worker->thread), PASSWORD_KEYBOARD_WORKER_FLAG_JOB);
+    } else {
+        password_arena_release(worker->arena, copy);
+        FURI_LOG_W(TAG, "Fronta psaní je plná");
+    }
+    return queued;
+}
+
+void password_keyboard_worker_cancel(PasswordKeyboardWorker* worker) {
+    furi_mutex_acquire(worker->mutex, FuriWaitForever);
+    // Úloha na začátku fronty se může právě psát, odebere ji vlákno workeru
+    // podle generace. Čekající úlohy se zahodí hned.
+    worker->generation++;
+    for(uint8_t i = 1; i < worker->count; i++) {
+        PasswordKeyboardWorkerJob* job =
+            &worker->jobs[(worker->head + i) % PASSWORD_KEYBOARD_WORKER_QUEUE_SIZE];
+        password_arena_release(worker->arena, job->text);
+        memset(job, 0, sizeof(PasswordKeyboardWorkerJob));
+    }
+    if(worker->count > 1) worker->count = 1;
+    furi_mutex_release(worker->mutex);
+}
+
+void password_keyboard_worker_status(
+    PasswordKeyboardWorker* worker,
+    PasswordKeyboardWorkerStatus* status) {
+    furi_mutex_acquire(worker->mutex, FuriWaitForever);
+    status->pending = worker->count;
+    status->typed = worker->typed;
+    status->length = worker->length;
+    furi_mutex_release(worker->mutex);
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include "password_arena.h"
+#include "password_keyboard.h"
+
+/*
+ * Psaní hesel ve vlastním vlákně
+ * 
+ * Psaní hesla trvá podle rychlosti a délky i přes sekundu, po kterou by
+ * hlavní smyčka aplikace nezpracovávala vstup ani nepřekreslovala. Úlohy
+ * (kopie textu, přenos, rozložení a rychlost) se proto řadí do malé fronty a píše
+ * je vlákno workeru jednu po druhé. O průběhu a výsledku dává worker vědět
+ * callbackem, stav fronty jde kdykoli přečíst. Kopie textů jsou ve slotech
+ * arény tajemství (password_arena.h), fronta tak nealokuje na haldě.
+ * 
+ * Zrušení zahodí právě psanou úlohu (po dopsání aktuálního znaku) i všechny
+ * čekající. Sloty s kopiemi textů se po napsání i zrušení přepíšou a vrátí.
+ */
+
+// Nejvíc úloh ve frontě včetně právě psané
+#define PASSWORD_KEYBOARD_WORKER_QUEUE_SIZE 4
+// Velikost textu úlohy včetně ukončovací nuly (nejvýš PASSWORD_ARENA_SLOT_SIZE)
+#define PASSWORD_KEYBOARD_WORKER_TEXT_SIZE 64
+
+typedef struct PasswordKeyboardWorker PasswordKeyboardWorker;
+
+typedef enum {
+    PasswordKeyboardWorkerEventProgress, // Napsán další znak
+    PasswordKeyboardWorkerEventDone, // Úloha dopsána
+    PasswordKeyboardWorkerEventFailed, // Úlohu nešlo napsat (přenos není připojený)
+    PasswordKeyboardWorkerEventCancelled, // Úloha zrušena
+} PasswordKeyboardWorkerEvent;
+
+/**
+ * @brief Callback událostí workeru
+ * 
+ * Volá se z vlákna workeru, nesmí blokovat (typicky jen vloží událost
+ * do fronty aplikace s nulovým timeoutem).
+ * 
+ * @param event Událost
+ * @param context Kontext
+ */
+typedef void (*PasswordKeyboardWorkerCallback)(PasswordKeyboardWorkerEvent event, void* context);
+
+typedef struct {
+    uint8_t pending; // Úlohy ve frontě včetně právě psané
+    uint8_t typed; // Zpracované znaky právě psané úlohy
+    uint8_t length; // Délka právě psané úlohy
+} PasswordKeyboardWorkerStatus;
+
+/**
+ * @brief Vytvoří worker a spustí jeho vlákno
+ * 
+ * @param arena Aréna tajemství pro kopie textů, musí přežít worker
+ * @param callback Callback událostí, může být NULL
+ * @param context Kontext callbacku
+ * @return PasswordKeyboardWorker* Worker
+ */
+PasswordKeyboardWorker* password_keyboard_worker_alloc(
+    PasswordArena* arena,
+    PasswordKeyboardWorkerCallback callback,
+    void* context);
+
+/**
+ * @brief Zruší všechny úlohy, počká na ukončení vlákna a uvolní worker
+ * 
+ * @param worker Worker
+ */
+void password_keyboard_worker_free(PasswordKeyboardWorker* worker);
+
+/**
+ * @brief Zařadí text k napsání
+ * 
+ * Text se zkopíruje, přenos a rozložení ne: musí zůstat zapnutý, resp.
+ * platné a beze změny, dokud fronta není prázdná.
+ * 
+ * @param worker Worker
+ * @param transport Přenos
+ * @param text Text k napsání, nejvýš PASSWORD_KEYBOARD_WORKER_TEXT_SIZE - 1 znaků
+ * @param layout Rozložení klávesnice cíle
+ * @param speed Rychlost psaní
+ * @return true Pokud se úloha zařadila
+ * @return false Pokud je fronta nebo aréna plná nebo je text příliš dlouhý
+ */
+bool password_keyboard_worker_enqueue(
+    PasswordKeyboardWorker* worker,
+    const PasswordHidTransport* transport,
+    const char* text,
+    const PasswordKeyboardLayout* layout,
+    PasswordKeyboardSpeed speed);
+
+/**
+ * @brief Zruší právě psanou i všechny čekající úlohy
+ * 
+ * Nečeká na vlákno workeru, psaní skončí po aktuálním znaku.
+ * 
+ * @param worker Worker
+ */
+void password_keyboard_worker_cancel(PasswordKeyboardWorker* worker);
+
+/**
+ * @brief Přečte stav fronty a průběh právě psané úlohy
+ * 
+ * @param worker Worker
+ * @param status Výstup, stav
+ */
+void password_keyboard_worker_status(
+    PasswordKeyboardWorker* worker,
+    PasswordKeyboardWorkerStatus* status);
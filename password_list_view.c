@@ -0,0 +1,119 @@
+#include "password_list_view.h"
+
+#include <string.h>
+
+#define PASSWORD_LIST_VIEW_TEXT_X 10
+#define PASSWORD_LIST_VIEW_SCROLLBAR_WIDTH 3
+#define PASSWORD_LIST_VIEW_THUMB_MIN 3
+#define PASSWORD_LIST_VIEW_ELLIPSIS "..."
+
+void password_list_view_reset(PasswordListView* view) {
+    memset(view, 0, sizeof(PasswordListView));
+}
+
+// Zkrátí název řádku na šířku po celých znacích UTF-8 a doplní "..."
+static void password_list_view_row_fit(PasswordListViewRow* row, Canvas* canvas, uint16_t max_width) {
+    row->width = canvas_string_width(canvas, row->text);
+    if(row->width <= max_width) return;
+    
+    size_t length = strlen(row->text);
+    do {
+        // Odebere poslední znak i s jeho pokračovacími bajty
+        while(length > 0 && (row->text[--length] & 0xC0) == 0x80) {
+        }
+        strlcpy(row->text + length, PASSWORD_LIST_VIEW_ELLIPSIS, sizeof(row->text) - length);
+        row->width = canvas_string_width(canvas, row->text);
+    } while(row->width > max_width && length > 0);
+}
+
+// Řádek položky: z cache, nebo se do něj zkopíruje název ze seznamu
+static void password_list_view_row(
+    PasswordListView* view,
+    const PasswordListViewRow* cached,
+    uint8_t cached_count,
+    PasswordListViewRow* row,
+    PasswordList* list,
+    uint32_t index) {
+    for(uint8_t i = 0; i < cached_count; i++) {
+        if(cached[i].index == index) {
+            *row = cached[i];
+            return;
+        }
+    }
+    row->index = index;
+    row->width = 0;
+    strlcpy(row->text, password_list_get_name(list, index), sizeof(row->text));
+    view->misses++;
+}
+
+// Posuvník: čára přes výšku řádků a jezdec úměrný viditelné části
+static void password_list_view_draw_scrollbar(
+    Canvas* canvas,
+    int32_t top,
+    uint32_t position,
+    uint32_t total) {
+    int32_t x = canvas_width(canvas) - 2;
+    uint32_t height = PASSWORD_LIST_VIEW_ROWS * PASSWORD_LIST_VIEW_ROW_HEIGHT;
+    uint32_t thumb = MAX(height * PASSWORD_LIST_VIEW_ROWS / total, (uint32_t)PASSWORD_LIST_VIEW_THUMB_MIN);
+    uint32_t offset = (uint64_t)(height - thumb) * position / (total - 1);
+    
+    canvas_draw_line(canvas, x, top, x, top + height - 1);
+    canvas_draw_box(canvas, x - 1, top + offset, PASSWORD_LIST_VIEW_SCROLLBAR_WIDTH, thumb);
+}
+
+void password_list_view_update(
+    PasswordListView* view,
+    PasswordList* list,
+    PasswordListRange range,
+    uint32_t selected) {
+    range.end = MIN(range.end, list->count);
+    if(range.start >= range.end) {
+        view->count = 0;
+        return;
+    }
+    selected = MIN(MAX(selected, range.start), range.end - 1);
+    
+    // Okno: vybraná položka nejvýš třetí shora, dole bez prázdných řádků
+    uint32_t total = range.end - range.start;
+    uint32_t first = selected > range.start + 2 ? selected - 2 : range.start;
+    if(total > PASSWORD_LIST_VIEW_ROWS) first = MIN(first, range.end - PASSWORD_LIST_VIEW_ROWS);
+    uint8_t count = MIN(total - (first - range.start), (uint32_t)PASSWORD_LIST_VIEW_ROWS);
+    
+    // Řádky ze staré generace seznamu nebo zkrácené na jinou šířku neplatí
+    bool scrollbar = total > PASSWORD_LIST_VIEW_ROWS;
+    if(view->generation != list->generation || view->scrollbar != scrollbar) {
+        view->count = 0;
+        view->generation = list->generation;
+        view->scrollbar = scrollbar;
+    }
+    PasswordListViewRow cached[PASSWORD_LIST_VIEW_ROWS];
+    uint8_t cached_count = view->count;
+    memcpy(cached, view->rows, sizeof(cached));
+    
+    for(uint8_t i = 0; i < count; i++) {
+        password_list_view_row(view, cached, cached_count, &view->rows[i], list, first + i);
+    }
+    view->count = count;
+    view->selected = selected - first;
+    view->position = selected - range.start;
+    view->total = total;
+}
+
+void password_list_view_draw(PasswordListView* view, Canvas* canvas, int32_t y) {
+    uint16_t max_width = canvas_width(canvas) - PASSWORD_LIST_VIEW_TEXT_X -
+                         (view->scrollbar ? PASSWORD_LIST_VIEW_SCROLLBAR_WIDTH + 2 : 0);
+                         
+    for(uint8_t i = 0; i < view->count; i++) {
+        PasswordListViewRow* row = &view->rows[i];
+        if(row->width == 0) password_list_view_row_fit(row, canvas, max_width);
+        
+        int32_t row_y = y + i * PASSWORD_LIST_VIEW_ROW_HEIGHT;
+        if(i == view->selected) canvas_draw_str(canvas, 0, row_y, ">");
+        canvas_draw_str(canvas, PASSWORD_LIST_VIEW_TEXT_X, row_y, row->text);
+    }
+    
+    if(view->count > 0 && view->scrollbar) {
+        password_list_view_draw_scrollbar(
+            canvas, y - PASSWORD_LIST_VIEW_ROW_HEIGHT + 1, view->position, view->total);
+    }
+}
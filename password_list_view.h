@@ -0,0 +1,80 @@
+#pragma once
+
+#include <gui/gui.h>
+
+#include "password_storage.h"
+
+/*
+ * Vykreslení seznamu hesel
+ * 
+ * Kreslí se jen viditelné řádky, práce na snímek tak nezávisí na velikosti
+ * trezoru. Řádky připravuje hlavní vlákno (password_list_view_update) před
+ * view_port_update: zkopíruje do nich názvy, při posunu o řádek převezme tři
+ * z cache a čte jen nový. Kreslení ve vlákně GUI čte jen řádky, na seznam
+ * nesahá (stránkovaný seznam při čtení názvu načítá okno trezoru a pool se
+ * může přesunout). Cache se zahodí po změně záznamů seznamu
+ * (PasswordList.generation) nebo když se objeví či zmizí posuvník.
+ * 
+ * Název se zkrátí na šířku displeje (s "...") při prvním kreslení řádku
+ * a řádek si pamatuje i jeho šířku v pixelech. Zkrácení platí pro písmo
+ * nastavené při kreslení, seznam se kreslí vždy stejným písmem na stejně
+ * široké plátno.
+ * 
+ * Příprava i kreslení musí běžet pod stejným zámkem (řádky zapisují obě).
+ */
+
+// Počet viditelných řádků a jejich výška v pixelech
+#define PASSWORD_LIST_VIEW_ROWS 4
+#define PASSWORD_LIST_VIEW_ROW_HEIGHT 10
+
+typedef struct {
+    uint32_t index; // Index položky seznamu
+    uint16_t width; // Šířka zobrazeného textu v pixelech, 0 dokud se název nezkrátí
+    char text[NAME_MAX_LENGTH + 3]; // Název, po kreslení zkrácený na šířku řádku, případně s "..."
+} PasswordListViewRow;
+
+typedef struct {
+    PasswordListViewRow rows[PASSWORD_LIST_VIEW_ROWS];
+    uint8_t count; // Platné řádky v cache
+    uint8_t selected; // Řádek vybrané položky
+    uint32_t position; // Pořadí vybrané položky v rozsahu (pro posuvník)
+    uint32_t total; // Délka zobrazeného rozsahu
+    bool scrollbar; // Rozsah je delší než okno, řádky jsou užší o posuvník
+    uint32_t generation; // Generace seznamu, pro kterou cache platí
+    uint32_t misses; // Počet řádků připravených znovu (čtení názvu)
+} PasswordListView;
+
+/**
+ * @brief Zahodí cache řádků
+ * 
+ * Volá se při inicializaci a po výměně seznamu (např. po zamčení).
+ * 
+ * @param view Seznam na displeji
+ */
+void password_list_view_reset(PasswordListView* view);
+
+/**
+ * @brief Připraví viditelné řádky rozsahu, volá se v hlavním vlákně
+ * 
+ * Okno řádků se drží tak, aby vybraná položka byla nejvýš třetí shora
+ * a pod posledním názvem nezůstávaly prázdné řádky.
+ * 
+ * @param view Seznam na displeji
+ * @param list Seznam hesel
+ * @param range Zobrazený rozsah seznamu (např. zúžený filtrem)
+ * @param selected Vybraná položka
+ */
+void password_list_view_update(
+    PasswordListView* view,
+    PasswordList* list,
+    PasswordListRange range,
+    uint32_t selected);
+
+/**
+ * @brief Vykreslí připravené řádky a posuvník
+ * 
+ * @param view Seznam na displeji
+ * @param canvas Plátno
+ * @param y Účaří prvního řádku
+ */
+void password_list_view_draw(PasswordListView* view, Canvas* canvas, int32_t y);
@@ -0,0 +1,132 @@
+#include "password_loader.h"
+#include "password_crypto.h"
+#include <furi.h>
+#include <string.h>
+
+#define TAG "PasswordLoader"
+
+// Stejně jako zásobník aplikace, načtení v hlavní smyčce dřív vystačilo s ním
+#define PASSWORD_LOADER_STACK_SIZE (2 * 1024)
+
+struct PasswordLoader {
+    FuriThread* thread; // NULL, pokud se nenačítá a výsledek nečeká
+    FuriMutex* mutex;
+    bool done;
+    bool success;
+    volatile bool cancelled; // Načítání se zahodí, seznam ho kontroluje mezi záznamy
+    FuriString* path;
+    PasswordList list; // Patří vláknu, dokud done není true
+    
+    PasswordLoaderCallback callback;
+    void* context;
+};
+
+static int32_t password_loader_thread(void* context) {
+    PasswordLoader* loader = context;
+    bool success = password_list_load(&loader->list, furi_string_get_cstr(loader->path));
+    loader->list.cancel = NULL;
+    
+    furi_mutex_acquire(loader->mutex, FuriWaitForever);
+    loader->success = success;
+    loader->done = true;
+    bool cancelled = loader->cancelled;
+    furi_mutex_release(loader->mutex);
+    
+    // Zrušené načítání uklidí vlákno samo, password_loader_cancel na něj nečeká
+    if(cancelled) {
+        password_list_free(&loader->list);
+        FURI_LOG_I(TAG, "Načítání zrušeno");
+    }
+    
+    if(loader->callback) loader->callback(loader->context);
+    return 0;
+}
+
+PasswordLoader* password_loader_alloc(PasswordLoaderCallback callback, void* context) {
+    PasswordLoader* loader = malloc(sizeof(PasswordLoader));
+    memset(loader, 0, sizeof(PasswordLoader));
+    loader->callback = callback;
+    loader->context = context;
+    loader->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    loader->path = furi_string_alloc();
+    password_list_init(&loader->list);
+    return loader;
+}
+
+// Počká na vlákno, seznam pak patří volajícímu
+static bool password_loader_join(PasswordLoader* loader) {
+    if(!loader->thread) return false;
+    furi_thread_join(loader->thread);
+    furi_thread_free(loader->thread);
+    loader->thread = NULL;
+    return true;
+}
+
+void password_loader_free(PasswordLoader* loader) {
+    password_loader_cancel(loader);
+    password_loader_join(loader);
+    furi_string_free(loader->path);
+    furi_mutex_free(loader->mutex);
+    free(loader);
+}
+
+bool password_loader_start(PasswordLoader* loader, const char* path, const uint8_t* key) {
+    // Vlákno zrušeného načítání se uvolní, až skončí
+    if(loader->thread) {
+        furi_mutex_acquire(loader->mutex, FuriWaitForever);
+        bool finished = loader->done && loader->cancelled;
+        furi_mutex_release(loader->mutex);
+        if(!finished) return false;
+        password_loader_join(loader);
+    }
+    
+    furi_string_set_str(loader->path, path);
+    password_list_init(&loader->list);
+    password_list_set_key(&loader->list, key);
+    loader->list.cancel = &loader->cancelled;
+    loader->done = false;
+    loader->success = false;
+    loader->cancelled = false;
+    
+    loader->thread =
+        furi_thread_alloc_ex(TAG, PASSWORD_LOADER_STACK_SIZE, password_loader_thread, loader);
+    furi_thread_start(loader->thread);
+    return true;
+}
+
+bool password_loader_is_done(PasswordLoader* loader) {
+    if(!loader->thread) return false;
+    furi_mutex_acquire(loader->mutex, FuriWaitForever);
+    bool done = loader->done && !loader->cancelled;
+    furi_mutex_release(loader->mutex);
+    return done;
+}
+
+bool password_loader_finish(PasswordLoader* loader, PasswordList* list) {
+    if(!password_loader_join(loader)) return false;
+    
+    // Seznam zrušeného načítání už vlákno uvolnilo
+    if(loader->cancelled) return false;
+    if(!loader->success) {
+        password_list_free(&loader->list);
+        return false;
+    }
+    password_list_move(list, &loader->list);
+    return true;
+}
+
+void password_loader_cancel(PasswordLoader* loader) {
+    if(!loader->thread) return;
+    furi_mutex_acquire(loader->mutex, FuriWaitForever);
+    bool done = loader->done;
+    bool cancelled = loader->cancelled;
+    loader->cancelled = true;
+    furi_mutex_release(loader->mutex);
+    
+    // Skončené vlákno už na zrušení nezareaguje, výsledek se zahodí tady
+    if(done && !cancelled) {
+        password_loader_join(loader);
+        password_list_free(&loader->list);
+        FURI_LOG_I(TAG, "Načítání zrušeno");
+    }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "password_storage.h"
+
+/*
+ * Načítání trezoru ve vlastním vlákně
+ * 
+ * Načtení trezoru (čtení souboru, přehrání žurnálu, případné sloučení)
+ * by jinak stálo hlavní smyčku aplikace, která by po tu dobu nekreslila
+ * ani nezpracovávala vstup. Loader proto načte trezor do vlastního
+ * seznamu ve vlákně, které existuje jen po dobu načítání, a o dokončení
+ * dá vědět callbackem. Aplikace pak hotový seznam převezme
+ * (password_loader_finish), do té doby se seznamu nedotýká. Zrušení
+ * jen nastaví příznak, který načítání kontroluje mezi záznamy; hlavní
+ * smyčka na vlákno nečeká a to výsledek po skončení samo zahodí.
+ * 
+ * Než načítání skončí, stačí k zobrazení počtu hesel a prvních názvů
+ * password_vault_preview, která čte jen hlavičku a začátek trezoru.
+ */
+
+typedef struct PasswordLoader PasswordLoader;
+
+/**
+ * @brief Callback dokončení načítání
+ * 
+ * Volá se z vlákna loaderu, nesmí blokovat (typicky jen vloží událost
+ * do fronty aplikace s nulovým timeoutem).
+ * 
+ * @param context Kontext
+ */
+typedef void (*PasswordLoaderCallback)(void* context);
+
+/**
+ * @brief Vytvoří loader, vlákno se spustí až s načítáním
+ * 
+ * @param callback Callback dokončení, může být NULL
+ * @param context Kontext callbacku
+ * @return PasswordLoader* Loader
+ */
+PasswordLoader* password_loader_alloc(PasswordLoaderCallback callback, void* context);
+
+/**
+ * @brief Počká na dokončení načítání, zahodí jeho výsledek a uvolní loader
+ * 
+ * @param loader Loader
+ */
+void password_loader_free(PasswordLoader* loader);
+
+/**
+ * @brief Začne načítat trezor na pozadí
+ * 
+ * @param loader Loader
+ * @param path Cesta k trezoru (password_list_load)
+ * @param key Klíč seznamu (PASSWORD_CRYPTO_KEY_SIZE B), zkopíruje se
+ * @return true Pokud se načítání spustilo
+ * @return false Pokud loader ještě načítá (i zrušené načítání, které
+ * ještě neskončilo) nebo nepřevzatý výsledek drží
+ */
+bool password_loader_start(PasswordLoader* loader, const char* path, const uint8_t* key);
+
+/**
+ * @brief Zjistí, zda načítání skončilo a výsledek čeká na převzetí
+ * 
+ * @param loader Loader
+ * @return true Pokud password_loader_finish nebude čekat
+ * @return false Pokud se načítá, se nic nenačítá nebo bylo načítání zrušeno
+ */
+bool password_loader_is_done(PasswordLoader* loader);
+
+/**
+ * @brief Počká na dokončení načítání a převezme načtený seznam
+ * 
+ * @param loader Loader
+ * @param list Výstup, prázdný seznam (po password_list_init); načtený seznam ho přepíše
+ * @return true Pokud se trezor načetl
+ * @return false Pokud se načtení nepodařilo, bylo zrušeno nebo se nic nenačítalo,
+ * list zůstane prázdný
+ */
+bool password_loader_finish(PasswordLoader* loader, PasswordList* list);
+
+/**
+ * @brief Zruší načítání bez čekání na vlákno, výsledek se zahodí
+ * 
+ * Čtení trezoru a přehrávání žurnálu skončí u dalšího záznamu, zápis
+ * (převod nebo sloučení žurnálu) se nepřeruší, změny by jinak zůstaly
+ * nedokončené. Další password_loader_start se podaří, až vlákno skončí.
+ * 
+ * @param loader Loader
+ */
+void password_loader_cancel(PasswordLoader* loader);
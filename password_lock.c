@@ -0,0 +1,139 @@
+#include "password_lock.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <string.h>
+#include <storage/storage.h>
+#include <toolbox/stream/stream.h>
+#include <toolbox/stream/file_stream.h>
+
+#define TAG "PasswordLock"
+
+#define PASSWORD_LOCK_NEW_SUFFIX ".new"
+// Přidružená data kontrolního bloku
+#define PASSWORD_LOCK_CHECK_NAME "PWLK"
+
+// Přečte a ověří hlavičku souboru zámku
+static bool password_lock_read(Storage* storage, const char* path, PasswordLockFile* file) {
+    Stream* stream = file_stream_alloc(storage);
+    bool success = file_stream_open(stream, path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+                   stream_size(stream) == sizeof(PasswordLockFile) &&
+                   stream_read(stream, (uint8_t*)file, sizeof(PasswordLockFile)) ==
+                       sizeof(PasswordLockFile) &&
+                   file->magic == PASSWORD_LOCK_MAGIC && file->version == PASSWORD_LOCK_VERSION &&
+                   file->iterations >= PASSWORD_KDF_MIN_ITERATIONS &&
+                   file->iterations <= PASSWORD_KDF_MAX_ITERATIONS;
+    stream_free(stream);
+    return success;
+}
+
+// Klíč trezoru: HMAC(klíč zařízení, PBKDF2(PIN, sůl))
+static bool password_lock_derive(const PasswordLockFile* file, const char* pin, uint8_t* key) {
+    uint8_t device_key[PASSWORD_CRYPTO_KEY_SIZE];
+    if(!password_crypto_device_key(device_key)) return false;
+    
+    uint8_t pin_key[PASSWORD_KDF_HASH_SIZE];
+    uint32_t start = furi_get_tick();
+    password_kdf_derive(pin, strlen(pin), file->salt, sizeof(file->salt), file->iterations, pin_key);
+    FURI_LOG_I(TAG, "Odvození klíče trvalo %lu ms", furi_get_tick() - start);
+    
+    password_hmac_sha256(device_key, sizeof(device_key), pin_key, sizeof(pin_key), key);
+    password_crypto_wipe(pin_key, sizeof(pin_key));
+    password_crypto_wipe(device_key, sizeof(device_key));
+    return true;
+}
+
+bool password_lock_exists(const char* path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    bool exists = storage_file_exists(storage, path);
+    furi_record_close(RECORD_STORAGE);
+    return exists;
+}
+
+bool password_lock_pending(const char* path) {
+    FuriString* new_path = furi_string_alloc_printf("%s%s", path, PASSWORD_LOCK_NEW_SUFFIX);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    PasswordLockFile file;
+    bool pending = password_lock_read(storage, furi_string_get_cstr(new_path), &file);
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(new_path);
+    return pending;
+}
+
+bool password_lock_create(const char* path, const char* pin, uint8_t* key) {
+    PasswordLockFile file = {
+        .magic = PASSWORD_LOCK_MAGIC,
+        .version = PASSWORD_LOCK_VERSION,
+        .iterations = password_kdf_calibrate(PASSWORD_KDF_TARGET_MS),
+    };
+    furi_hal_random_fill_buf(file.salt, sizeof(file.salt));
+    if(!password_lock_derive(&file, pin, key) ||
+       !password_crypto_seal(
+           key, PASSWORD_LOCK_CHECK_NAME, strlen(PASSWORD_LOCK_CHECK_NAME), "", 0, file.check)) {
+        return false;
+    }
+    
+    // Nedopsaný soubor neprojde kontrolou velikosti a bere se jako neexistující
+    FuriString* new_path = furi_string_alloc_printf("%s%s", path, PASSWORD_LOCK_NEW_SUFFIX);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* stream = file_stream_alloc(storage);
+    bool success = file_stream_open(
+                       stream, furi_string_get_cstr(new_path), FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+                   stream_write(stream, (const uint8_t*)&file, sizeof(file)) == sizeof(file);
+    stream_free(stream);
+    if(!success) {
+        FURI_LOG_E(TAG, "Nelze zapsat %s", furi_string_get_cstr(new_path));
+        password_crypto_wipe(key, PASSWORD_CRYPTO_KEY_SIZE);
+    }
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(new_path);
+    return success;
+}
+
+bool password_lock_commit(const char* path) {
+    FuriString* new_path = furi_string_alloc_printf("%s%s", path, PASSWORD_LOCK_NEW_SUFFIX);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_remove(storage, path);
+    bool success = storage_common_rename(storage, furi_string_get_cstr(new_path), path) == FSE_OK;
+    if(!success) FURI_LOG_E(TAG, "Nelze přejmenovat %s", furi_string_get_cstr(new_path));
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(new_path);
+    return success;
+}
+
+void password_lock_discard(const char* path) {
+    FuriString* new_path = furi_string_alloc_printf("%s%s", path, PASSWORD_LOCK_NEW_SUFFIX);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_remove(storage, furi_string_get_cstr(new_path));
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(new_path);
+}
+
+void password_lock_recover(const char* path, bool rekeyed) {
+    if(password_lock_exists(path) || !password_lock_pending(path)) return;
+    
+    if(rekeyed) {
+        password_lock_commit(path);
+    } else {
+        password_lock_discard(path);
+    }
+}
+
+PasswordLockResult password_lock_unlock(const char* path, const char* pin, uint8_t* key) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    PasswordLockFile file;
+    bool valid = password_lock_read(storage, path, &file);
+    furi_record_close(RECORD_STORAGE);
+    if(!valid) {
+        FURI_LOG_E(TAG, "Neplatný soubor zámku %s", path);
+        return PasswordLockResultError;
+    }
+    if(!password_lock_derive(&file, pin, key)) return PasswordLockResultError;
+    
+    char empty[1];
+    if(!password_crypto_open(
+           key, PASSWORD_LOCK_CHECK_NAME, strlen(PASSWORD_LOCK_CHECK_NAME), file.check, 0, empty)) {
+        password_crypto_wipe(key, PASSWORD_CRYPTO_KEY_SIZE);
+        return PasswordLockResultWrongPin;
+    }
+    return PasswordLockResultOk;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "password_crypto.h"
+#include "password_kdf.h"
+
+/*
+ * Zámek trezoru (passwords.pwk)
+ * 
+ *   PasswordLockFile        parametry odvození klíče a kontrolní blok
+ * 
+ * Klíč trezoru je HMAC-SHA256(klíč zařízení, PBKDF2(PIN, sůl)). Bez PINu
+ * ho nejde spočítat ani na tomtéž Flipperu a kopie SD karty bez Flipperu
+ * nestačí. Kontrolní blok je prázdné heslo zapečetěné klíčem trezoru,
+ * špatný PIN se tak pozná bez čtení trezoru.
+ * 
+ * Soubor se zakládá jako "<cesta>.new" a na své místo se přejmenuje až
+ * po přešifrování trezoru novým klíčem (password_lock_commit).
+ */
+
+#define PASSWORD_LOCK_MAGIC 0x4B4C5750 // "PWLK"
+#define PASSWORD_LOCK_VERSION 1
+#define PASSWORD_LOCK_PIN_MIN_LENGTH 4
+#define PASSWORD_LOCK_PIN_MAX_LENGTH 10
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t iterations;
+    uint8_t salt[PASSWORD_KDF_SALT_SIZE];
+    uint8_t check[PASSWORD_CRYPTO_SEALED_SIZE(0)];
+} PasswordLockFile;
+
+typedef enum {
+    PasswordLockResultOk,
+    PasswordLockResultWrongPin,
+    PasswordLockResultError,
+} PasswordLockResult;
+
+/**
+ * @brief Zjistí, zda je zámek založený
+ * 
+ * @param path Cesta k souboru zámku
+ * @return true Pokud soubor zámku existuje
+ * @return false Pokud trezor zatím PIN nemá
+ */
+bool password_lock_exists(const char* path);
+
+/**
+ * @brief Zjistí, zda zůstal nedokončený zámek "<cesta>.new"
+ * 
+ * @param path Cesta k souboru zámku
+ * @return true Pokud zakládání zámku přerušil výpadek
+ * @return false Pokud nedokončený zámek neexistuje
+ */
+bool password_lock_pending(const char* path);
+
+/**
+ * @brief Založí zámek s novým PINem jako "<cesta>.new"
+ * 
+ * Počet iterací se nejdřív zkalibruje na PASSWORD_KDF_TARGET_MS, samotné
+ * založení tak trvá o něco déle než jedno odemčení.
+ * 
+ * @param path Cesta k souboru zámku
+ * @param pin PIN
+ * @param key Výstup, klíč trezoru (PASSWORD_CRYPTO_KEY_SIZE B)
+ * @return true Pokud se založení podařilo
+ * @return false Pokud se založení nepodařilo
+ */
+bool password_lock_create(const char* path, const char* pin, uint8_t* key);
+
+/**
+ * @brief Nahradí zámek nedokončeným "<cesta>.new"
+ * 
+ * @param path Cesta k souboru zámku
+ * @return true Pokud se přejmenování podařilo
+ * @return false Pokud se přejmenování nepodařilo
+ */
+bool password_lock_commit(const char* path);
+
+/**
+ * @brief Smaže nedokončený zámek "<cesta>.new"
+ * 
+ * @param path Cesta k souboru zámku
+ */
+void password_lock_discard(const char* path);
+
+/**
+ * @brief Dokončí založení zámku přerušené výpadkem
+ * 
+ * Nedokončený "<cesta>.new" platí, pokud se trezor stihl přešifrovat
+ * klíčem z nového PINu, jinak se zahodí. Když platný zámek existuje
+ * nebo žádný nedokončený nezůstal, nic se nemění.
+ * 
+ * @param path Cesta k souboru zámku
+ * @param rekeyed Trezor je už zašifrovaný klíčem nedokončeného zámku
+ */
+void password_lock_recover(const char* path, bool rekeyed);
+
+/**
+ * @brief Odvodí klíč trezoru z PINu a ověří ho
+ * 
+ * @param path Cesta k souboru zámku
+ * @param pin PIN
+ * @param key Výstup, klíč trezoru (PASSWORD_CRYPTO_KEY_SIZE B)
+ * @return PasswordLockResult Výsledek, klíč je platný jen pro PasswordLockResultOk
+ */
+PasswordLockResult password_lock_unlock(const char* path, const char* pin, uint8_t* key);
@@ -7,19 +7,62 @@
 #include <notification/notification.h>
 #include <notification/notification_messages.h>
 
+#include "password_arena.h"
+#include "password_generator.h"
+#include "password_groups.h"
+#include "password_hid.h"
+#include "password_import.h"
+#include "password_keyboard.h"
+#include "password_keyboard_worker.h"
+#include "password_list_view.h"
+#include "password_loader.h"
+#include "password_lock.h"
+#include "password_perf.h"
+#include "password_scroll.h"
 #include "password_storage.h"
+#include "password_totp.h"
 #include "password_view.h"
 
 #define TAG "PasswordManager"
-#define PASSWORDS_FILE_PATH "/ext/passwords/passwords.txt"
+#define PASSWORDS_FILE_PATH "/ext/passwords/passwords.pwv"
+#define LOCK_FILE_PATH "/ext/passwords/passwords.pwk"
+// Manifest skupin a adresář jejich trezorů (výchozí skupina je PASSWORDS_FILE_PATH)
+#define GROUPS_MANIFEST_PATH "/ext/passwords/groups.txt"
+#define GROUPS_DIRECTORY "/ext/passwords/groups"
+#define GROUP_NONE 0xFF
+#define GROUPS_PATH_SIZE 64
+#define PIN_SIZE (PASSWORD_LOCK_PIN_MAX_LENGTH + 1)
+#define AUTO_LOCK_MS (60 * 1000)
+// Jak často se při nezapsaných změnách kontroluje nečinnost (password_list_flush_if_idle)
+#define FLUSH_POLL_MS 500
+#define LAYOUT_SETTING_PATH "/ext/passwords/keyboard_layout.txt"
+// Posun hodin Flipperu proti UTC v minutách (qFlipper je nastaví na místní čas), TOTP počítá v UTC
+#define TOTP_OFFSET_SETTING_PATH "/ext/passwords/totp_offset.txt"
+// Jak často se u kódu TOTP kontroluje, zda už ubyla sekunda platnosti
+#define TOTP_POLL_MS 250
+#define PERF_LOG_PATH "/ext/passwords/perf.log"
+// Exporty jiných správců hesel, importuje se první nalezený
+#define IMPORT_PATHS                                                           \
+    {"/ext/passwords/import.csv", "/ext/passwords/import.xml", "/ext/passwords/import.json"}
+#define FUZZY_MAX_RESULTS 8
+#define FUZZY_ROWS 4
+#define FUZZY_ALPHABET "abcdefghijklmnopqrstuvwxyz0123456789-_."
+// Výchozí délka generovaného hesla, mění se po GENERATOR_LENGTH_STEP
+#define GENERATOR_LENGTH 16
+#define GENERATOR_LENGTH_STEP 1
+#define EVENT_QUEUE_SIZE 16
 
 // Definice scén
 enum {
     SceneMain,
+    SceneGroups,
+    SceneLoading,
     SceneList,
     SceneView,
     SceneEdit,
     SceneHelp,
+    SceneDiagnostics,
+    SceneLock,
     SceneCount
 };
 
@@ -28,54 +71,196 @@ typedef enum {
     EventTypeTick,
     EventTypeKey,
     EventTypeBack,
+    EventTypeTyping,
+    EventTypeLoaded,
 } EventType;
 
 typedef struct {
     EventType type;
     InputEvent input;
+    PasswordKeyboardWorkerEvent typing;
 } PasswordManagerEvent;
 
 // Struktura aplikace
 typedef struct {
     // Stav
     int current_scene;
-    int selected_index;
+    uint32_t selected_index;
     bool is_editing;
     
-    // Data
+    // Data: seznam drží trezor zobrazené skupiny (app->group), ostatní jsou jen v manifestu
+    PasswordGroups groups;
+    uint8_t group;
+    uint8_t group_selected;
+    uint8_t* key; // Klíč trezorů od odemčení do zamčení
+    PasswordLoader* loader;
+    uint8_t loading; // Skupina, jejíž trezor se načítá na pozadí, GROUP_NONE bez načítání
+    bool load_queued; // Načítání skupiny loading čeká, až skončí zrušené předchozí
+    PasswordVaultPreview preview; // Počet a první názvy načítaného trezoru
     PasswordList password_list;
     char name_buffer[NAME_MAX_LENGTH];
-    char password_buffer[PASSWORD_MAX_LENGTH];
     
-    // GUI
+    // Otevřená tajemství (klíč, hesla, PIN) jsou ve slotech arény, přepíšou se po použití
+    // a všechna nejpozději při ukončení aplikace
+    PasswordArena* arena;
+    char* password_buffer; // Heslo v editoru
+    char* secret_buffer; // Dešifrované heslo zobrazené položky, jen po dobu zobrazení
+    
+    // TOTP zobrazené položky: stav HMAC z jejího tajemství (password_totp.h) se připraví
+    // při otevření a přepíše se spolu se secret_buffer
+    PasswordTotp totp;
+    bool has_totp;
+    int32_t totp_offset; // Posun hodin proti UTC v sekundách
+    uint32_t totp_second; // Čas posledního vykreslení kódu
+    
+    // Generátor hesel v editoru: dávka náhodných bajtů zůstává mezi vygenerováními
+    // a přepíše se spolu s password_buffer; zásady jsou z předvoleb generator_presets
+    PasswordGenerator generator;
+    PasswordGeneratorPolicy generator_policy;
+    uint8_t generator_preset;
+    
+    // Filtr seznamu: prefix názvu a rozsah seznamu pro každou jeho délku
+    char filter[NAME_MAX_LENGTH];
+    uint8_t filter_length;
+    PasswordListRange filter_ranges[NAME_MAX_LENGTH];
+    
+    // Fuzzy hledání: vzor a nejlepší výsledky, vybraný je fuzzy_results[fuzzy_selected]
+    bool fuzzy;
+    char fuzzy_pattern[NAME_MAX_LENGTH];
+    uint8_t fuzzy_length;
+    PasswordSearchResult fuzzy_results[FUZZY_MAX_RESULTS];
+    uint32_t fuzzy_count;
+    uint32_t fuzzy_selected;
+    
+    // Názvy viditelných fuzzy výsledků (od fuzzy_first) a zobrazené položky pro kreslení,
+    // kopíruje je hlavní vlákno spolu s řádky list_view
+    char fuzzy_names[FUZZY_ROWS][NAME_MAX_LENGTH];
+    uint32_t fuzzy_first;
+    uint8_t fuzzy_rows;
+    char view_name[NAME_MAX_LENGTH];
+    
+    // Opakování držené klávesy od stisku, určuje krok posouvání
+    uint32_t scroll_repeats;
+    
+    // Viditelné řádky seznamu se zkrácenými názvy, připravuje je hlavní vlákno
+    PasswordListView list_view;
+    
+    // Rychlost psaní hesla přes USB a rozložení klávesnice cíle, volí se na obrazovce hesla
+    PasswordKeyboardSpeed keyboard_speed;
+    PasswordKeyboardLayout keyboard_layout;
+    char keyboard_layout_id[PASSWORD_KEYBOARD_LAYOUT_NAME_SIZE];
+    
+    // Psaní hesel běží ve vlákně workeru, hlavní smyčka mezitím dál zpracovává vstup.
+    // Přenos (USB nebo Bluetooth) zůstává zapnutý po celou dobu běhu aplikace.
+    PasswordKeyboardWorker* keyboard_worker;
+    const PasswordHidTransport* keyboard_transport;
+    
+    // Zámek: PIN se zadává šipkami, nový PIN dvakrát (první zadání v pin_first)
+    char* pin;
+    uint8_t pin_length;
+    char* pin_first;
+    bool pin_setup;
+    const char* lock_message;
+    uint32_t last_activity;
+    
+    // Import exportu: průběh a výsledek se zobrazí na hlavní obrazovce
+    PasswordImportProgress import_progress;
+    const char* import_message;
+    bool importing;
+    
+    // Záznamy importu pro jinou než načtenou skupinu čekají zapečetěné v paměti, trezor se
+    // přepne až po návratu z parseru (password_manager_import_drain), ne hluboko v jeho callbacku
+    PasswordList* import_pending; // PASSWORD_GROUPS_MAX seznamů, jen po dobu importu
+    uint32_t import_late_skipped; // Odložené záznamy, jejichž název už v trezoru byl
+    bool import_failed;
+    
+    // Vykreslení jen po změně stavu (doba snímků se měří sondou password_perf.h)
+    bool redraw;
+    
+    // GUI; draw_mutex drží kreslení a příprava dat pro něj (list_view, fuzzy_names, view_name)
     ViewPort* view_port;
+    FuriMutex* draw_mutex;
     Gui* gui;
     NotificationApp* notifications;
     
-    // Události
+    // Události; událost vytažená z fronty při slučování opakování, zpracuje se jako další
     FuriMessageQueue* event_queue;
+    PasswordManagerEvent pending_event;
+    bool has_pending_event;
 } PasswordManager;
 
 // Prototypy funkcí
 static void password_manager_render_callback(Canvas* canvas, void* ctx);
 static void password_manager_input_callback(InputEvent* input_event, void* ctx);
+static void password_manager_typing_callback(PasswordKeyboardWorkerEvent typing, void* ctx);
+static void password_manager_loader_callback(void* ctx);
 static void password_manager_draw_main_scene(Canvas* canvas, PasswordManager* app);
+static void password_manager_draw_groups_scene(Canvas* canvas, PasswordManager* app);
+static void password_manager_draw_loading_scene(Canvas* canvas, PasswordManager* app);
 static void password_manager_draw_list_scene(Canvas* canvas, PasswordManager* app);
 static void password_manager_draw_view_scene(Canvas* canvas, PasswordManager* app);
 static void password_manager_draw_edit_scene(Canvas* canvas, PasswordManager* app);
 static void password_manager_draw_help_scene(Canvas* canvas, PasswordManager* app);
+static void password_manager_draw_diagnostics_scene(Canvas* canvas, PasswordManager* app);
+static void password_manager_draw_lock_scene(Canvas* canvas, PasswordManager* app);
+static void password_manager_lock(PasswordManager* app);
+static void password_manager_lock_recover(PasswordManager* app);
+static void password_manager_layout_restore(PasswordManager* app);
+static void password_manager_totp_offset_restore(PasswordManager* app);
+static void password_manager_group_leave(PasswordManager* app);
+static void password_manager_load_cancel(PasswordManager* app);
 
 // Inicializace aplikace
 static PasswordManager* password_manager_alloc() {
     PasswordManager* app = malloc(sizeof(PasswordManager));
+    app->redraw = true;
+    app->scroll_repeats = 0;
+    app->has_pending_event = false;
+    app->import_message = NULL;
+    app->importing = false;
+    app->import_pending = NULL;
+    app->has_totp = false;
+    app->totp_second = 0;
+    password_generator_init(&app->generator);
+    app->generator_preset = 0;
+    app->generator_policy = (PasswordGeneratorPolicy){
+        .length = GENERATOR_LENGTH,
+        .classes = PasswordGeneratorClassLower | PasswordGeneratorClassUpper |
+                   PasswordGeneratorClassDigits | PasswordGeneratorClassSymbols,
+        .require_each = true,
+    };
     
-    // Inicializace dat
-    password_list_init(&app->password_list);
-    password_list_load(&app->password_list, PASSWORDS_FILE_PATH);
+    // Sloty pro tajemství se vydají jednou, aréna je má na celou dobu běhu
+    app->arena = password_arena_alloc();
+    app->key = password_arena_take(app->arena, PASSWORD_CRYPTO_KEY_SIZE);
+    app->password_buffer = password_arena_take(app->arena, PASSWORD_MAX_LENGTH);
+    app->secret_buffer = password_arena_take(app->arena, PASSWORD_MAX_LENGTH);
+    app->pin = password_arena_take(app->arena, PIN_SIZE);
+    app->pin_first = password_arena_take(app->arena, PIN_SIZE);
     
-    app->current_scene = SceneMain;
-    app->selected_index = 0;
+    // Inicializace fronty událostí a workeru psaní (zamčení ruší psaní)
+    app->event_queue = furi_message_queue_alloc(EVENT_QUEUE_SIZE, sizeof(PasswordManagerEvent));
+    app->draw_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    app->keyboard_worker = password_keyboard_worker_alloc(app->arena, password_manager_typing_callback, app);
+    app->loader = password_loader_alloc(password_manager_loader_callback, app);
+    
+    // Trezor se načte až po odemčení PINem, na pozadí
+    password_groups_init(&app->groups);
+    app->group = GROUP_NONE;
+    app->loading = GROUP_NONE;
+    app->load_queued = false;
+    app->group_selected = 0;
+    password_list_init(&app->password_list);
+    password_manager_lock_recover(app);
+    password_manager_lock(app);
     app->is_editing = false;
+    app->keyboard_speed = PasswordKeyboardSpeedNormal;
+    password_manager_layout_restore(app);
+    password_manager_totp_offset_restore(app);
+    
+    // Přepnutí USB do režimu HID jednou na celou relaci, ne při každém odeslání
+    app->keyboard_transport = &password_hid_usb;
+    app->keyboard_transport->start();
     
     // Inicializace GUI
     app->view_port = view_port_alloc();
@@ -88,16 +273,20 @@ static PasswordManager* password_manager_alloc() {
     // Přidání view_port do GUI
     gui_add_view_port(app->gui, app->view_port, GuiLayerFullscreen);
     
-    // Inicializace fronty událostí
-    app->event_queue = furi_message_queue_alloc(8, sizeof(PasswordManagerEvent));
-    
     return app;
 }
 
 // Uvolnění aplikace
 static void password_manager_free(PasswordManager* app) {
-    // Uložení hesel
-    password_list_save(&app->password_list, PASSWORDS_FILE_PATH);
+    // Zrušení psaní (worker posílá události do fronty aplikace) a obnovení USB
+    password_keyboard_worker_free(app->keyboard_worker);
+    app->keyboard_transport->stop();
+    
+    // Zapsání čekajících změn, nezměněný trezor se nezapisuje
+    password_manager_load_cancel(app);
+    password_loader_free(app->loader);
+    password_manager_group_leave(app);
+    password_list_free(&app->password_list);
     
     // Uvolnění GUI
     view_port_enabled_set(app->view_port, false);
@@ -110,14 +299,25 @@ static void password_manager_free(PasswordManager* app) {
     
     // Uvolnění fronty událostí
     furi_message_queue_free(app->event_queue);
+    furi_mutex_free(app->draw_mutex);
     
-    // Uvolnění paměti
+    // Vrácení slotů (přepíšou se) a uvolnění arény, která přepíše i případné nevrácené
+    password_arena_release(app->arena, app->key);
+    password_arena_release(app->arena, app->password_buffer);
+    password_arena_release(app->arena, app->secret_buffer);
+    password_arena_release(app->arena, app->pin);
+    password_arena_release(app->arena, app->pin_first);
+    password_arena_free(app->arena);
+    password_crypto_wipe(app, sizeof(PasswordManager));
     free(app);
 }
 
-// Callback pro vykreslení
+// Callback pro vykreslení, běží ve vlákně GUI a nesmí alokovat. Seznam hesel nečte
+// (stránkovaný načítá okno trezoru), názvy bere z řádků připravených hlavním vláknem.
 static void password_manager_render_callback(Canvas* canvas, void* ctx) {
     PasswordManager* app = ctx;
+    furi_mutex_acquire(app->draw_mutex, FuriWaitForever);
+    PASSWORD_PERF_BEGIN(start);
     
     canvas_clear(canvas);
     canvas_set_font(canvas, FontPrimary);
@@ -127,6 +327,12 @@ static void password_manager_render_callback(Canvas* canvas, void* ctx) {
         case SceneMain:
             password_manager_draw_main_scene(canvas, app);
             break;
+        case SceneGroups:
+            password_manager_draw_groups_scene(canvas, app);
+            break;
+        case SceneLoading:
+            password_manager_draw_loading_scene(canvas, app);
+            break;
         case SceneList:
             password_manager_draw_list_scene(canvas, app);
             break;
@@ -139,9 +345,18 @@ static void password_manager_render_callback(Canvas* canvas, void* ctx) {
         case SceneHelp:
             password_manager_draw_help_scene(canvas, app);
             break;
+        case SceneDiagnostics:
+            password_manager_draw_diagnostics_scene(canvas, app);
+            break;
+        case SceneLock:
+            password_manager_draw_lock_scene(canvas, app);
+            break;
         default:
             break;
     }
+    
+    PASSWORD_PERF_END(PasswordPerfProbeFrame, start);
+    furi_mutex_release(app->draw_mutex);
 }
 
 // Callback pro vstup
@@ -154,56 +369,1016 @@ static void password_manager_input_callback(InputEvent* input_event, void* ctx)
         .input = *input_event
     };
     
-    // Odeslání události do fronty
-    furi_message_queue_put(app->event_queue, &event, FuriWaitForever);
+    // Odeslání události do fronty bez čekání, vlákno vstupu nesmí blokovat. Opakování
+    // držené klávesy se v hlavní smyčce slučují, plná fronta tak zahodí nanejvýš opakování.
+    furi_message_queue_put(app->event_queue, &event, 0);
+}
+
+// Callback workeru psaní, běží v jeho vlákně a nesmí čekat. Při plné frontě
+// se událost zahodí, průběh se stejně čte ze stavu workeru při vykreslení.
+static void password_manager_typing_callback(PasswordKeyboardWorkerEvent typing, void* ctx) {
+    PasswordManager* app = ctx;
+    PasswordManagerEvent event = {
+        .type = EventTypeTyping,
+        .typing = typing,
+    };
+    furi_message_queue_put(app->event_queue, &event, 0);
+}
+
+// Callback loaderu, běží v jeho vlákně. Při plné frontě se událost zahodí, dokončení
+// se stejně kontroluje v každém průchodu hlavní smyčkou.
+static void password_manager_loader_callback(void* ctx) {
+    PasswordManager* app = ctx;
+    PasswordManagerEvent event = {.type = EventTypeLoaded};
+    furi_message_queue_put(app->event_queue, &event, 0);
+}
+
+// Zda worker právě píše nebo má úlohy ve frontě
+static bool password_manager_typing(PasswordManager* app) {
+    PasswordKeyboardWorkerStatus status;
+    password_keyboard_worker_status(app->keyboard_worker, &status);
+    return status.pending > 0;
+}
+
+// Rozsah seznamu zúžený filtrem, bez filtru celý seznam
+static PasswordListRange password_manager_visible_range(PasswordManager* app) {
+    if(app->filter_length == 0) return (PasswordListRange){0, app->password_list.count};
+    return app->filter_ranges[app->filter_length];
+}
+
+// Zruší filtr i fuzzy hledání, po změně seznamu už spočítané rozsahy a výsledky neplatí
+static void password_manager_filter_reset(PasswordManager* app) {
+    memset(app->filter, 0, sizeof(app->filter));
+    app->filter_length = 0;
+    app->fuzzy = false;
+    memset(app->fuzzy_pattern, 0, sizeof(app->fuzzy_pattern));
+    app->fuzzy_length = 0;
+    app->fuzzy_count = 0;
+}
+
+// Zahodí názvy připravené pro kreslení (po výměně seznamu), kreslení je mezitím nečte
+static void password_manager_draw_reset(PasswordManager* app) {
+    furi_mutex_acquire(app->draw_mutex, FuriWaitForever);
+    password_list_view_reset(&app->list_view);
+    memset(app->fuzzy_names, 0, sizeof(app->fuzzy_names));
+    app->fuzzy_first = 0;
+    app->fuzzy_rows = 0;
+    memset(app->view_name, 0, sizeof(app->view_name));
+    furi_mutex_release(app->draw_mutex);
+}
+
+// Připraví názvy pro kreslení v hlavním vlákně: čtení názvu může načíst okno trezoru
+static void password_manager_draw_prepare(PasswordManager* app) {
+    furi_mutex_acquire(app->draw_mutex, FuriWaitForever);
+    if(app->current_scene == SceneList && app->fuzzy) {
+        // Vybraný výsledek nejvýš třetí shora
+        app->fuzzy_first = app->fuzzy_selected > 2 ? app->fuzzy_selected - 2 : 0;
+        uint32_t first = MIN(app->fuzzy_first, app->fuzzy_count);
+        app->fuzzy_rows = MIN(app->fuzzy_count - first, (uint32_t)FUZZY_ROWS);
+        for(uint8_t i = 0; i < app->fuzzy_rows; i++) {
+            uint32_t index = app->fuzzy_results[app->fuzzy_first + i].index;
+            strlcpy(app->fuzzy_names[i], password_list_get_name(&app->password_list, index), NAME_MAX_LENGTH);
+        }
+    } else if(app->current_scene == SceneList) {
+        password_list_view_update(
+            &app->list_view,
+            &app->password_list,
+            password_manager_visible_range(app),
+            app->selected_index);
+    } else if(app->current_scene == SceneView && app->selected_index < app->password_list.count) {
+        strlcpy(
+            app->view_name,
+            password_list_get_name(&app->password_list, app->selected_index),
+            NAME_MAX_LENGTH);
+    }
+    furi_mutex_release(app->draw_mutex);
+}
+
+// Překreslí obrazovku s názvy připravenými podle aktuálního stavu
+static void password_manager_redraw(PasswordManager* app) {
+    password_manager_draw_prepare(app);
+    view_port_update(app->view_port);
+}
+
+// Rozložení klávesnice
+
+// Načte naposledy zvolené rozložení, bez volby nebo při chybě zůstane vestavěné
+static void password_manager_layout_restore(PasswordManager* app) {
+    strlcpy(app->keyboard_layout_id, PASSWORD_KEYBOARD_LAYOUT_DEFAULT, sizeof(app->keyboard_layout_id));
+    password_keyboard_layout_default(&app->keyboard_layout);
+    
+    char id[PASSWORD_KEYBOARD_LAYOUT_NAME_SIZE] = {0};
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, LAYOUT_SETTING_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        storage_file_read(file, id, sizeof(id) - 1);
+    }
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    
+    id[strcspn(id, "\r\n")] = '\0';
+    if(id[0] != '\0' &&
+       password_keyboard_layout_select(&app->keyboard_layout, PASSWORD_KEYBOARD_LAYOUT_DIRECTORY, id)) {
+        strlcpy(app->keyboard_layout_id, id, sizeof(app->keyboard_layout_id));
+    }
+}
+
+// Přepne na další rozložení (za posledním zase vestavěné) a volbu uloží
+static void password_manager_layout_next(PasswordManager* app) {
+    char id[PASSWORD_KEYBOARD_LAYOUT_NAME_SIZE];
+    if(!password_keyboard_layout_next(
+           PASSWORD_KEYBOARD_LAYOUT_DIRECTORY, app->keyboard_layout_id, id, sizeof(id))) {
+        strlcpy(id, PASSWORD_KEYBOARD_LAYOUT_DEFAULT, sizeof(id));
+    }
+    if(!password_keyboard_layout_select(&app->keyboard_layout, PASSWORD_KEYBOARD_LAYOUT_DIRECTORY, id)) {
+        return;
+    }
+    strlcpy(app->keyboard_layout_id, id, sizeof(app->keyboard_layout_id));
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    if(!storage_file_open(file, LAYOUT_SETTING_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS) ||
+       storage_file_write(file, id, strlen(id)) != strlen(id)) {
+        FURI_LOG_E(TAG, "Nelze uložit rozložení klávesnice");
+    }
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+// TOTP
+
+// Načte posun hodin proti UTC, bez nastavení jdou hodiny v UTC
+static void password_manager_totp_offset_restore(PasswordManager* app) {
+    char minutes[12] = {0};
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    if(storage_file_open(file, TOTP_OFFSET_SETTING_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        storage_file_read(file, minutes, sizeof(minutes) - 1);
+    }
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    
+    app->totp_offset = strtol(minutes, NULL, 10) * 60;
+}
+
+// Unixový čas v UTC
+static uint64_t password_manager_totp_time(PasswordManager* app) {
+    return (int64_t)furi_hal_rtc_get_timestamp() - app->totp_offset;
+}
+
+// Zapomene heslo a stav TOTP zobrazené položky
+static void password_manager_view_close(PasswordManager* app) {
+    password_crypto_wipe(app->secret_buffer, PASSWORD_MAX_LENGTH);
+    password_crypto_wipe(&app->totp, sizeof(app->totp));
+    app->has_totp = false;
+}
+
+// Generátor hesel
+
+// Předvolby tříd znaků, přepínají se Nahoru/Dolů; první je výchozí
+static const uint8_t generator_presets[] = {
+    PasswordGeneratorClassLower | PasswordGeneratorClassUpper | PasswordGeneratorClassDigits |
+        PasswordGeneratorClassSymbols,
+    PasswordGeneratorClassLower | PasswordGeneratorClassUpper | PasswordGeneratorClassDigits,
+    PasswordGeneratorClassLower | PasswordGeneratorClassDigits,
+    PasswordGeneratorClassDigits,
+};
+
+// Vygeneruje heslo rovnou do password_buffer (slot arény), bez kopie mimo něj
+static void password_manager_generate(PasswordManager* app) {
+    if(!password_generator_generate(
+           &app->generator, &app->generator_policy, app->password_buffer, PASSWORD_MAX_LENGTH)) {
+        notification_message(app->notifications, &sequence_blink_red_100);
+    }
+}
+
+// Změní délku generovaného hesla v mezích generátoru a heslo vygeneruje znovu
+static void password_manager_generator_length(PasswordManager* app, bool longer) {
+    uint8_t length = app->generator_policy.length;
+    if(longer && length + GENERATOR_LENGTH_STEP <= PASSWORD_GENERATOR_MAX_LENGTH) {
+        length += GENERATOR_LENGTH_STEP;
+    } else if(!longer && length >= PASSWORD_GENERATOR_MIN_LENGTH + GENERATOR_LENGTH_STEP) {
+        length -= GENERATOR_LENGTH_STEP;
+    }
+    app->generator_policy.length = length;
+    password_manager_generate(app);
+}
+
+// Přepne na další (předchozí) předvolbu tříd znaků a heslo vygeneruje znovu
+static void password_manager_generator_preset(PasswordManager* app, bool forward) {
+    const uint8_t count = sizeof(generator_presets) / sizeof(generator_presets[0]);
+    app->generator_preset = (app->generator_preset + (forward ? 1 : count - 1)) % count;
+    app->generator_policy.classes = generator_presets[app->generator_preset];
+    password_manager_generate(app);
+}
+
+// Otevře editor nového hesla s vygenerovaným heslem
+static void password_manager_edit_open(PasswordManager* app) {
+    app->is_editing = false;
+    memset(app->name_buffer, 0, sizeof(app->name_buffer));
+    password_manager_generate(app);
+    app->current_scene = SceneEdit;
+}
+
+// Zapomene heslo v editoru i nespotřebované náhodné bajty generátoru
+static void password_manager_edit_close(PasswordManager* app) {
+    password_crypto_wipe(app->password_buffer, PASSWORD_MAX_LENGTH);
+    password_generator_wipe(&app->generator);
+}
+
+// Název v editoru se zadává jako vzor fuzzy hledání: šipky mění poslední znak
+static void password_manager_name_step(PasswordManager* app, bool forward) {
+    size_t length = strlen(app->name_buffer);
+    const size_t alphabet_size = sizeof(FUZZY_ALPHABET) - 1;
+    if(length == 0) {
+        if(forward) app->name_buffer[0] = FUZZY_ALPHABET[0];
+        return;
+    }
+    
+    char* last = &app->name_buffer[length - 1];
+    const char* found = strchr(FUZZY_ALPHABET, *last);
+    size_t position = found ? (size_t)(found - FUZZY_ALPHABET) : 0;
+    position = (position + (forward ? 1 : alphabet_size - 1)) % alphabet_size;
+    *last = FUZZY_ALPHABET[position];
+}
+
+// Přidá na konec názvu znak, nový začíná od 'a'
+static void password_manager_name_push(PasswordManager* app) {
+    size_t length = strlen(app->name_buffer);
+    if(length + 1 < NAME_MAX_LENGTH) app->name_buffer[length] = FUZZY_ALPHABET[0];
+}
+
+// Smaže poslední znak názvu
+static void password_manager_name_pop(PasswordManager* app) {
+    size_t length = strlen(app->name_buffer);
+    if(length > 0) app->name_buffer[length - 1] = '\0';
+}
+
+// Přepne mezi přenosem USB a Bluetooth, původní přenos vrátí do výchozího stavu
+static void password_manager_transport_next(PasswordManager* app) {
+    const PasswordHidTransport* next =
+        app->keyboard_transport == &password_hid_usb ? &password_hid_ble : &password_hid_usb;
+    app->keyboard_transport->stop();
+    if(!next->start()) {
+        notification_message(app->notifications, &sequence_blink_red_100);
+        next = app->keyboard_transport;
+        next->start();
+    }
+    app->keyboard_transport = next;
+}
+
+// Skupiny
+
+// Uvolní trezor zobrazené skupiny: zapíše změny, zaznamená počet hesel do manifestu
+static void password_manager_group_leave(PasswordManager* app) {
+    if(app->group == GROUP_NONE) return;
+    
+    password_list_flush(&app->password_list);
+    password_groups_set_count(&app->groups, app->group, app->password_list.count);
+    password_groups_save(&app->groups, GROUPS_MANIFEST_PATH);
+    password_list_free(&app->password_list);
+    password_list_init(&app->password_list);
+    password_manager_view_close(app);
+    password_manager_filter_reset(app);
+    password_manager_draw_reset(app);
+    app->selected_index = 0;
+    app->group = GROUP_NONE;
+}
+
+// Načte trezor skupiny klíčem z odemčení, trezor předchozí skupiny se uvolní
+static bool password_manager_group_enter(PasswordManager* app, uint8_t index) {
+    if(app->group == index) return true;
+    password_manager_group_leave(app);
+    
+    char path[GROUPS_PATH_SIZE];
+    password_groups_vault_path(
+        &app->groups, index, PASSWORDS_FILE_PATH, GROUPS_DIRECTORY, path, sizeof(path));
+    if(index > 0) {
+        Storage* storage = furi_record_open(RECORD_STORAGE);
+        storage_simply_mkdir(storage, GROUPS_DIRECTORY);
+        furi_record_close(RECORD_STORAGE);
+    }
+    
+    password_list_set_key(&app->password_list, app->key);
+    if(!password_list_load(&app->password_list, path)) {
+        password_list_free(&app->password_list);
+        password_list_init(&app->password_list);
+        return false;
+    }
+    app->group = index;
+    password_groups_set_count(&app->groups, index, app->password_list.count);
+    return true;
+}
+
+// Spustí loader pro skupinu app->loading, dokud běží zrušené načítání, nejde to
+static bool password_manager_load_start(PasswordManager* app) {
+    char path[GROUPS_PATH_SIZE];
+    password_groups_vault_path(
+        &app->groups, app->loading, PASSWORDS_FILE_PATH, GROUPS_DIRECTORY, path, sizeof(path));
+    return password_loader_start(app->loader, path, app->key);
+}
+
+// Začne načítat trezor skupiny na pozadí. Do načtení se zobrazí počet a první názvy
+// z hlavičky trezoru, které se přečtou hned.
+static void password_manager_group_load(PasswordManager* app, uint8_t index) {
+    password_manager_load_cancel(app);
+    password_manager_group_leave(app);
+    
+    char path[GROUPS_PATH_SIZE];
+    password_groups_vault_path(
+        &app->groups, index, PASSWORDS_FILE_PATH, GROUPS_DIRECTORY, path, sizeof(path));
+    if(index > 0) {
+        Storage* storage = furi_record_open(RECORD_STORAGE);
+        storage_simply_mkdir(storage, GROUPS_DIRECTORY);
+        furi_record_close(RECORD_STORAGE);
+    }
+    
+    // Bez manifestu (ještě nezapsaného) je počet hesel jen v hlavičce
+    password_vault_preview(path, &app->preview);
+    if(app->groups.groups[index].count == 0) app->groups.groups[index].count = app->preview.count;
+    
+    // Zrušené načítání předchozí skupiny ještě může běžet, nové se pak spustí po něm
+    app->loading = index;
+    app->load_queued = !password_manager_load_start(app);
+}
+
+// Převezme trezor načtený na pozadí, počká na dokončení načítání
+static bool password_manager_load_finish(PasswordManager* app) {
+    uint8_t index = app->loading;
+    if(index == GROUP_NONE) return false;
+    app->loading = GROUP_NONE;
+    if(!password_loader_finish(app->loader, &app->password_list)) return false;
+    
+    app->group = index;
+    password_groups_set_count(&app->groups, index, app->password_list.count);
+    return true;
+}
+
+// Zahodí načítání na pozadí bez čekání, vlákno skončí u dalšího záznamu
+static void password_manager_load_cancel(PasswordManager* app) {
+    if(app->loading == GROUP_NONE) return;
+    app->loading = GROUP_NONE;
+    if(app->load_queued) {
+        app->load_queued = false;
+        return;
+    }
+    password_loader_cancel(app->loader);
+}
+
+// Otevře seznam hesel skupiny: načtený hned, jinak přes obrazovku načítání
+static void password_manager_group_open(PasswordManager* app, uint8_t index) {
+    if(app->group == index) {
+        app->current_scene = SceneList;
+    } else {
+        if(app->loading != index) password_manager_group_load(app, index);
+        app->current_scene = SceneLoading;
+    }
+}
+
+// Dokončení načítání na pozadí: obrazovka načítání přejde na seznam, při chybě zpět
+static void password_manager_load_done(PasswordManager* app) {
+    if(app->load_queued) {
+        app->load_queued = !password_manager_load_start(app);
+        return;
+    }
+    if(!password_loader_is_done(app->loader)) return;
+    
+    bool loaded = password_manager_load_finish(app);
+    if(app->current_scene == SceneLoading) {
+        app->current_scene = loaded ? SceneList : app->groups.count > 1 ? SceneGroups : SceneMain;
+    }
+    if(!loaded) notification_message(app->notifications, &sequence_blink_red_100);
+    app->redraw = true;
+}
+
+// Počet hesel všech skupin: zobrazená podle seznamu, ostatní podle manifestu
+static uint32_t password_manager_total(PasswordManager* app) {
+    uint32_t total = 0;
+    for(uint8_t i = 0; i < app->groups.count; i++) {
+        total += i == app->group ? app->password_list.count : app->groups.groups[i].count;
+    }
+    return total;
+}
+
+// Zámek
+
+// Načte trezor klíčem vázaným jen na zařízení (trezor z doby před PINem)
+static bool password_manager_load_device_key(PasswordManager* app) {
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    if(!password_crypto_device_key(key)) return false;
+    password_list_set_key(&app->password_list, key);
+    password_crypto_wipe(key, sizeof(key));
+    return password_list_load(&app->password_list, PASSWORDS_FILE_PATH);
+}
+
+/**
+ * Dokončí založení PINu přerušené výpadkem. Zámek "<cesta>.new" platí,
+ * pokud se trezor stihl přešifrovat, tedy pokud ho klíč zařízení už
+ * neotevře.
+ */
+static void password_manager_lock_recover(PasswordManager* app) {
+    if(password_lock_exists(LOCK_FILE_PATH) || !password_lock_pending(LOCK_FILE_PATH)) return;
+    
+    FURI_LOG_W(TAG, "Dokončování přerušeného založení PINu");
+    bool device_key = password_manager_load_device_key(app) && app->password_list.count > 0 &&
+                      password_list_read_password(
+                          &app->password_list, 0, app->secret_buffer, PASSWORD_MAX_LENGTH);
+    password_crypto_wipe(app->secret_buffer, PASSWORD_MAX_LENGTH);
+    password_list_free(&app->password_list);
+    password_list_init(&app->password_list);
+    
+    password_lock_recover(LOCK_FILE_PATH, !device_key);
+}
+
+// Zamkne trezor: zruší psaní, zapíše změny, zapomene klíč i hesla a přejde na zadání PINu
+static void password_manager_lock(PasswordManager* app) {
+    password_keyboard_worker_cancel(app->keyboard_worker);
+    password_manager_load_cancel(app);
+    password_manager_group_leave(app);
+    password_crypto_wipe(app->key, PASSWORD_CRYPTO_KEY_SIZE);
+    password_manager_view_close(app);
+    password_manager_edit_close(app);
+    password_manager_filter_reset(app);
+    password_manager_draw_reset(app);
+    
+    password_crypto_wipe(app->pin, PIN_SIZE);
+    password_crypto_wipe(app->pin_first, PIN_SIZE);
+    app->pin_length = 0;
+    app->pin_setup = !password_lock_exists(LOCK_FILE_PATH);
+    app->lock_message = app->pin_setup ? "Zvolte nový PIN" : NULL;
+    app->selected_index = 0;
+    app->current_scene = SceneLock;
+}
+
+// Založí PIN: trezor se přešifruje klíčem z PINu a teprve pak platí nový zámek
+static bool password_manager_lock_setup(PasswordManager* app) {
+    // Klíč se odvozuje rovnou do arény, bez kopie na zásobníku
+    bool success = password_lock_create(LOCK_FILE_PATH, app->pin, app->key);
+    if(success) {
+        success = password_manager_load_device_key(app) &&
+                  password_list_rekey(&app->password_list, app->key) &&
+                  password_lock_commit(LOCK_FILE_PATH);
+    }
+    if(success) {
+        // Skupiny vznikají až s PINem, jejich trezory jsou rovnou zašifrované jeho klíčem
+        password_groups_load(&app->groups, GROUPS_MANIFEST_PATH);
+        app->group = 0;
+    }
+    if(!success) {
+        password_lock_discard(LOCK_FILE_PATH);
+        password_list_free(&app->password_list);
+        password_list_init(&app->password_list);
+        password_crypto_wipe(app->key, PASSWORD_CRYPTO_KEY_SIZE);
+    }
+    return success;
+}
+
+// Odemkne trezor, klíč odvozený z PINu zůstane v aplikaci do zamčení
+static PasswordLockResult password_manager_unlock(PasswordManager* app) {
+    PasswordLockResult result = password_lock_unlock(LOCK_FILE_PATH, app->pin, app->key);
+    if(result != PasswordLockResultOk) {
+        password_crypto_wipe(app->key, PASSWORD_CRYPTO_KEY_SIZE);
+    } else {
+        // Při startu se čte jen manifest, trezor skupiny až při vstupu do ní. Bez skupin
+        // se hlavní trezor hned začne načítat na pozadí.
+        password_groups_load(&app->groups, GROUPS_MANIFEST_PATH);
+        app->group_selected = 0;
+        if(app->groups.count == 1) password_manager_group_load(app, 0);
+    }
+    return result;
+}
+
+// Potvrzení PINu: při zakládání se PIN zadává dvakrát, jinak se trezor odemkne
+static void password_manager_lock_submit(PasswordManager* app) {
+    if(app->pin_length < PASSWORD_LOCK_PIN_MIN_LENGTH) {
+        app->lock_message = "PIN je příliš krátký";
+        return;
+    }
+    
+    bool success;
+    if(app->pin_setup && app->pin_first[0] == '\0') {
+        strlcpy(app->pin_first, app->pin, PIN_SIZE);
+        app->lock_message = "Zopakujte PIN";
+        success = true;
+    } else if(app->pin_setup && strcmp(app->pin_first, app->pin) != 0) {
+        password_crypto_wipe(app->pin_first, PIN_SIZE);
+        app->lock_message = "PINy se liší, znovu";
+        success = false;
+    } else {
+        // Odvození klíče trvá kolem půl sekundy, zpráva se vykreslí předem
+        app->lock_message = app->pin_setup ? "Šifrování trezoru..." : "Odemykání...";
+        password_manager_redraw(app);
+        
+        PasswordLockResult result = app->pin_setup ?
+                                        (password_manager_lock_setup(app) ? PasswordLockResultOk :
+                                                                            PasswordLockResultError) :
+                                        password_manager_unlock(app);
+        success = result == PasswordLockResultOk;
+        if(success) {
+            password_crypto_wipe(app->pin_first, PIN_SIZE);
+            app->lock_message = NULL;
+            app->current_scene = SceneMain;
+        } else {
+            app->lock_message = result == PasswordLockResultWrongPin ? "Špatný PIN" :
+                                                                       "Chyba trezoru";
+        }
+    }
+    
+    password_crypto_wipe(app->pin, PIN_SIZE);
+    app->pin_length = 0;
+    if(!success) notification_message(app->notifications, &sequence_blink_red_100);
+}
+
+// Vstup na obrazovce zámku: šipky přidávají znaky PINu, Zpět maže
+static void password_manager_lock_input(PasswordManager* app, InputEvent* input) {
+    if(input->type != InputTypeShort) return;
+    
+    static const char symbols[] = {
+        [InputKeyUp] = 'U',
+        [InputKeyDown] = 'D',
+        [InputKeyLeft] = 'L',
+        [InputKeyRight] = 'R',
+    };
+    switch(input->key) {
+        case InputKeyUp:
+        case InputKeyDown:
+        case InputKeyLeft:
+        case InputKeyRight:
+            if(app->pin_length < PASSWORD_LOCK_PIN_MAX_LENGTH) {
+                app->pin[app->pin_length++] = symbols[input->key];
+            }
+            break;
+        case InputKeyOk:
+            password_manager_lock_submit(app);
+            break;
+        case InputKeyBack:
+            if(app->pin_length > 0) {
+                app->pin[--app->pin_length] = '\0';
+            } else {
+                furi_message_queue_put(app->event_queue, &(PasswordManagerEvent){.type = EventTypeBack}, 0);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Záznam z importu: název, který už v trezoru je, se přeskočí
+static PasswordImportEntryResult password_manager_import_entry(
+    const char* group,
+    const char* name,
+    const char* password,
+    void* ctx) {
+    PasswordManager* app = ctx;
+    
+    // Záznam jde do trezoru své skupiny, chybějící skupina se založí. Záznam jiné než
+    // načtené skupiny počká v paměti, načtení trezoru by běželo pod rámci parseru.
+    uint8_t index;
+    if(!password_groups_add(&app->groups, group, &index)) index = 0;
+    PasswordList* list = app->group == index ? &app->password_list : &app->import_pending[index];
+    
+    switch(password_list_put(list, name, password, false)) {
+        case PasswordListPutAdded:
+            return PasswordImportEntryAdded;
+        case PasswordListPutExists:
+            return PasswordImportEntrySkipped;
+        default:
+            return PasswordImportEntryFailed;
+    }
+}
+
+// Zapíše odložené záznamy do trezorů jejich skupin. Exporty mívají záznamy seřazené
+// po složkách, trezor se tak přepíná nanejvýš jednou za kousek souboru.
+static bool password_manager_import_drain(PasswordManager* app) {
+    char name[NAME_MAX_LENGTH];
+    bool success = true;
+    for(uint8_t group = 0; group < app->groups.count && success; group++) {
+        PasswordList* pending = &app->import_pending[group];
+        if(pending->count == 0) continue;
+        if(!password_manager_group_enter(app, group)) {
+            success = false;
+            break;
+        }
+        
+        // Heslo se dešifruje do volného slotu arény, zobrazení během importu nic nedrží
+        for(uint32_t i = 0; i < pending->count && success; i++) {
+            strlcpy(name, password_list_get_name(pending, i), sizeof(name));
+            PasswordListPutResult result = PasswordListPutFailed;
+            if(password_list_read_password(pending, i, app->secret_buffer, PASSWORD_MAX_LENGTH)) {
+                result = password_list_put(&app->password_list, name, app->secret_buffer, false);
+            }
+            if(result == PasswordListPutExists) app->import_late_skipped++;
+            success = result != PasswordListPutFailed;
+        }
+        password_list_clear(pending);
+    }
+    password_crypto_wipe(app->secret_buffer, PASSWORD_MAX_LENGTH);
+    if(!success) app->import_failed = true;
+    return success;
+}
+
+// Počty importu z parseru opravené o odložené záznamy, které se nakonec přeskočily
+static void password_manager_import_count(PasswordManager* app, const PasswordImportProgress* progress) {
+    app->import_progress = *progress;
+    app->import_progress.imported -= app->import_late_skipped;
+    app->import_progress.skipped += app->import_late_skipped;
+}
+
+// Průběh importu po každém kousku souboru: přepnutí skupin pro odložené záznamy, zápis
+// změn, překreslení a zrušení klávesou Zpět. Hlavní smyčka mezitím stojí, ostatní
+// události se zahodí.
+static bool password_manager_import_progress(const PasswordImportProgress* progress, void* ctx) {
+    PasswordManager* app = ctx;
+    bool drained = password_manager_import_drain(app);
+    password_manager_import_count(app, progress);
+    bool flushed = password_list_flush(&app->password_list);
+    password_manager_redraw(app);
+    
+    bool cancel = false;
+    PasswordManagerEvent event;
+    while(furi_message_queue_get(app->event_queue, &event, 0) == FuriStatusOk) {
+        if(event.type == EventTypeKey && event.input.type == InputTypeShort &&
+           event.input.key == InputKeyBack) {
+            cancel = true;
+        }
+    }
+    return drained && flushed && !cancel;
+}
+
+// Naimportuje první nalezený export z IMPORT_PATHS
+static void password_manager_import(PasswordManager* app) {
+    static const char* const paths[] = IMPORT_PATHS;
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    const char* path = NULL;
+    for(size_t i = 0; i < COUNT_OF(paths) && !path; i++) {
+        if(storage_common_stat(storage, paths[i], NULL) == FSE_OK) path = paths[i];
+    }
+    furi_record_close(RECORD_STORAGE);
+    if(!path) {
+        app->import_message = "Export nenalezen";
+        notification_message(app->notifications, &sequence_blink_red_100);
+        return;
+    }
+    
+    // Import zapisuje do trezorů skupin, načítání na pozadí musí skončit
+    password_manager_load_finish(app);
+    
+    memset(&app->import_progress, 0, sizeof(app->import_progress));
+    app->import_message = "Import...";
+    app->importing = true;
+    app->import_late_skipped = 0;
+    app->import_failed = false;
+    app->import_pending = malloc(PASSWORD_GROUPS_MAX * sizeof(PasswordList));
+    for(uint8_t i = 0; i < PASSWORD_GROUPS_MAX; i++) {
+        password_list_init(&app->import_pending[i]);
+        password_list_set_key(&app->import_pending[i], app->key);
+    }
+    password_manager_redraw(app);
+    
+    PasswordImportProgress progress;
+    PasswordImportResult result = password_import_file(
+        path,
+        PasswordImportFormatAuto,
+        password_manager_import_entry,
+        password_manager_import_progress,
+        app,
+        &progress);
+        
+    // Poslední záznam (řádek CSV bez konce řádku) přijde až po posledním průběhu
+    if(!app->import_failed) password_manager_import_drain(app);
+    password_manager_import_count(app, &progress);
+    if(app->import_failed) result = PasswordImportResultWriteFailed;
+    for(uint8_t i = 0; i < PASSWORD_GROUPS_MAX; i++) password_list_free(&app->import_pending[i]);
+    free(app->import_pending);
+    app->import_pending = NULL;
+    app->importing = false;
+    
+    // Se skupinami zůstane načtená jen zvolená, jinak hlavní trezor
+    password_manager_group_leave(app);
+    if(app->groups.count == 1) password_manager_group_enter(app, 0);
+    password_groups_save(&app->groups, GROUPS_MANIFEST_PATH);
+    
+    switch(result) {
+        case PasswordImportResultOk:
+            app->import_message = "Import hotov";
+            break;
+        case PasswordImportResultUnknownFormat:
+            app->import_message = "Neznámý formát";
+            break;
+        case PasswordImportResultEncrypted:
+            app->import_message = "Export je šifrovaný";
+            break;
+        case PasswordImportResultCancelled:
+            app->import_message = "Import zrušen";
+            break;
+        default:
+            app->import_message = "Chyba importu";
+            break;
+    }
+    notification_message(
+        app->notifications,
+        result == PasswordImportResultOk ? &sequence_blink_green_100 : &sequence_blink_red_100);
+}
+
+// Nastaví poslední znak filtru podle názvu na indexu a zúží rozsah
+static bool password_manager_filter_set(PasswordManager* app, uint32_t index) {
+    uint8_t last = app->filter_length - 1;
+    const char* name = password_list_get_name(&app->password_list, index);
+    if(strlen(name) <= last) return false;
+    
+    char c = name[last];
+    app->filter[last] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+    app->filter[last + 1] = '\0';
+    
+    // Nový znak jen zužuje rozsah kratšího prefixu, stačí dvě binární vyhledávání
+    app->filter_ranges[last + 1] = app->filter_ranges[last];
+    password_list_filter(&app->password_list, app->filter, &app->filter_ranges[last + 1]);
+    app->selected_index = app->filter_ranges[last + 1].start;
+    return true;
+}
+
+// Přidá znak filtru: první znak, kterým v zúženém seznamu pokračuje nějaký název
+static void password_manager_filter_push(PasswordManager* app) {
+    if(app->filter_length >= NAME_MAX_LENGTH - 1) return;
+    if(app->filter_length == 0) {
+        app->filter_ranges[0] = (PasswordListRange){0, app->password_list.count};
+    }
+    
+    // Názvy rovné prefixu leží na začátku rozsahu a filtr neprodlouží
+    PasswordListRange range = app->filter_ranges[app->filter_length];
+    for(uint32_t index = range.start; index < range.end; index++) {
+        if(strlen(password_list_get_name(&app->password_list, index)) > app->filter_length) {
+            app->filter_length++;
+            password_manager_filter_set(app, index);
+            return;
+        }
+    }
+}
+
+// Odebere poslední znak filtru, rozsah kratšího prefixu je uložený
+static void password_manager_filter_pop(PasswordManager* app) {
+    if(app->filter_length == 0) return;
+    app->filter[--app->filter_length] = '\0';
+}
+
+// Přepne poslední znak filtru na sousední znak, se kterým existují názvy
+static void password_manager_filter_step(PasswordManager* app, bool forward) {
+    if(app->filter_length == 0) {
+        if(forward) password_manager_filter_push(app);
+        return;
+    }
+    
+    PasswordListRange parent = app->filter_ranges[app->filter_length - 1];
+    PasswordListRange current = app->filter_ranges[app->filter_length];
+    if(forward && current.end < parent.end) {
+        password_manager_filter_set(app, current.end);
+    } else if(!forward && current.start > parent.start) {
+        password_manager_filter_set(app, current.start - 1);
+    }
+}
+
+// Vybere výsledek fuzzy hledání, index seznamu se nastaví podle něj
+static void password_manager_fuzzy_select(PasswordManager* app, uint32_t result) {
+    app->fuzzy_selected = result;
+    if(result < app->fuzzy_count) app->selected_index = app->fuzzy_results[result].index;
+}
+
+// Spočítá výsledky pro aktuální vzor a vybere nejlepší
+static void password_manager_fuzzy_update(PasswordManager* app) {
+    app->fuzzy_count = password_list_search(
+        &app->password_list, app->fuzzy_pattern, app->fuzzy_results, FUZZY_MAX_RESULTS);
+    password_manager_fuzzy_select(app, 0);
+}
+
+// Přepne mezi prefixovým filtrem a fuzzy hledáním, obojí začíná prázdné
+static void password_manager_fuzzy_toggle(PasswordManager* app) {
+    bool fuzzy = !app->fuzzy;
+    password_manager_filter_reset(app);
+    app->fuzzy = fuzzy;
+    if(fuzzy) password_manager_fuzzy_update(app);
+}
+
+// Přidá na konec vzoru první znak abecedy
+static void password_manager_fuzzy_push(PasswordManager* app) {
+    if(app->fuzzy_length >= NAME_MAX_LENGTH - 1) return;
+    app->fuzzy_pattern[app->fuzzy_length++] = FUZZY_ALPHABET[0];
+    password_manager_fuzzy_update(app);
+}
+
+// Odebere poslední znak vzoru
+static void password_manager_fuzzy_pop(PasswordManager* app) {
+    if(app->fuzzy_length == 0) return;
+    app->fuzzy_pattern[--app->fuzzy_length] = '\0';
+    password_manager_fuzzy_update(app);
+}
+
+// Přepne poslední znak vzoru na sousední znak abecedy (dokola)
+static void password_manager_fuzzy_step(PasswordManager* app, bool forward) {
+    if(app->fuzzy_length == 0) {
+        if(forward) password_manager_fuzzy_push(app);
+        return;
+    }
+    
+    const size_t alphabet_size = sizeof(FUZZY_ALPHABET) - 1;
+    char* last = &app->fuzzy_pattern[app->fuzzy_length - 1];
+    size_t position = strchr(FUZZY_ALPHABET, *last) - FUZZY_ALPHABET;
+    position = (position + (forward ? 1 : alphabet_size - 1)) % alphabet_size;
+    *last = FUZZY_ALPHABET[position];
+    password_manager_fuzzy_update(app);
+}
+
+// Posouvání seznamu
+
+// Posune výběr o delta v rozsahu filtru nebo ve výsledcích fuzzy hledání, na okraji se zastaví
+static void password_manager_scroll(PasswordManager* app, int32_t delta) {
+    if(app->fuzzy) {
+        if(app->fuzzy_count == 0) return;
+        int64_t result = (int64_t)app->fuzzy_selected + delta;
+        result = MAX(result, 0);
+        password_manager_fuzzy_select(app, MIN(result, (int64_t)app->fuzzy_count - 1));
+        return;
+    }
+    
+    PasswordListRange range = password_manager_visible_range(app);
+    if(range.start >= range.end) return;
+    int64_t index = (int64_t)app->selected_index + delta;
+    index = MAX(index, (int64_t)range.start);
+    app->selected_index = MIN(index, (int64_t)range.end - 1);
+}
+
+// Opakování držené klávesy (kontext je klávesa) pro slučování password_scroll_coalesce
+static bool password_manager_is_repeat(const void* message, void* ctx) {
+    const PasswordManagerEvent* event = message;
+    const InputKey* key = ctx;
+    return event->type == EventTypeKey && event->input.key == *key &&
+           event->input.type == InputTypeRepeat;
+}
+
+// Rozsah abecední sekce (názvy se stejným prvním znakem) obsahující název na indexu
+static PasswordListRange password_manager_section(PasswordManager* app, uint32_t index) {
+    char c = password_list_get_name(&app->password_list, index)[0];
+    char prefix[2] = {(c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c, '\0'};
+    PasswordListRange range = {0, app->password_list.count};
+    password_list_filter(&app->password_list, prefix, &range);
+    return range;
+}
+
+// Skočí na začátek další nebo předchozí abecední sekce, seznam se nezužuje.
+// Zpět nejdřív na začátek aktuální sekce, z jejího začátku na předchozí.
+static void password_manager_section_step(PasswordManager* app, bool forward) {
+    uint32_t count = app->password_list.count;
+    if(count == 0) return;
+    
+    uint32_t index = MIN((uint32_t)app->selected_index, count - 1);
+    PasswordListRange section = password_manager_section(app, index);
+    if(forward) {
+        if(section.end < count) app->selected_index = section.end;
+    } else if(index > section.start) {
+        app->selected_index = section.start;
+    } else if(section.start > 0) {
+        app->selected_index = password_manager_section(app, section.start - 1).start;
+    }
+}
+
+// Vykreslí průběh psaní do spodního řádku, false pokud se nepíše
+static bool password_manager_draw_typing(Canvas* canvas, PasswordManager* app) {
+    PasswordKeyboardWorkerStatus status;
+    password_keyboard_worker_status(app->keyboard_worker, &status);
+    if(status.pending == 0) return false;
+    
+    char line[32];
+    snprintf(
+        line,
+        sizeof(line),
+        status.pending > 1 ? "Píšu %u/%u (+%u), Zpět: Stop" : "Píšu %u/%u, Zpět: Stop",
+        status.typed,
+        status.length,
+        status.pending - 1);
+    canvas_draw_str(canvas, 2, 58, line);
+    return true;
 }
 
 // Vykreslení hlavní scény
 static void password_manager_draw_main_scene(Canvas* canvas, PasswordManager* app) {
     canvas_draw_str(canvas, 2, 10, "Password Manager");
     canvas_draw_str(canvas, 2, 22, "Počet hesel: ");
-    canvas_draw_str_aligned(
-        canvas, 
-        90, 
-        22, 
-        AlignLeft, 
-        AlignTop, 
-        furi_string_get_cstr(furi_string_alloc_printf("%lu", app->password_list.count))
-    );
-    
-    canvas_draw_str(canvas, 2, 34, "Nahoru/Dolů: Procházet");
+    char count[12];
+    snprintf(count, sizeof(count), "%lu", password_manager_total(app));
+    canvas_draw_str_aligned(canvas, 90, 22, AlignLeft, AlignTop, count);
+    
+    // Během importu a po něm průběh místo nápovědy
+    if(app->import_message) {
+        canvas_draw_str(canvas, 2, 34, app->import_message);
+        char line[32];
+        snprintf(
+            line,
+            sizeof(line),
+            "+%lu, přeskočeno %lu",
+            app->import_progress.imported,
+            app->import_progress.skipped);
+        canvas_draw_str(canvas, 2, 46, line);
+        if(app->importing && app->import_progress.bytes_total > 0) {
+            snprintf(
+                line,
+                sizeof(line),
+                "%lu %%, Zpět: Zrušit",
+                app->import_progress.bytes_read * 100 / app->import_progress.bytes_total);
+            canvas_draw_str(canvas, 2, 58, line);
+        } else if(!app->importing) {
+            canvas_draw_str(canvas, 2, 58, "OK: Seznam hesel");
+        }
+        return;
+    }
+    
+    canvas_draw_str(canvas, 2, 34, "Držet OK: Import");
     canvas_draw_str(canvas, 2, 46, "OK: Seznam hesel");
     canvas_draw_str(canvas, 2, 58, "Zpět: Ukončit");
 }
 
-// Vykreslení scény seznamu
-static void password_manager_draw_list_scene(Canvas* canvas, PasswordManager* app) {
+// Vykreslení skupin: název a počet hesel z manifestu
+static void password_manager_draw_groups_scene(Canvas* canvas, PasswordManager* app) {
+    canvas_draw_str(canvas, 2, 10, "Skupiny");
+    
+    uint8_t start = app->group_selected > 2 ? app->group_selected - 2 : 0;
+    for(uint8_t i = 0; i < 4 && start + i < app->groups.count; i++) {
+        const PasswordGroup* group = &app->groups.groups[start + i];
+        int y = 22 + i * 10;
+        if(start + i == app->group_selected) canvas_draw_str(canvas, 0, y, ">");
+        canvas_draw_str(canvas, 6, y, start + i == 0 ? "Hlavní" : group->name);
+        
+        char count[12];
+        snprintf(count, sizeof(count), "%lu", group->count);
+        canvas_draw_str_aligned(canvas, 126, y, AlignRight, AlignBottom, count);
+    }
+    
+    canvas_draw_str(canvas, 2, 64, "OK: Otevřít, Zpět: Návrat");
+}
+
+// Vykreslení načítání: počet a první názvy z hlavičky trezoru, než se načte celý
+static void password_manager_draw_loading_scene(Canvas* canvas, PasswordManager* app) {
     canvas_draw_str(canvas, 2, 10, "Seznam hesel");
     
-    if(app->password_list.count == 0) {
-        canvas_draw_str(canvas, 2, 22, "Žádná hesla");
-        canvas_draw_str(canvas, 2, 34, "Dlouhý stisk OK: Přidat");
-        return;
+    char count[12];
+    snprintf(count, sizeof(count), "%lu", app->preview.count);
+    canvas_draw_str_aligned(canvas, 126, 10, AlignRight, AlignBottom, count);
+    for(uint8_t i = 0; i < app->preview.names_count; i++) {
+        canvas_draw_str(canvas, 6, 22 + i * 10, app->preview.names[i]);
     }
     
-    // Zobrazení seznamu hesel
-    int start_index = 0;
-    if(app->selected_index > 2) {
-        start_index = app->selected_index - 2;
+    canvas_draw_str(canvas, 2, 58, "Načítání...");
+}
+
+// Vykreslení fuzzy hledání: výsledky seřazené podle skóre
+static void password_manager_draw_fuzzy_scene(Canvas* canvas, PasswordManager* app) {
+    canvas_draw_str(canvas, 2, 10, "Fuzzy:");
+    canvas_draw_str(canvas, 50, 10, app->fuzzy_pattern);
+    
+    if(app->fuzzy_count == 0) {
+        canvas_draw_str(canvas, 2, 22, "Nic nenalezeno");
     }
     
-    for(int i = 0; i < 4 && (i + start_index) < app->password_list.count; i++) {
+    // Názvy připravené hlavním vláknem (password_manager_draw_prepare)
+    for(uint32_t i = 0; i < app->fuzzy_rows; i++) {
         int y = 22 + i * 10;
         
         // Zvýraznění vybrané položky
-        if(i + start_index == app->selected_index) {
+        if(app->fuzzy_first + i == app->fuzzy_selected) {
             canvas_draw_str(canvas, 0, y, ">");
         }
         
-        canvas_draw_str(canvas, 10, y, app->password_list.items[i + start_index].name);
+        canvas_draw_str(canvas, 10, y, app->fuzzy_names[i]);
     }
     
-    canvas_draw_str(canvas, 2, 58, "OK: Zobrazit, Dlouhý: Přidat");
+    canvas_draw_str(canvas, 2, 58, "OK: Zobrazit, </>: Znak");
+}
+
+// Vykreslení scény seznamu
+static void password_manager_draw_list_scene(Canvas* canvas, PasswordManager* app) {
+    if(app->fuzzy) {
+        password_manager_draw_fuzzy_scene(canvas, app);
+        return;
+    }
+    
+    if(app->filter_length > 0) {
+        canvas_draw_str(canvas, 2, 10, "Hledat:");
+        canvas_draw_str(canvas, 50, 10, app->filter);
+    } else {
+        canvas_draw_str(canvas, 2, 10, "Seznam hesel");
+    }
+    
+    if(app->password_list.count == 0) {
+        canvas_draw_str(canvas, 2, 22, "Žádná hesla");
+        canvas_draw_str(canvas, 2, 34, "Dlouhý stisk OK: Přidat");
+        return;
+    }
+    
+    // Zobrazení seznamu hesel (jen viditelné řádky rozsahu odpovídajícího filtru)
+    password_list_view_draw(&app->list_view, canvas, 22);
+    
+    if(!password_manager_draw_typing(canvas, app)) {
+        canvas_draw_str(canvas, 2, 58, "OK: Zobrazit, </>: Písmena");
+    }
 }
 
 // Vykreslení scény zobrazení hesla
@@ -213,16 +1388,46 @@ static void password_manager_draw_view_scene(Canvas* canvas, PasswordManager* ap
         return;
     }
     
-    PasswordItem* item = &app->password_list.items[app->selected_index];
-    
     canvas_draw_str(canvas, 2, 10, "Heslo:");
-    canvas_draw_str(canvas, 2, 22, item->name);
+    canvas_draw_str(canvas, 2, 22, app->view_name);
+    
+    // Kód TOTP a jeho zbývající platnost vpravo od názvu, dlouhý název překryje
+    if(app->has_totp) {
+        uint64_t time = password_manager_totp_time(app);
+        char totp[PASSWORD_TOTP_DIGITS_MAX + 8];
+        snprintf(
+            totp,
+            sizeof(totp),
+            "%s %lus",
+            password_totp_code(&app->totp, time),
+            password_totp_remaining(time));
+        canvas_set_font(canvas, FontSecondary);
+        uint16_t width = canvas_string_width(canvas, totp) + 4;
+        canvas_set_color(canvas, ColorWhite);
+        canvas_draw_box(canvas, 128 - width, 13, width, 11);
+        canvas_set_color(canvas, ColorBlack);
+        canvas_draw_str_aligned(canvas, 126, 22, AlignRight, AlignBottom, totp);
+        canvas_set_font(canvas, FontPrimary);
+    }
     
     // Zobrazení hesla
     canvas_draw_str(canvas, 2, 34, "Heslo:");
-    canvas_draw_str(canvas, 2, 46, item->password);
+    canvas_draw_str(canvas, 2, 46, app->secret_buffer);
     
-    canvas_draw_str(canvas, 2, 58, "OK: Odeslat, Dlouhý: Smazat");
+    // Rychlost psaní, přenos a rozložení klávesnice, mění se šipkami
+    canvas_draw_str(canvas, 70, 10, password_keyboard_speed_name(app->keyboard_speed));
+    char keyboard[32];
+    snprintf(
+        keyboard,
+        sizeof(keyboard),
+        "%s %s",
+        app->keyboard_transport->name,
+        app->keyboard_layout.name);
+    canvas_draw_str(canvas, 40, 34, keyboard);
+    
+    if(!password_manager_draw_typing(canvas, app)) {
+        canvas_draw_str(canvas, 2, 58, "OK: Odeslat, Dlouhý: Smazat");
+    }
 }
 
 // Vykreslení scény úpravy
@@ -238,7 +1443,22 @@ static void password_manager_draw_edit_scene(Canvas* canvas, PasswordManager* ap
     // Zvýraznění aktivního pole
     canvas_draw_str(canvas, 40, app->is_editing ? 34 : 22, ">");
     
-    canvas_draw_str(canvas, 2, 58, "OK: Potvrdit, Zpět: Zrušit");
+    // Zásady generátoru a odhad entropie (bez vlivu povinných tříd)
+    char classes[5];
+    char policy[32];
+    password_generator_describe(app->generator_policy.classes, classes);
+    snprintf(
+        policy,
+        sizeof(policy),
+        "%s, %u zn., ~%lu bitů",
+        classes,
+        app->generator_policy.length,
+        (unsigned long)password_generator_entropy(&app->generator_policy));
+    canvas_set_font(canvas, FontSecondary);
+    canvas_draw_str(canvas, 2, 46, policy);
+    
+    canvas_draw_str(canvas, 2, 58, app->is_editing ? "OK: Nové, Držet Zpět: Uložit" :
+                                                     "Šipky: Znak, Držet Zpět: Uložit");
 }
 
 // Vykreslení scény nápovědy
@@ -249,65 +1469,228 @@ static void password_manager_draw_help_scene(Canvas* canvas, PasswordManager* ap
     canvas_draw_str(canvas, 2, 22, "Správce hesel pro Flipper Zero");
     canvas_draw_str(canvas, 2, 34, "Autor: Augment Agent");
     canvas_draw_str(canvas, 2, 46, "Verze: 1.0");
-    canvas_draw_str(canvas, 2, 58, "Zpět: Návrat");
+    canvas_draw_str(canvas, 2, 58, "OK: Diagnostika, Zpět: Návrat");
+}
+
+// Vykreslení scény diagnostiky: pro každou sondu počet, průměr a maximum (us, fronta v událostech)
+static void password_manager_draw_diagnostics_scene(Canvas* canvas, PasswordManager* app) {
+    UNUSED(app);
+    
+    canvas_draw_str(canvas, 2, 10, "Diagnostika");
+    if(!PASSWORD_PERF_ENABLED) {
+        canvas_draw_str(canvas, 2, 22, "Měření je vypnuté,");
+        canvas_draw_str(canvas, 2, 34, "přeložte s PASSWORD_PERF");
+        canvas_draw_str(canvas, 2, 58, "Zpět: Návrat");
+        return;
+    }
+    
+    canvas_set_font(canvas, FontSecondary);
+    canvas_draw_str_aligned(canvas, 126, 10, AlignRight, AlignBottom, "OK: CSV");
+    char value[12];
+    for(uint8_t probe = 0; probe < PasswordPerfProbeCount; probe++) {
+        PasswordPerfStat stat;
+        password_perf_get(probe, &stat);
+        int y = 19 + probe * 8;
+        canvas_draw_str(canvas, 2, y, password_perf_name(probe));
+        
+        snprintf(value, sizeof(value), "%lu", stat.count);
+        canvas_draw_str_aligned(canvas, 60, y, AlignRight, AlignBottom, value);
+        snprintf(value, sizeof(value), "%lu", stat.count ? (uint32_t)(stat.total / stat.count) : 0);
+        canvas_draw_str_aligned(canvas, 94, y, AlignRight, AlignBottom, value);
+        snprintf(value, sizeof(value), "%lu", stat.max);
+        canvas_draw_str_aligned(canvas, 126, y, AlignRight, AlignBottom, value);
+    }
 }
 
-// Zpracování událostí
+// Vykreslení scény zámku
+static void password_manager_draw_lock_scene(Canvas* canvas, PasswordManager* app) {
+    canvas_draw_str(canvas, 2, 10, app->pin_setup ? "Nový PIN" : "Zadejte PIN");
+    
+    // Místo PINu jen hvězdičky
+    char mask[PASSWORD_LOCK_PIN_MAX_LENGTH + 1];
+    memset(mask, '*', app->pin_length);
+    mask[app->pin_length] = '\0';
+    canvas_draw_str(canvas, 2, 28, mask);
+    
+    if(app->lock_message) canvas_draw_str(canvas, 2, 46, app->lock_message);
+    canvas_draw_str(canvas, 2, 58, "Šipky: PIN, OK: Potvrdit");
+}
+
+// Zpracování událostí, překreslí se jen po události, která mohla změnit stav
 static void password_manager_process_event(PasswordManager* app, PasswordManagerEvent* event) {
-    if(event->type == EventTypeKey) {
+    if(event->type == EventTypeTyping ||
+       (event->type == EventTypeKey && event->input.type != InputTypePress &&
+        event->input.type != InputTypeRelease)) {
+        app->redraw = true;
+    }
+    
+    // Nový stisk začíná posouvání znovu od kroku 1
+    if(event->type == EventTypeKey && event->input.type == InputTypePress) {
+        app->scroll_repeats = 0;
+    }
+    
+    if(event->type == EventTypeKey && app->current_scene == SceneLock) {
+        password_manager_lock_input(app, &event->input);
+    } else if(event->type == EventTypeKey) {
         // Zpracování klávesových událostí
         if(event->input.type == InputTypeShort) {
             switch(event->input.key) {
                 case InputKeyBack:
-                    // Zpět
-                    if(app->current_scene == SceneMain) {
+                    // Zpět, během psaní nejdřív zruší psaní
+                    if(password_manager_typing(app)) {
+                        password_keyboard_worker_cancel(app->keyboard_worker);
+                    } else if(app->current_scene == SceneMain) {
                         // Ukončení aplikace
                         furi_message_queue_put(app->event_queue, &(PasswordManagerEvent){.type = EventTypeBack}, 0);
+                    } else if(
+                        app->current_scene == SceneList &&
+                        (app->filter_length > 0 || app->fuzzy)) {
+                        // Zrušení filtru nebo fuzzy hledání
+                        password_manager_filter_reset(app);
+                    } else if(app->current_scene == SceneLoading) {
+                        // Načítání pokračuje na pozadí, seznam se otevře hned příště
+                        app->current_scene = app->groups.count > 1 ? SceneGroups : SceneMain;
+                    } else if(app->current_scene == SceneList && app->groups.count > 1) {
+                        // Odchod ze skupiny uvolní její trezor
+                        password_manager_group_leave(app);
+                        app->current_scene = SceneGroups;
+                    } else if(app->current_scene == SceneEdit) {
+                        // Zrušení přidání, vygenerované heslo se zapomene
+                        password_manager_edit_close(app);
+                        app->current_scene = SceneList;
                     } else {
                         // Návrat na předchozí scénu
                         app->current_scene = SceneMain;
+                        password_manager_view_close(app);
                     }
                     break;
                     
                 case InputKeyUp:
-                    // Nahoru
-                    if(app->current_scene == SceneList && app->selected_index > 0) {
-                        app->selected_index--;
+                    // Nahoru (v rozsahu filtru nebo ve výsledcích fuzzy hledání), u hesla
+                    // další přenos (ne během psaní), v editoru hesla předchozí předvolba znaků
+                    if(app->current_scene == SceneEdit && app->is_editing) {
+                        password_manager_generator_preset(app, false);
+                    } else if(app->current_scene == SceneView) {
+                        if(!password_manager_typing(app)) password_manager_transport_next(app);
+                    } else if(app->current_scene == SceneList) {
+                        password_manager_scroll(app, -1);
+                    } else if(app->current_scene == SceneGroups && app->group_selected > 0) {
+                        app->group_selected--;
                     }
                     break;
                     
                 case InputKeyDown:
-                    // Dolů
-                    if(app->current_scene == SceneList && app->selected_index < app->password_list.count - 1) {
-                        app->selected_index++;
+                    // Dolů (v rozsahu filtru nebo ve výsledcích fuzzy hledání), u hesla další
+                    // rozložení (ne během psaní, worker z rozložení čte), v editoru hesla
+                    // další předvolba znaků
+                    if(app->current_scene == SceneEdit && app->is_editing) {
+                        password_manager_generator_preset(app, true);
+                    } else if(app->current_scene == SceneView) {
+                        if(!password_manager_typing(app)) password_manager_layout_next(app);
+                    } else if(app->current_scene == SceneList) {
+                        password_manager_scroll(app, 1);
+                    } else if(
+                        app->current_scene == SceneGroups &&
+                        app->group_selected + 1 < app->groups.count) {
+                        app->group_selected++;
                     }
                     break;
                     
                 case InputKeyOk:
                     // OK
                     if(app->current_scene == SceneMain) {
-                        // Přechod na seznam hesel
-                        app->current_scene = SceneList;
+                        // Přechod na skupiny nebo bez nich rovnou na seznam hesel, výsledek
+                        // importu se už nezobrazí
+                        app->import_message = NULL;
+                        if(app->groups.count > 1) {
+                            app->current_scene = SceneGroups;
+                        } else {
+                            password_manager_group_open(app, 0);
+                        }
+                    } else if(app->current_scene == SceneGroups) {
+                        // Vstup do skupiny načte její trezor
+                        password_manager_group_open(app, app->group_selected);
+                    } else if(app->current_scene == SceneHelp) {
+                        // Přechod na diagnostiku
+                        app->current_scene = SceneDiagnostics;
+                    } else if(app->current_scene == SceneDiagnostics && PASSWORD_PERF_ENABLED) {
+                        // Připsání výsledků do CSV, porovnávají se mezi verzemi firmwaru
+                        notification_message(
+                            app->notifications,
+                            password_perf_append_csv(PERF_LOG_PATH) ? &sequence_blink_green_100 :
+                                                                      &sequence_blink_red_100);
                     } else if(app->current_scene == SceneList) {
-                        // Přechod na zobrazení hesla
-                        if(app->password_list.count > 0) {
+                        // Přechod na zobrazení hesla, heslo se načte až teď a případné
+                        // tajemství TOTP se od něj oddělí
+                        if(app->password_list.count > 0 &&
+                           (!app->fuzzy || app->fuzzy_count > 0) &&
+                           password_list_read_password(
+                               &app->password_list,
+                               app->selected_index,
+                               app->secret_buffer,
+                               PASSWORD_MAX_LENGTH)) {
+                            app->has_totp = password_totp_split(app->secret_buffer, &app->totp);
                             app->current_scene = SceneView;
                         }
+                    } else if(app->current_scene == SceneEdit && app->is_editing) {
+                        // Nové heslo se stejnými zásadami
+                        password_manager_generate(app);
                     } else if(app->current_scene == SceneView) {
-                        // Odeslání hesla
-                        if(app->selected_index < app->password_list.count) {
-                            password_send_as_keyboard(app->password_list.items[app->selected_index].password);
-                            
-                            // Notifikace o odeslání
-                            notification_message(app->notifications, &sequence_blink_green_100);
+                        // Zařazení hesla k odeslání, píše se na pozadí a výsledek přijde událostí
+                        if(app->selected_index < app->password_list.count &&
+                           !password_keyboard_worker_enqueue(
+                               app->keyboard_worker,
+                               app->keyboard_transport,
+                               app->secret_buffer,
+                               &app->keyboard_layout,
+                               app->keyboard_speed)) {
+                            notification_message(app->notifications, &sequence_blink_red_100);
                         }
                     }
                     break;
                     
                 case InputKeyRight:
-                    // Vpravo - přechod na nápovědu
-                    if(app->current_scene == SceneMain) {
+                    // Vpravo - přechod na nápovědu, v seznamu další znak filtru nebo vzoru
+                    // (bez filtru další abecední sekce), u hesla vyšší rychlost psaní,
+                    // v editoru další znak názvu nebo delší heslo
+                    if(app->current_scene == SceneEdit) {
+                        if(app->is_editing) {
+                            password_manager_generator_length(app, true);
+                        } else {
+                            password_manager_name_step(app, true);
+                        }
+                    } else if(app->current_scene == SceneMain) {
+                        app->import_message = NULL;
                         app->current_scene = SceneHelp;
+                    } else if(app->current_scene == SceneView) {
+                        if(app->keyboard_speed + 1 < PasswordKeyboardSpeedCount) app->keyboard_speed++;
+                    } else if(app->current_scene == SceneList && app->fuzzy) {
+                        password_manager_fuzzy_step(app, true);
+                    } else if(app->current_scene == SceneList && app->filter_length > 0) {
+                        password_manager_filter_step(app, true);
+                    } else if(app->current_scene == SceneList) {
+                        password_manager_section_step(app, true);
+                    }
+                    break;
+                    
+                case InputKeyLeft:
+                    // Vlevo - v seznamu předchozí znak filtru nebo vzoru (bez filtru předchozí
+                    // abecední sekce), u hesla nižší rychlost psaní, v editoru předchozí znak
+                    // názvu nebo kratší heslo
+                    if(app->current_scene == SceneEdit) {
+                        if(app->is_editing) {
+                            password_manager_generator_length(app, false);
+                        } else {
+                            password_manager_name_step(app, false);
+                        }
+                    } else if(app->current_scene == SceneView) {
+                        if(app->keyboard_speed > 0) app->keyboard_speed--;
+                    } else if(app->current_scene == SceneList && app->fuzzy) {
+                        password_manager_fuzzy_step(app, false);
+                    } else if(app->current_scene == SceneList && app->filter_length > 0) {
+                        password_manager_filter_step(app, false);
+                    } else if(app->current_scene == SceneList) {
+                        password_manager_section_step(app, false);
                     }
                     break;
                     
@@ -318,17 +1701,22 @@ static void password_manager_process_event(PasswordManager* app, PasswordManager
             // Dlouhý stisk
             switch(event->input.key) {
                 case InputKeyOk:
-                    if(app->current_scene == SceneList) {
-                        // Přidání nového hesla
-                        app->is_editing = false;
-                        memset(app->name_buffer, 0, sizeof(app->name_buffer));
-                        memset(app->password_buffer, 0, sizeof(app->password_buffer));
-                        app->current_scene = SceneEdit;
+                    if(app->current_scene == SceneMain) {
+                        // Import exportu z SD karty
+                        password_manager_import(app);
+                    } else if(app->current_scene == SceneDiagnostics) {
+                        // Vynulování sond
+                        password_perf_reset();
+                    } else if(app->current_scene == SceneList) {
+                        // Přidání nového hesla, heslo se rovnou vygeneruje
+                        password_manager_edit_open(app);
                     } else if(app->current_scene == SceneView) {
                         // Smazání hesla
                         if(app->selected_index < app->password_list.count) {
+                            // Změna se zapíše do žurnálu, soubor se nepřepisuje
                             password_list_remove(&app->password_list, app->selected_index);
-                            password_list_save(&app->password_list, PASSWORDS_FILE_PATH);
+                            password_manager_view_close(app);
+                            password_manager_filter_reset(app);
                             
                             // Návrat na seznam
                             app->current_scene = SceneList;
@@ -347,18 +1735,88 @@ static void password_manager_process_event(PasswordManager* app, PasswordManager
                     }
                     break;
                     
+                case InputKeyRight:
+                    // Další znak filtru, vzoru nebo názvu v editoru, u hesla s TOTP odeslání
+                    // aktuálního kódu
+                    if(app->current_scene == SceneEdit && !app->is_editing) {
+                        password_manager_name_push(app);
+                    } else if(app->current_scene == SceneView && app->has_totp) {
+                        const char* code =
+                            password_totp_code(&app->totp, password_manager_totp_time(app));
+                        if(!password_keyboard_worker_enqueue(
+                               app->keyboard_worker,
+                               app->keyboard_transport,
+                               code,
+                               &app->keyboard_layout,
+                               app->keyboard_speed)) {
+                            notification_message(app->notifications, &sequence_blink_red_100);
+                        }
+                    } else if(app->current_scene == SceneList && app->fuzzy) {
+                        password_manager_fuzzy_push(app);
+                    } else if(app->current_scene == SceneList) {
+                        password_manager_filter_push(app);
+                    }
+                    break;
+                    
+                case InputKeyLeft:
+                    // Smazání posledního znaku filtru, vzoru nebo názvu v editoru
+                    if(app->current_scene == SceneEdit && !app->is_editing) {
+                        password_manager_name_pop(app);
+                    } else if(app->current_scene == SceneList && app->fuzzy) {
+                        password_manager_fuzzy_pop(app);
+                    } else if(app->current_scene == SceneList) {
+                        password_manager_filter_pop(app);
+                    }
+                    break;
+                    
                 case InputKeyBack:
-                    if(app->current_scene == SceneEdit) {
+                    if(app->current_scene == SceneList) {
+                        // Přepnutí mezi filtrem podle prefixu a fuzzy hledáním (držení
+                        // Nahoru/Dolů už posouvá seznam)
+                        password_manager_fuzzy_toggle(app);
+                    } else if(app->current_scene == SceneEdit) {
                         // Uložení hesla
                         if(strlen(app->name_buffer) > 0 && strlen(app->password_buffer) > 0) {
-                            password_list_add(&app->password_list, app->name_buffer, app->password_buffer);
-                            password_list_save(&app->password_list, PASSWORDS_FILE_PATH);
+                            // Nahrazené heslo si ponechá své tajemství TOTP; nevejde-li se k novému
+                            // heslu, zůstane se v editoru (secret_buffer je tu volný)
+                            uint32_t index;
+                            bool carried = true;
+                            if(password_list_find(&app->password_list, app->name_buffer, &index) &&
+                               password_list_read_password(
+                                   &app->password_list, index, app->secret_buffer, PASSWORD_MAX_LENGTH)) {
+                                carried = password_totp_carry(
+                                    app->password_buffer, PASSWORD_MAX_LENGTH, app->secret_buffer);
+                            }
+                            password_crypto_wipe(app->secret_buffer, PASSWORD_MAX_LENGTH);
+                            if(!carried) {
+                                notification_message(app->notifications, &sequence_blink_red_100);
+                                break;
+                            }
+                            
+                            // Heslo uloží password_list_put (replace true): nový název přidá,
+                            // u stejného názvu heslo nahradí, duplicita nevznikne. Název i heslo
+                            // z name_buffer a password_buffer zkopíruje (heslo zapečetěné) do
+                            // poolu seznamu, buffery tak zůstávají aplikaci: password_buffer hned
+                            // vymaže edit_close, name_buffer ještě poslouží k výběru hesla. Při
+                            // chybě (paměť, zápis) se zůstane v editoru bez přeneseného tajemství.
+                            if(password_list_put(
+                                   &app->password_list, app->name_buffer, app->password_buffer, true) ==
+                               PasswordListPutFailed) {
+                                char* separator = strchr(app->password_buffer, PASSWORD_TOTP_SEPARATOR);
+                                if(separator) password_crypto_wipe(separator, strlen(separator));
+                                notification_message(app->notifications, &sequence_blink_red_100);
+                                break;
+                            }
+                            password_manager_edit_close(app);
                             
                             // Návrat na seznam
                             app->current_scene = SceneList;
+                            password_manager_filter_reset(app);
                             
-                            // Výběr nově přidaného hesla
-                            app->selected_index = app->password_list.count - 1;
+                            // Výběr nově přidaného hesla (seznam je seřazený podle názvu)
+                            if(password_list_find(&app->password_list, app->name_buffer, &index)) {
+                                app->selected_index = index;
+                            }
                             
                             // Notifikace o přidání
                             notification_message(app->notifications, &sequence_blink_green_100);
@@ -369,6 +1827,50 @@ static void password_manager_process_event(PasswordManager* app, PasswordManager
                 default:
                     break;
             }
+        } else if(event->input.type == InputTypeRepeat && app->current_scene == SceneList) {
+            // Držená klávesa v seznamu: opakování čekající ve frontě se sloučí do jednoho
+            // posunu a jednoho překreslení
+            InputKey key = event->input.key;
+            uint32_t repeats = 1 + password_scroll_coalesce(
+                                       app->event_queue,
+                                       password_manager_is_repeat,
+                                       &key,
+                                       &app->pending_event,
+                                       &app->has_pending_event);
+            if(event->input.key == InputKeyUp || event->input.key == InputKeyDown) {
+                PasswordListRange range = password_manager_visible_range(app);
+                int32_t delta = password_scroll_delta(&app->scroll_repeats, repeats, range.end - range.start);
+                password_manager_scroll(app, event->input.key == InputKeyUp ? -delta : delta);
+            } else if(event->input.key == InputKeyLeft || event->input.key == InputKeyRight) {
+                // Vlevo/Vpravo opakují krátký stisk: znak filtru, vzoru nebo abecední sekci
+                bool forward = event->input.key == InputKeyRight;
+                while(repeats--) {
+                    if(app->fuzzy) {
+                        password_manager_fuzzy_step(app, forward);
+                    } else if(app->filter_length > 0) {
+                        password_manager_filter_step(app, forward);
+                    } else {
+                        password_manager_section_step(app, forward);
+                    }
+                }
+            }
+        } else if(
+            event->input.type == InputTypeRepeat && app->current_scene == SceneEdit &&
+            (event->input.key == InputKeyLeft || event->input.key == InputKeyRight)) {
+            // Držená šipka v editoru opakuje krátký stisk (znak názvu, délka hesla)
+            bool forward = event->input.key == InputKeyRight;
+            if(app->is_editing) {
+                password_manager_generator_length(app, forward);
+            } else {
+                password_manager_name_step(app, forward);
+            }
+        }
+    } else if(event->type == EventTypeTyping) {
+        // Notifikace o odeslání, průběh se jen překreslí
+        if(event->typing == PasswordKeyboardWorkerEventDone) {
+            notification_message(app->notifications, &sequence_blink_green_100);
+        } else if(event->typing == PasswordKeyboardWorkerEventFailed) {
+            notification_message(app->notifications, &sequence_blink_red_100);
         }
     } else if(event->type == EventTypeBack) {
         // Ukončení aplikace
@@ -376,6 +1878,34 @@ static void password_manager_process_event(PasswordManager* app, PasswordManager
     }
 }
 
+// Další událost: nejdřív odložená při slučování opakování, jinak z fronty
+static FuriStatus
+    password_manager_next_event(PasswordManager* app, PasswordManagerEvent* event, uint32_t timeout) {
+    if(app->has_pending_event) {
+        *event = app->pending_event;
+        app->has_pending_event = false;
+        return FuriStatusOk;
+    }
+    return furi_message_queue_get(app->event_queue, event, timeout);
+}
+
+// Čas do nejbližšího časovače: kontrola zápisu změn, dokončení načítání, odpočet kódu TOTP
+// a automatické zamčení
+static uint32_t password_manager_timeout(PasswordManager* app) {
+    if(app->current_scene == SceneLock) return FuriWaitForever;
+    
+    uint32_t idle = furi_get_tick() - app->last_activity;
+    uint32_t lock = furi_ms_to_ticks(AUTO_LOCK_MS);
+    uint32_t timeout = idle < lock ? lock - idle : 0;
+    if(password_list_is_dirty(&app->password_list) || app->loading != GROUP_NONE) {
+        timeout = MIN(timeout, furi_ms_to_ticks(FLUSH_POLL_MS));
+    }
+    if(app->current_scene == SceneView && app->has_totp) {
+        timeout = MIN(timeout, furi_ms_to_ticks(TOTP_POLL_MS));
+    }
+    return timeout;
+}
+
 // Hlavní funkce aplikace
 int32_t password_manager_app(void* p) {
     UNUSED(p);
@@ -383,25 +1913,50 @@ int32_t password_manager_app(void* p) {
     // Alokace aplikace
     PasswordManager* app = password_manager_alloc();
     
-    // Hlavní smyčka
+    // Hlavní smyčka: bez událostí a časovačů spí, překresluje se jen po změně stavu
     PasswordManagerEvent event;
     bool running = true;
     
     while(running) {
-        // Čekání na událost
-        FuriStatus status = furi_message_queue_get(app->event_queue, &event, 100);
+        // Čekání na událost nebo nejbližší časovač
+        FuriStatus status = password_manager_next_event(app, &event, password_manager_timeout(app));
         
         if(status == FuriStatusOk) {
+            PASSWORD_PERF_VALUE(
+                PasswordPerfProbeQueue, furi_message_queue_get_count(app->event_queue) + 1);
+                
             // Zpracování události
             if(event.type == EventTypeBack) {
                 running = false;
             } else {
+                if(event.type == EventTypeKey) app->last_activity = furi_get_tick();
                 password_manager_process_event(app, &event);
             }
         }
         
+        // Převzetí trezoru načteného na pozadí
+        if(app->loading != GROUP_NONE) password_manager_load_done(app);
+        
+        // Zapsání změn po chvíli nečinnosti, po delší nečinnosti se trezor zamkne
+        password_list_flush_if_idle(&app->password_list);
+        if(app->current_scene != SceneLock &&
+           furi_get_tick() - app->last_activity >= furi_ms_to_ticks(AUTO_LOCK_MS)) {
+            password_manager_lock(app);
+            app->redraw = true;
+        }
+        
+        // Zbývající platnost kódu TOTP se překreslí s každou sekundou, kód sám jen v novém kroku
+        if(app->current_scene == SceneView && app->has_totp &&
+           furi_hal_rtc_get_timestamp() != app->totp_second) {
+            app->totp_second = furi_hal_rtc_get_timestamp();
+            app->redraw = true;
+        }
+        
         // Překreslení GUI
-        view_port_update(app->view_port);
+        if(app->redraw) {
+            app->redraw = false;
+            password_manager_redraw(app);
+        }
     }
     
     // Uvolnění aplikace
@@ -0,0 +1,88 @@
+#include "password_perf.h"
+#include <furi.h>
+#include <furi_hal.h>
+#include <storage/storage.h>
+#include <toolbox/version.h>
+#include <string.h>
+
+#define TAG "PasswordPerf"
+
+#define PASSWORD_PERF_CSV_HEADER "firmware,tick_ms,probe,count,last,avg,max\n"
+
+static PasswordPerfStat password_perf_stats[PasswordPerfProbeCount];
+
+static const char* const password_perf_names[PasswordPerfProbeCount] = {
+    [PasswordPerfProbeLoad] = "load",
+    [PasswordPerfProbeSave] = "save",
+    [PasswordPerfProbeFlush] = "flush",
+    [PasswordPerfProbeKey] = "key",
+    [PasswordPerfProbeFrame] = "frame",
+    [PasswordPerfProbeQueue] = "queue",
+};
+
+uint32_t password_perf_cycles(void) {
+    return DWT->CYCCNT;
+}
+
+void password_perf_record_cycles(PasswordPerfProbe probe, uint32_t start) {
+    // Rozdíl je správně i po přetečení čítače (nejdelší měřená doba je 2^32 cyklů)
+    uint32_t cycles = DWT->CYCCNT - start;
+    password_perf_record(probe, cycles / furi_hal_cortex_instructions_per_microsecond());
+}
+
+void password_perf_record(PasswordPerfProbe probe, uint32_t value) {
+    PasswordPerfStat* stat = &password_perf_stats[probe];
+    stat->count++;
+    stat->last = value;
+    stat->total += value;
+    if(value > stat->max) stat->max = value;
+}
+
+void password_perf_get(PasswordPerfProbe probe, PasswordPerfStat* stat) {
+    *stat = password_perf_stats[probe];
+}
+
+const char* password_perf_name(PasswordPerfProbe probe) {
+    return password_perf_names[probe];
+}
+
+void password_perf_reset(void) {
+    memset(password_perf_stats, 0, sizeof(password_perf_stats));
+}
+
+bool password_perf_append_csv(const char* path) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool success = storage_file_open(file, path, FSAM_WRITE, FSOM_OPEN_APPEND);
+    if(success && storage_file_size(file) == 0) {
+        size_t length = strlen(PASSWORD_PERF_CSV_HEADER);
+        success = storage_file_write(file, PASSWORD_PERF_CSV_HEADER, length) == length;
+    }
+    
+    const char* firmware = version_get_version(NULL);
+    uint32_t tick = furi_get_tick();
+    char line[96];
+    for(size_t probe = 0; success && probe < PasswordPerfProbeCount; probe++) {
+        PasswordPerfStat stat;
+        password_perf_get(probe, &stat);
+        // Přetypování kvůli hostitelskému buildu, kde uint32_t není unsigned long
+        int length = snprintf(
+            line,
+            sizeof(line),
+            "%s,%lu,%s,%lu,%lu,%lu,%lu\n",
+            firmware ? firmware : "",
+            (unsigned long)tick,
+            password_perf_names[probe],
+            (unsigned long)stat.count,
+            (unsigned long)stat.last,
+            (unsigned long)(stat.count ? stat.total / stat.count : 0),
+            (unsigned long)stat.max);
+        success = length > 0 && (size_t)length < sizeof(line) &&
+                  storage_file_write(file, line, length) == (size_t)length;
+    }
+    
+    if(!success) FURI_LOG_E(TAG, "Nelze zapsat %s", path);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return success;
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Měření horkých cest
+ * 
+ * Sondy měří dobu průchodu (čítač cyklů jádra DWT->CYCCNT přepočtený na us):
+ * načtení a uložení trezoru, zápis žurnálu, jeden znak psaní hesla a snímek
+ * GUI. Hloubka fronty událostí se zaznamenává stejně, jen místo doby počet
+ * událostí. Výsledky ukazuje scéna diagnostiky a jdou připsat jako CSV
+ * do souboru, podle verze firmwaru se tak dají porovnávat.
+ * 
+ * Měření se zapne makrem PASSWORD_PERF (application.fam:
+ * cdefines=["PASSWORD_PERF"], hostitelský build: make PERF=1). Bez něj se
+ * makra sond přeloží na nic; funkce pro čtení a zápis výsledků zůstávají
+ * a vrací nuly.
+ * 
+ * Sondy se zapisují bez zámků, každou jen jedno vlákno (GUI, worker psaní,
+ * hlavní smyčka). Čtení z jiného vlákna může zachytit rozepsanou hodnotu,
+ * pro diagnostiku to stačí.
+ */
+
+typedef enum {
+    PasswordPerfProbeLoad, // password_list_load
+    PasswordPerfProbeSave, // password_list_save
+    PasswordPerfProbeFlush, // Zápis žurnálu
+    PasswordPerfProbeKey, // Jeden znak psaní hesla
+    PasswordPerfProbeFrame, // Snímek GUI
+    PasswordPerfProbeQueue, // Hloubka fronty událostí (počet, ne us)
+    PasswordPerfProbeCount,
+} PasswordPerfProbe;
+
+typedef struct {
+    uint32_t count; // Počet průchodů
+    uint32_t last; // Poslední hodnota
+    uint32_t max; // Největší hodnota
+    uint64_t total; // Součet hodnot, průměr je total / count
+} PasswordPerfStat;
+
+#ifdef PASSWORD_PERF
+#define PASSWORD_PERF_ENABLED true
+#define PASSWORD_PERF_BEGIN(start) uint32_t start = password_perf_cycles()
+#define PASSWORD_PERF_END(probe, start) password_perf_record_cycles(probe, start)
+#define PASSWORD_PERF_VALUE(probe, value) password_perf_record(probe, value)
+#else
+#define PASSWORD_PERF_ENABLED false
+#define PASSWORD_PERF_BEGIN(start)
+#define PASSWORD_PERF_END(probe, start)
+#define PASSWORD_PERF_VALUE(probe, value)
+#endif
+
+/**
+ * @brief Přečte čítač cyklů jádra
+ * 
+ * @return uint32_t Cykly
+ */
+uint32_t password_perf_cycles(void);
+
+/**
+ * @brief Zaznamená dobu od start do teď
+ * 
+ * @param probe Sonda
+ * @param start Čítač cyklů na začátku (password_perf_cycles)
+ */
+void password_perf_record_cycles(PasswordPerfProbe probe, uint32_t start);
+
+/**
+ * @brief Zaznamená hodnotu sondy
+ * 
+ * @param probe Sonda
+ * @param value Hodnota (us, u fronty počet událostí)
+ */
+void password_perf_record(PasswordPerfProbe probe, uint32_t value);
+
+/**
+ * @brief Vrátí výsledky sondy
+ * 
+ * @param probe Sonda
+ * @param stat Výstup, výsledky
+ */
+void password_perf_get(PasswordPerfProbe probe, PasswordPerfStat* stat);
+
+/**
+ * @brief Vrátí krátký název sondy (sloupec CSV)
+ * 
+ * @param probe Sonda
+ * @return const char* Název
+ */
+const char* password_perf_name(PasswordPerfProbe probe);
+
+/** @brief Vynuluje výsledky všech sond */
+void password_perf_reset(void);
+
+/**
+ * @brief Připíše výsledky všech sond jako CSV
+ * 
+ * Nový soubor dostane hlavičku. Každá sonda je jeden řádek s verzí firmwaru
+ * a časem od startu: firmware,tick_ms,probe,count,last,avg,max.
+ * 
+ * @param path Cesta k souboru
+ * @return true Pokud se výsledky zapsaly
+ */
+bool password_perf_append_csv(const char* path);
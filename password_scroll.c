@@ -0,0 +1,31 @@
+#include "password_scroll.h"
+
+uint32_t password_scroll_step(uint32_t repeat, uint32_t length) {
+    if(repeat < PASSWORD_SCROLL_FAST_AFTER) return 1;
+    if(repeat < PASSWORD_SCROLL_PAGE_AFTER) return PASSWORD_SCROLL_FAST_STEP;
+    return MAX(length / PASSWORD_SCROLL_PAGES, (uint32_t)PASSWORD_SCROLL_FAST_STEP);
+}
+
+uint32_t password_scroll_delta(uint32_t* repeats, uint32_t count, uint32_t length) {
+    uint32_t delta = 0;
+    while(count--) delta += password_scroll_step((*repeats)++, length);
+    return delta;
+}
+
+uint32_t password_scroll_coalesce(
+    FuriMessageQueue* queue,
+    PasswordScrollRepeatCallback is_repeat,
+    void* context,
+    void* pending,
+    bool* has_pending) {
+    // Opakování se čtou rovnou do pending, první jiná událost v něm zůstane
+    uint32_t repeats = 0;
+    while(!*has_pending && furi_message_queue_get(queue, pending, 0) == FuriStatusOk) {
+        if(is_repeat(pending, context)) {
+            repeats++;
+        } else {
+            *has_pending = true;
+        }
+    }
+    return repeats;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <furi.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Posouvání seznamu drženou klávesou
+ * 
+ * Zrychlení: první opakování posouvají o 1, po PASSWORD_SCROLL_FAST_AFTER
+ * opakováních o PASSWORD_SCROLL_FAST_STEP a po PASSWORD_SCROLL_PAGE_AFTER
+ * o stránku (1/PASSWORD_SCROLL_PAGES seznamu). Nový stisk začíná znovu
+ * od kroku 1.
+ * 
+ * Slučování: opakování, která se mezitím nahromadila ve frontě událostí
+ * (např. během čtení názvů z karty), se zpracují najednou jako jeden
+ * posun o součet kroků a jedno překreslení.
+ */
+
+#define PASSWORD_SCROLL_FAST_AFTER 5
+#define PASSWORD_SCROLL_FAST_STEP 5
+#define PASSWORD_SCROLL_PAGE_AFTER 15
+#define PASSWORD_SCROLL_PAGES 32
+
+/**
+ * @brief Callback, který pozná opakování držené klávesy
+ * 
+ * @param event Událost z fronty
+ * @param context Kontext (např. držená klávesa)
+ * @return true Pokud je událost dalším opakováním držené klávesy
+ */
+typedef bool (*PasswordScrollRepeatCallback)(const void* event, void* context);
+
+/**
+ * @brief Vrátí krok pro opakování držené klávesy
+ * 
+ * @param repeat Pořadí opakování od stisku (od 0)
+ * @param length Délka posouvaného seznamu
+ * @return uint32_t Krok: 1, pak PASSWORD_SCROLL_FAST_STEP, pak stránka
+ */
+uint32_t password_scroll_step(uint32_t repeat, uint32_t length);
+
+/**
+ * @brief Sečte kroky několika opakování za sebou
+ * 
+ * @param repeats Opakování od stisku, zvýší se o count
+ * @param count Počet zpracovávaných opakování
+ * @param length Délka posouvaného seznamu
+ * @return uint32_t Součet kroků
+ */
+uint32_t password_scroll_delta(uint32_t* repeats, uint32_t count, uint32_t length);
+
+/**
+ * @brief Vytáhne z fronty opakování, která čekají hned za zpracovávaným
+ * 
+ * První jiná událost se vytáhne do pending a hlavní smyčka ji zpracuje
+ * jako další. Když už nějaká událost odložená je, fronta se nečte.
+ * 
+ * @param queue Fronta událostí
+ * @param is_repeat Callback, který pozná opakování
+ * @param context Kontext callbacku
+ * @param pending Odložená událost (velikost zprávy fronty)
+ * @param has_pending Zda je událost odložená
+ * @return uint32_t Počet vytažených opakování
+ */
+uint32_t password_scroll_coalesce(
+    FuriMessageQueue* queue,
+    PasswordScrollRepeatCallback is_repeat,
+    void* context,
+    void* pending,
+    bool* has_pending);
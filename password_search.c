@@ -0,0 +1,129 @@
+#include "password_search.h"
+
+#define PASSWORD_SEARCH_SCORE_MATCH 16
+#define PASSWORD_SEARCH_BONUS_BOUNDARY 8
+#define PASSWORD_SEARCH_BONUS_CONSECUTIVE 4
+// První znak vzoru na začátku slova dostane bonus tolikrát
+#define PASSWORD_SEARCH_BONUS_FIRST_MULTIPLIER 2
+#define PASSWORD_SEARCH_GAP_START 3
+#define PASSWORD_SEARCH_GAP_EXTENSION 1
+// Buňka bez shody; odečtení penalizací ji nedostane pod INT16_MIN
+#define PASSWORD_SEARCH_NONE (INT16_MIN / 2)
+
+#define PASSWORD_SEARCH_MAX(a, b) ((a) > (b) ? (a) : (b))
+
+static size_t password_search_length(const char* text) {
+    size_t length = 0;
+    while(length < PASSWORD_SEARCH_MAX_LENGTH && text[length] != '\0') length++;
+    return length;
+}
+
+static unsigned char password_search_fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : (unsigned char)c;
+}
+
+static bool password_search_is_alnum(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+// Bit znaku v masce: a-z 0-25, 0-9 26-35, ostatní znaky sdílí 36-63
+static uint8_t password_search_bit(char c) {
+    unsigned char folded = password_search_fold(c);
+    if(folded >= 'a' && folded <= 'z') return folded - 'a';
+    if(folded >= '0' && folded <= '9') return 26 + (folded - '0');
+    return 36 + folded % 28;
+}
+
+uint64_t password_search_mask(const char* text, size_t length) {
+    uint64_t mask = 0;
+    for(size_t i = 0; i < length && text[i] != '\0'; i++) {
+        mask |= (uint64_t)1 << password_search_bit(text[i]);
+    }
+    return mask;
+}
+
+uint64_t password_search_prefilter(const uint64_t* masks, uint32_t count, uint64_t pattern_mask) {
+    uint64_t hits = 0;
+    for(uint32_t i = 0; i < count; i++) {
+        hits |= (uint64_t)((masks[i] & pattern_mask) == pattern_mask) << i;
+    }
+    return hits;
+}
+
+// Bonus za znak na začátku slova: začátek názvu, za oddělovačem, "camelCase"
+static int16_t password_search_bonus(const char* name, size_t position) {
+    if(position == 0) return PASSWORD_SEARCH_BONUS_BOUNDARY;
+    char previous = name[position - 1];
+    char current = name[position];
+    if(!password_search_is_alnum(previous)) return PASSWORD_SEARCH_BONUS_BOUNDARY;
+    if(previous >= 'a' && previous <= 'z' && current >= 'A' && current <= 'Z') {
+        return PASSWORD_SEARCH_BONUS_BOUNDARY;
+    }
+    if(!(previous >= '0' && previous <= '9') && current >= '0' && current <= '9') {
+        return PASSWORD_SEARCH_BONUS_BOUNDARY / 2;
+    }
+    return 0;
+}
+
+/**
+ * Dynamické programování po řádcích vzoru, v paměti jsou jen dva řádky.
+ * Buňka [i][j] je nejlepší skóre umístění prvních i + 1 znaků vzoru,
+ * ve kterém znak i leží na pozici j názvu. Nejlepší předchůdce přes
+ * mezeru se počítá průběžně, řádek tak stojí O(n) místo O(n^2).
+ */
+bool password_search_match(const char* name, const char* pattern, int16_t* score) {
+    size_t name_length = password_search_length(name);
+    size_t pattern_length = password_search_length(pattern);
+    if(pattern_length == 0) {
+        *score = 0;
+        return true;
+    }
+    if(pattern_length > name_length) return false;
+    
+    int16_t bonus[PASSWORD_SEARCH_MAX_LENGTH];
+    int16_t rows[2][PASSWORD_SEARCH_MAX_LENGTH];
+    int16_t* previous = rows[0];
+    int16_t* current = rows[1];
+    
+    // První znak vzoru
+    unsigned char c = password_search_fold(pattern[0]);
+    for(size_t j = 0; j < name_length; j++) {
+        bonus[j] = password_search_bonus(name, j);
+        current[j] = password_search_fold(name[j]) == c ?
+                         PASSWORD_SEARCH_SCORE_MATCH +
+                             bonus[j] * PASSWORD_SEARCH_BONUS_FIRST_MULTIPLIER :
+                         PASSWORD_SEARCH_NONE;
+    }
+    
+    for(size_t i = 1; i < pattern_length; i++) {
+        int16_t* swap = previous;
+        previous = current;
+        current = swap;
+        
+        c = password_search_fold(pattern[i]);
+        int16_t gap = PASSWORD_SEARCH_NONE;
+        current[0] = PASSWORD_SEARCH_NONE;
+        for(size_t j = 1; j < name_length; j++) {
+            // Předchozí znak vzoru o dvě a více pozic zpět, mezera se penalizuje
+            if(j >= 2) {
+                gap = PASSWORD_SEARCH_MAX(
+                    gap - PASSWORD_SEARCH_GAP_EXTENSION, previous[j - 2] - PASSWORD_SEARCH_GAP_START);
+            }
+            
+            int16_t best = PASSWORD_SEARCH_MAX(
+                previous[j - 1] + PASSWORD_SEARCH_BONUS_CONSECUTIVE, gap);
+            current[j] = password_search_fold(name[j]) == c && best > PASSWORD_SEARCH_NONE / 2 ?
+                             best + PASSWORD_SEARCH_SCORE_MATCH + bonus[j] :
+                             PASSWORD_SEARCH_NONE;
+        }
+    }
+    
+    int16_t best = PASSWORD_SEARCH_NONE;
+    for(size_t j = pattern_length - 1; j < name_length; j++) {
+        best = PASSWORD_SEARCH_MAX(best, current[j]);
+    }
+    if(best <= PASSWORD_SEARCH_NONE / 2) return false;
+    
+    *score = best;
+    return true;
+}
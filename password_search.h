@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Fuzzy vyhledávání v názvech hesel
+ * 
+ * Vzor odpovídá názvu, pokud jeho znaky leží v názvu ve stejném pořadí
+ * (bez ohledu na velikost písmen), např. "gthb" najde "github-work".
+ * 
+ * Každý název má předpočítanou 64bitovou masku přítomných znaků. Název,
+ * jehož maska neobsahuje všechny bity masky vzoru, odpovídat nemůže,
+ * většina kandidátů tak odpadne jedním AND ještě před načtením názvu.
+ */
+
+// Nejdelší zpracovaný název a vzor (delší se zkrátí)
+#define PASSWORD_SEARCH_MAX_LENGTH 32
+
+/**
+ * @brief Spočítá masku znaků textu
+ * 
+ * Písmena (bez ohledu na velikost) a číslice mají vlastní bit, ostatní
+ * znaky sdílí zbylé bity.
+ * 
+ * @param text Text
+ * @param length Délka textu
+ * @return uint64_t Maska přítomných znaků
+ */
+uint64_t password_search_mask(const char* text, size_t length);
+
+/**
+ * @brief Vybere názvy, jejichž maska obsahuje všechny znaky vzoru
+ * 
+ * Smyčka je bez větvení, překladač ji může vektorizovat.
+ * 
+ * @param masks Masky názvů
+ * @param count Počet masek, nejvýše 64
+ * @param pattern_mask Maska vzoru
+ * @return uint64_t Bit i je nastavený, pokud název i projde filtrem
+ */
+uint64_t password_search_prefilter(const uint64_t* masks, uint32_t count, uint64_t pattern_mask);
+
+/**
+ * @brief Ohodnotí shodu vzoru s názvem
+ * 
+ * Body dostává každý nalezený znak, navíc znak na začátku slova (za
+ * oddělovačem nebo velkým písmenem po malém) a znaky jdoucí za sebou.
+ * Mezery mezi nalezenými znaky se penalizují. Vybere se nejlepší
+ * ze všech možných umístění vzoru.
+ * 
+ * @param name Název
+ * @param pattern Vzor, prázdný odpovídá všemu
+ * @param score Skóre shody, vyšší je lepší
+ * @return true Pokud název vzoru odpovídá
+ * @return false Pokud název vzoru neodpovídá
+ */
+bool password_search_match(const char* name, const char* pattern, int16_t* score);
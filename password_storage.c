@@ -1,307 +1,2275 @@
 #include "password_storage.h"
-#include <furi_hal_usb_hid.h>
+#include "password_perf.h"
 #include <toolbox/stream/file_stream.h>
 #include <toolbox/stream/stream.h>
 
 #define TAG "PasswordStorage"
 #define PASSWORDS_FILE_DIRECTORY "/ext/passwords"
-#define PASSWORDS_FILE_PATH PASSWORDS_FILE_DIRECTORY "/passwords.txt"
+#define PASSWORDS_FILE_PATH PASSWORDS_FILE_DIRECTORY "/passwords.pwv"
+
+#define PASSWORD_LIST_INITIAL_CAPACITY 8
+#define PASSWORD_POOL_INITIAL_CAPACITY 256
+#define PASSWORD_POOL_COMPACT_MIN_GARBAGE 512
+// Nejmenší index názvů; index se zvětší, když je zaplněný z poloviny
+#define PASSWORD_NAME_INDEX_MIN_CAPACITY 16
+
+// Soubory větší než tento limit se otevírají ve stránkovaném režimu
+#define PASSWORD_LIST_PAGED_THRESHOLD (16 * 1024)
+// Počet názvů držených v paměti ve stránkovaném režimu (viditelné řádky + předčtení)
+#define PASSWORD_LIST_WINDOW_SIZE 16
+
+// Největší zapečetěné heslo a záznam binárního trezoru (délky jsou omezené buffery v UI)
+#define PASSWORD_SECRET_MAX_SIZE PASSWORD_CRYPTO_SEALED_SIZE(PASSWORD_MAX_LENGTH - 1)
+#define PASSWORD_VAULT_RECORD_MAX_SIZE \
+    (PASSWORD_VAULT_RECORD_HEADER_SIZE + NAME_MAX_LENGTH - 1 + PASSWORD_SECRET_MAX_SIZE)
+#define PASSWORD_VAULT_WRITE_BUFFER 256
+#define PASSWORD_VAULT_READ_BUFFER 512
+// Fuzzy hledání prosévá masky po blocích (jeden bit výsledku na název)
+#define PASSWORD_SEARCH_BLOCK 64
+
+// Starý textový trezor se při načtení převede a ponechá jako záloha
+#define PASSWORD_LEGACY_EXTENSION ".txt"
+#define PASSWORD_LEGACY_BACKUP_SUFFIX ".bak"
+#define PASSWORD_LEGACY_INDEX_SUFFIX ".idx"
+
+#define PASSWORD_JOURNAL_SUFFIX ".jnl"
+#define PASSWORD_JOURNAL_MAGIC 0x4C4E4A50 // "PJNL"
+#define PASSWORD_JOURNAL_VERSION 3
+// Žurnál binárního trezoru s hesly v otevřeném textu
+#define PASSWORD_JOURNAL_PLAINTEXT_VERSION 2
+// Žurnál textového trezoru: záznamy bez pozice, přidané položky šly na konec
+#define PASSWORD_JOURNAL_LEGACY_VERSION 1
+#define PASSWORD_JOURNAL_LEGACY_RECORD_SIZE offsetof(PasswordJournalRecord, position)
+// Žurnál se sloučí se základním souborem po tomto počtu záznamů (překryv
+// stránkovaného režimu má pevnou velikost a žurnál se musí vejít do obou režimů)...
+#define PASSWORD_JOURNAL_MAX_RECORDS 64
+// ...nebo když přeroste polovinu základního souboru, nejméně však tuto velikost
+#define PASSWORD_JOURNAL_MIN_COMPACT_SIZE 1024
+
+// Čekající záznamy žurnálu se zapíšou najednou po této době nečinnosti
+#define PASSWORD_JOURNAL_FLUSH_DELAY_MS 2000
+#define PASSWORD_JOURNAL_PENDING_SIZE 512
+
+// Nový obsah se píše do ".tmp" a po úplném zápisu přejmenuje na ".new"
+#define PASSWORD_TEMP_SUFFIX ".tmp"
+#define PASSWORD_NEW_SUFFIX ".new"
+
+/**
+ * Hlavička žurnálu. Velikost základního souboru váže žurnál k obsahu,
+ * ze kterého vychází, žurnál k jinému obsahu se zahodí.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vault_size;
+} PasswordJournalHeader;
+
+typedef enum {
+    PasswordJournalOpAdd = 'A',
+    PasswordJournalOpRemove = 'R',
+    PasswordJournalOpUpdate = 'U',
+} PasswordJournalOp;
+
+/**
+ * Záznam žurnálu. Za ním následuje název bez ukončovací nuly, zapečetěné
+ * heslo a CRC32 záznamu i dat, podle kterého se pozná nedopsaný konec žurnálu.
+ * Seznam je seřazený podle názvu, pozici nového znění spočítá změna
+ * jednou a přehrání ji jen převezme.
+ */
+typedef struct {
+    uint8_t op;
+    uint8_t name_length;
+    uint8_t password_length;
+    uint8_t reserved;
+    uint32_t index; // Odebíraný nebo upravovaný záznam
+    uint32_t position; // Pozice přidaného nebo upraveného záznamu po změně
+} PasswordJournalRecord;
+
+// Záznam přidaný v žurnálu na logické pozici stránkovaného seznamu
+typedef struct {
+    uint32_t index;
+    uint32_t journal_offset;
+} PasswordOverlayEntry;
+
+struct PasswordVault {
+    Storage* storage;
+    FuriString* path;
+    FuriString* journal_path;
+    Stream* journal;
+    uint32_t vault_size;
+    uint32_t journal_size; // 0 = žurnál není otevřen
+    uint32_t journal_records; // Včetně čekajících záznamů
+    uint32_t journal_version; // Starší verze jen při převodu nešifrovaného trezoru
+    uint32_t version; // Verze základního souboru
+    const uint8_t* key; // Klíč seznamu, zapečetí hesla nešifrovaného trezoru
+    
+    // Záznamy čekající na zápis, celá dávka se připíše jedním zápisem
+    uint8_t pending[PASSWORD_JOURNAL_PENDING_SIZE];
+    uint32_t pending_size;
+    uint32_t last_change;
+    
+    // Stránkovaný režim: otevřený základní soubor a překryv změn ze žurnálu
+    bool paged;
+    Stream* stream;
+    uint32_t masks_offset; // 0 = trezor bez tabulky masek
+    uint32_t records_offset;
+    uint32_t records_size;
+    uint32_t base_count;
+    uint32_t removed[PASSWORD_JOURNAL_MAX_RECORDS]; // Seřazené indexy v základním souboru
+    uint32_t removed_count;
+    PasswordOverlayEntry overlay[PASSWORD_JOURNAL_MAX_RECORDS]; // Seřazené podle indexu
+    uint32_t overlay_count;
+};
+
+// Příjemce záznamů při procházení seznamu (délky bez ukončovací nuly, heslo zapečetěné)
+typedef bool (*PasswordListEntryCallback)(
+    void* context,
+    const char* name,
+    size_t name_length,
+    const uint8_t* secret,
+    size_t password_length);
+
+static void password_vault_free(PasswordList* list);
 
 void password_list_init(PasswordList* list) {
     FURI_LOG_I(TAG, "Inicializace seznamu hesel");
+    memset(list, 0, sizeof(PasswordList));
+}
+
+void password_list_free(PasswordList* list) {
+    password_vault_free(list);
+    free(list->pool);
+    free(list->offsets);
+    free(list->masks);
+    free(list->name_index);
+    password_crypto_wipe(list, sizeof(PasswordList));
+}
+
+void password_list_move(PasswordList* list, PasswordList* from) {
+    memcpy(list, from, sizeof(PasswordList));
+    // Trezor zapečeťuje hesla klíčem seznamu, ukazatel na něj se přesune také
+    if(list->vault) list->vault->key = list->key;
+    password_crypto_wipe(from, sizeof(PasswordList));
+}
+
+void password_list_set_key(PasswordList* list, const uint8_t* key) {
+    memcpy(list->key, key, PASSWORD_CRYPTO_KEY_SIZE);
+}
+
+// Zahodí index názvů, sestaví se znovu při příštím hledání
+static void password_name_index_drop(PasswordList* list) {
+    free(list->name_index);
+    list->name_index = NULL;
+    list->name_index_capacity = 0;
+}
+
+// Vyprázdní pool (okno záznamů v paměti)
+static void password_pool_reset(PasswordList* list, uint32_t window_start) {
+    password_name_index_drop(list);
+    list->pool_size = 0;
+    list->pool_garbage = 0;
+    list->window_start = window_start;
+    list->window_count = 0;
+}
+
+void password_list_clear(PasswordList* list) {
+    password_vault_free(list);
+    password_pool_reset(list, 0);
+    list->count = 0;
+    list->generation++;
+}
+
+// Zda volající otevírání zrušil (password_list_open)
+static bool password_list_cancelled(const PasswordList* list) {
+    return list->cancel != NULL && *list->cancel;
+}
+
+bool password_list_is_paged(const PasswordList* list) {
+    return list->vault != NULL && list->vault->paged;
+}
+
+// Zapečetěné heslo záznamu v poolu ("název\0" [délka hesla][zapečetěné heslo])
+static const uint8_t* password_pool_secret(
+    const PasswordList* list,
+    uint32_t slot,
+    size_t* password_length) {
+    const char* name = list->pool + list->offsets[slot];
+    const uint8_t* length = (const uint8_t*)name + strlen(name) + 1;
+    *password_length = *length;
+    return length + 1;
+}
+
+// Délka záznamu v poolu včetně ukončovací nuly názvu a délky hesla
+static size_t password_pool_record_size(const PasswordList* list, uint32_t slot) {
+    size_t password_length;
+    const uint8_t* secret = password_pool_secret(list, slot, &password_length);
+    return secret - (const uint8_t*)(list->pool + list->offsets[slot]) +
+           PASSWORD_CRYPTO_SEALED_SIZE(password_length);
+}
+
+// Přepíše pool bez mezer po odebraných záznamech
+static void password_pool_compact(PasswordList* list) {
+    FURI_LOG_D(TAG, "Kompaktace poolu, uvolněno %u B", list->pool_garbage);
+    
+    char* pool = malloc(list->pool_capacity);
+    size_t pool_size = 0;
+    for(uint32_t i = 0; i < list->window_count; i++) {
+        size_t record_size = password_pool_record_size(list, i);
+        memcpy(pool + pool_size, list->pool + list->offsets[i], record_size);
+        list->offsets[i] = pool_size;
+        pool_size += record_size;
+    }
+    
+    free(list->pool);
+    list->pool = pool;
+    list->pool_size = pool_size;
+    list->pool_garbage = 0;
+}
+
+// Místo po odebraných záznamech se uvolní, až tvoří polovinu poolu
+static void password_pool_collect(PasswordList* list) {
+    if(list->window_count == 0) {
+        password_pool_reset(list, list->window_start);
+    } else if(
+        list->pool_garbage >= PASSWORD_POOL_COMPACT_MIN_GARBAGE &&
+        list->pool_garbage * 2 >= list->pool_size) {
+        password_pool_compact(list);
+    }
+}
+
+// Připojí záznam na konec poolu, okno stránkovaného režimu hesla nedrží (secret NULL)
+static bool password_pool_append(
+    PasswordList* list,
+    const char* name,
+    size_t name_length,
+    const uint8_t* secret,
+    size_t password_length) {
+    // Délky odpovídají bufferům v UI
+    name_length = MIN(name_length, (size_t)(NAME_MAX_LENGTH - 1));
+    password_length = secret ? MIN(password_length, (size_t)(PASSWORD_MAX_LENGTH - 1)) : 0;
+    size_t record_size = name_length + 2 + PASSWORD_CRYPTO_SEALED_SIZE(password_length);
+    
+    if(list->window_count == UINT32_MAX || list->pool_size + record_size > UINT32_MAX) {
+        FURI_LOG_E(TAG, "Seznam hesel je plný");
+        return false;
+    }
+    
+    // Zvětšení tabulky offsetů
+    if(list->window_count == list->capacity) {
+        uint32_t capacity = list->capacity ? list->capacity * 2 : PASSWORD_LIST_INITIAL_CAPACITY;
+        list->offsets = realloc(list->offsets, capacity * sizeof(uint32_t));
+        list->masks = realloc(list->masks, capacity * sizeof(uint64_t));
+        list->capacity = capacity;
+    }
+    
+    // Zvětšení poolu
+    if(list->pool_size + record_size > list->pool_capacity) {
+        size_t capacity = list->pool_capacity ? list->pool_capacity : PASSWORD_POOL_INITIAL_CAPACITY;
+        while(list->pool_size + record_size > capacity) capacity *= 2;
+        list->pool = realloc(list->pool, capacity);
+        list->pool_capacity = capacity;
+    }
+    
+    char* record = list->pool + list->pool_size;
+    memcpy(record, name, name_length);
+    record[name_length] = '\0';
+    record[name_length + 1] = (char)password_length;
+    if(secret) {
+        memcpy(record + name_length + 2, secret, PASSWORD_CRYPTO_SEALED_SIZE(password_length));
+    } else {
+        memset(record + name_length + 2, 0, PASSWORD_CRYPTO_SEALED_SIZE(0));
+    }
+    
+    list->masks[list->window_count] = password_search_mask(name, name_length);
+    list->offsets[list->window_count++] = list->pool_size;
+    list->pool_size += record_size;
+    
+    return true;
+}
+
+// Odebere záznam z poolu, místo se uvolní při příští kompaktaci
+static void password_pool_remove(PasswordList* list, uint32_t slot) {
+    list->pool_garbage += password_pool_record_size(list, slot);
+    
+    // Posun offsetů a masek za indexem o jednu pozici zpět
+    memmove(
+        &list->offsets[slot],
+        &list->offsets[slot + 1],
+        (list->window_count - slot - 1) * sizeof(uint32_t));
+    memmove(
+        &list->masks[slot],
+        &list->masks[slot + 1],
+        (list->window_count - slot - 1) * sizeof(uint64_t));
+        
+    list->window_count--;
+    password_pool_collect(list);
+}
+
+// Nahradí záznam v poolu novým zněním na stejné pozici
+static bool password_pool_replace(
+    PasswordList* list,
+    uint32_t slot,
+    const char* name,
+    size_t name_length,
+    const uint8_t* secret,
+    size_t password_length) {
+    size_t record_size = password_pool_record_size(list, slot);
+    if(!password_pool_append(list, name, name_length, secret, password_length)) return false;
+    
+    // Nové znění leží na konci poolu, jeho offset se přesune na místo starého
+    list->offsets[slot] = list->offsets[--list->window_count];
+    list->masks[slot] = list->masks[list->window_count];
+    list->pool_garbage += record_size;
+    password_pool_collect(list);
+    return true;
+}
+
+// Přesune offset záznamu na jinou pozici, záznamy mezi nimi se posunou
+static void password_pool_move(PasswordList* list, uint32_t from, uint32_t to) {
+    uint32_t offset = list->offsets[from];
+    uint64_t mask = list->masks[from];
+    if(from < to) {
+        memmove(&list->offsets[from], &list->offsets[from + 1], (to - from) * sizeof(uint32_t));
+        memmove(&list->masks[from], &list->masks[from + 1], (to - from) * sizeof(uint64_t));
+    } else if(from > to) {
+        memmove(&list->offsets[to + 1], &list->offsets[to], (from - to) * sizeof(uint32_t));
+        memmove(&list->masks[to + 1], &list->masks[to], (from - to) * sizeof(uint64_t));
+    }
+    list->offsets[to] = offset;
+    list->masks[to] = mask;
+}
+
+// Vloží záznam na danou pozici, data se připíšou na konec poolu
+static bool password_pool_insert(
+    PasswordList* list,
+    uint32_t slot,
+    const char* name,
+    size_t name_length,
+    const uint8_t* secret,
+    size_t password_length) {
+    if(!password_pool_append(list, name, name_length, secret, password_length)) return false;
+    password_pool_move(list, list->window_count - 1, slot);
+    return true;
+}
+
+// Index názvů
+
+// FNV-1a přesného názvu (hledání podle názvu rozlišuje velikost písmen)
+static uint32_t password_name_hash(const char* name) {
+    uint32_t hash = 2166136261UL;
+    while(*name) hash = (hash ^ (uint8_t)*name++) * 16777619UL;
+    return hash;
+}
+
+// Vloží index záznamu do volného slotu za jeho domovským slotem
+static void password_name_index_put(PasswordList* list, uint32_t index) {
+    uint32_t mask = list->name_index_capacity - 1;
+    uint32_t slot = password_name_hash(list->pool + list->offsets[index]) & mask;
+    while(list->name_index[slot]) slot = (slot + 1) & mask;
+    list->name_index[slot] = index + 1;
+}
+
+/**
+ * Sestaví index názvů celého seznamu v paměti: otevřená adresace
+ * s lineárním zkoušením, slot drží index záznamu + 1 (0 je volný slot).
+ * Index je nejvýš z poloviny plný, hledání tak v průměru projde jeden
+ * až dva sloty.
+ */
+static void password_name_index_build(PasswordList* list) {
+    uint32_t capacity = PASSWORD_NAME_INDEX_MIN_CAPACITY;
+    while(capacity / 2 <= list->count) capacity *= 2;
+    
+    free(list->name_index);
+    list->name_index = calloc(capacity, sizeof(uint32_t));
+    list->name_index_capacity = capacity;
+    for(uint32_t i = 0; i < list->count; i++) password_name_index_put(list, i);
+}
+
+/**
+ * Přečísluje záznamy, které se v seřazeném seznamu posunuly o delta
+ * a teď leží na [start, end). Slot každého se najde přes jeho název,
+ * práce tak odpovídá počtu posunutých záznamů, ne velikosti indexu.
+ * Posun nahoru se čísluje od konce a dolů od začátku, nové číslo
+ * záznamu se tak nikdy nepotká se starým číslem dosud nepřečíslovaného.
+ */
+static void password_name_index_shift(PasswordList* list, uint32_t start, uint32_t end, int32_t delta) {
+    uint32_t mask = list->name_index_capacity - 1;
+    for(uint32_t i = 0; i < end - start; i++) {
+        uint32_t index = delta > 0 ? end - 1 - i : start + i;
+        uint32_t old = index - delta + 1;
+        uint32_t slot = password_name_hash(list->pool + list->offsets[index]) & mask;
+        while(list->name_index[slot] && list->name_index[slot] != old) slot = (slot + 1) & mask;
+        if(list->name_index[slot]) list->name_index[slot] = index + 1;
+    }
+}
+
+// Odebere index záznamu (jeho název je ještě v poolu), následující sloty se posunou na uvolněné místo
+static void password_name_index_delete(PasswordList* list, uint32_t index) {
+    uint32_t mask = list->name_index_capacity - 1;
+    uint32_t slot = password_name_hash(list->pool + list->offsets[index]) & mask;
+    while(list->name_index[slot] != index + 1) {
+        if(!list->name_index[slot]) return;
+        slot = (slot + 1) & mask;
+    }
+    
+    for(uint32_t next = (slot + 1) & mask; list->name_index[next]; next = (next + 1) & mask) {
+        uint32_t home =
+            password_name_hash(list->pool + list->offsets[list->name_index[next] - 1]) & mask;
+        // Záznam se smí posunout jen na slot mezi svým domovským slotem a současným
+        if(((next - home) & mask) >= ((next - slot) & mask)) {
+            list->name_index[slot] = list->name_index[next];
+            slot = next;
+        }
+    }
+    list->name_index[slot] = 0;
+}
+
+// Rozdělí řádek "název:heslo\n" na části, řádky bez oddělovače jsou neplatné
+static bool password_line_parse(
+    const char* line,
+    size_t* name_length,
+    const char** password,
+    size_t* password_length) {
+    const char* separator = strchr(line, ':');
+    if(!separator) return false;
+    
+    *name_length = separator - line;
+    *password = separator + 1;
+    *password_length = strcspn(*password, "\n");
+    return true;
+}
+
+// CRC32 (IEEE 802.3) s tabulkou po půlbajtech, aby zabírala jen 64 B
+uint32_t password_crc32(uint32_t crc, const void* data, size_t size) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+        0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const uint8_t* bytes = data;
+    
+    crc = ~crc;
+    for(size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ bytes[i]) & 0x0F] ^ (crc >> 4);
+        crc = table[(crc ^ (bytes[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+}
+
+static bool password_stream_read_u32(Stream* stream, uint32_t* value) {
+    return stream_read(stream, (uint8_t*)value, sizeof(uint32_t)) == sizeof(uint32_t);
+}
+
+static unsigned char password_fold_char(char c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : (unsigned char)c;
+}
+
+/**
+ * Porovná názvy pro řazení: bez ohledu na velikost písmen (ASCII),
+ * při shodě rozhoduje přesné porovnání, aby bylo pořadí jednoznačné.
+ */
+static int password_name_compare(const char* a, const char* b) {
+    for(size_t i = 0;; i++) {
+        unsigned char ca = password_fold_char(a[i]);
+        unsigned char cb = password_fold_char(b[i]);
+        if(ca != cb) return ca - cb;
+        if(ca == '\0') break;
+    }
+    return strcmp(a, b);
+}
+
+/**
+ * Porovná začátek názvu s prefixem stejně jako password_name_compare.
+ * Názvy se stejným prefixem tak v seřazeném seznamu leží za sebou.
+ */
+static int password_prefix_compare(const char* name, const char* prefix) {
+    for(size_t i = 0; prefix[i] != '\0'; i++) {
+        unsigned char ca = password_fold_char(name[i]);
+        unsigned char cb = password_fold_char(prefix[i]);
+        if(ca != cb) return ca - cb;
+    }
+    return 0;
+}
+
+// Binární trezor
+
+/**
+ * Rozbalí záznam "[délky][název][heslo]" do bufferů o velikosti
+ * NAME_MAX_LENGTH a PASSWORD_SECRET_MAX_SIZE. Heslo zůstane zapečetěné,
+ * u nešifrovaného trezoru (sealed false) je to otevřený text bez
+ * ukončovací nuly. Vrací velikost záznamu, 0 pro záznam přesahující
+ * dostupná data nebo limity délek.
+ */
+static size_t password_vault_record_decode(
+    const uint8_t* record,
+    size_t size,
+    bool sealed,
+    char* name,
+    uint8_t* secret,
+    size_t* password_length) {
+    if(size < PASSWORD_VAULT_RECORD_HEADER_SIZE) return 0;
+    uint8_t name_length = record[0];
+    *password_length = record[1];
+    size_t secret_size = sealed ? PASSWORD_CRYPTO_SEALED_SIZE(*password_length) : *password_length;
+    size_t record_size = PASSWORD_VAULT_RECORD_HEADER_SIZE + name_length + secret_size;
+    if(name_length >= NAME_MAX_LENGTH || *password_length >= PASSWORD_MAX_LENGTH ||
+       record_size > size) {
+        return 0;
+    }
+    
+    memcpy(name, record + PASSWORD_VAULT_RECORD_HEADER_SIZE, name_length);
+    name[name_length] = '\0';
+    memcpy(secret, record + PASSWORD_VAULT_RECORD_HEADER_SIZE + name_length, secret_size);
+    return record_size;
+}
+
+// Zapečetí heslo přečtené z nešifrovaného trezoru nebo žurnálu, secret drží otevřený text
+static bool password_secret_seal(
+    const uint8_t* key,
+    const char* name,
+    uint8_t* secret,
+    size_t password_length) {
+    char password[PASSWORD_MAX_LENGTH];
+    memcpy(password, secret, password_length);
+    bool success =
+        password_crypto_seal(key, name, strlen(name), password, password_length, secret);
+    password_crypto_wipe(password, sizeof(password));
+    return success;
+}
+
+// Velikost tabulek na jeden záznam: offset a od verze 2 i maska názvu
+static size_t password_vault_table_entry_size(uint32_t version) {
+    return version == PASSWORD_VAULT_VERSION_NO_MASKS ? sizeof(uint32_t) :
+                                                        sizeof(uint32_t) + sizeof(uint64_t);
+}
+
+// Ověří, že hlavička odpovídá velikosti souboru
+static bool password_vault_header_check(const PasswordVaultHeader* header, size_t file_size) {
+    if(header->magic != PASSWORD_VAULT_MAGIC ||
+       header->version < PASSWORD_VAULT_VERSION_NO_MASKS ||
+       header->version > PASSWORD_VAULT_VERSION ||
+       header->count > (UINT32_MAX - sizeof(PasswordVaultHeader)) /
+                           password_vault_table_entry_size(header->version)) {
+        return false;
+    }
+    uint64_t expected = sizeof(PasswordVaultHeader) +
+                        (uint64_t)header->count * password_vault_table_entry_size(header->version) +
+                        header->records_size;
+    return expected == file_size;
+}
+
+static bool password_vault_read_header(Stream* stream, PasswordVaultHeader* header) {
+    if(!stream_rewind(stream) ||
+       stream_read(stream, (uint8_t*)header, sizeof(PasswordVaultHeader)) !=
+           sizeof(PasswordVaultHeader) ||
+       !password_vault_header_check(header, stream_size(stream))) {
+        FURI_LOG_E(TAG, "Neplatná hlavička trezoru");
+        return false;
+    }
+    return true;
+}
+
+bool password_vault_view_check(const uint8_t* data, size_t size, bool verify_checksum) {
+    PasswordVaultHeader header;
+    if(size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+    if(!password_vault_header_check(&header, size)) return false;
+    
+    return !verify_checksum ||
+           password_crc32(0, data + sizeof(header), size - sizeof(header)) == header.checksum;
+}
+
+bool password_vault_view_record(
+    const uint8_t* data,
+    size_t size,
+    uint32_t index,
+    PasswordVaultRecordView* record) {
+    PasswordVaultHeader header;
+    memcpy(&header, data, sizeof(header));
+    if(index >= header.count) return false;
+    
+    uint32_t offset;
+    memcpy(&offset, data + sizeof(header) + index * sizeof(uint32_t), sizeof(offset));
+    const uint8_t* records = data + sizeof(header) +
+                             header.count * password_vault_table_entry_size(header.version);
+    if((uint64_t)offset + PASSWORD_VAULT_RECORD_HEADER_SIZE > header.records_size) return false;
+    
+    record->name_length = records[offset];
+    record->password_length = records[offset + 1];
+    size_t secret_size = header.version == PASSWORD_VAULT_VERSION ?
+                             PASSWORD_CRYPTO_SEALED_SIZE(record->password_length) :
+                             record->password_length;
+    if((uint64_t)offset + PASSWORD_VAULT_RECORD_HEADER_SIZE + record->name_length + secret_size >
+       header.records_size) {
+        return false;
+    }
+    record->name = (const char*)records + offset + PASSWORD_VAULT_RECORD_HEADER_SIZE;
+    record->secret = (const uint8_t*)record->name + record->name_length;
+    UNUSED(size);
+    return true;
+}
+
+/**
+ * Převede oblast záznamů načtenou do poolu na místě z "[délky][název][heslo]"
+ * na "název\0" [délka hesla][heslo]. Zapečetěné heslo zůstává na svém místě,
+ * velikost záznamů se nemění a offsety z tabulky tak rovnou slouží jako
+ * offsety poolu.
+ */
+static bool password_vault_decode_pool(PasswordList* list, uint32_t records_size) {
+    for(uint32_t i = 0; i < list->window_count; i++) {
+        if(list->offsets[i] >= records_size) return false;
+    }
+    
+    char* records = list->pool;
+    uint32_t position = 0;
+    while(position < records_size) {
+        if(records_size - position < PASSWORD_VAULT_RECORD_HEADER_SIZE) return false;
+        uint8_t name_length = records[position];
+        uint8_t password_length = records[position + 1];
+        uint32_t record_size = PASSWORD_VAULT_RECORD_HEADER_SIZE + name_length +
+                               PASSWORD_CRYPTO_SEALED_SIZE(password_length);
+        if(name_length >= NAME_MAX_LENGTH || password_length >= PASSWORD_MAX_LENGTH ||
+           records_size - position < record_size) {
+            return false;
+        }
+        
+        char* record = records + position;
+        memmove(record, record + PASSWORD_VAULT_RECORD_HEADER_SIZE, name_length);
+        record[name_length] = '\0';
+        record[name_length + 1] = (char)password_length;
+        position += record_size;
+    }
+    return true;
+}
+
+/**
+ * Sestaví pool znovu ze záznamů nešifrovaného trezoru (verze 1 a 2)
+ * načtených do poolu, hesla cestou zapečetí. Záznamy se o režii šifry
+ * zvětší, na místě to nejde. Původní záznamy se nakonec přepíšou.
+ */
+static bool password_pool_seal(PasswordList* list, uint32_t count, uint32_t records_size) {
+    uint8_t* records = (uint8_t*)list->pool;
+    list->pool = NULL;
+    list->pool_capacity = 0;
+    password_pool_reset(list, 0);
+    
+    char name[NAME_MAX_LENGTH];
+    uint8_t secret[PASSWORD_SECRET_MAX_SIZE];
+    size_t password_length;
+    bool success = true;
+    for(uint32_t i = 0; success && i < count; i++) {
+        // Append přepíše offset i až po jeho přečtení
+        uint32_t offset = list->offsets[i];
+        success = !password_list_cancelled(list) && offset < records_size &&
+                  password_vault_record_decode(
+                      records + offset, records_size - offset, false, name, secret, &password_length) !=
+                      0 &&
+                  password_secret_seal(list->key, name, secret, password_length) &&
+                  password_pool_append(list, name, strlen(name), secret, password_length);
+    }
+    
+    password_crypto_wipe(records, records_size);
+    free(records);
+    return success;
+}
+
+// Žurnál
+
+// Připraví záznam žurnálu, délky se zkrátí stejně jako v poolu
+static void password_journal_record_init(
+    PasswordJournalRecord* record,
+    PasswordJournalOp op,
+    uint32_t index,
+    uint32_t position,
+    const char* name,
+    const char* password) {
+    record->op = op;
+    record->name_length = MIN(strlen(name), (size_t)(NAME_MAX_LENGTH - 1));
+    record->password_length = MIN(strlen(password), (size_t)(PASSWORD_MAX_LENGTH - 1));
+    record->reserved = 0;
+    record->index = index;
+    record->position = position;
+}
+
+/**
+ * Přečte záznam žurnálu z aktuální pozice streamu. Buffery musí mít
+ * velikost NAME_MAX_LENGTH a PASSWORD_SECRET_MAX_SIZE. Žurnál starší
+ * verze (version) nese heslo v otevřeném textu bez ukončovací nuly,
+ * záznam žurnálu textového trezoru navíc nemá pozici, doplní ji volající.
+ * 
+ * Vrací velikost záznamu v souboru, 0 pro nedopsaný nebo poškozený záznam.
+ */
+static size_t password_journal_read(
+    Stream* stream,
+    uint32_t version,
+    PasswordJournalRecord* record,
+    char* name,
+    uint8_t* secret) {
+    size_t record_size = version == PASSWORD_JOURNAL_LEGACY_VERSION ?
+                             PASSWORD_JOURNAL_LEGACY_RECORD_SIZE :
+                             sizeof(PasswordJournalRecord);
+    uint32_t crc;
+    if(stream_read(stream, (uint8_t*)record, record_size) != record_size ||
+       record->name_length >= NAME_MAX_LENGTH || record->password_length >= PASSWORD_MAX_LENGTH) {
+        return 0;
+    }
+    
+    size_t secret_size = version == PASSWORD_JOURNAL_VERSION ?
+                             PASSWORD_CRYPTO_SEALED_SIZE(record->password_length) :
+                             record->password_length;
+    if(stream_read(stream, (uint8_t*)name, record->name_length) != record->name_length ||
+       stream_read(stream, secret, secret_size) != secret_size ||
+       !password_stream_read_u32(stream, &crc)) {
+        return 0;
+    }
+    
+    uint32_t expected = password_crc32(0, record, record_size);
+    expected = password_crc32(expected, name, record->name_length);
+    expected = password_crc32(expected, secret, secret_size);
+    if(crc != expected) return 0;
+    
+    name[record->name_length] = '\0';
+    return record_size + record->name_length + secret_size + sizeof(uint32_t);
+}
+
+// Založí prázdný žurnál svázaný s aktuální velikostí základního souboru
+static bool password_journal_create(PasswordVault* vault) {
+    PasswordJournalHeader header = {
+        .magic = PASSWORD_JOURNAL_MAGIC,
+        .version = PASSWORD_JOURNAL_VERSION,
+        .vault_size = vault->vault_size,
+    };
+    if(!file_stream_open(
+           vault->journal,
+           furi_string_get_cstr(vault->journal_path),
+           FSAM_READ_WRITE,
+           FSOM_CREATE_ALWAYS) ||
+       stream_write(vault->journal, (const uint8_t*)&header, sizeof(header)) != sizeof(header)) {
+        FURI_LOG_E(TAG, "Nelze vytvořit žurnál %s", furi_string_get_cstr(vault->journal_path));
+        file_stream_close(vault->journal);
+        return false;
+    }
+    
+    vault->journal_size = sizeof(header);
+    return true;
+}
+
+// Zavře žurnál a zahodí čekající záznamy, jeho obsah už je v základním souboru
+static void password_journal_close(PasswordVault* vault) {
+    if(vault->journal_size) file_stream_close(vault->journal);
+    memset(vault->pending, 0, vault->pending_size);
+    vault->pending_size = 0;
+    vault->journal_size = 0;
+    vault->journal_records = 0;
+    vault->journal_version = PASSWORD_JOURNAL_VERSION;
+}
+
+// Konec zapsané části žurnálu (hlavička se počítá i u dosud nevytvořeného)
+static uint32_t password_journal_written_size(const PasswordVault* vault) {
+    return vault->journal_size ? vault->journal_size : sizeof(PasswordJournalHeader);
+}
+
+// Připíše čekající záznamy na konec žurnálu jedním zápisem
+static bool password_journal_flush(PasswordVault* vault) {
+    if(!vault->pending_size) return true;
+    if(!vault->journal_size && !password_journal_create(vault)) return false;
+    
+    // Při chybě záznamy čekají dál a příští pokus přepíše nedopsaný konec
+    if(!stream_seek(vault->journal, vault->journal_size, StreamOffsetFromStart) ||
+       stream_write(vault->journal, vault->pending, vault->pending_size) != vault->pending_size) {
+        FURI_LOG_E(TAG, "Nelze zapsat do žurnálu");
+        return false;
+    }
+    
+    FURI_LOG_D(TAG, "Zapsáno %lu B do žurnálu", vault->pending_size);
+    vault->journal_size += vault->pending_size;
+    memset(vault->pending, 0, vault->pending_size);
+    vault->pending_size = 0;
+    return true;
+}
+
+// Zařadí záznam mezi čekající, vrací jeho budoucí offset v žurnálu (0 při chybě)
+static uint32_t password_journal_queue(
+    PasswordVault* vault,
+    const PasswordJournalRecord* record,
+    const char* name,
+    const uint8_t* secret) {
+    size_t secret_size = PASSWORD_CRYPTO_SEALED_SIZE(record->password_length);
+    size_t size = sizeof(PasswordJournalRecord) + record->name_length + secret_size +
+                  sizeof(uint32_t);
+    if(vault->pending_size + size > PASSWORD_JOURNAL_PENDING_SIZE &&
+       !password_journal_flush(vault)) {
+        return 0;
+    }
+    
+    uint8_t* buffer = vault->pending + vault->pending_size;
+    size_t position = 0;
+    memcpy(buffer, record, sizeof(PasswordJournalRecord));
+    position += sizeof(PasswordJournalRecord);
+    memcpy(buffer + position, name, record->name_length);
+    position += record->name_length;
+    memcpy(buffer + position, secret, secret_size);
+    position += secret_size;
+    uint32_t crc = password_crc32(0, buffer, position);
+    memcpy(buffer + position, &crc, sizeof(crc));
+    
+    uint32_t offset = password_journal_written_size(vault) + vault->pending_size;
+    vault->pending_size += size;
+    vault->journal_records++;
+    vault->last_change = furi_get_tick();
+    return offset;
+}
+
+static bool password_journal_needs_compaction(const PasswordVault* vault) {
+    return vault->journal_records >= PASSWORD_JOURNAL_MAX_RECORDS ||
+           password_journal_written_size(vault) + vault->pending_size >
+               MAX(PASSWORD_JOURNAL_MIN_COMPACT_SIZE, vault->vault_size / 2);
+}
+
+// Stránkovaný režim
+
+// Otevře základní soubor, překryv změn začíná prázdný
+static bool password_vault_open_base(PasswordList* list) {
+    PasswordVault* vault = list->vault;
+    const char* path = furi_string_get_cstr(vault->path);
+    
+    if(!vault->stream) vault->stream = file_stream_alloc(vault->storage);
+    
+    PasswordVaultHeader header;
+    if(!file_stream_open(vault->stream, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        FURI_LOG_E(TAG, "Nelze otevřít soubor %s", path);
+        return false;
+    }
+    if(!password_vault_read_header(vault->stream, &header)) {
+        file_stream_close(vault->stream);
+        return false;
+    }
+    
+    vault->paged = true;
+    vault->version = header.version;
+    vault->masks_offset = header.version == PASSWORD_VAULT_VERSION_NO_MASKS ?
+                              0 :
+                              sizeof(PasswordVaultHeader) + header.count * sizeof(uint32_t);
+    vault->records_offset = sizeof(PasswordVaultHeader) +
+                            header.count * password_vault_table_entry_size(header.version);
+    vault->records_size = header.records_size;
+    vault->base_count = header.count;
+    vault->removed_count = 0;
+    vault->overlay_count = 0;
+    
+    password_pool_reset(list, 0);
+    list->count = header.count;
+    return true;
+}
+
+static void password_vault_close_base(PasswordVault* vault) {
+    if(!vault->paged) return;
+    file_stream_close(vault->stream);
+    vault->paged = false;
+}
+
+/**
+ * Převede logický index stránkovaného seznamu na záznam základního souboru
+ * (vrací true, position je index v souboru) nebo na záznam přidaný
+ * v žurnálu (vrací false, position je pozice v překryvu).
+ */
+static bool password_vault_locate(const PasswordVault* vault, uint32_t index, uint32_t* position) {
+    // Přidané záznamy před indexem ho v základním souboru posunou zpět...
+    uint32_t inserted = 0;
+    for(; inserted < vault->overlay_count && vault->overlay[inserted].index <= index; inserted++) {
+        if(vault->overlay[inserted].index == index) {
+            *position = inserted;
+            return false;
+        }
+    }
+    index -= inserted;
+    
+    // ...a odebrané záznamy (seřazené) před ním ho posunou vpřed
+    for(uint32_t i = 0; i < vault->removed_count && vault->removed[i] <= index; i++) index++;
+    *position = index;
+    return true;
+}
+
+// Vloží záznam žurnálu na logickou pozici, záznamy od ní se posunou o jednu dál
+static bool password_vault_insert(PasswordVault* vault, uint32_t index, uint32_t journal_offset) {
+    if(vault->overlay_count == PASSWORD_JOURNAL_MAX_RECORDS) return false;
+    
+    uint32_t i = vault->overlay_count;
+    while(i > 0 && vault->overlay[i - 1].index >= index) {
+        vault->overlay[i] = vault->overlay[i - 1];
+        vault->overlay[i].index++;
+        i--;
+    }
+    vault->overlay[i].index = index;
+    vault->overlay[i].journal_offset = journal_offset;
+    vault->overlay_count++;
+    return true;
+}
+
+// Odebere záznam na logické pozici, ze základního souboru jen poznamenáním indexu
+static bool password_vault_remove(PasswordVault* vault, uint32_t index) {
+    uint32_t position;
+    if(!password_vault_locate(vault, index, &position)) {
+        vault->overlay_count--;
+        memmove(
+            &vault->overlay[position],
+            &vault->overlay[position + 1],
+            (vault->overlay_count - position) * sizeof(PasswordOverlayEntry));
+    } else {
+        if(vault->removed_count == PASSWORD_JOURNAL_MAX_RECORDS) return false;
+        
+        uint32_t i = vault->removed_count;
+        while(i > 0 && vault->removed[i - 1] > position) {
+            vault->removed[i] = vault->removed[i - 1];
+            i--;
+        }
+        vault->removed[i] = position;
+        vault->removed_count++;
+    }
+    
+    for(uint32_t i = 0; i < vault->overlay_count; i++) {
+        if(vault->overlay[i].index > index) vault->overlay[i].index--;
+    }
+    return true;
+}
+
+// Přečte záznam základního souboru: položku tabulky a pak celý záznam naráz
+static bool password_vault_read_base(
+    PasswordVault* vault,
+    uint32_t base_index,
+    char* name,
+    uint8_t* secret,
+    size_t* password_length) {
+    uint8_t record[PASSWORD_VAULT_RECORD_MAX_SIZE];
+    uint32_t offset;
+    bool success = stream_seek(
+                       vault->stream,
+                       sizeof(PasswordVaultHeader) + base_index * sizeof(uint32_t),
+                       StreamOffsetFromStart) &&
+                   password_stream_read_u32(vault->stream, &offset) &&
+                   offset < vault->records_size;
+    bool sealed = vault->version == PASSWORD_VAULT_VERSION;
+    if(success) {
+        size_t size = MIN(sizeof(record), (size_t)(vault->records_size - offset));
+        success = stream_seek(vault->stream, vault->records_offset + offset, StreamOffsetFromStart) &&
+                  stream_read(vault->stream, record, size) == size &&
+                  password_vault_record_decode(
+                      record, size, sealed, name, secret, password_length) != 0;
+    }
+    password_crypto_wipe(record, sizeof(record));
+    
+    // Nešifrovaný trezor se hned po otevření převádí, do té doby se hesla pečetí při čtení
+    success = success && (sealed || password_secret_seal(vault->key, name, secret, *password_length));
+    
+    if(!success) FURI_LOG_E(TAG, "Nelze přečíst záznam %lu", base_index);
+    return success;
+}
+
+// Načte záznam žurnálu na daném offsetu, i když ještě čeká na zápis
+static bool password_vault_read_journal(
+    PasswordVault* vault,
+    uint32_t offset,
+    char* name,
+    uint8_t* secret,
+    size_t* password_length) {
+    PasswordJournalRecord record;
+    uint32_t written_size = password_journal_written_size(vault);
+    if(offset >= written_size) {
+        const uint8_t* data = vault->pending + (offset - written_size);
+        memcpy(&record, data, sizeof(record));
+        data += sizeof(record);
+        memcpy(name, data, record.name_length);
+        name[record.name_length] = '\0';
+        memcpy(
+            secret,
+            data + record.name_length,
+            PASSWORD_CRYPTO_SEALED_SIZE(record.password_length));
+    } else if(
+        !stream_seek(vault->journal, offset, StreamOffsetFromStart) ||
+        password_journal_read(vault->journal, vault->journal_version, &record, name, secret) == 0 ||
+        (vault->journal_version != PASSWORD_JOURNAL_VERSION &&
+         !password_secret_seal(vault->key, name, secret, record.password_length))) {
+        return false;
+    }
+    *password_length = record.password_length;
+    return true;
+}
+
+/**
+ * Načte název a zapečetěné heslo záznamu stránkovaného seznamu, ať leží
+ * v základním souboru, nebo v žurnálu. Buffery musí mít velikost
+ * NAME_MAX_LENGTH a PASSWORD_SECRET_MAX_SIZE.
+ */
+static bool password_vault_read_entry(
+    PasswordVault* vault,
+    uint32_t index,
+    char* name,
+    uint8_t* secret,
+    size_t* password_length) {
+    uint32_t position;
+    if(!password_vault_locate(vault, index, &position)) {
+        return password_vault_read_journal(
+            vault, vault->overlay[position].journal_offset, name, secret, password_length);
+    }
+    return password_vault_read_base(vault, position, name, secret, password_length);
+}
+
+// Naplní okno názvy kolem zadaného indexu
+static void password_vault_load_window(PasswordList* list, uint32_t index) {
+    uint32_t start = index > PASSWORD_LIST_WINDOW_SIZE / 2 ? index - PASSWORD_LIST_WINDOW_SIZE / 2 : 0;
+    if(list->count > PASSWORD_LIST_WINDOW_SIZE && start + PASSWORD_LIST_WINDOW_SIZE > list->count) {
+        start = list->count - PASSWORD_LIST_WINDOW_SIZE;
+    }
+    
+    password_pool_reset(list, start);
+    
+    // Hesla se do okna nenačítají
+    char name[NAME_MAX_LENGTH];
+    uint8_t secret[PASSWORD_SECRET_MAX_SIZE];
+    size_t password_length;
+    for(uint32_t row = start;
+        row < list->count && list->window_count < PASSWORD_LIST_WINDOW_SIZE;
+        row++) {
+        if(!password_vault_read_entry(list->vault, row, name, secret, &password_length)) break;
+        password_pool_append(list, name, strlen(name), NULL, 0);
+    }
+}
+
+// Soubor trezoru
+
+static PasswordVault* password_vault_alloc(const char* storage_path, const uint8_t* key) {
+    PasswordVault* vault = malloc(sizeof(PasswordVault));
+    memset(vault, 0, sizeof(PasswordVault));
+    vault->journal_version = PASSWORD_JOURNAL_VERSION;
+    vault->version = PASSWORD_VAULT_VERSION;
+    vault->key = key;
+    vault->storage = furi_record_open(RECORD_STORAGE);
+    vault->path = furi_string_alloc_set_str(storage_path);
+    vault->journal_path = furi_string_alloc_printf("%s%s", storage_path, PASSWORD_JOURNAL_SUFFIX);
+    vault->journal = file_stream_alloc(vault->storage);
+    return vault;
+}
+
+static void password_vault_free(PasswordList* list) {
+    PasswordVault* vault = list->vault;
+    if(!vault) return;
+    
+    if(vault->stream) stream_free(vault->stream);
+    // Změny čekající na zápis se neztratí ani při zavření bez uložení
+    password_journal_flush(vault);
+    password_journal_close(vault);
+    stream_free(vault->journal);
+    furi_string_free(vault->path);
+    furi_string_free(vault->journal_path);
+    free(vault);
+    furi_record_close(RECORD_STORAGE);
+    
+    list->vault = NULL;
+    password_pool_reset(list, 0);
     list->count = 0;
-    memset(list->items, 0, sizeof(list->items));
+    list->generation++;
+}
+
+/**
+ * Promítne změnu do seznamu. Ve stránkovaném režimu se změna jen zapíše
+ * do překryvu, data zůstávají v žurnálu na offsetu journal_offset.
+ * Úprava odebere původní záznam a nové znění vloží na record->position.
+ */
+static bool password_list_apply(
+    PasswordList* list,
+    const PasswordJournalRecord* record,
+    const char* name,
+    const uint8_t* secret,
+    uint32_t journal_offset) {
+    bool add = record->op == PasswordJournalOpAdd;
+    bool remove = record->op == PasswordJournalOpRemove;
+    if(!add && !remove && record->op != PasswordJournalOpUpdate) return false;
+    if(!add && record->index >= list->count) return false;
+    if(!remove && record->position > list->count - (add ? 0 : 1)) return false;
+    
+    if(!password_list_is_paged(list)) {
+        // Index názvů se udržuje spolu se seznamem, dokud se nezaplní
+        bool indexed = list->name_index_capacity > 0;
+        if(indexed && !add) password_name_index_delete(list, record->index);
+        
+        if(add) {
+            if(!password_pool_insert(
+                   list, record->position, name, record->name_length, secret, record->password_length)) {
+                password_name_index_drop(list);
+                return false;
+            }
+        } else if(remove) {
+            password_pool_remove(list, record->index);
+        } else {
+            if(!password_pool_replace(
+                   list,
+                   record->index,
+                   name,
+                   record->name_length,
+                   secret,
+                   record->password_length)) {
+                password_name_index_drop(list);
+                return false;
+            }
+            password_pool_move(list, record->index, record->position);
+        }
+        list->count = list->window_count;
+        
+        // Přečíslují se jen záznamy mezi starou a novou pozicí
+        if(indexed && add && list->count >= list->name_index_capacity / 2) {
+            password_name_index_drop(list);
+        } else if(indexed) {
+            if(add) {
+                password_name_index_shift(list, record->position + 1, list->count, 1);
+            } else if(remove) {
+                password_name_index_shift(list, record->index, list->count, -1);
+            } else if(record->index < record->position) {
+                password_name_index_shift(list, record->index, record->position, -1);
+            } else {
+                password_name_index_shift(list, record->position + 1, record->index + 1, 1);
+            }
+            if(!remove) password_name_index_put(list, record->position);
+        }
+        return true;
+    }
+    
+    // Místo v překryvu se ověří předem, úprava se nesmí provést napůl
+    PasswordVault* vault = list->vault;
+    if((!remove && vault->overlay_count == PASSWORD_JOURNAL_MAX_RECORDS) ||
+       (!add && vault->removed_count == PASSWORD_JOURNAL_MAX_RECORDS)) {
+        return false;
+    }
+    if(!add) password_vault_remove(vault, record->index);
+    if(!remove) password_vault_insert(vault, record->position, journal_offset);
+    
+    // Okno se načte znovu při příštím čtení
+    list->count = vault->base_count - vault->removed_count + vault->overlay_count;
+    password_pool_reset(list, 0);
+    return true;
+}
+
+// Přehraje žurnál do seznamu, vrací false pro nedopsaný nebo cizí žurnál
+static bool password_journal_replay(PasswordList* list) {
+    PasswordVault* vault = list->vault;
+    const char* journal_path = furi_string_get_cstr(vault->journal_path);
+    
+    if(!storage_file_exists(vault->storage, journal_path)) return true;
+    if(!file_stream_open(vault->journal, journal_path, FSAM_READ_WRITE, FSOM_OPEN_EXISTING)) {
+        FURI_LOG_E(TAG, "Nelze otevřít žurnál %s", journal_path);
+        return false;
+    }
+    
+    PasswordJournalHeader header;
+    uint32_t version = vault->journal_version;
+    if(stream_read(vault->journal, (uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+       header.magic != PASSWORD_JOURNAL_MAGIC || header.version != version ||
+       header.vault_size != vault->vault_size) {
+        FURI_LOG_W(TAG, "Žurnál neodpovídá trezoru, zahazuji ho");
+        file_stream_close(vault->journal);
+        return false;
+    }
+    vault->journal_size = sizeof(header);
+    
+    PasswordJournalRecord record;
+    char name[NAME_MAX_LENGTH];
+    uint8_t secret[PASSWORD_SECRET_MAX_SIZE];
+    size_t record_size;
+    while(!password_list_cancelled(list) &&
+          (record_size = password_journal_read(vault->journal, version, &record, name, secret)) != 0) {
+        // Textový trezor nebyl seřazený: přidané šly na konec, upravené zůstaly na místě
+        if(version == PASSWORD_JOURNAL_LEGACY_VERSION) {
+            record.position = record.op == PasswordJournalOpAdd ? list->count : record.index;
+        }
+        // Nešifrovaný žurnál se přehrává jen před převodem, hesla se zapečetí hned
+        if(version != PASSWORD_JOURNAL_VERSION && record.op != PasswordJournalOpRemove &&
+           !password_secret_seal(list->key, name, secret, record.password_length)) {
+            break;
+        }
+        if(!password_list_apply(list, &record, name, secret, vault->journal_size)) break;
+        vault->journal_size += record_size;
+        vault->journal_records++;
+    }
+    password_crypto_wipe(secret, sizeof(secret));
+    
+    FURI_LOG_I(TAG, "Přehráno %lu záznamů žurnálu", vault->journal_records);
+    
+    if(vault->journal_size != stream_size(vault->journal)) {
+        FURI_LOG_W(TAG, "Konec žurnálu je poškozený");
+        return false;
+    }
+    return true;
+}
+
+// Zápis trezoru
+
+static void password_pool_sift_down(
+    const PasswordList* list,
+    uint32_t* offsets,
+    uint32_t root,
+    uint32_t count) {
+    while(true) {
+        uint32_t child = root * 2 + 1;
+        if(child >= count) break;
+        if(child + 1 < count &&
+           password_name_compare(list->pool + offsets[child], list->pool + offsets[child + 1]) < 0) {
+            child++;
+        }
+        if(password_name_compare(list->pool + offsets[root], list->pool + offsets[child]) >= 0) break;
+        
+        uint32_t swap = offsets[root];
+        offsets[root] = offsets[child];
+        offsets[child] = swap;
+        root = child;
+    }
+}
+
+// Seřadí offsety záznamů poolu podle názvu (heapsort, bez další paměti a rekurze)
+static void password_pool_sort(const PasswordList* list, uint32_t* offsets, uint32_t count) {
+    for(uint32_t start = count / 2; start-- > 0;) {
+        password_pool_sift_down(list, offsets, start, count);
+    }
+    for(uint32_t end = count; end-- > 1;) {
+        uint32_t swap = offsets[0];
+        offsets[0] = offsets[end];
+        offsets[end] = swap;
+        password_pool_sift_down(list, offsets, 0, end);
+    }
+}
+
+/**
+ * Postupné čtení oblasti záznamů. Záznamy leží v pořadí tabulky, celý
+ * základní soubor se tak projde bez skoků přes tabulku offsetů.
+ */
+typedef struct {
+    uint8_t data[PASSWORD_VAULT_READ_BUFFER];
+    size_t size;
+    size_t position;
+} PasswordVaultReader;
+
+static bool password_vault_read_next(
+    PasswordVault* vault,
+    PasswordVaultReader* reader,
+    char* name,
+    uint8_t* secret,
+    size_t* password_length) {
+    if(reader->size - reader->position < PASSWORD_VAULT_RECORD_MAX_SIZE) {
+        reader->size -= reader->position;
+        memmove(reader->data, reader->data + reader->position, reader->size);
+        reader->position = 0;
+        reader->size +=
+            stream_read(vault->stream, reader->data + reader->size, sizeof(reader->data) - reader->size);
+    }
+    
+    bool sealed = vault->version == PASSWORD_VAULT_VERSION;
+    size_t record_size = password_vault_record_decode(
+        reader->data + reader->position,
+        reader->size - reader->position,
+        sealed,
+        name,
+        secret,
+        password_length);
+    reader->position += record_size;
+    return record_size != 0 &&
+           (sealed || password_secret_seal(vault->key, name, secret, *password_length));
+}
+
+/**
+ * Projde stránkovaný seznam v logickém pořadí. Základní soubor se čte
+ * postupně a záznamy z překryvu se vkládají na své pozice, paměť tak
+ * neroste s velikostí trezoru.
+ */
+static bool password_vault_iterate(
+    PasswordList* list,
+    PasswordListEntryCallback callback,
+    void* context) {
+    PasswordVault* vault = list->vault;
+    PasswordVaultReader* reader = malloc(sizeof(PasswordVaultReader));
+    reader->size = 0;
+    reader->position = 0;
+    
+    char name[NAME_MAX_LENGTH];
+    uint8_t secret[PASSWORD_SECRET_MAX_SIZE];
+    size_t password_length = 0;
+    bool success = stream_seek(vault->stream, vault->records_offset, StreamOffsetFromStart);
+    
+    uint32_t base_index = 0;
+    uint32_t removed = 0;
+    uint32_t inserted = 0;
+    for(uint32_t index = 0; success && index < list->count; index++) {
+        if(inserted < vault->overlay_count && vault->overlay[inserted].index == index) {
+            success = password_vault_read_journal(
+                vault, vault->overlay[inserted++].journal_offset, name, secret, &password_length);
+        } else {
+            // Odebrané záznamy základního souboru se jen přečtou a přeskočí
+            while(success && removed < vault->removed_count &&
+                  vault->removed[removed] == base_index) {
+                success = password_vault_read_next(vault, reader, name, secret, &password_length);
+                removed++;
+                base_index++;
+            }
+            success = success &&
+                      password_vault_read_next(vault, reader, name, secret, &password_length);
+            base_index++;
+        }
+        success = success && callback(context, name, strlen(name), secret, password_length);
+    }
+    
+    password_crypto_wipe(reader, sizeof(PasswordVaultReader));
+    free(reader);
+    return success;
+}
+
+// Průchody zápisu v pořadí částí souboru
+typedef enum {
+    PasswordVaultWriterPassTable,
+    PasswordVaultWriterPassMasks,
+    PasswordVaultWriterPassRecords,
+    PasswordVaultWriterPassCount,
+} PasswordVaultWriterPass;
+
+/**
+ * Zapisovač binárního trezoru. Malé zápisy se sbírají do bufferu,
+ * kontrolní součet se počítá z toho, co skutečně odchází do souboru.
+ */
+typedef struct {
+    Stream* stream;
+    uint8_t buffer[PASSWORD_VAULT_WRITE_BUFFER];
+    size_t buffer_size;
+    uint32_t checksum;
+    uint32_t count;
+    uint32_t records_size;
+    PasswordVaultWriterPass pass;
+    bool success;
+    const uint8_t* key; // Klíč, kterým se hesla přešifrují (NULL = beze změny)
+    const uint8_t* old_key;
+} PasswordVaultWriter;
+
+static void password_vault_writer_flush(PasswordVaultWriter* writer) {
+    if(!writer->buffer_size) return;
+    if(stream_write(writer->stream, writer->buffer, writer->buffer_size) != writer->buffer_size) {
+        writer->success = false;
+    }
+    writer->checksum = password_crc32(writer->checksum, writer->buffer, writer->buffer_size);
+    writer->buffer_size = 0;
+}
+
+static void password_vault_writer_put(PasswordVaultWriter* writer, const void* data, size_t size) {
+    if(writer->buffer_size + size > sizeof(writer->buffer)) password_vault_writer_flush(writer);
+    memcpy(writer->buffer + writer->buffer_size, data, size);
+    writer->buffer_size += size;
+}
+
+static bool password_vault_writer_entry(
+    void* context,
+    const char* name,
+    size_t name_length,
+    const uint8_t* secret,
+    size_t password_length) {
+    PasswordVaultWriter* writer = context;
+    uint8_t lengths[PASSWORD_VAULT_RECORD_HEADER_SIZE] = {
+        MIN(name_length, (size_t)(NAME_MAX_LENGTH - 1)),
+        MIN(password_length, (size_t)(PASSWORD_MAX_LENGTH - 1)),
+    };
+    
+    if(writer->pass == PasswordVaultWriterPassTable) {
+        // Záznamy jdou v pořadí tabulky, offset je součet předchozích velikostí
+        password_vault_writer_put(writer, &writer->records_size, sizeof(uint32_t));
+        writer->records_size += sizeof(lengths) + lengths[0] + PASSWORD_CRYPTO_SEALED_SIZE(lengths[1]);
+        writer->count++;
+    } else if(writer->pass == PasswordVaultWriterPassMasks) {
+        uint64_t mask = password_search_mask(name, lengths[0]);
+        password_vault_writer_put(writer, &mask, sizeof(mask));
+    } else {
+        // Přešifrování: heslo se otevře původním klíčem a zapečetí novým
+        uint8_t resealed[PASSWORD_SECRET_MAX_SIZE];
+        if(writer->key) {
+            char password[PASSWORD_MAX_LENGTH];
+            writer->success =
+                writer->success &&
+                password_crypto_open(
+                    writer->old_key, name, lengths[0], secret, lengths[1], password) &&
+                password_crypto_seal(writer->key, name, lengths[0], password, lengths[1], resealed);
+            password_crypto_wipe(password, sizeof(password));
+            secret = resealed;
+        }
+        password_vault_writer_put(writer, lengths, sizeof(lengths));
+        password_vault_writer_put(writer, name, lengths[0]);
+        password_vault_writer_put(writer, secret, PASSWORD_CRYPTO_SEALED_SIZE(lengths[1]));
+    }
+    return writer->success;
+}
+
+/**
+ * Zapíše seznam jako binární trezor v logickém pořadí, které je seřazené
+ * podle názvu. První průchod zapíše tabulku offsetů, druhý masky názvů
+ * a třetí záznamy, hlavička se doplní nakonec. Hesla se zapečetí klíčem
+ * key, jiný než klíč seznamu znamená přešifrování.
+ */
+static bool password_list_write(PasswordList* list, Stream* stream, const uint8_t* key) {
+    PasswordVaultWriter* writer = malloc(sizeof(PasswordVaultWriter));
+    memset(writer, 0, sizeof(PasswordVaultWriter));
+    writer->stream = stream;
+    if(memcmp(key, list->key, PASSWORD_CRYPTO_KEY_SIZE) != 0) {
+        writer->key = key;
+        writer->old_key = list->key;
+    }
+    
+    bool paged = password_list_is_paged(list);
+    PasswordVaultHeader header = {0};
+    writer->success = stream_write(stream, (const uint8_t*)&header, sizeof(header)) == sizeof(header);
+    for(writer->pass = 0; writer->pass < PasswordVaultWriterPassCount && writer->success;
+        writer->pass++) {
+        if(paged) {
+            if(!password_vault_iterate(list, password_vault_writer_entry, writer)) {
+                writer->success = false;
+            }
+        } else {
+            for(uint32_t i = 0; i < list->count && writer->success; i++) {
+                const char* name = list->pool + list->offsets[i];
+                size_t password_length;
+                const uint8_t* secret = password_pool_secret(list, i, &password_length);
+                password_vault_writer_entry(writer, name, strlen(name), secret, password_length);
+            }
+        }
+    }
+    password_vault_writer_flush(writer);
+    
+    header.magic = PASSWORD_VAULT_MAGIC;
+    header.version = PASSWORD_VAULT_VERSION;
+    header.count = writer->count;
+    header.records_size = writer->records_size;
+    header.checksum = writer->checksum;
+    bool success = writer->success && stream_seek(stream, 0, StreamOffsetFromStart) &&
+                   stream_write(stream, (const uint8_t*)&header, sizeof(header)) == sizeof(header);
+                   
+    memset(writer, 0, sizeof(PasswordVaultWriter));
+    free(writer);
+    return success;
 }
 
-bool password_list_load(PasswordList* list, const char* storage_path) {
-    FURI_LOG_I(TAG, "Načítání hesel z %s", storage_path);
+/**
+ * Zapíše seznam do souboru "<cesta>.tmp" a až po úplném zápisu ho přejmenuje
+ * na "<cesta>.new". Existující ".new" je tak vždy kompletní nová verze.
+ */
+static bool password_list_write_new(
+    PasswordList* list,
+    Storage* storage,
+    const char* storage_path,
+    const uint8_t* key) {
+    FuriString* temp_path = furi_string_alloc_printf("%s%s", storage_path, PASSWORD_TEMP_SUFFIX);
+    FuriString* new_path = furi_string_alloc_printf("%s%s", storage_path, PASSWORD_NEW_SUFFIX);
     
-    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Stream* stream = file_stream_alloc(storage);
+    bool success =
+        file_stream_open(stream, furi_string_get_cstr(temp_path), FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+        password_list_write(list, stream, key);
+    stream_free(stream);
     
-    // Vytvoření adresáře, pokud neexistuje
+    if(success) {
+        storage_common_remove(storage, furi_string_get_cstr(new_path));
+        success = storage_common_rename(
+                      storage, furi_string_get_cstr(temp_path), furi_string_get_cstr(new_path)) ==
+                  FSE_OK;
+    }
+    if(!success) {
+        FURI_LOG_E(TAG, "Nelze zapsat %s", furi_string_get_cstr(temp_path));
+        storage_common_remove(storage, furi_string_get_cstr(temp_path));
+    }
+    
+    furi_string_free(temp_path);
+    furi_string_free(new_path);
+    return success;
+}
+
+/**
+ * Nahradí soubor hotovou verzí "<cesta>.new". Žurnál patří ke starému
+ * obsahu, proto se smaže první. Výpadek kdykoli během výměny dokončí
+ * příští otevření (password_storage_recover).
+ */
+static bool password_storage_commit(Storage* storage, const char* storage_path) {
+    FuriString* path = furi_string_alloc_printf("%s%s", storage_path, PASSWORD_JOURNAL_SUFFIX);
+    storage_common_remove(storage, furi_string_get_cstr(path));
+    storage_common_remove(storage, storage_path);
+    
+    furi_string_printf(path, "%s%s", storage_path, PASSWORD_NEW_SUFFIX);
+    bool success = storage_common_rename(storage, furi_string_get_cstr(path), storage_path) ==
+                   FSE_OK;
+    if(!success) FURI_LOG_E(TAG, "Nelze přejmenovat %s", furi_string_get_cstr(path));
+    
+    furi_string_free(path);
+    return success;
+}
+
+// Dokončí uložení přerušené výpadkem napájení, nedopsaný ".tmp" zahodí
+static void password_storage_recover(Storage* storage, const char* storage_path) {
+    FuriString* path = furi_string_alloc_printf("%s%s", storage_path, PASSWORD_NEW_SUFFIX);
+    if(storage_file_exists(storage, furi_string_get_cstr(path))) {
+        FURI_LOG_W(TAG, "Dokončování přerušeného uložení %s", storage_path);
+        password_storage_commit(storage, storage_path);
+    }
+    
+    furi_string_printf(path, "%s%s", storage_path, PASSWORD_TEMP_SUFFIX);
+    if(storage_file_exists(storage, furi_string_get_cstr(path))) {
+        FURI_LOG_W(TAG, "Mazání nedokončeného %s", furi_string_get_cstr(path));
+        storage_common_remove(storage, furi_string_get_cstr(path));
+    }
+    furi_string_free(path);
+}
+
+// Přepíše základní soubor i se žurnálem (včetně čekajících záznamů), hesla zapečetí klíčem key
+static bool password_vault_rewrite(PasswordList* list, const uint8_t* key) {
+    PasswordVault* vault = list->vault;
+    const char* path = furi_string_get_cstr(vault->path);
+    
+    FURI_LOG_I(TAG, "Slučování žurnálu (%lu záznamů)", vault->journal_records);
+    
+    if(!password_list_write_new(list, vault->storage, path, key)) return false;
+    
+    bool paged = vault->paged;
+    password_vault_close_base(vault);
+    password_journal_close(vault);
+    bool success = password_storage_commit(vault->storage, path);
+    if(success) vault->version = PASSWORD_VAULT_VERSION;
+    
+    FileInfo info;
+    vault->vault_size = storage_common_stat(vault->storage, path, &info) == FSE_OK ? info.size : 0;
+    
+    if(paged && !password_vault_open_base(list)) {
+        password_list_clear(list);
+        return false;
+    }
+    return success;
+}
+
+// Sloučí žurnál se základním souborem
+static bool password_vault_compact(PasswordList* list) {
+    return password_vault_rewrite(list, list->key);
+}
+
+// Seřazený seznam
+
+/**
+ * Vrátí název záznamu pro vyhledávání. Mimo okno se ve stránkovaném
+ * režimu čte přímo ze souboru, hledání tak okno zobrazených řádků nemění.
+ */
+static const char* password_list_probe_name(PasswordList* list, uint32_t index, char* buffer) {
+    if(index >= list->window_start && index - list->window_start < list->window_count) {
+        return list->pool + list->offsets[index - list->window_start];
+    }
+    
+    uint8_t secret[PASSWORD_SECRET_MAX_SIZE];
+    size_t password_length;
+    if(!password_vault_read_entry(list->vault, index, buffer, secret, &password_length)) {
+        buffer[0] = '\0';
+    }
+    return buffer;
+}
+
+/**
+ * Binární vyhledávání v rozsahu seřazeného seznamu. Vrátí první index,
+ * jehož název je větší než key (upper), nebo větší či rovný (!upper).
+ * S prefix se porovnává jen začátek názvu.
+ */
+static uint32_t password_list_bound(
+    PasswordList* list,
+    uint32_t start,
+    uint32_t end,
+    const char* key,
+    bool prefix,
+    bool upper) {
+    char buffer[NAME_MAX_LENGTH];
+    while(start < end) {
+        uint32_t middle = start + (end - start) / 2;
+        const char* name = password_list_probe_name(list, middle, buffer);
+        int result = prefix ? password_prefix_compare(name, key) : password_name_compare(name, key);
+        if(result < 0 || (upper && result == 0)) {
+            start = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return start;
+}
+
+/**
+ * Zařadí změnu jako jeden záznam žurnálu a promítne ji do seznamu. Zápis
+ * na kartu proběhne až v password_list_flush. Seznam, který nevznikl
+ * ze souboru, se mění jen v paměti. Heslo se zapečetí hned, dál už
+ * putuje jen zašifrované.
+ */
+static bool password_list_mutate(
+    PasswordList* list,
+    PasswordJournalOp op,
+    uint32_t index,
+    const char* name,
+    const char* password) {
+    PasswordVault* vault = list->vault;
+    
+    // Překryv stránkovaného režimu pojme jen omezený počet změn
+    if(vault && vault->journal_records >= PASSWORD_JOURNAL_MAX_RECORDS &&
+       (!password_vault_compact(list) || !list->vault)) {
+        FURI_LOG_E(TAG, "Žurnál je plný");
+        return false;
+    }
+    
+    // Nové znění jde za všechny menší a stejné názvy, seznam zůstane seřazený
+    uint32_t position = 0;
+    if(op != PasswordJournalOpRemove) {
+        char key[NAME_MAX_LENGTH];
+        strlcpy(key, name, sizeof(key));
+        position = password_list_bound(list, 0, list->count, key, false, true);
+        if(op == PasswordJournalOpUpdate && position > index) position--;
+    }
+    
+    PasswordJournalRecord record;
+    uint8_t secret[PASSWORD_SECRET_MAX_SIZE] = {0};
+    password_journal_record_init(&record, op, index, position, name, password);
+    if(op != PasswordJournalOpRemove &&
+       !password_crypto_seal(
+           list->key, name, record.name_length, password, record.password_length, secret)) {
+        return false;
+    }
+    
+    bool success;
+    if(!vault) {
+        success = password_list_apply(list, &record, name, secret, 0);
+    } else {
+        uint32_t offset = password_journal_queue(vault, &record, name, secret);
+        success = offset && password_list_apply(list, &record, name, secret, offset);
+        if(success && password_journal_needs_compaction(vault)) password_vault_compact(list);
+    }
+    password_crypto_wipe(secret, sizeof(secret));
+    if(success) list->generation++;
+    return success;
+}
+
+// Fuzzy hledání
+
+/**
+ * Zařadí výsledek mezi nejlepší: vyšší skóre dřív, při shodě nižší index.
+ * Horší výsledek než poslední v plném poli se zahodí.
+ */
+static void password_search_result_add(
+    PasswordSearchResult* results,
+    uint32_t* count,
+    uint32_t max_results,
+    uint32_t index,
+    int16_t score) {
+    uint32_t i = *count;
+    if(i == max_results) {
+        if(i == 0 || results[i - 1].score > score ||
+           (results[i - 1].score == score && results[i - 1].index < index)) {
+            return;
+        }
+        i--;
+    } else {
+        (*count)++;
+    }
+    
+    while(i > 0 && (results[i - 1].score < score ||
+                    (results[i - 1].score == score && results[i - 1].index > index))) {
+        results[i] = results[i - 1];
+        i--;
+    }
+    results[i].index = index;
+    results[i].score = score;
+}
+
+/**
+ * Fuzzy hledání ve stránkovaném seznamu. Masky základního souboru se čtou
+ * po blocích z tabulky masek, název se načte jen u kandidátů. Záznamy
+ * z překryvu se porovnají přímo, je jich nejvýše velikost žurnálu.
+ */
+static uint32_t password_vault_search(
+    PasswordList* list,
+    const char* pattern,
+    uint64_t pattern_mask,
+    PasswordSearchResult* results,
+    uint32_t max_results) {
+    PasswordVault* vault = list->vault;
+    uint64_t* masks = malloc(PASSWORD_SEARCH_BLOCK * sizeof(uint64_t));
+    char name[NAME_MAX_LENGTH];
+    uint8_t secret[PASSWORD_SECRET_MAX_SIZE];
+    size_t password_length;
+    uint32_t found = 0;
+    int16_t score;
+    
+    uint32_t removed = 0;
+    bool success = true;
+    for(uint32_t block = 0; success && block < vault->base_count; block += PASSWORD_SEARCH_BLOCK) {
+        uint32_t block_count = MIN(vault->base_count - block, (uint32_t)PASSWORD_SEARCH_BLOCK);
+        
+        // Trezor bez masek (jen při chybě převodu) projde celý
+        uint64_t hits = block_count == PASSWORD_SEARCH_BLOCK ? UINT64_MAX : ((uint64_t)1 << block_count) - 1;
+        if(vault->masks_offset) {
+            size_t size = block_count * sizeof(uint64_t);
+            success = stream_seek(
+                          vault->stream,
+                          vault->masks_offset + block * sizeof(uint64_t),
+                          StreamOffsetFromStart) &&
+                      stream_read(vault->stream, (uint8_t*)masks, size) == size;
+            if(!success) break;
+            hits = password_search_prefilter(masks, block_count, pattern_mask);
+        }
+        
+        // Odebrané záznamy nejsou kandidáti
+        for(; removed < vault->removed_count && vault->removed[removed] < block + block_count;
+            removed++) {
+            hits &= ~((uint64_t)1 << (vault->removed[removed] - block));
+        }
+        
+        for(; hits; hits &= hits - 1) {
+            uint32_t base_index = block + __builtin_ctzll(hits);
+            if(!password_vault_read_base(vault, base_index, name, secret, &password_length)) {
+                success = false;
+                break;
+            }
+            if(!password_search_match(name, pattern, &score)) continue;
+            
+            // Logický index: odebrané záznamy před ním ho posunou zpět, přidané vpřed
+            uint32_t index = base_index;
+            for(uint32_t i = 0; i < vault->removed_count && vault->removed[i] < base_index; i++) {
+                index--;
+            }
+            for(uint32_t i = 0; i < vault->overlay_count && vault->overlay[i].index <= index; i++) {
+                index++;
+            }
+            password_search_result_add(results, &found, max_results, index, score);
+        }
+    }
+    
+    for(uint32_t i = 0; success && i < vault->overlay_count; i++) {
+        success = password_vault_read_journal(
+            vault, vault->overlay[i].journal_offset, name, secret, &password_length);
+        if(success && password_search_match(name, pattern, &score)) {
+            password_search_result_add(results, &found, max_results, vault->overlay[i].index, score);
+        }
+    }
+    if(!success) FURI_LOG_E(TAG, "Hledání v trezoru selhalo");
+    
+    free(masks);
+    return found;
+}
+
+// Veřejné API
+
+const char* password_list_get_name(PasswordList* list, uint32_t index) {
+    furi_assert(index < list->count);
+    if(password_list_is_paged(list) &&
+       (index < list->window_start || index >= list->window_start + list->window_count)) {
+        password_vault_load_window(list, index);
+        if(index >= list->window_start + list->window_count) return "";
+    }
+    return list->pool + list->offsets[index - list->window_start];
+}
+
+bool password_list_read_password(PasswordList* list, uint32_t index, char* buffer, size_t size) {
+    if(index >= list->count || size == 0) return false;
+    
+    // Ve stránkovaném režimu se zapečetěné heslo čte až ze souboru
+    char name[NAME_MAX_LENGTH];
+    uint8_t secret[PASSWORD_SECRET_MAX_SIZE];
+    size_t password_length;
+    if(!password_list_is_paged(list)) {
+        strlcpy(name, list->pool + list->offsets[index], sizeof(name));
+        const uint8_t* sealed = password_pool_secret(list, index, &password_length);
+        memcpy(secret, sealed, PASSWORD_CRYPTO_SEALED_SIZE(password_length));
+    } else if(!password_vault_read_entry(list->vault, index, name, secret, &password_length)) {
+        return false;
+    }
+    
+    // Heslo se dešifruje jen do krátkodobého bufferu
+    char password[PASSWORD_MAX_LENGTH];
+    bool success = password_crypto_open(
+        list->key, name, strlen(name), secret, password_length, password);
+    if(success) strlcpy(buffer, password, size);
+    password_crypto_wipe(password, sizeof(password));
+    return success;
+}
+
+// Vytvoří adresář s hesly, pokud neexistuje
+static bool password_storage_ensure_directory(Storage* storage) {
     if(!storage_dir_exists(storage, PASSWORDS_FILE_DIRECTORY)) {
         FURI_LOG_I(TAG, "Vytváření adresáře %s", PASSWORDS_FILE_DIRECTORY);
         if(!storage_simply_mkdir(storage, PASSWORDS_FILE_DIRECTORY)) {
             FURI_LOG_E(TAG, "Nelze vytvořit adresář %s", PASSWORDS_FILE_DIRECTORY);
-            furi_record_close(RECORD_STORAGE);
             return false;
         }
     }
-    
-    // Kontrola, zda soubor existuje
-    if(!storage_file_exists(storage, storage_path)) {
-        FURI_LOG_I(TAG, "Soubor %s neexistuje, vytvářím prázdný seznam", storage_path);
-        furi_record_close(RECORD_STORAGE);
-        return true; // Vrátíme true, protože prázdný seznam je validní stav
-    }
-    
+    return true;
+}
+
+// Načte celý textový trezor (starý formát "název:heslo\n") do poolu
+static bool password_list_read_text(PasswordList* list, Storage* storage, const char* storage_path) {
     // Otevření souboru
     Stream* stream = file_stream_alloc(storage);
     if(!file_stream_open(stream, storage_path, FSAM_READ, FSOM_OPEN_EXISTING)) {
         FURI_LOG_E(TAG, "Nelze otevřít soubor %s", storage_path);
         stream_free(stream);
-        furi_record_close(RECORD_STORAGE);
         return false;
     }
     
     // Načtení hesel
-    password_list_init(list); // Reset seznamu
-    
-    char line[PASSWORD_MAX_LENGTH + NAME_MAX_LENGTH + 2]; // +2 pro oddělovač a \0
-    while(stream_read_line(stream, line, sizeof(line))) {
-        // Odstranění nového řádku
-        char* newline = strchr(line, '\n');
-        if(newline) *newline = '\0';
+    FuriString* line_string = furi_string_alloc();
+    uint8_t secret[PASSWORD_SECRET_MAX_SIZE];
+    bool success = true;
+    while(stream_read_line(stream, line_string)) {
+        const char* line = furi_string_get_cstr(line_string);
         
         // Rozdělení řádku na název a heslo
-        char* separator = strchr(line, ':');
-        if(!separator) continue; // Přeskočit neplatné řádky
-        
-        *separator = '\0'; // Rozdělit řetězec
-        char* name = line;
-        char* password = separator + 1;
+        size_t name_length, password_length;
+        const char* password;
+        if(!password_line_parse(line, &name_length, &password, &password_length)) {
+            continue; // Přeskočit neplatné řádky
+        }
         
-        // Přidání hesla do seznamu
-        if(!password_list_add(list, name, password)) {
-            FURI_LOG_W(TAG, "Seznam hesel je plný, načteno %lu hesel", list->count);
+        // Přidání zapečetěného hesla do seznamu
+        name_length = MIN(name_length, (size_t)(NAME_MAX_LENGTH - 1));
+        password_length = MIN(password_length, (size_t)(PASSWORD_MAX_LENGTH - 1));
+        if(!password_crypto_seal(list->key, line, name_length, password, password_length, secret)) {
+            success = false;
+            break;
+        }
+        if(!password_pool_append(list, line, name_length, secret, password_length)) {
+            FURI_LOG_W(TAG, "Seznam hesel je plný, načteno %lu hesel", list->window_count);
             break;
         }
     }
-    
-    FURI_LOG_I(TAG, "Načteno %lu hesel", list->count);
+    list->count = list->window_count;
     
     // Uzavření souboru
+    furi_string_free(line_string);
     stream_free(stream);
-    furi_record_close(RECORD_STORAGE);
     
-    return true;
+    return success;
 }
 
-bool password_list_save(PasswordList* list, const char* storage_path) {
-    FURI_LOG_I(TAG, "Ukládání hesel do %s", storage_path);
-    
-    Storage* storage = furi_record_open(RECORD_STORAGE);
+/**
+ * Načte celý binární trezor do paměti: tabulku offsetů, tabulku masek
+ * a oblast záznamů vždy jedním čtením, záznamy se pak převedou v poolu
+ * na místě. Nešifrovanému trezoru (verze 1 a 2) se hesla zapečetí
+ * a masky dopočítají z názvů, převod do souboru zařídí volající.
+ */
+static bool password_list_read_vault(PasswordList* list, Storage* storage, const char* storage_path) {
+    Stream* stream = file_stream_alloc(storage);
+    if(!file_stream_open(stream, storage_path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        FURI_LOG_E(TAG, "Nelze otevřít soubor %s", storage_path);
+        stream_free(stream);
+        return false;
+    }
     
-    // Vytvoření adresáře, pokud neexistuje
-    if(!storage_dir_exists(storage, PASSWORDS_FILE_DIRECTORY)) {
-        FURI_LOG_I(TAG, "Vytváření adresáře %s", PASSWORDS_FILE_DIRECTORY);
-        if(!storage_simply_mkdir(storage, PASSWORDS_FILE_DIRECTORY)) {
-            FURI_LOG_E(TAG, "Nelze vytvořit adresář %s", PASSWORDS_FILE_DIRECTORY);
-            furi_record_close(RECORD_STORAGE);
-            return false;
+    PasswordVaultHeader header;
+    bool success = password_vault_read_header(stream, &header);
+    if(success) {
+        if(header.count > list->capacity) {
+            list->offsets = realloc(list->offsets, header.count * sizeof(uint32_t));
+            list->masks = realloc(list->masks, header.count * sizeof(uint64_t));
+            list->capacity = header.count;
+        }
+        if(header.records_size > list->pool_capacity) {
+            list->pool = realloc(list->pool, header.records_size);
+            list->pool_capacity = header.records_size;
+        }
+        
+        size_t table_size = header.count * sizeof(uint32_t);
+        size_t masks_size = header.version == PASSWORD_VAULT_VERSION_NO_MASKS ?
+                                0 :
+                                header.count * sizeof(uint64_t);
+        success = stream_read(stream, (uint8_t*)list->offsets, table_size) == table_size &&
+                  stream_read(stream, (uint8_t*)list->masks, masks_size) == masks_size &&
+                  stream_read(stream, (uint8_t*)list->pool, header.records_size) ==
+                      header.records_size;
+        if(success) {
+            uint32_t checksum = password_crc32(0, list->offsets, table_size);
+            checksum = password_crc32(checksum, list->masks, masks_size);
+            checksum = password_crc32(checksum, list->pool, header.records_size);
+            list->window_count = header.count;
+            list->pool_size = header.records_size;
+            if(header.version != PASSWORD_VAULT_VERSION) {
+                success = checksum == header.checksum &&
+                          password_pool_seal(list, header.count, header.records_size);
+            } else {
+                success = checksum == header.checksum &&
+                          password_vault_decode_pool(list, header.records_size);
+            }
+            if(!success) FURI_LOG_E(TAG, "Trezor %s je poškozený", storage_path);
         }
     }
     
-    // Otevření souboru
+    if(success) {
+        list->count = header.count;
+        list->vault->version = header.version;
+    } else {
+        password_pool_reset(list, 0);
+    }
+    stream_free(stream);
+    return success;
+}
+
+bool password_vault_preview(const char* storage_path, PasswordVaultPreview* preview) {
+    memset(preview, 0, sizeof(PasswordVaultPreview));
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
     Stream* stream = file_stream_alloc(storage);
-    if(!file_stream_open(stream, storage_path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
-        FURI_LOG_E(TAG, "Nelze otevřít soubor %s pro zápis", storage_path);
-        stream_free(stream);
+    PasswordVaultHeader header;
+    bool success = file_stream_open(stream, storage_path, FSAM_READ, FSOM_OPEN_EXISTING) &&
+                   password_vault_read_header(stream, &header);
+    if(success) {
+        preview->count = header.count;
+        
+        // Záznam N najdou dvě čtení: položka tabulky a začátek záznamu
+        uint32_t records_offset = sizeof(PasswordVaultHeader) +
+                                  header.count * password_vault_table_entry_size(header.version);
+        uint32_t names = MIN(header.count, PASSWORD_VAULT_PREVIEW_NAMES);
+        for(uint32_t i = 0; i < names; i++) {
+            uint32_t offset;
+            uint8_t lengths[PASSWORD_VAULT_RECORD_HEADER_SIZE];
+            char* name = preview->names[i];
+            if(!stream_seek(
+                   stream,
+                   sizeof(PasswordVaultHeader) + i * sizeof(uint32_t),
+                   StreamOffsetFromStart) ||
+               !password_stream_read_u32(stream, &offset) || offset >= header.records_size ||
+               !stream_seek(stream, records_offset + offset, StreamOffsetFromStart) ||
+               stream_read(stream, lengths, sizeof(lengths)) != sizeof(lengths) ||
+               lengths[0] >= NAME_MAX_LENGTH ||
+               stream_read(stream, (uint8_t*)name, lengths[0]) != lengths[0]) {
+                break;
+            }
+            name[lengths[0]] = '\0';
+            preview->names_count++;
+        }
+    }
+    
+    file_stream_close(stream);
+    stream_free(stream);
+    furi_record_close(RECORD_STORAGE);
+    return success;
+}
+
+bool password_list_open(PasswordList* list, const char* storage_path, PasswordListMode mode) {
+    FURI_LOG_I(TAG, "Načítání hesel z %s", storage_path);
+    
+    password_list_clear(list); // Reset seznamu
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    
+    // Vytvoření adresáře, pokud neexistuje
+    if(!password_storage_ensure_directory(storage)) {
         furi_record_close(RECORD_STORAGE);
         return false;
     }
     
-    // Uložení hesel
-    for(uint32_t i = 0; i < list->count; i++) {
-        PasswordItem* item = &list->items[i];
-        stream_write_format(stream, "%s:%s\n", item->name, item->password);
-    }
+    password_storage_recover(storage, storage_path);
+    
+    // Kontrola, zda soubor existuje
+    FileInfo info;
+    bool exists = storage_common_stat(storage, storage_path, &info) == FSE_OK;
+    bool paged = mode == PasswordListModePaged ||
+                 (mode == PasswordListModeAuto && exists && info.size > PASSWORD_LIST_PAGED_THRESHOLD);
+                 
+    list->vault = password_vault_alloc(storage_path, list->key);
     
-    FURI_LOG_I(TAG, "Uloženo %lu hesel", list->count);
+    // Stránkovaný režim potřebuje soubor, chybějící trezor se založí prázdný
+    if(!exists && paged) {
+        FURI_LOG_I(TAG, "Soubor %s neexistuje, vytvářím prázdný trezor", storage_path);
+        exists = password_list_write_new(list, storage, storage_path, list->key) &&
+                 password_storage_commit(storage, storage_path) &&
+                 storage_common_stat(storage, storage_path, &info) == FSE_OK;
+    }
+    list->vault->vault_size = exists ? info.size : 0;
     
-    // Uzavření souboru
-    stream_free(stream);
+    // Velký trezor se nenačítá celý, jen se otevře ve stránkovaném režimu
+    bool success = true;
+    if(paged) {
+        success = exists && password_vault_open_base(list);
+    } else if(!exists) {
+        FURI_LOG_I(TAG, "Soubor %s neexistuje, vytvářím prázdný seznam", storage_path);
+    } else {
+        success = password_list_read_vault(list, storage, storage_path);
+    }
     furi_record_close(RECORD_STORAGE);
     
+    if(!success || password_list_cancelled(list)) {
+        password_list_clear(list);
+        return false;
+    }
+    
+    // Změny od posledního sloučení; poškozený nebo přerostlý žurnál se hned sloučí.
+    // Starší verze trezoru (bez masek nebo nešifrovaná) se sloučením převede na novou.
+    if(list->vault->version != PASSWORD_VAULT_VERSION) {
+        list->vault->journal_version = PASSWORD_JOURNAL_PLAINTEXT_VERSION;
+    }
+    bool replayed = password_journal_replay(list);
+    
+    // Zrušené otevření nic nezapíše, ani nesloučí žurnál
+    if(password_list_cancelled(list)) {
+        FURI_LOG_I(TAG, "Otevírání %s zrušeno", storage_path);
+        password_list_clear(list);
+        return false;
+    }
+    if(!replayed || password_journal_needs_compaction(list->vault) ||
+       list->vault->version != PASSWORD_VAULT_VERSION) {
+        password_vault_compact(list);
+    }
+    list->generation++;
+    
+    FURI_LOG_I(
+        TAG,
+        "Načteno %lu hesel%s",
+        list->count,
+        password_list_is_paged(list) ? " (stránkovaný režim)" : "");
     return true;
 }
 
-bool password_list_add(PasswordList* list, const char* name, const char* password) {
-    if(list->count >= MAX_PASSWORDS) {
-        FURI_LOG_E(TAG, "Seznam hesel je plný");
-        return false;
+bool password_vault_convert(const char* text_path, const char* vault_path, const uint8_t* key) {
+    FURI_LOG_I(TAG, "Převod %s na %s", text_path, vault_path);
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    password_storage_recover(storage, text_path);
+    
+    PasswordList* list = malloc(sizeof(PasswordList));
+    password_list_init(list);
+    password_list_set_key(list, key);
+    bool success = password_list_read_text(list, storage, text_path);
+    
+    // Změny z žurnálu textového trezoru se převedou také
+    FileInfo info;
+    if(success && storage_common_stat(storage, text_path, &info) == FSE_OK) {
+        list->vault = password_vault_alloc(text_path, list->key);
+        list->vault->vault_size = info.size;
+        list->vault->journal_version = PASSWORD_JOURNAL_LEGACY_VERSION;
+        password_journal_replay(list);
     }
     
-    PasswordItem* item = &list->items[list->count];
+    // Textový trezor nebyl seřazený, binární musí být
+    password_pool_sort(list, list->offsets, list->count);
     
-    // Kopírování názvu a hesla s ověřením délky
-    strlcpy(item->name, name, NAME_MAX_LENGTH);
-    strlcpy(item->password, password, PASSWORD_MAX_LENGTH);
+    success = success && password_list_write_new(list, storage, vault_path, list->key) &&
+              password_storage_commit(storage, vault_path);
+    if(success) FURI_LOG_I(TAG, "Převedeno %lu hesel", list->count);
     
-    list->count++;
+    password_list_free(list);
+    free(list);
+    furi_record_close(RECORD_STORAGE);
+    return success;
+}
+
+// Převede textový trezor se stejným názvem, pokud binární ještě neexistuje
+static void password_list_migrate(PasswordList* list, const char* storage_path) {
+    const char* extension = strrchr(storage_path, '.');
+    const char* file_name = strrchr(storage_path, '/');
+    FuriString* legacy_path = furi_string_alloc_set_str(storage_path);
+    if(extension && (!file_name || extension > file_name)) {
+        furi_string_left(legacy_path, extension - storage_path);
+    }
+    furi_string_cat_str(legacy_path, PASSWORD_LEGACY_EXTENSION);
+    const char* legacy = furi_string_get_cstr(legacy_path);
     
-    return true;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    if(strcmp(legacy, storage_path) != 0 && !storage_file_exists(storage, storage_path) &&
+       storage_file_exists(storage, legacy) &&
+       password_vault_convert(legacy, storage_path, list->key)) {
+        // Textový soubor zůstane jako záloha, žurnál a index už nejsou potřeba
+        FuriString* path = furi_string_alloc_printf("%s%s", legacy, PASSWORD_LEGACY_BACKUP_SUFFIX);
+        storage_common_remove(storage, furi_string_get_cstr(path));
+        storage_common_rename(storage, legacy, furi_string_get_cstr(path));
+        furi_string_printf(path, "%s%s", legacy, PASSWORD_JOURNAL_SUFFIX);
+        storage_common_remove(storage, furi_string_get_cstr(path));
+        furi_string_printf(path, "%s%s", legacy, PASSWORD_LEGACY_INDEX_SUFFIX);
+        storage_common_remove(storage, furi_string_get_cstr(path));
+        furi_string_free(path);
+    }
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(legacy_path);
 }
 
-bool password_list_remove(PasswordList* list, uint32_t index) {
-    if(index >= list->count) {
-        FURI_LOG_E(TAG, "Neplatný index %lu", index);
+bool password_list_load(PasswordList* list, const char* storage_path) {
+    PASSWORD_PERF_BEGIN(start);
+    password_list_migrate(list, storage_path);
+    bool success = password_list_open(list, storage_path, PasswordListModeAuto);
+    PASSWORD_PERF_END(PasswordPerfProbeLoad, start);
+    return success;
+}
+
+bool password_list_save(PasswordList* list, const char* storage_path) {
+    // Trezoru otevřenému z tohoto souboru stačí zapsat čekající změny
+    if(list->vault && furi_string_cmp_str(list->vault->path, storage_path) == 0) {
+        return password_list_flush(list);
+    }
+    
+    FURI_LOG_I(TAG, "Ukládání hesel do %s", storage_path);
+    PASSWORD_PERF_BEGIN(start);
+    
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    
+    // Vytvoření adresáře, pokud neexistuje
+    if(!password_storage_ensure_directory(storage)) {
+        furi_record_close(RECORD_STORAGE);
         return false;
     }
     
-    // Posun všech položek za indexem o jednu pozici zpět
-    for(uint32_t i = index; i < list->count - 1; i++) {
-        memcpy(&list->items[i], &list->items[i + 1], sizeof(PasswordItem));
+    // Cílový soubor se nahradí až úplně zapsanou kopií
+    bool success = password_list_write_new(list, storage, storage_path, list->key) &&
+                   password_storage_commit(storage, storage_path);
+    if(success) {
+        FURI_LOG_I(TAG, "Uloženo %lu hesel", list->count);
     }
     
-    // Vymazání poslední položky
-    memset(&list->items[list->count - 1], 0, sizeof(PasswordItem));
+    furi_record_close(RECORD_STORAGE);
+    PASSWORD_PERF_END(PasswordPerfProbeSave, start);
+    
+    return success;
+}
+
+bool password_list_is_dirty(const PasswordList* list) {
+    return list->vault != NULL && list->vault->pending_size > 0;
+}
+
+// Zapíše čekající záznamy žurnálu (měřeno sondou zápisu)
+static bool password_list_flush_journal(PasswordList* list) {
+    PASSWORD_PERF_BEGIN(start);
+    bool success = password_journal_flush(list->vault);
+    PASSWORD_PERF_END(PasswordPerfProbeFlush, start);
+    return success;
+}
+
+bool password_list_flush(PasswordList* list) {
+    if(!password_list_is_dirty(list)) return true;
+    return password_list_flush_journal(list);
+}
+
+bool password_list_flush_if_idle(PasswordList* list) {
+    if(!password_list_is_dirty(list)) return true;
     
-    list->count--;
+    // Dávka úprav jdoucích rychle po sobě se zapíše najednou
+    uint32_t idle = furi_get_tick() - list->vault->last_change;
+    if(idle < furi_ms_to_ticks(PASSWORD_JOURNAL_FLUSH_DELAY_MS)) return true;
+    return password_list_flush_journal(list);
+}
+
+bool password_list_rekey(PasswordList* list, const uint8_t* key) {
+    // Soubor se přepíše celý, až potom se přešifruje pool v paměti
+    if(list->vault && !password_vault_rewrite(list, key)) {
+        FURI_LOG_E(TAG, "Přešifrování trezoru selhalo");
+        return false;
+    }
     
+    // Zapečetěné heslo má stejnou velikost, přepíše se na místě
+    char password[PASSWORD_MAX_LENGTH];
+    for(uint32_t i = 0; !password_list_is_paged(list) && i < list->window_count; i++) {
+        const char* name = list->pool + list->offsets[i];
+        size_t password_length;
+        uint8_t* secret = (uint8_t*)password_pool_secret(list, i, &password_length);
+        if(password_crypto_open(list->key, name, strlen(name), secret, password_length, password)) {
+            password_crypto_seal(key, name, strlen(name), password, password_length, secret);
+        }
+    }
+    password_crypto_wipe(password, sizeof(password));
+    password_list_set_key(list, key);
     return true;
 }
 
-void password_send_as_keyboard(const char* password) {
-    FURI_LOG_I(TAG, "Odesílání hesla jako klávesnice");
+bool password_list_find(PasswordList* list, const char* name, uint32_t* index) {
+    // Celý seznam je v paměti: index názvů, u stejných názvů vyhrává poslední
+    if(!password_list_is_paged(list)) {
+        if(list->count == 0) return false;
+        if(list->name_index_capacity == 0) password_name_index_build(list);
+        
+        uint32_t mask = list->name_index_capacity - 1;
+        bool found = false;
+        for(uint32_t slot = password_name_hash(name) & mask; list->name_index[slot];
+            slot = (slot + 1) & mask) {
+            uint32_t candidate = list->name_index[slot] - 1;
+            if((!found || candidate > *index) &&
+               strcmp(list->pool + list->offsets[candidate], name) == 0) {
+                *index = candidate;
+                found = true;
+            }
+        }
+        return found;
+    }
     
-    // Kontrola, zda je USB HID připojen
-    if(!furi_hal_usb_is_connected()) {
-        FURI_LOG_E(TAG, "USB není připojeno");
-        return;
+    // Stránkovaný režim: binární vyhledávání, index by držel celý seznam v paměti
+    uint32_t end = password_list_bound(list, 0, list->count, name, false, true);
+    char buffer[NAME_MAX_LENGTH];
+    if(end == 0 || strcmp(password_list_probe_name(list, end - 1, buffer), name) != 0) {
+        return false;
+    }
+    *index = end - 1;
+    return true;
+}
+
+void password_list_filter(PasswordList* list, const char* prefix, PasswordListRange* range) {
+    range->end = MIN(range->end, list->count);
+    range->start = password_list_bound(list, range->start, range->end, prefix, true, false);
+    range->end = password_list_bound(list, range->start, range->end, prefix, true, true);
+}
+
+uint32_t password_list_search(
+    PasswordList* list,
+    const char* pattern,
+    PasswordSearchResult* results,
+    uint32_t max_results) {
+    uint64_t pattern_mask = password_search_mask(pattern, strlen(pattern));
+    if(password_list_is_paged(list)) {
+        return password_vault_search(list, pattern, pattern_mask, results, max_results);
     }
     
-    // Odeslání hesla jako klávesnice
-    for(size_t i = 0; i < strlen(password); i++) {
-        char c = password[i];
-        
-        // Převod znaku na klávesový kód
-        uint16_t keycode = 0;
-        uint8_t mod = 0;
-        
-        if(c >= 'a' && c <= 'z') {
-            keycode = HID_KEYBOARD_A + (c - 'a');
-        } else if(c >= 'A' && c <= 'Z') {
-            keycode = HID_KEYBOARD_A + (c - 'A');
-            mod = KEY_MOD_LEFT_SHIFT;
-        } else if(c >= '0' && c <= '9') {
-            keycode = HID_KEYBOARD_0 + (c - '0');
-        } else {
-            // Speciální znaky
-            switch(c) {
-                case ' ':
-                    keycode = HID_KEYBOARD_SPACEBAR;
-                    break;
-                case '!':
-                    keycode = HID_KEYBOARD_1;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '@':
-                    keycode = HID_KEYBOARD_2;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '#':
-                    keycode = HID_KEYBOARD_3;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '$':
-                    keycode = HID_KEYBOARD_4;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '%':
-                    keycode = HID_KEYBOARD_5;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '^':
-                    keycode = HID_KEYBOARD_6;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '&':
-                    keycode = HID_KEYBOARD_7;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '*':
-                    keycode = HID_KEYBOARD_8;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '(':
-                    keycode = HID_KEYBOARD_9;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case ')':
-                    keycode = HID_KEYBOARD_0;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '-':
-                    keycode = HID_KEYBOARD_MINUS;
-                    break;
-                case '_':
-                    keycode = HID_KEYBOARD_MINUS;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '=':
-                    keycode = HID_KEYBOARD_EQUAL;
-                    break;
-                case '+':
-                    keycode = HID_KEYBOARD_EQUAL;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '[':
-                    keycode = HID_KEYBOARD_OPEN_BRACKET;
-                    break;
-                case '{':
-                    keycode = HID_KEYBOARD_OPEN_BRACKET;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case ']':
-                    keycode = HID_KEYBOARD_CLOSE_BRACKET;
-                    break;
-                case '}':
-                    keycode = HID_KEYBOARD_CLOSE_BRACKET;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '\\':
-                    keycode = HID_KEYBOARD_BACKSLASH;
-                    break;
-                case '|':
-                    keycode = HID_KEYBOARD_BACKSLASH;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case ';':
-                    keycode = HID_KEYBOARD_SEMICOLON;
-                    break;
-                case ':':
-                    keycode = HID_KEYBOARD_SEMICOLON;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '\'':
-                    keycode = HID_KEYBOARD_APOSTROPHE;
-                    break;
-                case '"':
-                    keycode = HID_KEYBOARD_APOSTROPHE;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case ',':
-                    keycode = HID_KEYBOARD_COMMA;
-                    break;
-                case '<':
-                    keycode = HID_KEYBOARD_COMMA;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '.':
-                    keycode = HID_KEYBOARD_DOT;
-                    break;
-                case '>':
-                    keycode = HID_KEYBOARD_DOT;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                case '/':
-                    keycode = HID_KEYBOARD_SLASH;
-                    break;
-                case '?':
-                    keycode = HID_KEYBOARD_SLASH;
-                    mod = KEY_MOD_LEFT_SHIFT;
-                    break;
-                default:
-                    // Neznámý znak, přeskočíme
-                    continue;
+    // Celý seznam je v paměti, masky se prosévají po blocích bez větvení
+    uint32_t found = 0;
+    int16_t score;
+    for(uint32_t block = 0; block < list->count; block += PASSWORD_SEARCH_BLOCK) {
+        uint32_t block_count = MIN(list->count - block, (uint32_t)PASSWORD_SEARCH_BLOCK);
+        uint64_t hits = password_search_prefilter(list->masks + block, block_count, pattern_mask);
+        for(; hits; hits &= hits - 1) {
+            uint32_t index = block + __builtin_ctzll(hits);
+            if(password_search_match(list->pool + list->offsets[index], pattern, &score)) {
+                password_search_result_add(results, &found, max_results, index, score);
             }
         }
-        
-        // Odeslání klávesy
-        furi_hal_usb_hid_keyboard_press(mod, keycode);
-        furi_delay_ms(10);
-        furi_hal_usb_hid_keyboard_release(keycode);
-        furi_delay_ms(10);
     }
+    return found;
+}
+
+bool password_list_add(PasswordList* list, const char* name, const char* password) {
+    return password_list_mutate(list, PasswordJournalOpAdd, 0, name, password);
+}
+
+PasswordListPutResult password_list_put(
+    PasswordList* list,
+    const char* name,
+    const char* password,
+    bool replace) {
+    // Názvy se v seznamu zkracují, porovnává se zkrácený
+    char key[NAME_MAX_LENGTH];
+    strlcpy(key, name, sizeof(key));
+    
+    uint32_t index;
+    if(!password_list_find(list, key, &index)) {
+        return password_list_add(list, key, password) ? PasswordListPutAdded : PasswordListPutFailed;
+    }
+    if(!replace) return PasswordListPutExists;
+    return password_list_update(list, index, key, password) ? PasswordListPutReplaced :
+                                                              PasswordListPutFailed;
+}
+
+bool password_list_update(
+    PasswordList* list,
+    uint32_t index,
+    const char* name,
+    const char* password) {
+    if(index >= list->count) {
+        FURI_LOG_E(TAG, "Neplatný index %lu", index);
+        return false;
+    }
+    return password_list_mutate(list, PasswordJournalOpUpdate, index, name, password);
+}
+
+bool password_list_remove(PasswordList* list, uint32_t index) {
+    if(index >= list->count) {
+        FURI_LOG_E(TAG, "Neplatný index %lu", index);
+        return false;
+    }
+    return password_list_mutate(list, PasswordJournalOpRemove, index, "", "");
 }
@@ -6,20 +6,103 @@
 #include <toolbox/stream/stream.h>
 #include <toolbox/stream/file_stream.h>
 
+#include "password_crypto.h"
+#include "password_search.h"
+#include "password_vault_format.h"
+
 #define PASSWORD_MAX_LENGTH 64
 #define NAME_MAX_LENGTH 32
-#define MAX_PASSWORDS 50
 
-typedef struct {
-    char name[NAME_MAX_LENGTH];
-    char password[PASSWORD_MAX_LENGTH];
-} PasswordItem;
+typedef struct PasswordVault PasswordVault;
+
+typedef enum {
+    PasswordListModeAuto, // Podle velikosti souboru
+    PasswordListModeFull, // Celý seznam v paměti
+    PasswordListModePaged, // Jen okno názvů v paměti
+} PasswordListMode;
 
+/**
+ * @brief Seznam hesel
+ * 
+ * Názvy a hesla jsou uložena za sebou v jediném poolu
+ * ("název\0" [délka hesla][zapečetěné heslo]), seznam samotný je jen
+ * tabulka offsetů do poolu. Paměť tak roste se skutečnou délkou obsahu
+ * a počet hesel není omezen.
+ * 
+ * Hesla jsou v paměti i v souborech zapečetěná klíčem seznamu
+ * (password_crypto.h), názvy zůstávají otevřené kvůli řazení
+ * a hledání. Dešifruje se jen heslo, které se čte
+ * (password_list_read_password).
+ * 
+ * Seznam je vždy seřazený podle názvu bez ohledu na velikost písmen:
+ * přidání i úprava vloží záznam rovnou na jeho místo. Hledání názvu
+ * nebo prefixu je tak binární vyhledávání. Ke každému offsetu patří
+ * maska znaků názvu, podle které fuzzy hledání vyřadí většinu názvů
+ * bez jejich čtení.
+ * 
+ * Přesný název najde index názvů (hashovací tabulka indexů záznamů)
+ * v konstantním čase. Sestaví se při prvním hledání a dál se udržuje
+ * při každé změně, po načtení nebo vyprázdnění seznamu se zahodí.
+ * 
+ * Ve stránkovaném režimu drží pool jen okno názvů kolem právě
+ * zobrazovaných řádků, hesla se čtou ze souboru až na vyžádání.
+ * Binární trezor (password_vault_format.h) k tomu nepotřebuje index,
+ * libovolný záznam najde dvěma čteními.
+ * 
+ * Seznam otevřený ze souboru zapisuje každou změnu jako jeden záznam
+ * do žurnálu vedle souboru, celý soubor se přepíše až při sloučení.
+ * Záznamy se nejdřív hromadí v paměti a na kartu se zapíšou najednou
+ * po chvíli nečinnosti (password_list_flush_if_idle).
+ */
 typedef struct {
-    PasswordItem items[MAX_PASSWORDS];
+    char* pool;
+    size_t pool_size;
+    size_t pool_capacity;
+    size_t pool_garbage;
+    uint32_t* offsets;
+    uint64_t* masks; // Masky znaků názvů, souběžně s offsets
+    uint32_t capacity;
+    uint32_t window_start;
+    uint32_t window_count;
     uint32_t count;
+    uint32_t generation; // Zvýší se při každé změně záznamů (platnost cache zobrazení)
+    uint32_t* name_index; // Index názvů pro password_list_find, NULL dokud není potřeba
+    uint32_t name_index_capacity;
+    PasswordVault* vault;
+    uint8_t key[PASSWORD_CRYPTO_KEY_SIZE];
+    const volatile bool* cancel; // Příznak zrušení otevírání (loader), NULL: nejde zrušit
 } PasswordList;
 
+// Rozsah indexů seznamu [start, end)
+typedef struct {
+    uint32_t start;
+    uint32_t end;
+} PasswordListRange;
+
+// Výsledek password_list_put
+typedef enum {
+    PasswordListPutAdded, // Název v seznamu nebyl, heslo se přidalo
+    PasswordListPutReplaced, // Heslo se stejným názvem se nahradilo
+    PasswordListPutExists, // Název v seznamu už je, nic se nezměnilo
+    PasswordListPutFailed, // Zápis se nepodařil
+} PasswordListPutResult;
+
+// Počet názvů v náhledu trezoru
+#define PASSWORD_VAULT_PREVIEW_NAMES 3
+
+// Náhled trezoru podle základního souboru, bez změn v žurnálu
+typedef struct {
+    uint32_t count;
+    uint8_t names_count;
+    char names[PASSWORD_VAULT_PREVIEW_NAMES][NAME_MAX_LENGTH]; // První názvy podle abecedy
+} PasswordVaultPreview;
+
+// Výsledek fuzzy hledání
+typedef struct {
+    uint32_t index;
+    int16_t score;
+} PasswordSearchResult;
+
 /**
  * @brief Inicializuje seznam hesel
  * 
@@ -27,9 +110,100 @@ typedef struct {
  */
 void password_list_init(PasswordList* list);
 
+/**
+ * @brief Uvolní paměť seznamu hesel
+ * 
+ * @param list Seznam hesel
+ */
+void password_list_free(PasswordList* list);
+
+/**
+ * @brief Přesune seznam i s otevřeným trezorem do jiné proměnné
+ * 
+ * Např. seznam načtený v jiném vlákně (password_loader.h).
+ * 
+ * @param list Cíl, prázdný seznam; přepíše se
+ * @param from Přesouvaný seznam, zůstane prázdný
+ */
+void password_list_move(PasswordList* list, PasswordList* from);
+
+/**
+ * @brief Nastaví klíč, kterým se hesla zapečetí a dešifrují
+ * 
+ * Volá se před načtením, hesla ze starších nešifrovaných trezorů se
+ * při načtení zapečetí tímto klíčem.
+ * 
+ * @param list Seznam hesel
+ * @param key Klíč (PASSWORD_CRYPTO_KEY_SIZE B)
+ */
+void password_list_set_key(PasswordList* list, const uint8_t* key);
+
+/**
+ * @brief Přešifruje všechna hesla novým klíčem
+ * 
+ * Seznam otevřený ze souboru přepíše soubor celý (i se žurnálem), starý
+ * soubor se nahradí až úplně zapsaným novým.
+ * 
+ * @param list Seznam hesel
+ * @param key Nový klíč (PASSWORD_CRYPTO_KEY_SIZE B)
+ * @return true Pokud se přešifrování podařilo
+ * @return false Pokud se přešifrování nepodařilo, seznam zůstal se starým klíčem
+ */
+bool password_list_rekey(PasswordList* list, const uint8_t* key);
+
+/**
+ * @brief Odstraní všechna hesla, alokovaná paměť zůstává k dispozici
+ * 
+ * @param list Seznam hesel
+ */
+void password_list_clear(PasswordList* list);
+
+/**
+ * @brief Zjistí, zda je seznam ve stránkovaném režimu
+ * 
+ * @param list Seznam hesel
+ * @return true Pokud je v paměti jen okno záznamů
+ * @return false Pokud je v paměti celý seznam
+ */
+bool password_list_is_paged(const PasswordList* list);
+
+/**
+ * @brief Vrátí název hesla
+ * 
+ * Ve stránkovaném režimu může posunout okno a načíst názvy ze souboru,
+ * v plném režimu vrací ukazatel do poolu řetězců, který se při přidání
+ * přesune. Volá se proto jen ve vlákně, které seznam mění (v aplikaci
+ * hlavní smyčka), nikdy z kreslení; to kreslí kopie názvů
+ * (password_list_view_update).
+ * 
+ * @param list Seznam hesel
+ * @param index Index hesla
+ * @return const char* Název, platný do dalšího volání nebo změny seznamu
+ */
+const char* password_list_get_name(PasswordList* list, uint32_t index);
+
+/**
+ * @brief Dešifruje heslo do bufferu
+ * 
+ * Ve stránkovaném režimu se heslo čte ze souboru až v tomto volání.
+ * Volající buffer po použití přepíše (password_crypto_wipe).
+ * 
+ * @param list Seznam hesel
+ * @param index Index hesla
+ * @param buffer Cílový buffer
+ * @param size Velikost bufferu
+ * @return true Pokud se čtení podařilo
+ * @return false Pokud se čtení nepodařilo nebo heslo nejde ověřit
+ */
+bool password_list_read_password(PasswordList* list, uint32_t index, char* buffer, size_t size);
+
 /**
  * @brief Načte hesla ze souboru
  * 
+ * Velký soubor se místo načtení celého otevře ve stránkovaném režimu.
+ * Pokud trezor neexistuje a vedle něj leží textový soubor se stejným
+ * názvem a příponou .txt, převede ho a textový soubor ponechá jako .txt.bak.
+ * 
  * @param list Seznam hesel
  * @param storage_path Cesta k souboru
  * @return true Pokud se načtení podařilo
@@ -37,9 +211,59 @@ void password_list_init(PasswordList* list);
  */
 bool password_list_load(PasswordList* list, const char* storage_path);
 
+/**
+ * @brief Přečte počet hesel a první názvy trezoru bez jeho načtení
+ * 
+ * Čte jen hlavičku, začátek tabulky a první záznamy, trvá tak stejně
+ * u každé velikosti trezoru. Nic nedešifruje, názvy nejsou šifrované.
+ * 
+ * @param storage_path Cesta k souboru
+ * @param preview Výstup, náhled; při chybě prázdný
+ * @return true Pokud je soubor platný trezor
+ * @return false Pokud soubor chybí nebo nejde přečíst
+ */
+bool password_vault_preview(const char* storage_path, PasswordVaultPreview* preview);
+
+/**
+ * @brief Otevře hesla ze souboru ve zvoleném režimu
+ * 
+ * Soubor musí být v binárním formátu. Ve stránkovaném režimu v paměti
+ * drží jen okno názvů, chybějící soubor rovnou založí. V obou režimech
+ * pak přehraje žurnál změn (soubor s příponou .jnl) a další změny do něj
+ * připisuje. Nešifrovaný trezor starší verze rovnou převede.
+ * 
+ * Příznak list->cancel se kontroluje mezi záznamy čtení a přehrávání
+ * žurnálu; zrušené otevření nic nezapíše a seznam nechá prázdný.
+ * 
+ * @param list Seznam hesel
+ * @param storage_path Cesta k souboru
+ * @param mode Režim načtení
+ * @return true Pokud se otevření podařilo
+ * @return false Pokud se otevření nepodařilo nebo bylo zrušeno
+ */
+bool password_list_open(PasswordList* list, const char* storage_path, PasswordListMode mode);
+
+/**
+ * @brief Převede textový trezor ("název:heslo" na řádek) na binární
+ * 
+ * Převede i změny z žurnálu textového trezoru. Textový soubor zůstane
+ * beze změny, binární se zapíše celý a nahradí případný existující.
+ * 
+ * @param text_path Cesta k textovému trezoru
+ * @param vault_path Cesta k binárnímu trezoru
+ * @param key Klíč, kterým se hesla zapečetí
+ * @return true Pokud se převod podařil
+ * @return false Pokud se převod nepodařil
+ */
+bool password_vault_convert(const char* text_path, const char* vault_path, const uint8_t* key);
+
 /**
  * @brief Uloží hesla do souboru
  * 
+ * Pro soubor, ze kterého byl seznam otevřen, jen zapíše čekající změny
+ * do žurnálu. Jiný soubor se zapíše celý, seřazený podle názvu, do
+ * dočasného souboru, který původní nahradí až po úplném zápisu.
+ * 
  * @param list Seznam hesel
  * @param storage_path Cesta k souboru
  * @return true Pokud se uložení podařilo
@@ -47,9 +271,88 @@ bool password_list_load(PasswordList* list, const char* storage_path);
  */
 bool password_list_save(PasswordList* list, const char* storage_path);
 
+/**
+ * @brief Zjistí, zda seznam obsahuje změny čekající na zápis
+ * 
+ * @param list Seznam hesel
+ * @return true Pokud jsou v paměti nezapsané změny
+ * @return false Pokud je soubor aktuální
+ */
+bool password_list_is_dirty(const PasswordList* list);
+
+/**
+ * @brief Zapíše čekající změny do žurnálu, čistý seznam nic nezapisuje
+ * 
+ * @param list Seznam hesel
+ * @return true Pokud je soubor aktuální
+ * @return false Pokud se zápis nepodařil
+ */
+bool password_list_flush(PasswordList* list);
+
+/**
+ * @brief Zapíše čekající změny, pokud od poslední změny uplynula prodleva
+ * 
+ * Volá se pravidelně z hlavní smyčky, série rychlých úprav se tak
+ * zapíše jediným zápisem.
+ * 
+ * @param list Seznam hesel
+ * @return true Pokud nenastala chyba zápisu
+ * @return false Pokud se zápis nepodařil
+ */
+bool password_list_flush_if_idle(PasswordList* list);
+
+/**
+ * @brief Najde heslo podle přesného názvu
+ * 
+ * S celým seznamem v paměti O(1) přes index názvů, ve stránkovaném
+ * režimu binární vyhledávání v souboru.
+ * 
+ * @param list Seznam hesel
+ * @param name Název hesla
+ * @param index Index nalezeného hesla (u stejných názvů posledního)
+ * @return true Pokud heslo existuje
+ * @return false Pokud heslo neexistuje
+ */
+bool password_list_find(PasswordList* list, const char* name, uint32_t* index);
+
+/**
+ * @brief Zúží rozsah na názvy začínající prefixem (bez ohledu na velikost písmen)
+ * 
+ * Dvě binární vyhledávání uvnitř rozsahu. Při psaní se předává rozsah
+ * spočítaný pro kratší prefix, každý další znak tak stojí O(log n).
+ * Pro první znak se začíná s rozsahem {0, list->count}.
+ * 
+ * @param list Seznam hesel
+ * @param prefix Prefix názvu
+ * @param range Rozsah, ve kterém se hledá; přepíše se výsledkem
+ */
+void password_list_filter(PasswordList* list, const char* prefix, PasswordListRange* range);
+
+/**
+ * @brief Najde názvy odpovídající vzoru fuzzy (password_search.h)
+ * 
+ * Názvy se nejdřív prosejí podle masek znaků, skóre se počítá jen
+ * u těch, které maskou projdou. Ve stránkovaném režimu se masky čtou
+ * z tabulky v souboru po blocích a názvy jen u kandidátů.
+ * 
+ * @param list Seznam hesel
+ * @param pattern Vzor
+ * @param results Nejlepší výsledky, seřazené od nejvyššího skóre
+ * (při shodě podle indexu)
+ * @param max_results Velikost pole results
+ * @return uint32_t Počet vrácených výsledků
+ */
+uint32_t password_list_search(
+    PasswordList* list,
+    const char* pattern,
+    PasswordSearchResult* results,
+    uint32_t max_results);
+
 /**
  * @brief Přidá heslo do seznamu
  * 
+ * Heslo se zařadí podle názvu, za hesla se stejným názvem.
+ * 
  * @param list Seznam hesel
  * @param name Název hesla
  * @param password Heslo
@@ -59,18 +362,44 @@ bool password_list_save(PasswordList* list, const char* storage_path);
 bool password_list_add(PasswordList* list, const char* name, const char* password);
 
 /**
- * @brief Odstraní heslo ze seznamu
+ * @brief Přidá heslo, nebo nahradí heslo se stejným názvem
+ * 
+ * Duplicity se tak nevytvářejí: import s replace false existující
+ * názvy přeskočí, uložení z editoru s replace true heslo nahradí.
+ * Název delší než NAME_MAX_LENGTH - 1 se porovnává zkrácený.
+ * 
+ * @param list Seznam hesel
+ * @param name Název hesla
+ * @param password Heslo
+ * @param replace Zda nahradit heslo existujícího názvu
+ * @return PasswordListPutResult Výsledek
+ */
+PasswordListPutResult password_list_put(
+    PasswordList* list,
+    const char* name,
+    const char* password,
+    bool replace);
+
+/**
+ * @brief Nahradí název a heslo na daném indexu
+ * 
+ * Se změnou názvu se heslo přesune na nové místo v seřazeném seznamu.
  * 
  * @param list Seznam hesel
  * @param index Index hesla
- * @return true Pokud se odstranění podařilo
- * @return false Pokud se odstranění nepodařilo
+ * @param name Nový název
+ * @param password Nové heslo
+ * @return true Pokud se úprava podařila
+ * @return false Pokud se úprava nepodařila
  */
-bool password_list_remove(PasswordList* list, uint32_t index);
+bool password_list_update(PasswordList* list, uint32_t index, const char* name, const char* password);
 
 /**
- * @brief Odešle heslo jako klávesnici
+ * @brief Odstraní heslo ze seznamu
  * 
- * @param password Heslo k odeslání
+ * @param list Seznam hesel
+ * @param index Index hesla
+ * @return true Pokud se odstranění podařilo
+ * @return false Pokud se odstranění nepodařilo
  */
-void password_send_as_keyboard(const char* password);
+bool password_list_remove(PasswordList* list, uint32_t index);
@@ -0,0 +1,337 @@
+#include "password_totp.h"
+#include "password_crypto.h"
+#include "password_kdf.h"
+#include <furi.h>
+#include <string.h>
+
+#define TAG "PasswordTotp"
+
+#define PASSWORD_TOTP_URI_PREFIX "otpauth://totp/"
+// Tajemství v Base32 pro nejdelší klíč a ukončovací nula
+#define PASSWORD_TOTP_BASE32_SIZE ((PASSWORD_TOTP_KEY_MAX_SIZE * 8 + 4) / 5 + 1)
+
+static const char password_totp_base32[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+static const uint32_t password_sha1_initial[5] = {
+    0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0,
+};
+
+#define PASSWORD_SHA1_ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+static uint32_t password_totp_load(const uint8_t* data) {
+    return (uint32_t)data[0] << 24 | (uint32_t)data[1] << 16 | (uint32_t)data[2] << 8 | data[3];
+}
+
+static void password_totp_store(uint8_t* data, uint32_t value) {
+    data[0] = value >> 24;
+    data[1] = value >> 16;
+    data[2] = value >> 8;
+    data[3] = value;
+}
+
+// Zpracuje jeden 64bajtový blok SHA-1
+static void password_sha1_compress(uint32_t* state, const uint8_t* block) {
+    uint32_t w[80];
+    for(size_t i = 0; i < 16; i++) w[i] = password_totp_load(block + i * 4);
+    for(size_t i = 16; i < 80; i++) {
+        w[i] = PASSWORD_SHA1_ROL(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+    
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    for(size_t i = 0; i < 80; i++) {
+        uint32_t f, k;
+        if(i < 20) {
+            f = (b & c) | (~b & d);
+            k = 0x5a827999;
+        } else if(i < 40) {
+            f = b ^ c ^ d;
+            k = 0x6ed9eba1;
+        } else if(i < 60) {
+            f = (b & c) | (b & d) | (c & d);
+            k = 0x8f1bbcdc;
+        } else {
+            f = b ^ c ^ d;
+            k = 0xca62c1d6;
+        }
+        uint32_t t = PASSWORD_SHA1_ROL(a, 5) + f + e + k + w[i];
+        e = d;
+        d = c;
+        c = PASSWORD_SHA1_ROL(b, 30);
+        b = a;
+        a = t;
+    }
+    
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+static void password_totp_compress(PasswordTotpAlgorithm algorithm, uint32_t* state, const uint8_t* block) {
+    if(algorithm == PasswordTotpAlgorithmSha256) {
+        password_sha256_compress(state, block);
+    } else {
+        password_sha1_compress(state, block);
+    }
+}
+
+// Velikost výsledku hashe ve slovech
+static size_t password_totp_hash_words(PasswordTotpAlgorithm algorithm) {
+    return algorithm == PasswordTotpAlgorithmSha256 ? 8 : 5;
+}
+
+// Stav hashe po jednom bloku klíče s ipad nebo opad
+static void password_totp_pad(PasswordTotpAlgorithm algorithm, const uint8_t* block, uint32_t* state) {
+    if(algorithm == PasswordTotpAlgorithmSha256) {
+        PasswordSha256 sha;
+        password_sha256_init(&sha);
+        memcpy(state, sha.state, sizeof(sha.state));
+    } else {
+        memcpy(state, password_sha1_initial, sizeof(password_sha1_initial));
+    }
+    password_totp_compress(algorithm, state, block);
+}
+
+// Zarovnání posledního bloku: 0x80 za daty a délka celé zprávy v bitech
+static void password_totp_finish_block(uint8_t* block, size_t data_size, size_t message_size) {
+    memset(block + data_size, 0, PASSWORD_KDF_BLOCK_SIZE - data_size);
+    block[data_size] = 0x80;
+    block[PASSWORD_KDF_BLOCK_SIZE - 2] = (message_size * 8) >> 8;
+    block[PASSWORD_KDF_BLOCK_SIZE - 1] = (message_size * 8) & 0xff;
+}
+
+size_t password_totp_base32_decode(const char* text, uint8_t* key, size_t size) {
+    uint32_t buffer = 0;
+    uint8_t bits = 0;
+    size_t length = 0;
+    bool padding = false;
+    for(; *text; text++) {
+        char c = *text;
+        if(c == ' ' || c == '-') continue;
+        if(c == '=') {
+            padding = true;
+            continue;
+        }
+        
+        if(c >= 'a' && c <= 'z') c -= 'a' - 'A';
+        
+        // Za zarovnáním už nic být nesmí
+        const char* value = padding ? NULL : strchr(password_totp_base32, c);
+        if(!value) return 0;
+        buffer = buffer << 5 | (value - password_totp_base32);
+        bits += 5;
+        if(bits >= 8) {
+            if(length == size) return 0;
+            bits -= 8;
+            key[length++] = buffer >> bits;
+        }
+    }
+    return length;
+}
+
+// Zakóduje klíč do Base32 bez zarovnání
+static void password_totp_base32_encode(const uint8_t* key, size_t size, char* text) {
+    uint32_t buffer = 0;
+    uint8_t bits = 0;
+    for(size_t i = 0; i < size; i++) {
+        buffer = buffer << 8 | key[i];
+        bits += 8;
+        while(bits >= 5) {
+            bits -= 5;
+            *text++ = password_totp_base32[(buffer >> bits) & 0x1f];
+        }
+    }
+    if(bits > 0) *text++ = password_totp_base32[(buffer << (5 - bits)) & 0x1f];
+    *text = '\0';
+}
+
+bool password_totp_init(
+    PasswordTotp* totp,
+    PasswordTotpAlgorithm algorithm,
+    uint8_t digits,
+    const uint8_t* key,
+    size_t key_size) {
+    memset(totp, 0, sizeof(PasswordTotp));
+    if((algorithm != PasswordTotpAlgorithmSha1 && algorithm != PasswordTotpAlgorithmSha256) ||
+       (digits != 6 && digits != 8) || key_size == 0 || key_size > PASSWORD_TOTP_KEY_MAX_SIZE) {
+        return false;
+    }
+    totp->algorithm = algorithm;
+    totp->digits = digits;
+    
+    uint8_t block[PASSWORD_KDF_BLOCK_SIZE] = {0};
+    memcpy(block, key, key_size);
+    for(size_t i = 0; i < sizeof(block); i++) block[i] ^= 0x36;
+    password_totp_pad(algorithm, block, totp->inner);
+    for(size_t i = 0; i < sizeof(block); i++) block[i] ^= 0x36 ^ 0x5c;
+    password_totp_pad(algorithm, block, totp->outer);
+    password_crypto_wipe(block, sizeof(block));
+    return true;
+}
+
+void password_totp_hotp(const PasswordTotp* totp, uint64_t counter, char* code) {
+    size_t words = password_totp_hash_words(totp->algorithm);
+    size_t hash_size = words * 4;
+    uint8_t block[PASSWORD_KDF_BLOCK_SIZE];
+    uint32_t state[8];
+    
+    // Vnitřní hash: čítač za blokem klíče, celá zpráva má 64 + 8 B
+    for(size_t i = 0; i < sizeof(counter); i++) block[i] = counter >> (56 - i * 8);
+    password_totp_finish_block(block, sizeof(counter), PASSWORD_KDF_BLOCK_SIZE + sizeof(counter));
+    memcpy(state, totp->inner, sizeof(state));
+    password_totp_compress(totp->algorithm, state, block);
+    
+    // Vnější hash nad vnitřním, zpráva má 64 B klíče a hash
+    for(size_t i = 0; i < words; i++) password_totp_store(block + i * 4, state[i]);
+    password_totp_finish_block(block, hash_size, PASSWORD_KDF_BLOCK_SIZE + hash_size);
+    memcpy(state, totp->outer, sizeof(state));
+    password_totp_compress(totp->algorithm, state, block);
+    for(size_t i = 0; i < words; i++) password_totp_store(block + i * 4, state[i]);
+    
+    // Dynamické zkrácení (RFC 4226, 5.3) na počet číslic
+    size_t offset = block[hash_size - 1] & 0x0f;
+    uint32_t value = (uint32_t)(block[offset] & 0x7f) << 24 | (uint32_t)block[offset + 1] << 16 |
+                     (uint32_t)block[offset + 2] << 8 | block[offset + 3];
+    for(size_t i = totp->digits; i > 0; i--) {
+        code[i - 1] = '0' + value % 10;
+        value /= 10;
+    }
+    code[totp->digits] = '\0';
+    
+    password_crypto_wipe(block, sizeof(block));
+    password_crypto_wipe(state, sizeof(state));
+}
+
+const char* password_totp_code(PasswordTotp* totp, uint64_t time) {
+    uint64_t step = time / PASSWORD_TOTP_PERIOD;
+    if(totp->code[0] == '\0' || totp->step != step) {
+        password_totp_hotp(totp, step, totp->code);
+        totp->step = step;
+    }
+    return totp->code;
+}
+
+uint32_t password_totp_remaining(uint64_t time) {
+    return PASSWORD_TOTP_PERIOD - time % PASSWORD_TOTP_PERIOD;
+}
+
+// Uložený tvar "<číslice><algoritmus><Base32>"
+static bool password_totp_parse(const char* spec, PasswordTotp* totp) {
+    if((spec[0] != '6' && spec[0] != '8') || (spec[1] != '1' && spec[1] != '2')) return false;
+    
+    uint8_t key[PASSWORD_TOTP_KEY_MAX_SIZE];
+    size_t key_size = password_totp_base32_decode(spec + 2, key, sizeof(key));
+    PasswordTotpAlgorithm algorithm =
+        spec[1] == '2' ? PasswordTotpAlgorithmSha256 : PasswordTotpAlgorithmSha1;
+    bool success = password_totp_init(totp, algorithm, spec[0] - '0', key, key_size);
+    password_crypto_wipe(key, sizeof(key));
+    return success;
+}
+
+bool password_totp_split(char* password, PasswordTotp* totp) {
+    memset(totp, 0, sizeof(PasswordTotp));
+    char* separator = strchr(password, PASSWORD_TOTP_SEPARATOR);
+    if(!separator || !password_totp_parse(separator + 1, totp)) return false;
+    password_crypto_wipe(separator, strlen(separator));
+    return true;
+}
+
+static bool password_totp_param_is(const char* param, size_t length, const char* name) {
+    return strlen(name) == length && strncasecmp(param, name, length) == 0;
+}
+
+// Parametry URI otpauth, neznámé (issuer, image...) se přeskočí
+static bool password_totp_parse_uri(
+    const char* uri,
+    char* secret,
+    size_t size,
+    PasswordTotpAlgorithm* algorithm,
+    uint8_t* digits) {
+    const char* query = strchr(uri, '?');
+    if(strncasecmp(uri, PASSWORD_TOTP_URI_PREFIX, strlen(PASSWORD_TOTP_URI_PREFIX)) != 0 ||
+       !query) {
+        return false;
+    }
+    
+    secret[0] = '\0';
+    for(const char* param = query + 1; *param;) {
+        size_t length = strcspn(param, "&");
+        const char* value = memchr(param, '=', length);
+        if(value) {
+            size_t name_length = value - param;
+            size_t value_length = length - name_length - 1;
+            value++;
+            if(password_totp_param_is(param, name_length, "secret")) {
+                if(value_length >= size) return false;
+                memcpy(secret, value, value_length);
+                secret[value_length] = '\0';
+            } else if(password_totp_param_is(param, name_length, "algorithm")) {
+                if(password_totp_param_is(value, value_length, "SHA1")) {
+                    *algorithm = PasswordTotpAlgorithmSha1;
+                } else if(password_totp_param_is(value, value_length, "SHA256")) {
+                    *algorithm = PasswordTotpAlgorithmSha256;
+                } else {
+                    return false;
+                }
+            } else if(password_totp_param_is(param, name_length, "digits")) {
+                if(password_totp_param_is(value, value_length, "6")) {
+                    *digits = 6;
+                } else if(password_totp_param_is(value, value_length, "8")) {
+                    *digits = 8;
+                } else {
+                    return false;
+                }
+            } else if(password_totp_param_is(param, name_length, "period")) {
+                if(!password_totp_param_is(value, value_length, "30")) return false;
+            }
+        }
+        param += length;
+        if(*param == '&') param++;
+    }
+    return secret[0] != '\0';
+}
+
+bool password_totp_append(char* password, size_t size, const char* secret) {
+    PasswordTotpAlgorithm algorithm = PasswordTotpAlgorithmSha1;
+    uint8_t digits = 6;
+    char text[PASSWORD_TOTP_BASE32_SIZE];
+    uint8_t key[PASSWORD_TOTP_KEY_MAX_SIZE];
+    size_t key_size = 0;
+    if(strncasecmp(secret, "otpauth:", 8) != 0) {
+        key_size = password_totp_base32_decode(secret, key, sizeof(key));
+    } else if(password_totp_parse_uri(secret, text, sizeof(text), &algorithm, &digits)) {
+        key_size = password_totp_base32_decode(text, key, sizeof(key));
+    }
+    
+    // Uloží se kanonické Base32 bez mezer a zarovnání
+    size_t length = strlen(password);
+    size_t encoded_length = (key_size * 8 + 4) / 5;
+    bool success = key_size > 0 && length + 3 + encoded_length < size;
+    if(success) {
+        char* spec = password + length;
+        spec[0] = PASSWORD_TOTP_SEPARATOR;
+        spec[1] = '0' + digits;
+        spec[2] = algorithm == PasswordTotpAlgorithmSha256 ? '2' : '1';
+        password_totp_base32_encode(key, key_size, spec + 3);
+    } else {
+        FURI_LOG_W(TAG, "Tajemství TOTP je neplatné nebo se k heslu nevejde");
+    }
+    
+    password_crypto_wipe(text, sizeof(text));
+    password_crypto_wipe(key, sizeof(key));
+    return success;
+}
+
+bool password_totp_carry(char* password, size_t size, const char* previous) {
+    const char* separator = strchr(previous, PASSWORD_TOTP_SEPARATOR);
+    if(!separator) return true;
+    
+    size_t length = strlen(password);
+    if(length + strlen(separator) >= size) {
+        FURI_LOG_W(TAG, "Tajemství TOTP se k novému heslu nevejde");
+        return false;
+    }
+    memcpy(password + length, separator, strlen(separator) + 1);
+    return true;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Kódy TOTP (RFC 6238) k záznamům
+ * 
+ * Záznam může vedle hesla nést tajemství TOTP. Uloží se v zapečetěném
+ * hesle za oddělovačem PASSWORD_TOTP_SEPARATOR jako "<číslice><algoritmus><Base32>",
+ * např. "heslo" "\x1f" "61GEZDGNBV..." (6 číslic, SHA-1). Formát trezoru
+ * se tak nemění a tajemství je zašifrované a svázané s názvem stejně
+ * jako heslo; heslo s tajemstvím se ale musí vejít do PASSWORD_MAX_LENGTH - 1.
+ * 
+ * Při otevření záznamu se klíč jednou zpracuje na stav hashe po bloku
+ * klíče s ipad a opad (jako PBKDF2 v password_kdf.c). Kód pro osmibajtový
+ * čítač pak stojí jen dvě komprese SHA-1 nebo SHA-256. Hotový kód se
+ * drží do konce svého kroku (PASSWORD_TOTP_PERIOD s), překreslení ho
+ * znovu nepočítá.
+ */
+
+#define PASSWORD_TOTP_SEPARATOR '\x1f'
+#define PASSWORD_TOTP_PERIOD 30
+#define PASSWORD_TOTP_DIGITS_MAX 8
+// Klíč se vejde do jednoho bloku hashe, delší by se musel nejdřív hashovat
+#define PASSWORD_TOTP_KEY_MAX_SIZE 64
+
+typedef enum {
+    PasswordTotpAlgorithmSha1,
+    PasswordTotpAlgorithmSha256,
+} PasswordTotpAlgorithm;
+
+typedef struct {
+    PasswordTotpAlgorithm algorithm;
+    uint8_t digits; // 6 nebo 8
+    uint32_t inner[8]; // Stav hashe po bloku klíče s ipad
+    uint32_t outer[8]; // Stav hashe po bloku klíče s opad
+    uint64_t step; // Krok, ke kterému patří code
+    char code[PASSWORD_TOTP_DIGITS_MAX + 1]; // Prázdný, dokud se kód nespočítá
+} PasswordTotp;
+
+/**
+ * @brief Dekóduje tajemství v Base32 (RFC 4648)
+ * 
+ * Velikost písmen, mezery, pomlčky a zarovnání '=' nevadí.
+ * 
+ * @param text Tajemství v Base32
+ * @param key Výstup, klíč
+ * @param size Velikost výstupu
+ * @return size_t Délka klíče, 0 pro neplatný, prázdný nebo příliš dlouhý text
+ */
+size_t password_totp_base32_decode(const char* text, uint8_t* key, size_t size);
+
+/**
+ * @brief Připraví stav HMAC pro klíč
+ * 
+ * @param totp Výstup
+ * @param algorithm Hash
+ * @param digits Počet číslic kódu (6 nebo 8)
+ * @param key Klíč
+ * @param key_size Velikost klíče, nejvýš PASSWORD_TOTP_KEY_MAX_SIZE
+ * @return true Pokud jsou parametry platné
+ * @return false Pokud nejsou, totp zůstane vynulované
+ */
+bool password_totp_init(
+    PasswordTotp* totp,
+    PasswordTotpAlgorithm algorithm,
+    uint8_t digits,
+    const uint8_t* key,
+    size_t key_size);
+
+/**
+ * @brief Spočítá kód HOTP (RFC 4226) pro čítač, bez mezipaměti
+ * 
+ * @param totp Stav z password_totp_init
+ * @param counter Čítač (pro TOTP krok času)
+ * @param code Výstup (PASSWORD_TOTP_DIGITS_MAX + 1 B)
+ */
+void password_totp_hotp(const PasswordTotp* totp, uint64_t counter, char* code);
+
+/**
+ * @brief Vrátí kód pro čas, počítá se jen v novém kroku
+ * 
+ * @param totp Stav z password_totp_init
+ * @param time Unixový čas v UTC
+ * @return const char* Kód, platný do dalšího volání
+ */
+const char* password_totp_code(PasswordTotp* totp, uint64_t time);
+
+/**
+ * @brief Zbývající platnost kódu
+ * 
+ * @param time Unixový čas v UTC
+ * @return uint32_t Sekundy do dalšího kroku (1 až PASSWORD_TOTP_PERIOD)
+ */
+uint32_t password_totp_remaining(uint64_t time);
+
+/**
+ * @brief Oddělí tajemství TOTP od hesla
+ * 
+ * Heslo s platným tajemstvím se zkrátí na samotné heslo, text tajemství
+ * se přepíše.
+ * 
+ * @param password Heslo přečtené z trezoru
+ * @param totp Výstup, stav pro tajemství
+ * @return true Pokud heslo neslo platné tajemství
+ * @return false Pokud ne, heslo zůstane beze změny a totp vynulované
+ */
+bool password_totp_split(char* password, PasswordTotp* totp);
+
+/**
+ * @brief Připojí tajemství TOTP k heslu v uloženém tvaru
+ * 
+ * Tajemství je text v Base32 nebo URI "otpauth://totp/...?secret=..."
+ * s nepovinnými parametry algorithm (SHA1, SHA256), digits (6, 8)
+ * a period (jen 30).
+ * 
+ * @param password Heslo, připojí se za něj
+ * @param size Velikost bufferu hesla
+ * @param secret Tajemství
+ * @return true Pokud se tajemství připojilo
+ * @return false Pokud je neplatné nebo se nevejde, heslo zůstane beze změny
+ */
+bool password_totp_append(char* password, size_t size, const char* secret);
+
+/**
+ * @brief Přenese tajemství TOTP z dosavadního uloženého hesla k novému
+ * 
+ * Při nahrazení hesla by se jinak tajemství za oddělovačem ztratilo.
+ * 
+ * @param password Nové heslo, tajemství se připojí za něj
+ * @param size Velikost bufferu nového hesla
+ * @param previous Dosavadní heslo v uloženém tvaru
+ * @return true Pokud se tajemství přeneslo nebo dosavadní heslo žádné nemělo
+ * @return false Pokud se k novému heslu nevejde, heslo zůstane beze změny
+ */
+bool password_totp_carry(char* password, size_t size, const char* previous);
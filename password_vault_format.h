@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "password_crypto.h"
+
+/*
+ * Binární formát trezoru (passwords.pwv)
+ * 
+ *   PasswordVaultHeader
+ *   uint32_t table[count]   offsety záznamů od začátku oblasti záznamů,
+ *                           seřazené podle názvu
+ *   uint64_t masks[count]   masky znaků názvů pro fuzzy vyhledávání
+ *                           (password_search.h), ve verzi 1 chybí
+ *   záznamy                 [délka názvu][délka hesla][název][zapečetěné heslo]
+ * 
+ * Záznamy leží v pořadí tabulky, celý trezor jde projít postupným čtením.
+ * Záznam N se najde dvěma čteními na pevných pozicích (položka tabulky
+ * a samotný záznam), bez parsování předchozích záznamů. Názvy mohou
+ * obsahovat libovolné znaky včetně ':'. Hledání v maskách nepotřebuje
+ * záznamy číst, názvy se načtou jen u kandidátů, kteří maskou projdou.
+ * 
+ * Heslo je zapečetěné samostatně (password_crypto.h), délka hesla je
+ * délka otevřeného textu, záznam má navíc PASSWORD_CRYPTO_OVERHEAD B.
+ * Otevření trezoru tak nic nedešifruje, dešifruje se až jedno vybrané
+ * heslo. Verze 1 a 2 nesou hesla v otevřeném textu a při otevření se
+ * převedou.
+ * 
+ * Záznam zabírá stejně bajtů jako v poolu seznamu ("název\0" [délka
+ * hesla][zapečetěné heslo]), plný režim proto načte oblast záznamů
+ * jediným čtením a převede ji na místě, offsety z tabulky zůstanou platné.
+ */
+
+#define PASSWORD_VAULT_MAGIC 0x54565750 // "PWVT"
+#define PASSWORD_VAULT_VERSION 3
+// Hesla v otevřeném textu, verze 1 ještě bez tabulky masek
+#define PASSWORD_VAULT_VERSION_PLAINTEXT 2
+#define PASSWORD_VAULT_VERSION_NO_MASKS 1
+#define PASSWORD_VAULT_RECORD_HEADER_SIZE 2
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t records_size;
+    uint32_t checksum; // CRC32 tabulek a záznamů
+} PasswordVaultHeader;
+
+typedef struct {
+    const char* name; // Bez ukončovací nuly
+    const uint8_t* secret; // Zapečetěné heslo (ve verzi 1 a 2 otevřený text)
+    uint8_t name_length;
+    uint8_t password_length;
+} PasswordVaultRecordView;
+
+/**
+ * @brief Spočítá CRC32 (IEEE 802.3)
+ * 
+ * @param crc Výsledek předchozího bloku, 0 pro první blok
+ * @param data Data
+ * @param size Velikost dat
+ * @return uint32_t CRC32 všech dosavadních bloků
+ */
+uint32_t password_crc32(uint32_t crc, const void* data, size_t size);
+
+/**
+ * @brief Ověří trezor načtený nebo namapovaný do paměti
+ * 
+ * @param data Obsah souboru
+ * @param size Velikost souboru
+ * @param verify_checksum Zda ověřit i kontrolní součet (čte celý soubor)
+ * @return true Pokud je trezor platný
+ * @return false Pokud trezor není platný
+ */
+bool password_vault_view_check(const uint8_t* data, size_t size, bool verify_checksum);
+
+/**
+ * @brief Najde záznam v trezoru v paměti, bez kopírování
+ * 
+ * Trezor musí projít password_vault_view_check.
+ * 
+ * @param data Obsah souboru
+ * @param size Velikost souboru
+ * @param index Index záznamu v pořadí tabulky
+ * @param record Ukazatele na název a heslo uvnitř data
+ * @return true Pokud záznam existuje
+ * @return false Pokud je index mimo rozsah nebo záznam poškozený
+ */
+bool password_vault_view_record(
+    const uint8_t* data,
+    size_t size,
+    uint32_t index,
+    PasswordVaultRecordView* record);